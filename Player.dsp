@@ -96,10 +96,50 @@ LINK32=link.exe
 # PROP Default_Filter "cpp;c;cxx;rc;def;r;odl;idl;hpj;bat"
 # Begin Source File
 
+SOURCE=.\src\AssetCache.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\AssetIndex.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\BackgroundPolicy.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\BatchRunner.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\BmpImage.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\CmdlineParser.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\CompositionPrefetch.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\DebounceScheduler.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\DisplayModeCatalog.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\FileSystem.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\FullscreenPolicy.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\GameConfig.cpp
 # End Source File
 # Begin Source File
@@ -108,14 +148,54 @@ SOURCE=.\src\GamePlayer.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\GameSession.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\Hotfix.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\HotfixPlan.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\InstanceChannel.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\JsonText.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\LatencyProbe.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\LoadDiagnostics.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\LoadProgress.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\Logger.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\MappedFile.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\PickGrid.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\Platform.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\Player.cpp
 # End Source File
 # Begin Source File
@@ -124,10 +204,30 @@ SOURCE=.\src\PlayerOptions.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\PluginDiscovery.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\PluginIndex.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\PluginManifest.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\RenderDriverCache.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\Splash.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\Thread.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\Utils.cpp
 # End Source File
 # End Group
@@ -136,14 +236,62 @@ SOURCE=.\src\Utils.cpp
 # PROP Default_Filter "h;hpp;hxx;hm;inl"
 # Begin Source File
 
+SOURCE=.\src\AssetCache.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\AssetIndex.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\BackgroundPolicy.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\BatchRunner.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\BehaviorGraphIndex.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\BmpImage.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\CmdlineParser.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\CompositionPrefetch.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\config.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\DebounceScheduler.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\DisplayModeCatalog.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\FileSystem.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\FrameRing.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\FullscreenPolicy.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\GameConfig.h
 # End Source File
 # Begin Source File
@@ -156,18 +304,74 @@ SOURCE=.\src\GamePlayer.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\GameSession.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\HotfixPlan.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\InstanceChannel.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\InterfaceManager.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\JsonText.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\LatencyProbe.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\LoadDiagnostics.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\LoadProgress.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\Logger.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\MappedFile.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\PickGrid.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\Platform.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\PlayerOptions.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\PluginDiscovery.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\PluginIndex.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\PluginManifest.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\src\RenderDriverCache.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\resource.h
 # End Source File
 # Begin Source File
@@ -180,6 +384,10 @@ SOURCE=.\src\Splash.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\src\Thread.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\src\Utils.h
 # End Source File
 # End Group
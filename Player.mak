@@ -71,14 +71,39 @@ CLEAN :
 	@if not exist "$(INTDIR)\$(NULL)" mkdir "$(INTDIR)"
 
 OBJS= \
+	"$(INTDIR)\AssetCache.obj" \
+	"$(INTDIR)\AssetIndex.obj" \
+	"$(INTDIR)\BackgroundPolicy.obj" \
+	"$(INTDIR)\BatchRunner.obj" \
+	"$(INTDIR)\BmpImage.obj" \
 	"$(INTDIR)\CmdlineParser.obj" \
+	"$(INTDIR)\CompositionPrefetch.obj" \
+	"$(INTDIR)\DebounceScheduler.obj" \
+	"$(INTDIR)\DisplayModeCatalog.obj" \
+	"$(INTDIR)\FileSystem.obj" \
+	"$(INTDIR)\FullscreenPolicy.obj" \
 	"$(INTDIR)\GameConfig.obj" \
 	"$(INTDIR)\GamePlayer.obj" \
+	"$(INTDIR)\GameSession.obj" \
 	"$(INTDIR)\Hotfix.obj" \
+	"$(INTDIR)\HotfixPlan.obj" \
+	"$(INTDIR)\InstanceChannel.obj" \
+	"$(INTDIR)\JsonText.obj" \
+	"$(INTDIR)\LatencyProbe.obj" \
+	"$(INTDIR)\LoadDiagnostics.obj" \
+	"$(INTDIR)\LoadProgress.obj" \
 	"$(INTDIR)\Logger.obj" \
+	"$(INTDIR)\MappedFile.obj" \
+	"$(INTDIR)\PickGrid.obj" \
+	"$(INTDIR)\Platform.obj" \
 	"$(INTDIR)\Player.obj" \
 	"$(INTDIR)\PlayerOptions.obj" \
+	"$(INTDIR)\PluginDiscovery.obj" \
+	"$(INTDIR)\PluginIndex.obj" \
+	"$(INTDIR)\PluginManifest.obj" \
+	"$(INTDIR)\RenderDriverCache.obj" \
 	"$(INTDIR)\Splash.obj" \
+	"$(INTDIR)\Thread.obj" \
 	"$(INTDIR)\Utils.obj" \
 	"$(INTDIR)\Player.res"
 
@@ -87,30 +112,105 @@ OBJS= \
 $(LINK32_FLAGS) $(OBJS)
 <<
 
+"$(INTDIR)\AssetCache.obj" : ".\src\AssetCache.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\AssetCache.cpp"
+
+"$(INTDIR)\AssetIndex.obj" : ".\src\AssetIndex.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\AssetIndex.cpp"
+
+"$(INTDIR)\BackgroundPolicy.obj" : ".\src\BackgroundPolicy.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\BackgroundPolicy.cpp"
+
+"$(INTDIR)\BatchRunner.obj" : ".\src\BatchRunner.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\BatchRunner.cpp"
+
+"$(INTDIR)\BmpImage.obj" : ".\src\BmpImage.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\BmpImage.cpp"
+
 "$(INTDIR)\CmdlineParser.obj" : ".\src\CmdlineParser.cpp" "$(INTDIR)"
 	$(CPP) $(CPP_PROJ) ".\src\CmdlineParser.cpp"
 
+"$(INTDIR)\CompositionPrefetch.obj" : ".\src\CompositionPrefetch.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\CompositionPrefetch.cpp"
+
+"$(INTDIR)\DebounceScheduler.obj" : ".\src\DebounceScheduler.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\DebounceScheduler.cpp"
+
+"$(INTDIR)\DisplayModeCatalog.obj" : ".\src\DisplayModeCatalog.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\DisplayModeCatalog.cpp"
+
+"$(INTDIR)\FileSystem.obj" : ".\src\FileSystem.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\FileSystem.cpp"
+
+"$(INTDIR)\FullscreenPolicy.obj" : ".\src\FullscreenPolicy.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\FullscreenPolicy.cpp"
+
 "$(INTDIR)\GameConfig.obj" : ".\src\GameConfig.cpp" "$(INTDIR)"
 	$(CPP) $(CPP_PROJ) ".\src\GameConfig.cpp"
 
 "$(INTDIR)\GamePlayer.obj" : ".\src\GamePlayer.cpp" "$(INTDIR)"
 	$(CPP) $(CPP_PROJ) ".\src\GamePlayer.cpp"
 
+"$(INTDIR)\GameSession.obj" : ".\src\GameSession.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\GameSession.cpp"
+
 "$(INTDIR)\Hotfix.obj" : ".\src\Hotfix.cpp" "$(INTDIR)"
 	$(CPP) $(CPP_PROJ) ".\src\Hotfix.cpp"
 
+"$(INTDIR)\HotfixPlan.obj" : ".\src\HotfixPlan.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\HotfixPlan.cpp"
+
+"$(INTDIR)\InstanceChannel.obj" : ".\src\InstanceChannel.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\InstanceChannel.cpp"
+
+"$(INTDIR)\JsonText.obj" : ".\src\JsonText.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\JsonText.cpp"
+
+"$(INTDIR)\LatencyProbe.obj" : ".\src\LatencyProbe.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\LatencyProbe.cpp"
+
+"$(INTDIR)\LoadDiagnostics.obj" : ".\src\LoadDiagnostics.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\LoadDiagnostics.cpp"
+
+"$(INTDIR)\LoadProgress.obj" : ".\src\LoadProgress.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\LoadProgress.cpp"
+
 "$(INTDIR)\Logger.obj" : ".\src\Logger.cpp" "$(INTDIR)"
 	$(CPP) $(CPP_PROJ) ".\src\Logger.cpp"
 
+"$(INTDIR)\MappedFile.obj" : ".\src\MappedFile.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\MappedFile.cpp"
+
+"$(INTDIR)\PickGrid.obj" : ".\src\PickGrid.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\PickGrid.cpp"
+
+"$(INTDIR)\Platform.obj" : ".\src\Platform.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\Platform.cpp"
+
 "$(INTDIR)\Player.obj" : ".\src\Player.cpp" "$(INTDIR)"
 	$(CPP) $(CPP_PROJ) ".\src\Player.cpp"
 
 "$(INTDIR)\PlayerOptions.obj" : ".\src\PlayerOptions.cpp" "$(INTDIR)"
 	$(CPP) $(CPP_PROJ) ".\src\PlayerOptions.cpp"
 
+"$(INTDIR)\PluginDiscovery.obj" : ".\src\PluginDiscovery.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\PluginDiscovery.cpp"
+
+"$(INTDIR)\PluginIndex.obj" : ".\src\PluginIndex.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\PluginIndex.cpp"
+
+"$(INTDIR)\PluginManifest.obj" : ".\src\PluginManifest.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\PluginManifest.cpp"
+
+"$(INTDIR)\RenderDriverCache.obj" : ".\src\RenderDriverCache.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\RenderDriverCache.cpp"
+
 "$(INTDIR)\Splash.obj" : ".\src\Splash.cpp" "$(INTDIR)"
 	$(CPP) $(CPP_PROJ) ".\src\Splash.cpp"
 
+"$(INTDIR)\Thread.obj" : ".\src\Thread.cpp" "$(INTDIR)"
+	$(CPP) $(CPP_PROJ) ".\src\Thread.cpp"
+
 "$(INTDIR)\Utils.obj" : ".\src\Utils.cpp" "$(INTDIR)"
 	$(CPP) $(CPP_PROJ) ".\src\Utils.cpp"
 
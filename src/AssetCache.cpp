@@ -0,0 +1,152 @@
+#include "AssetCache.h"
+
+#include "FileSystem.h"
+
+CAssetCache::CAssetCache()
+    : m_ReleaseFunction(NULL),
+      m_ReleaseContext(NULL),
+      m_Budget(0),
+      m_TotalBytes(0),
+      m_Clock(0),
+      m_Load(0),
+      m_Hits(0),
+      m_Misses(0),
+      m_Evictions(0) {}
+
+CAssetCache::~CAssetCache()
+{
+    Clear();
+}
+
+void CAssetCache::SetReleaseFunction(ReleaseFunction function, void *context)
+{
+    m_ReleaseFunction = function;
+    m_ReleaseContext = context;
+}
+
+void CAssetCache::SetBudget(platform::uint64 bytes)
+{
+    m_Budget = bytes;
+    MakeRoom(0);
+}
+
+void CAssetCache::BeginLoad()
+{
+    ++m_Load;
+}
+
+const AssetCacheEntry *CAssetCache::Find(const char *path, platform::uint32 crc)
+{
+    if (!path || !*path)
+        return NULL;
+
+    int index = IndexOf(filesystem::NormalizePath(path));
+    if (index < 0 || m_Entries[index].crc != crc)
+    {
+        ++m_Misses;
+        return NULL;
+    }
+
+    AssetCacheEntry &entry = m_Entries[index];
+    entry.lastUse = ++m_Clock;
+    entry.load = m_Load;
+    ++m_Hits;
+    return &entry;
+}
+
+const AssetCacheEntry *CAssetCache::Peek(const char *path) const
+{
+    if (!path || !*path)
+        return NULL;
+
+    int index = IndexOf(filesystem::NormalizePath(path));
+    return index >= 0 ? &m_Entries[index] : NULL;
+}
+
+bool CAssetCache::Insert(const char *path, platform::uint32 crc, platform::uint64 version, void *payload, platform::uint64 size)
+{
+    if (!path || !*path || size > m_Budget)
+        return false;
+
+    const std::string normalized = filesystem::NormalizePath(path);
+    int index = IndexOf(normalized);
+    if (index >= 0)
+        Release(index);
+
+    if (!MakeRoom(size))
+        return false;
+
+    AssetCacheEntry entry;
+    entry.path = normalized;
+    entry.crc = crc;
+    entry.version = version;
+    entry.size = size;
+    entry.payload = payload;
+    entry.lastUse = ++m_Clock;
+    entry.load = m_Load;
+    m_Entries.push_back(entry);
+    m_TotalBytes += size;
+    return true;
+}
+
+bool CAssetCache::Remove(const char *path)
+{
+    if (!path || !*path)
+        return false;
+
+    int index = IndexOf(filesystem::NormalizePath(path));
+    if (index < 0)
+        return false;
+
+    Release(index);
+    return true;
+}
+
+void CAssetCache::Clear()
+{
+    while (!m_Entries.empty())
+        Release((int)m_Entries.size() - 1);
+}
+
+int CAssetCache::IndexOf(const std::string &normalizedPath) const
+{
+    int i;
+    for (i = 0; i < (int)m_Entries.size(); ++i)
+    {
+        if (m_Entries[i].path == normalizedPath)
+            return i;
+    }
+    return -1;
+}
+
+void CAssetCache::Release(int index)
+{
+    AssetCacheEntry &entry = m_Entries[index];
+    if (m_ReleaseFunction)
+        m_ReleaseFunction(entry.payload, m_ReleaseContext);
+    m_TotalBytes -= entry.size;
+    m_Entries.erase(m_Entries.begin() + index);
+}
+
+bool CAssetCache::MakeRoom(platform::uint64 bytes)
+{
+    while (m_TotalBytes + bytes > m_Budget)
+    {
+        // Least recently used among the entries the current load has not touched.
+        int victim = -1;
+        int i;
+        for (i = 0; i < (int)m_Entries.size(); ++i)
+        {
+            if (m_Entries[i].load == m_Load)
+                continue;
+            if (victim < 0 || m_Entries[i].lastUse < m_Entries[victim].lastUse)
+                victim = i;
+        }
+        if (victim < 0)
+            return false;
+
+        Release(victim);
+        ++m_Evictions;
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef PLAYER_ASSETCACHE_H
+#define PLAYER_ASSETCACHE_H
+
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+
+struct AssetCacheEntry
+{
+    std::string path;         // normalized source path
+    platform::uint32 crc;     // CRC-32 of the source content
+    platform::uint64 version; // opaque, e.g. the modification time the CRC was taken at
+    platform::uint64 size;    // bytes charged against the budget
+    void *payload;
+    platform::uint64 lastUse;
+    platform::uint32 load;    // the load that last used the entry
+};
+
+// Content-addressed cache of loaded assets that survives between compositions.
+//
+// Entries are keyed by source path and CRC and charged their size against a
+// byte budget. Every load starts with BeginLoad(); the entries found or inserted
+// during that load are pinned until the next one, and the least recently used of
+// the others are evicted whenever an insertion would exceed the budget.
+//
+// The cache owns the payloads and hands them to the release function when an
+// entry is evicted, replaced or cleared.
+class CAssetCache
+{
+public:
+    typedef void (*ReleaseFunction)(void *payload, void *context);
+
+    CAssetCache();
+    ~CAssetCache();
+
+    void SetReleaseFunction(ReleaseFunction function, void *context);
+
+    // Evicts unpinned entries right away if the cache no longer fits. 0 disables the cache.
+    void SetBudget(platform::uint64 bytes);
+    platform::uint64 GetBudget() const { return m_Budget; }
+
+    void BeginLoad();
+
+    // Returns the entry for the path if its content has the CRC, and pins it.
+    const AssetCacheEntry *Find(const char *path, platform::uint32 crc);
+
+    // Returns the entry for the path whatever its content, without using it, so
+    // a caller can check the version before paying for a CRC.
+    const AssetCacheEntry *Peek(const char *path) const;
+
+    // Stores the payload, replacing the entry of the same path, and pins it.
+    // Returns false if it cannot fit even after evicting every unpinned entry;
+    // the caller then keeps the payload.
+    bool Insert(const char *path, platform::uint32 crc, platform::uint64 version, void *payload, platform::uint64 size);
+
+    bool Remove(const char *path);
+    void Clear();
+
+    int GetEntryCount() const { return (int)m_Entries.size(); }
+    platform::uint64 GetTotalBytes() const { return m_TotalBytes; }
+    int GetHits() const { return m_Hits; }
+    int GetMisses() const { return m_Misses; }
+    int GetEvictions() const { return m_Evictions; }
+
+private:
+    CAssetCache(const CAssetCache &);
+    CAssetCache &operator=(const CAssetCache &);
+
+    int IndexOf(const std::string &normalizedPath) const;
+    void Release(int index);
+    bool MakeRoom(platform::uint64 bytes);
+
+    std::vector<AssetCacheEntry> m_Entries;
+    ReleaseFunction m_ReleaseFunction;
+    void *m_ReleaseContext;
+    platform::uint64 m_Budget;
+    platform::uint64 m_TotalBytes;
+    platform::uint64 m_Clock;
+    platform::uint32 m_Load;
+    int m_Hits;
+    int m_Misses;
+    int m_Evictions;
+};
+
+#endif // PLAYER_ASSETCACHE_H
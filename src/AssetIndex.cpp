@@ -0,0 +1,123 @@
+#include "AssetIndex.h"
+
+#include <algorithm>
+#include <ctype.h>
+
+namespace
+{
+    // The lower-cased file name after the last separator.
+    std::string GetNameKey(const char *path)
+    {
+        const char *name = path;
+        const char *p;
+        for (p = path; *p; ++p)
+        {
+            if (*p == '/' || *p == '\\')
+                name = p + 1;
+        }
+
+        std::string key = name;
+        size_t i;
+        for (i = 0; i < key.size(); ++i)
+            key[i] = (char)tolower((unsigned char)key[i]);
+        return key;
+    }
+
+    std::string GetStem(const std::string &name)
+    {
+        const size_t dot = name.rfind('.');
+        if (dot == std::string::npos || dot == 0)
+            return name;
+        return name.substr(0, dot);
+    }
+}
+
+bool CAssetIndex::AddDirectory(const char *directory)
+{
+    if (!directory || !*directory)
+        return false;
+
+    const std::string normalized = filesystem::NormalizePath(directory);
+    if (std::find(m_Directories.begin(), m_Directories.end(), normalized) != m_Directories.end())
+        return true;
+
+    if (!m_FileSystem.DirectoryExists(directory))
+        return false;
+    m_Directories.push_back(normalized);
+
+    std::vector<FileEntry> files;
+    if (!m_FileSystem.ListFiles(directory, NULL, files))
+        return false;
+
+    size_t i;
+    for (i = 0; i < files.size(); ++i)
+    {
+        const std::string name = GetNameKey(files[i].path.c_str());
+        if (name.empty() || m_Names.find(name) != m_Names.end())
+            continue;
+
+        const size_t position = m_Files.size();
+        m_Files.push_back(files[i]);
+        m_Names[name] = position;
+
+        const std::string stem = GetStem(name);
+        if (stem != name && m_Stems.find(stem) == m_Stems.end())
+            m_Stems[stem] = position;
+    }
+    return true;
+}
+
+void CAssetIndex::Clear()
+{
+    m_Directories.clear();
+    m_Files.clear();
+    m_Names.clear();
+    m_Stems.clear();
+}
+
+const FileEntry *CAssetIndex::Find(const char *reference) const
+{
+    if (!reference || !*reference)
+        return NULL;
+
+    const std::string name = GetNameKey(reference);
+    if (name.empty())
+        return NULL;
+
+    std::map<std::string, size_t>::const_iterator it = m_Names.find(name);
+    if (it != m_Names.end())
+        return &m_Files[it->second];
+
+    if (name.find('.') == std::string::npos)
+    {
+        it = m_Stems.find(name);
+        if (it != m_Stems.end())
+            return &m_Files[it->second];
+    }
+    return NULL;
+}
+
+bool CAssetPrefetchPlanner::Add(const CAssetIndex &index, const char *reference)
+{
+    const FileEntry *file = index.Find(reference);
+    if (!file)
+    {
+        if (reference && *reference)
+            m_Unresolved.push_back(reference);
+        return false;
+    }
+
+    if (std::find(m_Paths.begin(), m_Paths.end(), file->path) != m_Paths.end())
+        return true;
+
+    m_Paths.push_back(file->path);
+    m_Bytes += file->size;
+    return true;
+}
+
+void CAssetPrefetchPlanner::Clear()
+{
+    m_Paths.clear();
+    m_Unresolved.clear();
+    m_Bytes = 0;
+}
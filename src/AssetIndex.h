@@ -0,0 +1,66 @@
+#ifndef PLAYER_ASSETINDEX_H
+#define PLAYER_ASSETINDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FileSystem.h"
+
+// Maps asset file names to the files found in the composition's asset
+// directories, so every reference resolves with one lookup instead of a probe of
+// each directory.
+class CAssetIndex
+{
+public:
+    explicit CAssetIndex(CFileSystem &fileSystem) : m_FileSystem(fileSystem) {}
+
+    // Lists the directory once (not recursively) and indexes its files. When two
+    // directories hold the same name, the one added first wins, as in the path
+    // manager. Returns false if the directory does not exist.
+    bool AddDirectory(const char *directory);
+
+    void Clear();
+
+    // Returns the file a reference resolves to, or NULL. Any directory part of the
+    // reference is ignored and names compare case-insensitively; a reference
+    // without an extension also matches a file by its stem.
+    const FileEntry *Find(const char *reference) const;
+
+    int GetFileCount() const { return (int)m_Files.size(); }
+    int GetDirectoryCount() const { return (int)m_Directories.size(); }
+
+private:
+    CAssetIndex(const CAssetIndex &);
+    CAssetIndex &operator=(const CAssetIndex &);
+
+    CFileSystem &m_FileSystem;
+    std::vector<std::string> m_Directories;
+    std::vector<FileEntry> m_Files;
+    std::map<std::string, size_t> m_Names;
+    std::map<std::string, size_t> m_Stems;
+};
+
+// Collects the files the assets of a composition resolve to, each once and in
+// the order first referenced, for the read-ahead.
+class CAssetPrefetchPlanner
+{
+public:
+    CAssetPrefetchPlanner() : m_Bytes(0) {}
+
+    // Returns false if the reference does not resolve; it is then recorded as unresolved.
+    bool Add(const CAssetIndex &index, const char *reference);
+
+    void Clear();
+
+    const std::vector<std::string> &GetPaths() const { return m_Paths; }
+    const std::vector<std::string> &GetUnresolved() const { return m_Unresolved; }
+    platform::uint64 GetBytes() const { return m_Bytes; }
+
+private:
+    std::vector<std::string> m_Paths;
+    std::vector<std::string> m_Unresolved;
+    platform::uint64 m_Bytes;
+};
+
+#endif // PLAYER_ASSETINDEX_H
@@ -0,0 +1,76 @@
+#include "BackgroundPolicy.h"
+
+CBackgroundPolicy::CBackgroundPolicy()
+    : m_Mode(eBackgroundContinue),
+      m_ThrottleFps(DEFAULT_THROTTLE_FPS),
+      m_Active(true),
+      m_HasThrottledFrame(false),
+      m_LastThrottledFrame(0) {}
+
+void CBackgroundPolicy::Configure(int mode, int throttleFps)
+{
+    m_Mode = (mode >= 0 && mode < eBackgroundModeCount) ? (BackgroundMode)mode : eBackgroundContinue;
+    m_ThrottleFps = (throttleFps > 0 && throttleFps <= MAX_THROTTLE_FPS) ? throttleFps : DEFAULT_THROTTLE_FPS;
+    m_HasThrottledFrame = false;
+}
+
+void CBackgroundPolicy::SetActive(bool active)
+{
+    if (m_Active == active)
+        return;
+
+    m_Active = active;
+    m_HasThrottledFrame = false;
+}
+
+BackgroundAction CBackgroundPolicy::Decide(platform::uint64 now, bool processDue, bool renderDue)
+{
+    BackgroundAction action;
+    action.process = processDue;
+    action.render = renderDue;
+    action.wait = eBackgroundNoWait;
+    action.waitMs = 0;
+
+    if (m_Active)
+        return action;
+
+    switch (m_Mode)
+    {
+    case eBackgroundThrottle:
+    {
+        const platform::uint64 interval = 1000000 / m_ThrottleFps;
+        if (!m_HasThrottledFrame || now - m_LastThrottledFrame >= interval)
+        {
+            // A throttled frame always processes and renders, whatever the limiter says.
+            m_HasThrottledFrame = true;
+            m_LastThrottledFrame = now;
+            action.process = true;
+            action.render = true;
+        }
+        else
+        {
+            const platform::uint64 remaining = interval - (now - m_LastThrottledFrame);
+            action.process = false;
+            action.render = false;
+            action.wait = eBackgroundWaitTimeout;
+            action.waitMs = (unsigned int)((remaining + 999) / 1000);
+        }
+        break;
+    }
+
+    case eBackgroundProcessOnly:
+        action.render = false;
+        break;
+
+    case eBackgroundPause:
+        action.process = false;
+        action.render = false;
+        action.wait = eBackgroundWaitMessage;
+        break;
+
+    default:
+        break;
+    }
+
+    return action;
+}
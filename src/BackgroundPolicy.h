@@ -0,0 +1,66 @@
+#ifndef PLAYER_BACKGROUNDPOLICY_H
+#define PLAYER_BACKGROUNDPOLICY_H
+
+#include "Platform.h"
+
+// What the player keeps doing while its window is not the active one.
+enum BackgroundMode
+{
+    eBackgroundContinue = 0, // run as if focused
+    eBackgroundThrottle,     // process and render at a reduced frame rate
+    eBackgroundProcessOnly,  // keep processing, stop rendering
+    eBackgroundPause,        // sleep until the next window message
+    eBackgroundModeCount
+};
+
+enum BackgroundWait
+{
+    eBackgroundNoWait = 0,
+    eBackgroundWaitTimeout, // wait for a message or the timeout, whichever comes first
+    eBackgroundWaitMessage  // wait for a message only
+};
+
+struct BackgroundAction
+{
+    bool process;
+    bool render;
+    BackgroundWait wait;
+    unsigned int waitMs;
+};
+
+// Decides, once per idle loop iteration, whether the frame limiter's verdict stands.
+class CBackgroundPolicy
+{
+public:
+    enum
+    {
+        DEFAULT_THROTTLE_FPS = 10,
+        MAX_THROTTLE_FPS = 1000
+    };
+
+    CBackgroundPolicy();
+
+    // Out of range values fall back to eBackgroundContinue and DEFAULT_THROTTLE_FPS.
+    void Configure(int mode, int throttleFps);
+
+    BackgroundMode GetMode() const { return m_Mode; }
+    int GetThrottleFps() const { return m_ThrottleFps; }
+
+    void SetActive(bool active);
+    bool IsActive() const { return m_Active; }
+
+    // True while the policy holds the player back from running normally.
+    bool IsRestricting() const { return !m_Active && m_Mode != eBackgroundContinue; }
+
+    // processDue/renderDue are what the frame limiter asks for at time now (microseconds).
+    BackgroundAction Decide(platform::uint64 now, bool processDue, bool renderDue);
+
+private:
+    BackgroundMode m_Mode;
+    int m_ThrottleFps;
+    bool m_Active;
+    bool m_HasThrottledFrame;
+    platform::uint64 m_LastThrottledFrame;
+};
+
+#endif // PLAYER_BACKGROUNDPOLICY_H
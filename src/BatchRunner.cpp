@@ -0,0 +1,853 @@
+#include "BatchRunner.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "JsonText.h"
+
+namespace
+{
+    const char RESULT_MAGIC[] = "BallancePlayerBatchResult";
+    const int RESULT_VERSION = 1;
+
+    const char *const STATUS_NAMES[eBatchStatusCount] = {
+        "pending",
+        "passed",
+        "load_failed",
+        "hotfix_failed",
+        "crashed",
+        "timed_out",
+        "launch_failed",
+    };
+
+    const char *const HOTFIX_NAMES[] = {
+        "skipped",
+        "applied",
+        "failed",
+    };
+
+    // The options that take a value; the parent keeps them for itself.
+    const char *const BATCH_OPTIONS[] = {
+        "--batch",
+        "--batch-report",
+        "--batch-jobs",
+        "--batch-frames",
+        "--batch-timeout",
+        "--batch-worker",
+    };
+
+    const int BATCH_OPTION_COUNT = (int)(sizeof(BATCH_OPTIONS) / sizeof(BATCH_OPTIONS[0]));
+
+    bool IsOptionLike(const std::string &text)
+    {
+        return text.size() >= 2 && text[0] == '-' && !(text[1] >= '0' && text[1] <= '9');
+    }
+
+    bool ReadFile(const char *filename, std::string &text)
+    {
+        text.clear();
+        if (!filename || !*filename)
+            return false;
+
+        FILE *file = fopen(filename, "rb");
+        if (!file)
+            return false;
+
+        char buffer[4096];
+        size_t received;
+        while ((received = fread(buffer, 1, sizeof(buffer), file)) > 0)
+            text.append(buffer, received);
+        fclose(file);
+        return true;
+    }
+
+    bool WriteFile(const char *filename, const std::string &text)
+    {
+        if (!filename || !*filename)
+            return false;
+
+        FILE *file = fopen(filename, "wb");
+        if (!file)
+            return false;
+
+        bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+        if (fclose(file) != 0)
+            ok = false;
+        return ok;
+    }
+
+    bool FileExists(const std::string &filename)
+    {
+        FILE *file = fopen(filename.c_str(), "rb");
+        if (!file)
+            return false;
+        fclose(file);
+        return true;
+    }
+
+    // Results are written by the worker that found them; nothing in them may
+    // break a line.
+    std::string MakeStorable(const std::string &text)
+    {
+        std::string result = text;
+        size_t i;
+        for (i = 0; i < result.size(); ++i)
+        {
+            if (result[i] == '\t' || result[i] == '\r' || result[i] == '\n')
+                result[i] = ' ';
+        }
+        return result;
+    }
+
+    void SplitFields(const std::string &line, std::vector<std::string> &fields)
+    {
+        fields.clear();
+        size_t start = 0;
+        for (;;)
+        {
+            size_t tab = line.find('\t', start);
+            if (tab == std::string::npos)
+            {
+                fields.push_back(line.substr(start));
+                return;
+            }
+            fields.push_back(line.substr(start, tab - start));
+            start = tab + 1;
+        }
+    }
+
+    std::string TrimLine(const std::string &line)
+    {
+        size_t begin = 0;
+        size_t end = line.size();
+        while (begin < end && (line[begin] == ' ' || line[begin] == '\t'))
+            ++begin;
+        while (end > begin && (line[end - 1] == ' ' || line[end - 1] == '\t' || line[end - 1] == '\r'))
+            --end;
+        return line.substr(begin, end - begin);
+    }
+
+    void AppendUInt64(std::string &text, platform::uint64 value)
+    {
+        char digits[24];
+        int count = 0;
+        do
+        {
+            digits[count++] = (char)('0' + (int)(value % 10));
+            value /= 10;
+        } while (value != 0);
+        while (count > 0)
+            text += digits[--count];
+    }
+
+    void AppendInt(std::string &text, int value)
+    {
+        if (value < 0)
+        {
+            text += '-';
+            AppendUInt64(text, (platform::uint64)(-(value + 1)) + 1);
+            return;
+        }
+        AppendUInt64(text, (platform::uint64)value);
+    }
+
+    bool ParseUInt64(const std::string &text, platform::uint64 &value)
+    {
+        if (text.empty() || text.size() > 20)
+            return false;
+
+        platform::uint64 result = 0;
+        size_t i;
+        for (i = 0; i < text.size(); ++i)
+        {
+            if (text[i] < '0' || text[i] > '9')
+                return false;
+            result = result * 10 + (platform::uint64)(text[i] - '0');
+        }
+        value = result;
+        return true;
+    }
+
+    bool ParseInt(const std::string &text, int &value)
+    {
+        platform::uint64 result = 0;
+        if (text.size() > 10 || !ParseUInt64(text, result) || result > 0x7FFFFFFF)
+            return false;
+        value = (int)result;
+        return true;
+    }
+
+    int FindName(const char *const *names, int count, const std::string &name)
+    {
+        int i;
+        for (i = 0; i < count; ++i)
+        {
+            if (name == names[i])
+                return i;
+        }
+        return -1;
+    }
+
+    void AppendJsonKey(std::string &json, const char *indent, const char *key)
+    {
+        json += indent;
+        json += '"';
+        json += key;
+        json += "\": ";
+    }
+
+    void AppendJsonNumber(std::string &json, const char *indent, const char *key, platform::uint64 value, bool last = false)
+    {
+        AppendJsonKey(json, indent, key);
+        AppendUInt64(json, value);
+        json += last ? "\n" : ",\n";
+    }
+
+    void AppendJsonInt(std::string &json, const char *indent, const char *key, int value, bool last = false)
+    {
+        AppendJsonKey(json, indent, key);
+        AppendInt(json, value);
+        json += last ? "\n" : ",\n";
+    }
+
+    void AppendJsonText(std::string &json, const char *indent, const char *key, const std::string &value, bool last = false)
+    {
+        AppendJsonKey(json, indent, key);
+        jsontext::AppendString(json, value);
+        json += last ? "\n" : ",\n";
+    }
+
+    void AppendResultJson(std::string &json, const BatchResult &result)
+    {
+        const char *indent = "      ";
+        json += "    {\n";
+        AppendJsonText(json, indent, "composition", result.composition);
+        AppendJsonText(json, indent, "status", batchrunner::GetStatusName(result.status));
+        AppendJsonInt(json, indent, "exit_code", result.exitCode);
+        AppendJsonNumber(json, indent, "load_us", result.loadUs);
+        AppendJsonText(json, indent, "hotfix", batchrunner::GetHotfixName(result.hotfix));
+
+        AppendJsonKey(json, indent, "missing_guids");
+        json += '[';
+        size_t i;
+        for (i = 0; i < result.missingGuids.size(); ++i)
+        {
+            if (i > 0)
+                json += ", ";
+            jsontext::AppendString(json, result.missingGuids[i]);
+        }
+        json += "],\n";
+
+        const BatchFrameStats &frames = result.frameStats;
+        AppendJsonKey(json, indent, "frames");
+        json += "{\"count\": ";
+        AppendInt(json, frames.frames);
+        json += ", \"mean_us\": ";
+        AppendUInt64(json, frames.frames > 0 ? frames.totalUs / (platform::uint64)frames.frames : 0);
+        json += ", \"min_us\": ";
+        AppendUInt64(json, frames.minUs);
+        json += ", \"max_us\": ";
+        AppendUInt64(json, frames.maxUs);
+        json += ", \"p95_us\": ";
+        AppendUInt64(json, frames.p95Us);
+        json += "},\n";
+
+        AppendJsonText(json, indent, "error", result.error);
+        AppendJsonText(json, indent, "log", result.logFile, true);
+        json += "    }";
+    }
+}
+
+BatchResult::BatchResult()
+{
+    Reset(std::string());
+}
+
+void BatchResult::Reset(const std::string &file)
+{
+    composition = file;
+    status = eBatchPending;
+    exitCode = 0;
+    loadUs = 0;
+    hotfix = eBatchHotfixSkipped;
+    missingGuids.clear();
+    memset(&frameStats, 0, sizeof(frameStats));
+    error.clear();
+    logFile.clear();
+}
+
+namespace batchrunner
+{
+    void RemoveOptions(std::vector<std::string> &args)
+    {
+        std::vector<std::string> kept;
+        size_t i = 0;
+        while (i < args.size())
+        {
+            const std::string &arg = args[i];
+            bool matched = false;
+            bool jointed = false;
+            int j;
+            for (j = 0; j < BATCH_OPTION_COUNT && !matched; ++j)
+            {
+                const size_t length = strlen(BATCH_OPTIONS[j]);
+                if (arg.compare(0, length, BATCH_OPTIONS[j]) != 0)
+                    continue;
+                if (arg.size() == length)
+                    matched = true;
+                else if (arg[length] == '=')
+                    matched = jointed = true;
+            }
+
+            ++i;
+            if (!matched)
+            {
+                kept.push_back(arg);
+                continue;
+            }
+            if (!jointed && i < args.size() && !IsOptionLike(args[i]))
+                ++i;
+        }
+        args.swap(kept);
+    }
+
+    void ReadJobList(const std::string &text, std::vector<std::string> &compositions)
+    {
+        size_t start = 0;
+        while (start < text.size())
+        {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos)
+                end = text.size();
+
+            std::string line = TrimLine(text.substr(start, end - start));
+            if (!line.empty() && line[0] != '#')
+                compositions.push_back(line);
+            start = end + 1;
+        }
+    }
+
+    bool LoadJobList(const char *filename, std::vector<std::string> &compositions)
+    {
+        std::string text;
+        if (!ReadFile(filename, text))
+            return false;
+
+        // Lists saved by Notepad start with a byte order mark.
+        if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0)
+            text.erase(0, 3);
+        ReadJobList(text, compositions);
+        return true;
+    }
+
+    void WriteResult(const BatchResult &result, std::string &text)
+    {
+        text = RESULT_MAGIC;
+        text += ' ';
+        AppendInt(text, RESULT_VERSION);
+        text += '\n';
+
+        text += "composition\t";
+        text += MakeStorable(result.composition);
+        text += "\nstatus\t";
+        text += GetStatusName(result.status);
+        text += "\nload_us\t";
+        AppendUInt64(text, result.loadUs);
+        text += "\nhotfix\t";
+        text += GetHotfixName(result.hotfix);
+        text += '\n';
+
+        size_t i;
+        for (i = 0; i < result.missingGuids.size(); ++i)
+        {
+            text += "missing_guid\t";
+            text += MakeStorable(result.missingGuids[i]);
+            text += '\n';
+        }
+
+        const BatchFrameStats &frames = result.frameStats;
+        text += "frames\t";
+        AppendInt(text, frames.frames);
+        text += '\t';
+        AppendUInt64(text, frames.totalUs);
+        text += '\t';
+        AppendUInt64(text, frames.minUs);
+        text += '\t';
+        AppendUInt64(text, frames.maxUs);
+        text += '\t';
+        AppendUInt64(text, frames.p95Us);
+        text += '\n';
+
+        if (!result.error.empty())
+        {
+            text += "error\t";
+            text += MakeStorable(result.error);
+            text += '\n';
+        }
+    }
+
+    bool ReadResult(const std::string &text, BatchResult &result)
+    {
+        BatchResult read;
+        std::vector<std::string> fields;
+        bool header = false;
+        bool hasStatus = false;
+
+        size_t start = 0;
+        while (start < text.size())
+        {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos)
+                end = text.size();
+            std::string line = text.substr(start, end - start);
+            start = end + 1;
+            if (!line.empty() && line[line.size() - 1] == '\r')
+                line.erase(line.size() - 1);
+
+            if (!header)
+            {
+                std::string expected = RESULT_MAGIC;
+                expected += ' ';
+                AppendInt(expected, RESULT_VERSION);
+                if (line != expected)
+                    return false;
+                header = true;
+                continue;
+            }
+            if (line.empty())
+                continue;
+
+            SplitFields(line, fields);
+            const std::string &key = fields[0];
+            if (fields.size() < 2)
+                return false;
+
+            if (key == "composition")
+            {
+                read.composition = fields[1];
+            }
+            else if (key == "status")
+            {
+                read.status = FindName(STATUS_NAMES, eBatchStatusCount, fields[1]);
+                if (read.status < 0)
+                    return false;
+                hasStatus = true;
+            }
+            else if (key == "load_us")
+            {
+                if (!ParseUInt64(fields[1], read.loadUs))
+                    return false;
+            }
+            else if (key == "hotfix")
+            {
+                read.hotfix = FindName(HOTFIX_NAMES, 3, fields[1]);
+                if (read.hotfix < 0)
+                    return false;
+            }
+            else if (key == "missing_guid")
+            {
+                read.missingGuids.push_back(fields[1]);
+            }
+            else if (key == "frames")
+            {
+                BatchFrameStats &frames = read.frameStats;
+                if (fields.size() != 6 ||
+                    !ParseInt(fields[1], frames.frames) ||
+                    !ParseUInt64(fields[2], frames.totalUs) ||
+                    !ParseUInt64(fields[3], frames.minUs) ||
+                    !ParseUInt64(fields[4], frames.maxUs) ||
+                    !ParseUInt64(fields[5], frames.p95Us))
+                    return false;
+            }
+            else if (key == "error")
+            {
+                read.error = fields[1];
+            }
+            // Keys from a later version are skipped.
+        }
+
+        if (!header || !hasStatus)
+            return false;
+
+        read.exitCode = result.exitCode;
+        read.logFile = result.logFile;
+        result = read;
+        return true;
+    }
+
+    bool SaveResult(const char *filename, const BatchResult &result)
+    {
+        std::string text;
+        WriteResult(result, text);
+        return WriteFile(filename, text);
+    }
+
+    bool LoadResult(const char *filename, BatchResult &result)
+    {
+        std::string text;
+        if (!ReadFile(filename, text))
+            return false;
+        return ReadResult(text, result);
+    }
+
+    const char *GetStatusName(int status)
+    {
+        if (status < 0 || status >= eBatchStatusCount)
+            return "unknown";
+        return STATUS_NAMES[status];
+    }
+
+    const char *GetHotfixName(int hotfix)
+    {
+        if (hotfix < eBatchHotfixSkipped || hotfix > eBatchHotfixError)
+            return "unknown";
+        return HOTFIX_NAMES[hotfix];
+    }
+}
+
+CBatchProcessLauncher::CBatchProcessLauncher(const std::string &executable, const std::vector<std::string> &arguments,
+                                             const std::string &resultPrefix)
+    : m_Executable(executable), m_Arguments(arguments), m_ResultPrefix(resultPrefix) {}
+
+CBatchProcessLauncher::~CBatchProcessLauncher()
+{
+    size_t i;
+    for (i = 0; i < m_Processes.size(); ++i)
+    {
+        if (m_Processes[i].running)
+            Kill((int)i);
+    }
+}
+
+std::string CBatchProcessLauncher::GetLogFile(const std::string &resultFile)
+{
+    const size_t dot = resultFile.find_last_of('.');
+    const size_t separator = resultFile.find_last_of("/\\");
+    if (dot == std::string::npos || (separator != std::string::npos && dot < separator))
+        return resultFile + ".log";
+    return resultFile.substr(0, dot) + ".log";
+}
+
+bool CBatchProcessLauncher::Start(int job, const std::string &composition, int &worker)
+{
+    Process process;
+    process.resultFile = m_ResultPrefix + "-";
+    AppendInt(process.resultFile, job);
+    process.resultFile += ".txt";
+    process.running = false;
+
+    // A result left by an earlier run must not be taken for this one.
+    remove(process.resultFile.c_str());
+
+    std::vector<std::string> args;
+    args.push_back(m_Executable);
+    args.insert(args.end(), m_Arguments.begin(), m_Arguments.end());
+    args.push_back("--batch-worker");
+    args.push_back(process.resultFile);
+    args.push_back("--cmo");
+    args.push_back(composition);
+
+#ifdef _WIN32
+    // The player splits its command line at blanks outside of quotes and drops
+    // the quotes, so quoting every argument keeps paths with blanks together.
+    std::string commandLine;
+    size_t i;
+    for (i = 0; i < args.size(); ++i)
+    {
+        if (i > 0)
+            commandLine += ' ';
+        commandLine += '"';
+        commandLine += args[i];
+        commandLine += '"';
+    }
+
+    STARTUPINFOA si;
+    PROCESS_INFORMATION pi;
+    memset(&si, 0, sizeof(si));
+    si.cb = sizeof(si);
+    memset(&pi, 0, sizeof(pi));
+    if (!::CreateProcessA(m_Executable.c_str(), &commandLine[0], NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi))
+        return false;
+    ::CloseHandle(pi.hThread);
+    process.handle = pi.hProcess;
+#else
+    std::vector<char *> argv;
+    size_t i;
+    for (i = 0; i < args.size(); ++i)
+        argv.push_back(&args[i][0]);
+    argv.push_back(NULL);
+
+    const pid_t pid = fork();
+    if (pid < 0)
+        return false;
+    if (pid == 0)
+    {
+        execv(m_Executable.c_str(), &argv[0]);
+        _exit(127);
+    }
+    process.pid = (int)pid;
+#endif
+
+    process.running = true;
+    worker = (int)m_Processes.size();
+    m_Processes.push_back(process);
+    return true;
+}
+
+bool CBatchProcessLauncher::Poll(int worker, BatchResult &result)
+{
+    if (worker < 0 || worker >= (int)m_Processes.size())
+        return true;
+
+    Process &process = m_Processes[worker];
+    if (!process.running)
+        return true;
+
+#ifdef _WIN32
+    if (::WaitForSingleObject((HANDLE)process.handle, 0) != WAIT_OBJECT_0)
+        return false;
+
+    DWORD exitCode = 0;
+    if (!::GetExitCodeProcess((HANDLE)process.handle, &exitCode))
+        exitCode = (DWORD)-1;
+    ::CloseHandle((HANDLE)process.handle);
+    process.handle = NULL;
+    Collect(process, (int)exitCode, result);
+#else
+    int status = 0;
+    const pid_t pid = waitpid((pid_t)process.pid, &status, WNOHANG);
+    if (pid == 0)
+        return false;
+
+    int exitCode = -1;
+    if (pid > 0 && WIFEXITED(status))
+        exitCode = WEXITSTATUS(status);
+    else if (pid > 0 && WIFSIGNALED(status))
+        exitCode = 128 + WTERMSIG(status);
+    Collect(process, exitCode, result);
+#endif
+    return true;
+}
+
+void CBatchProcessLauncher::Kill(int worker)
+{
+    if (worker < 0 || worker >= (int)m_Processes.size())
+        return;
+
+    Process &process = m_Processes[worker];
+    if (!process.running)
+        return;
+
+#ifdef _WIN32
+    ::TerminateProcess((HANDLE)process.handle, 1);
+    ::WaitForSingleObject((HANDLE)process.handle, INFINITE);
+    ::CloseHandle((HANDLE)process.handle);
+    process.handle = NULL;
+#else
+    kill((pid_t)process.pid, SIGKILL);
+    int status = 0;
+    waitpid((pid_t)process.pid, &status, 0);
+#endif
+    process.running = false;
+    remove(process.resultFile.c_str());
+}
+
+void CBatchProcessLauncher::Collect(Process &process, int exitCode, BatchResult &result)
+{
+    process.running = false;
+
+    result.exitCode = exitCode;
+    const std::string composition = result.composition;
+    batchrunner::LoadResult(process.resultFile.c_str(), result);
+    result.composition = composition;
+    remove(process.resultFile.c_str());
+
+    const std::string logFile = GetLogFile(process.resultFile);
+    if (FileExists(logFile))
+        result.logFile = logFile;
+}
+
+CBatchScheduler::CBatchScheduler()
+    : m_Concurrency(1), m_TimeoutUs(0), m_NextJob(0), m_Finished(0) {}
+
+void CBatchScheduler::SetConcurrency(int workers)
+{
+    m_Concurrency = workers < 1 ? 1 : workers;
+}
+
+void CBatchScheduler::AddJob(const std::string &composition)
+{
+    BatchResult result;
+    result.Reset(composition);
+    m_Results.push_back(result);
+}
+
+bool CBatchScheduler::Step(CBatchLauncher &launcher, platform::uint64 now)
+{
+    size_t i = 0;
+    while (i < m_Running.size())
+    {
+        const Slot slot = m_Running[i];
+        if (launcher.Poll(slot.worker, m_Results[slot.job]))
+        {
+            m_Running.erase(m_Running.begin() + i);
+            BatchResult &result = m_Results[slot.job];
+            if (result.status == eBatchPending)
+                Fail(slot.job, eBatchCrashed, "The worker exited without a result.");
+            else
+                ++m_Finished;
+            continue;
+        }
+
+        if (m_TimeoutUs > 0 && now - slot.startTime >= m_TimeoutUs)
+        {
+            launcher.Kill(slot.worker);
+            m_Running.erase(m_Running.begin() + i);
+            Fail(slot.job, eBatchTimedOut, "The worker ran out of time and was killed.");
+            continue;
+        }
+        ++i;
+    }
+
+    while ((int)m_Running.size() < m_Concurrency && m_NextJob < (int)m_Results.size())
+    {
+        Slot slot;
+        slot.job = m_NextJob++;
+        slot.worker = -1;
+        slot.startTime = now;
+        if (!launcher.Start(slot.job, m_Results[slot.job].composition, slot.worker))
+        {
+            Fail(slot.job, eBatchLaunchFailed, "The worker could not be started.");
+            continue;
+        }
+        m_Running.push_back(slot);
+    }
+
+    return m_Finished < (int)m_Results.size();
+}
+
+void CBatchScheduler::Run(CBatchLauncher &launcher, unsigned int pollMs)
+{
+    while (Step(launcher, platform::GetTimeMicros()))
+        platform::SleepMs(pollMs);
+}
+
+void CBatchScheduler::Fail(int job, int status, const char *error)
+{
+    BatchResult &result = m_Results[job];
+    result.status = status;
+    result.error = error;
+    ++m_Finished;
+}
+
+CBatchReport::CBatchReport()
+{
+    m_Summary.jobs = 0;
+    memset(m_Summary.statusCounts, 0, sizeof(m_Summary.statusCounts));
+    m_Summary.missingGuidJobs = 0;
+    m_Summary.hotfixApplied = 0;
+    m_Summary.hotfixFailed = 0;
+    m_Summary.loadedJobs = 0;
+    m_Summary.totalLoadUs = 0;
+    m_Summary.maxLoadUs = 0;
+    m_Summary.wallUs = 0;
+}
+
+void CBatchReport::Add(const BatchResult &result)
+{
+    m_Results.push_back(result);
+
+    ++m_Summary.jobs;
+    if (result.status >= 0 && result.status < eBatchStatusCount)
+        ++m_Summary.statusCounts[result.status];
+    if (!result.missingGuids.empty())
+        ++m_Summary.missingGuidJobs;
+    if (result.hotfix == eBatchHotfixApplied)
+        ++m_Summary.hotfixApplied;
+    else if (result.hotfix == eBatchHotfixError)
+        ++m_Summary.hotfixFailed;
+
+    // A load that failed stopped somewhere in the middle; its time says little.
+    if (result.status == eBatchPassed || result.status == eBatchHotfixFailed)
+    {
+        ++m_Summary.loadedJobs;
+        m_Summary.totalLoadUs += result.loadUs;
+        if (result.loadUs > m_Summary.maxLoadUs || m_Summary.slowestLoad.empty())
+        {
+            m_Summary.maxLoadUs = result.loadUs;
+            m_Summary.slowestLoad = result.composition;
+        }
+    }
+}
+
+void CBatchReport::AddAll(const std::vector<BatchResult> &results)
+{
+    size_t i;
+    for (i = 0; i < results.size(); ++i)
+        Add(results[i]);
+}
+
+bool CBatchReport::AllPassed() const
+{
+    return m_Summary.statusCounts[eBatchPassed] == m_Summary.jobs;
+}
+
+void CBatchReport::WriteJson(std::string &json) const
+{
+    const BatchSummary &summary = m_Summary;
+
+    json = "{\n";
+    AppendJsonInt(json, "  ", "version", VERSION);
+
+    json += "  \"summary\": {\n";
+    AppendJsonInt(json, "    ", "jobs", summary.jobs);
+    AppendJsonInt(json, "    ", "passed", summary.statusCounts[eBatchPassed]);
+    AppendJsonInt(json, "    ", "failed", summary.jobs - summary.statusCounts[eBatchPassed]);
+    json += "    \"statuses\": {";
+    int i;
+    bool first = true;
+    for (i = eBatchPassed; i < eBatchStatusCount; ++i)
+    {
+        if (!first)
+            json += ", ";
+        first = false;
+        jsontext::AppendString(json, STATUS_NAMES[i]);
+        json += ": ";
+        AppendInt(json, summary.statusCounts[i]);
+    }
+    json += "},\n";
+    AppendJsonInt(json, "    ", "missing_guid_jobs", summary.missingGuidJobs);
+    AppendJsonInt(json, "    ", "hotfix_applied", summary.hotfixApplied);
+    AppendJsonInt(json, "    ", "hotfix_failed", summary.hotfixFailed);
+    AppendJsonNumber(json, "    ", "total_load_us", summary.totalLoadUs);
+    AppendJsonNumber(json, "    ", "mean_load_us",
+                     summary.loadedJobs > 0 ? summary.totalLoadUs / (platform::uint64)summary.loadedJobs : 0);
+    AppendJsonNumber(json, "    ", "max_load_us", summary.maxLoadUs);
+    AppendJsonText(json, "    ", "slowest_load", summary.slowestLoad);
+    AppendJsonNumber(json, "    ", "wall_us", summary.wallUs, true);
+    json += "  },\n";
+
+    json += "  \"results\": [";
+    size_t j;
+    for (j = 0; j < m_Results.size(); ++j)
+    {
+        json += j > 0 ? ",\n" : "\n";
+        AppendResultJson(json, m_Results[j]);
+    }
+    json += m_Results.empty() ? "]\n" : "\n  ]\n";
+    json += "}\n";
+}
+
+bool CBatchReport::Save(const char *filename) const
+{
+    std::string json;
+    WriteJson(json);
+    return WriteFile(filename, json);
+}
@@ -0,0 +1,233 @@
+#ifndef PLAYER_BATCHRUNNER_H
+#define PLAYER_BATCHRUNNER_H
+
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+
+enum BatchStatus
+{
+    eBatchPending = 0,
+    eBatchPassed,
+    eBatchLoadFailed,
+    eBatchHotfixFailed,
+    eBatchCrashed,      // the worker exited without writing a result
+    eBatchTimedOut,
+    eBatchLaunchFailed,
+    eBatchStatusCount
+};
+
+enum BatchHotfix
+{
+    eBatchHotfixSkipped = 0, // disabled, or the composition has no interface manager
+    eBatchHotfixApplied,
+    eBatchHotfixError
+};
+
+struct BatchFrameStats
+{
+    int frames;
+    platform::uint64 totalUs;
+    platform::uint64 minUs;
+    platform::uint64 maxUs;
+    platform::uint64 p95Us;
+};
+
+// What one worker found out about one composition.
+struct BatchResult
+{
+    std::string composition;
+    int status;
+    int exitCode;
+    platform::uint64 loadUs;
+    int hotfix;
+    std::vector<std::string> missingGuids; // "d1,d2" in hex, as the load logs them
+    BatchFrameStats frameStats;
+    std::string error;
+    std::string logFile;
+
+    BatchResult();
+    void Reset(const std::string &file);
+};
+
+struct BatchOptions
+{
+    std::string listFile;   // --batch <file>, one composition per line
+    std::string reportFile; // --batch-report <file>
+    int jobs;               // --batch-jobs <n>, 0 for one per processor
+    int frames;             // --batch-frames <n>
+    int timeoutSeconds;     // --batch-timeout <s>, 0 for none
+    std::string resultFile; // --batch-worker <file>, set in the worker processes
+
+    BatchOptions()
+        : reportFile("BatchReport.json"), jobs(0), frames(100), timeoutSeconds(120) {}
+
+    bool IsWorker() const { return !resultFile.empty(); }
+    bool IsBatch() const { return !listFile.empty() || IsWorker(); }
+};
+
+namespace batchrunner
+{
+    // Drops the batch options from split command line arguments, so the rest can
+    // be handed on to the workers.
+    void RemoveOptions(std::vector<std::string> &args);
+
+    // One composition per line; blank lines and lines starting with '#' are skipped.
+    void ReadJobList(const std::string &text, std::vector<std::string> &compositions);
+    bool LoadJobList(const char *filename, std::vector<std::string> &compositions);
+
+    // The file a worker leaves for the runner, one "key<TAB>value" line per field.
+    void WriteResult(const BatchResult &result, std::string &text);
+    bool ReadResult(const std::string &text, BatchResult &result);
+    bool SaveResult(const char *filename, const BatchResult &result);
+    bool LoadResult(const char *filename, BatchResult &result);
+
+    const char *GetStatusName(int status);
+    const char *GetHotfixName(int hotfix);
+}
+
+// Starts and watches the workers, so the scheduler can run without processes in tests.
+class CBatchLauncher
+{
+public:
+    virtual ~CBatchLauncher() {}
+
+    // Starts a worker on the composition; the worker id names it in the other calls.
+    virtual bool Start(int job, const std::string &composition, int &worker) = 0;
+
+    // True once the worker is gone. The result holds what it reported; its status
+    // stays pending if it reported nothing.
+    virtual bool Poll(int worker, BatchResult &result) = 0;
+
+    virtual void Kill(int worker) = 0;
+};
+
+// Runs the player once per composition in worker processes of its own:
+//   <executable> <arguments> --batch-worker <prefix>-<job>.txt --cmo <composition>
+// The worker writes its result to that file and its log next to it.
+class CBatchProcessLauncher : public CBatchLauncher
+{
+public:
+    CBatchProcessLauncher(const std::string &executable, const std::vector<std::string> &arguments,
+                          const std::string &resultPrefix);
+    virtual ~CBatchProcessLauncher();
+
+    virtual bool Start(int job, const std::string &composition, int &worker);
+    virtual bool Poll(int worker, BatchResult &result);
+    virtual void Kill(int worker);
+
+    static std::string GetLogFile(const std::string &resultFile);
+
+private:
+    CBatchProcessLauncher(const CBatchProcessLauncher &);
+    CBatchProcessLauncher &operator=(const CBatchProcessLauncher &);
+
+    struct Process
+    {
+#ifdef _WIN32
+        void *handle;
+#else
+        int pid;
+#endif
+        std::string resultFile;
+        bool running;
+    };
+
+    void Collect(Process &process, int exitCode, BatchResult &result);
+
+    std::string m_Executable;
+    std::vector<std::string> m_Arguments;
+    std::string m_ResultPrefix;
+    std::vector<Process> m_Processes;
+};
+
+// Hands the compositions out to at most a given number of workers at a time and
+// collects a result for each, whether the worker reported one, crashed, could
+// not be started or ran out of time.
+class CBatchScheduler
+{
+public:
+    CBatchScheduler();
+
+    void SetConcurrency(int workers);
+    int GetConcurrency() const { return m_Concurrency; }
+
+    // A worker still running after this long is killed; 0 waits forever.
+    void SetTimeout(platform::uint64 timeoutUs) { m_TimeoutUs = timeoutUs; }
+
+    void AddJob(const std::string &composition);
+    int GetJobCount() const { return (int)m_Results.size(); }
+
+    // Collects the finished workers and starts new ones. Returns false once every
+    // job has its result.
+    bool Step(CBatchLauncher &launcher, platform::uint64 now);
+
+    // Steps until every job is done, sleeping between polls.
+    void Run(CBatchLauncher &launcher, unsigned int pollMs);
+
+    int GetRunningCount() const { return (int)m_Running.size(); }
+    int GetFinishedCount() const { return m_Finished; }
+
+    // In the order the jobs were added.
+    const std::vector<BatchResult> &GetResults() const { return m_Results; }
+
+private:
+    struct Slot
+    {
+        int job;
+        int worker;
+        platform::uint64 startTime;
+    };
+
+    void Fail(int job, int status, const char *error);
+
+    int m_Concurrency;
+    platform::uint64 m_TimeoutUs;
+    std::vector<BatchResult> m_Results;
+    std::vector<Slot> m_Running;
+    int m_NextJob;
+    int m_Finished;
+};
+
+struct BatchSummary
+{
+    int jobs;
+    int statusCounts[eBatchStatusCount];
+    int missingGuidJobs;
+    int hotfixApplied;
+    int hotfixFailed;
+    int loadedJobs; // the load times below only count these
+    platform::uint64 totalLoadUs;
+    platform::uint64 maxLoadUs;
+    std::string slowestLoad;
+    platform::uint64 wallUs;
+};
+
+// Adds the results up and writes them as JSON.
+class CBatchReport
+{
+public:
+    enum { VERSION = 1 };
+
+    CBatchReport();
+
+    void Add(const BatchResult &result);
+    void AddAll(const std::vector<BatchResult> &results);
+    void SetWallTime(platform::uint64 wallUs) { m_Summary.wallUs = wallUs; }
+
+    const BatchSummary &GetSummary() const { return m_Summary; }
+    int GetCount() const { return (int)m_Results.size(); }
+    const BatchResult &GetResult(int index) const { return m_Results[index]; }
+
+    bool AllPassed() const;
+
+    void WriteJson(std::string &json) const;
+    bool Save(const char *filename) const;
+
+private:
+    std::vector<BatchResult> m_Results;
+    BatchSummary m_Summary;
+};
+
+#endif // PLAYER_BATCHRUNNER_H
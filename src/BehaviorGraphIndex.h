@@ -0,0 +1,447 @@
+#ifndef PLAYER_BEHAVIORGRAPHINDEX_H
+#define PLAYER_BEHAVIORGRAPHINDEX_H
+
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Lookup tables over the sub-behaviors and sub-links of one script, answering the
+// queries of the scriptutils search helpers without scanning the script.
+//
+// Behavior names are interned once; behaviors are found by name, links by the
+// pair of IOs they join, and each behavior keeps the links leaving and entering
+// it. Every list is kept in script order, so the first match and the match after
+// a "previous" one are the same the linear scans return.
+//
+// The index does not watch the script: links created, removed or re-pointed
+// after Build() have to be reported with AddLink(), RemoveLink() and UpdateLink().
+//
+// Graph supplies the types and accessors, so the index can run on a mock graph:
+//
+//   typedef ... Behavior; typedef ... Link; typedef ... IO;  // pointer-like
+//   static int GetSubBehaviorCount(Behavior script);
+//   static Behavior GetSubBehavior(Behavior script, int index);
+//   static int GetSubLinkCount(Behavior script);
+//   static Link GetSubLink(Behavior script, int index);
+//   static const char *GetName(Behavior beh);
+//   static const char *GetTargetName(Behavior beh); // NULL without a target
+//   static IO GetInput(Behavior beh, int pos);
+//   static IO GetOutput(Behavior beh, int pos);
+//   static IO GetLinkInput(Link link);   // the IO the link leaves from
+//   static IO GetLinkOutput(Link link);  // the IO the link enters
+//   static Behavior GetOwner(IO io);
+template <typename Graph>
+class CBehaviorGraphIndex
+{
+public:
+    typedef typename Graph::Behavior Behavior;
+    typedef typename Graph::Link Link;
+    typedef typename Graph::IO IO;
+
+    CBehaviorGraphIndex() : m_Script(Behavior()), m_NextOrder(0) {}
+
+    // Indexes the direct sub-behaviors and sub-links of the script.
+    void Build(Behavior script)
+    {
+        Clear();
+        m_Script = script;
+
+        int i;
+        const int behaviorCount = Graph::GetSubBehaviorCount(script);
+        for (i = 0; i < behaviorCount; ++i)
+            AddBehavior(Graph::GetSubBehavior(script, i));
+
+        const int linkCount = Graph::GetSubLinkCount(script);
+        for (i = 0; i < linkCount; ++i)
+            AddLink(Graph::GetSubLink(script, i));
+    }
+
+    void Clear()
+    {
+        m_Script = Behavior();
+        m_NextOrder = 0;
+        m_NameIds.clear();
+        m_ByName.clear();
+        m_Behaviors.clear();
+        m_Links.clear();
+        m_ByEnds.clear();
+        m_Owners.clear();
+    }
+
+    Behavior GetScript() const { return m_Script; }
+    int GetBehaviorCount() const { return (int)m_Behaviors.size(); }
+    int GetLinkCount() const { return (int)m_Links.size(); }
+
+    // Indexes a behavior added to the script, after every behavior indexed so far.
+    void AddBehavior(Behavior beh)
+    {
+        if (!beh || m_Behaviors.find(beh) != m_Behaviors.end())
+            return;
+
+        BehaviorEntry entry;
+        entry.order = m_NextOrder++;
+        entry.nameId = Intern(Graph::GetName(beh));
+        m_Behaviors[beh] = entry;
+        m_ByName[entry.nameId].push_back(std::make_pair(entry.order, beh));
+    }
+
+    // The links of the behavior stay indexed until removed themselves, as they
+    // stay in the script.
+    void RemoveBehavior(Behavior beh)
+    {
+        typename BehaviorMap::iterator it = m_Behaviors.find(beh);
+        if (it == m_Behaviors.end())
+            return;
+
+        Erase(m_ByName[it->second.nameId], it->second.order);
+        m_Behaviors.erase(it);
+    }
+
+    // Indexes a link added to the script, after every link indexed so far.
+    void AddLink(Link link)
+    {
+        if (!link || m_Links.find(link) != m_Links.end())
+            return;
+
+        LinkEntry entry;
+        entry.order = m_NextOrder++;
+        Insert(link, entry);
+    }
+
+    void RemoveLink(Link link)
+    {
+        typename LinkMap::iterator it = m_Links.find(link);
+        if (it == m_Links.end())
+            return;
+
+        Detach(it->second);
+        m_Links.erase(it);
+    }
+
+    // Re-reads the ends of a link that was re-pointed; it keeps its place in the order.
+    void UpdateLink(Link link)
+    {
+        typename LinkMap::iterator it = m_Links.find(link);
+        if (it == m_Links.end())
+            return;
+
+        LinkEntry entry = it->second;
+        Detach(entry);
+        m_Links.erase(it);
+        Insert(link, entry);
+    }
+
+    // The first sub-behavior with the name, or the first after the previous one.
+    Behavior FindBehavior(const char *name, Behavior previous = Behavior()) const
+    {
+        const BehaviorList *list = GetNamed(name);
+        int after;
+        if (!list || !GetBehaviorOrder(previous, after))
+            return Behavior();
+
+        size_t i = First(*list, after);
+        return i < list->size() ? (*list)[i].second : Behavior();
+    }
+
+    // As above, among the behaviors whose target has the target name.
+    Behavior FindBehavior(const char *name, const char *targetName, Behavior previous = Behavior()) const
+    {
+        const BehaviorList *list = GetNamed(name);
+        int after;
+        if (!list || !targetName || !GetBehaviorOrder(previous, after))
+            return Behavior();
+
+        size_t i;
+        for (i = First(*list, after); i < list->size(); ++i)
+        {
+            const char *target = Graph::GetTargetName((*list)[i].second);
+            if (target && strcmp(target, targetName) == 0)
+                return (*list)[i].second;
+        }
+        return Behavior();
+    }
+
+    Link FindLink(IO in, IO out, Link previous = Link()) const
+    {
+        int after;
+        if (!GetLinkOrder(previous, after))
+            return Link();
+
+        typename EndsMap::const_iterator it = m_ByEnds.find(std::make_pair(in, out));
+        if (it == m_ByEnds.end())
+            return Link();
+
+        size_t i = First(it->second, after);
+        return i < it->second.size() ? it->second[i].second : Link();
+    }
+
+    Link FindLink(Behavior inBeh, Behavior outBeh, int inPos = 0, int outPos = 0, Link previous = Link()) const
+    {
+        if (!inBeh || !outBeh)
+            return Link();
+        return FindLink(Graph::GetOutput(inBeh, inPos), Graph::GetInput(outBeh, outPos), previous);
+    }
+
+    Link FindLink(const char *inName, Behavior outBeh, int inPos = 0, int outPos = 0, Link previous = Link()) const
+    {
+        int nameId;
+        int after;
+        const OwnerEntry *owner = GetOwner(outBeh);
+        if (!owner || !LookupName(inName, nameId) || !GetLinkOrder(previous, after))
+            return Link();
+
+        IO out = Graph::GetInput(outBeh, outPos);
+        size_t i;
+        for (i = First(owner->entering, after); i < owner->entering.size(); ++i)
+        {
+            Link link = owner->entering[i].second;
+            const LinkEntry &entry = m_Links.find(link)->second;
+            if (entry.out == out && entry.inNameId == nameId && Graph::GetOutput(entry.inOwner, inPos) == entry.in)
+                return link;
+        }
+        return Link();
+    }
+
+    Link FindLink(Behavior inBeh, const char *outName, int inPos = 0, int outPos = 0, Link previous = Link()) const
+    {
+        int nameId;
+        int after;
+        const OwnerEntry *owner = GetOwner(inBeh);
+        if (!owner || !LookupName(outName, nameId) || !GetLinkOrder(previous, after))
+            return Link();
+
+        IO in = Graph::GetOutput(inBeh, inPos);
+        size_t i;
+        for (i = First(owner->leaving, after); i < owner->leaving.size(); ++i)
+        {
+            Link link = owner->leaving[i].second;
+            const LinkEntry &entry = m_Links.find(link)->second;
+            if (entry.in == in && entry.outNameId == nameId && Graph::GetInput(entry.outOwner, outPos) == entry.out)
+                return link;
+        }
+        return Link();
+    }
+
+    Link FindLink(const char *inName, const char *outName, int inPos = 0, int outPos = 0, Link previous = Link()) const
+    {
+        int outNameId;
+        int after;
+        const BehaviorList *sources = GetNamed(inName);
+        if (!sources || !LookupName(outName, outNameId) || !GetLinkOrder(previous, after))
+            return Link();
+
+        // The earliest match among the links leaving every behavior with the name.
+        Link best = Link();
+        int bestOrder = 0;
+        size_t s;
+        for (s = 0; s < sources->size(); ++s)
+        {
+            Behavior inBeh = (*sources)[s].second;
+            Link link = FindLink(inBeh, outName, inPos, outPos, previous);
+            if (!link)
+                continue;
+            const int order = m_Links.find(link)->second.order;
+            if (!best || order < bestOrder)
+            {
+                best = link;
+                bestOrder = order;
+            }
+        }
+        return best;
+    }
+
+    // The links leaving or entering any IO of the behavior, in script order.
+    void GetLinksFrom(Behavior beh, std::vector<Link> &links) const { CopyLinks(beh, true, links); }
+    void GetLinksTo(Behavior beh, std::vector<Link> &links) const { CopyLinks(beh, false, links); }
+
+private:
+    CBehaviorGraphIndex(const CBehaviorGraphIndex &);
+    CBehaviorGraphIndex &operator=(const CBehaviorGraphIndex &);
+
+    // Objects with their order, sorted by it.
+    typedef std::vector<std::pair<int, Behavior> > BehaviorList;
+    typedef std::vector<std::pair<int, Link> > LinkList;
+
+    struct BehaviorEntry
+    {
+        int order;
+        int nameId;
+    };
+
+    struct LinkEntry
+    {
+        int order;
+        IO in;
+        IO out;
+        Behavior inOwner;
+        Behavior outOwner;
+        int inNameId;
+        int outNameId;
+    };
+
+    // Links by the behavior at their ends; the owner can be the script itself.
+    struct OwnerEntry
+    {
+        LinkList leaving;
+        LinkList entering;
+    };
+
+    typedef std::map<Behavior, BehaviorEntry> BehaviorMap;
+    typedef std::map<Link, LinkEntry> LinkMap;
+    typedef std::map<std::pair<IO, IO>, LinkList > EndsMap;
+    typedef std::map<Behavior, OwnerEntry> OwnerMap;
+
+    int Intern(const char *name)
+    {
+        const std::string key = name ? name : "";
+        std::map<std::string, int>::const_iterator it = m_NameIds.find(key);
+        if (it != m_NameIds.end())
+            return it->second;
+
+        const int id = (int)m_ByName.size();
+        m_NameIds[key] = id;
+        m_ByName.push_back(BehaviorList());
+        return id;
+    }
+
+    bool LookupName(const char *name, int &id) const
+    {
+        if (!name)
+            return false;
+        std::map<std::string, int>::const_iterator it = m_NameIds.find(name);
+        if (it == m_NameIds.end())
+            return false;
+        id = it->second;
+        return true;
+    }
+
+    const BehaviorList *GetNamed(const char *name) const
+    {
+        int id;
+        if (!LookupName(name, id))
+            return NULL;
+        return &m_ByName[id];
+    }
+
+    const OwnerEntry *GetOwner(Behavior beh) const
+    {
+        typename OwnerMap::const_iterator it = m_Owners.find(beh);
+        return it != m_Owners.end() ? &it->second : NULL;
+    }
+
+    // A previous object that is not indexed ends the search, as in the scans.
+    bool GetBehaviorOrder(Behavior previous, int &order) const
+    {
+        order = -1;
+        if (!previous)
+            return true;
+        typename BehaviorMap::const_iterator it = m_Behaviors.find(previous);
+        if (it == m_Behaviors.end())
+            return false;
+        order = it->second.order;
+        return true;
+    }
+
+    bool GetLinkOrder(Link previous, int &order) const
+    {
+        order = -1;
+        if (!previous)
+            return true;
+        typename LinkMap::const_iterator it = m_Links.find(previous);
+        if (it == m_Links.end())
+            return false;
+        order = it->second.order;
+        return true;
+    }
+
+    // The position of the first element ordered after the given order.
+    template <typename List>
+    static size_t First(const List &list, int after)
+    {
+        size_t low = 0;
+        size_t high = list.size();
+        while (low < high)
+        {
+            size_t mid = (low + high) / 2;
+            if (list[mid].first <= after)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+
+    template <typename List, typename T>
+    static void Add(List &list, int order, T value)
+    {
+        size_t i = First(list, order);
+        list.insert(list.begin() + i, std::make_pair(order, value));
+    }
+
+    template <typename List>
+    static void Erase(List &list, int order)
+    {
+        size_t i = First(list, order - 1);
+        if (i < list.size() && list[i].first == order)
+            list.erase(list.begin() + i);
+    }
+
+    void Insert(Link link, LinkEntry &entry)
+    {
+        entry.in = Graph::GetLinkInput(link);
+        entry.out = Graph::GetLinkOutput(link);
+        entry.inOwner = entry.in ? Graph::GetOwner(entry.in) : Behavior();
+        entry.outOwner = entry.out ? Graph::GetOwner(entry.out) : Behavior();
+        entry.inNameId = entry.inOwner ? Intern(Graph::GetName(entry.inOwner)) : -1;
+        entry.outNameId = entry.outOwner ? Intern(Graph::GetName(entry.outOwner)) : -1;
+        m_Links[link] = entry;
+
+        Add(m_ByEnds[std::make_pair(entry.in, entry.out)], entry.order, link);
+        if (entry.inOwner)
+            Add(m_Owners[entry.inOwner].leaving, entry.order, link);
+        if (entry.outOwner)
+            Add(m_Owners[entry.outOwner].entering, entry.order, link);
+    }
+
+    void Detach(const LinkEntry &entry)
+    {
+        typename EndsMap::iterator ends = m_ByEnds.find(std::make_pair(entry.in, entry.out));
+        if (ends != m_ByEnds.end())
+        {
+            Erase(ends->second, entry.order);
+            if (ends->second.empty())
+                m_ByEnds.erase(ends);
+        }
+        if (entry.inOwner)
+            Erase(m_Owners[entry.inOwner].leaving, entry.order);
+        if (entry.outOwner)
+            Erase(m_Owners[entry.outOwner].entering, entry.order);
+    }
+
+    void CopyLinks(Behavior beh, bool leaving, std::vector<Link> &links) const
+    {
+        links.clear();
+        const OwnerEntry *owner = GetOwner(beh);
+        if (!owner)
+            return;
+
+        const LinkList &list = leaving ? owner->leaving : owner->entering;
+        size_t i;
+        for (i = 0; i < list.size(); ++i)
+            links.push_back(list[i].second);
+    }
+
+    Behavior m_Script;
+    int m_NextOrder;
+    std::map<std::string, int> m_NameIds;
+    std::vector<BehaviorList > m_ByName;
+    BehaviorMap m_Behaviors;
+    LinkMap m_Links;
+    EndsMap m_ByEnds;
+    OwnerMap m_Owners;
+};
+
+#endif // PLAYER_BEHAVIORGRAPHINDEX_H
@@ -0,0 +1,306 @@
+#include "BmpImage.h"
+
+#include <string.h>
+
+namespace
+{
+    enum
+    {
+        FILE_HEADER_SIZE = 14,
+        CORE_HEADER_SIZE = 12,
+        INFO_HEADER_SIZE = 40,
+        BITFIELDS_SIZE = 12, // the three masks after an info header
+    };
+
+    unsigned int ReadU16(const unsigned char *p)
+    {
+        return (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+    }
+
+    platform::uint32 ReadU32(const unsigned char *p)
+    {
+        return (platform::uint32)p[0] | ((platform::uint32)p[1] << 8) |
+               ((platform::uint32)p[2] << 16) | ((platform::uint32)p[3] << 24);
+    }
+
+    bool IsKnownHeaderSize(platform::uint32 size)
+    {
+        // BITMAPCOREHEADER, BITMAPINFOHEADER, the two Adobe variants, V4 and V5.
+        return size == CORE_HEADER_SIZE || size == INFO_HEADER_SIZE || size == 52 || size == 56 ||
+               size == 108 || size == 124;
+    }
+
+    size_t GetRowStride(int width, int bitCount)
+    {
+        return (((size_t)width * bitCount + 31) / 32) * 4;
+    }
+}
+
+CBmpImage::CBmpImage()
+    : m_Width(0), m_Height(0), m_BitCount(0), m_Compression(eBmpRgb), m_TopDown(false), m_Stride(0), m_Pixels(NULL) {}
+
+void CBmpImage::Clear()
+{
+    m_Width = 0;
+    m_Height = 0;
+    m_BitCount = 0;
+    m_Compression = eBmpRgb;
+    m_TopDown = false;
+    m_Stride = 0;
+    m_Pixels = NULL;
+    m_Decoded.clear();
+    m_Palette.clear();
+}
+
+bool CBmpImage::Decode(const void *data, size_t size)
+{
+    Clear();
+
+    const unsigned char *bytes = (const unsigned char *)data;
+    if (!bytes || size < FILE_HEADER_SIZE + 4 || bytes[0] != 'B' || bytes[1] != 'M')
+        return false;
+
+    const platform::uint32 pixelOffset = ReadU32(&bytes[10]);
+    const platform::uint32 headerSize = ReadU32(&bytes[FILE_HEADER_SIZE]);
+    if (!IsKnownHeaderSize(headerSize) || FILE_HEADER_SIZE + (size_t)headerSize > size)
+        return false;
+
+    const unsigned char *header = &bytes[FILE_HEADER_SIZE];
+    long width, height;
+    unsigned int planes, bitCount;
+    platform::uint32 compression = eBmpRgb;
+    platform::uint32 imageSize = 0;
+    platform::uint32 colorsUsed = 0;
+    size_t entrySize = 4;
+    if (headerSize == CORE_HEADER_SIZE)
+    {
+        width = (long)ReadU16(&header[4]);
+        height = (long)ReadU16(&header[6]);
+        planes = ReadU16(&header[8]);
+        bitCount = ReadU16(&header[10]);
+        entrySize = 3;
+    }
+    else
+    {
+        width = (long)(platform::int32)ReadU32(&header[4]);
+        height = (long)(platform::int32)ReadU32(&header[8]);
+        planes = ReadU16(&header[12]);
+        bitCount = ReadU16(&header[14]);
+        compression = ReadU32(&header[16]);
+        imageSize = ReadU32(&header[20]);
+        colorsUsed = ReadU32(&header[32]);
+    }
+
+    bool topDown = false;
+    if (height < -(long)MAX_DIMENSION)
+        return false;
+    if (height < 0)
+    {
+        topDown = true;
+        height = -height;
+    }
+    if (planes != 1 || width <= 0 || height <= 0 || width > MAX_DIMENSION || height > MAX_DIMENSION)
+        return false;
+
+    // The variants the splash uses; anything else is turned away.
+    int indexBits;
+    switch (compression)
+    {
+    case eBmpRgb:
+        if (bitCount != 8 && bitCount != 24 && bitCount != 32)
+            return false;
+        indexBits = (bitCount == 8) ? 8 : 0;
+        break;
+    case eBmpRle8:
+        if (bitCount != 8 || topDown)
+            return false;
+        indexBits = 8;
+        break;
+    case eBmpRle4:
+        if (bitCount != 4 || topDown)
+            return false;
+        indexBits = 4;
+        break;
+    case eBmpBitfields:
+    {
+        if (bitCount != 32)
+            return false;
+        // Only the masks of plain BGRX, so the pixels can be shown without conversion.
+        const size_t maskOffset = FILE_HEADER_SIZE + INFO_HEADER_SIZE;
+        if (maskOffset + BITFIELDS_SIZE > size)
+            return false;
+        if (ReadU32(&bytes[maskOffset]) != 0x00FF0000 || ReadU32(&bytes[maskOffset + 4]) != 0x0000FF00 ||
+            ReadU32(&bytes[maskOffset + 8]) != 0x000000FF)
+            return false;
+        indexBits = 0;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    // The palette follows the headers and ends before the pixels.
+    if (indexBits > 0)
+    {
+        const platform::uint32 maxColors = 1u << indexBits;
+        if (colorsUsed == 0)
+            colorsUsed = maxColors;
+        if (colorsUsed > maxColors)
+            return false;
+
+        size_t paletteOffset = FILE_HEADER_SIZE + (size_t)headerSize;
+        if (headerSize == INFO_HEADER_SIZE && compression == eBmpBitfields)
+            paletteOffset += BITFIELDS_SIZE;
+        const size_t paletteEnd = paletteOffset + (size_t)colorsUsed * entrySize;
+        if (paletteEnd > size || paletteEnd > (size_t)pixelOffset)
+            return false;
+
+        m_Palette.resize(colorsUsed);
+        platform::uint32 i;
+        for (i = 0; i < colorsUsed; ++i)
+        {
+            const unsigned char *entry = &bytes[paletteOffset + i * entrySize];
+            m_Palette[i].blue = entry[0];
+            m_Palette[i].green = entry[1];
+            m_Palette[i].red = entry[2];
+            m_Palette[i].reserved = 0;
+        }
+    }
+    else if (pixelOffset < FILE_HEADER_SIZE + headerSize)
+    {
+        return false;
+    }
+
+    if ((size_t)pixelOffset >= size)
+    {
+        Clear();
+        return false;
+    }
+
+    m_Width = (int)width;
+    m_Height = (int)height;
+    m_Compression = (BmpCompression)compression;
+    m_TopDown = topDown;
+
+    if (compression == eBmpRle8 || compression == eBmpRle4)
+    {
+        size_t dataSize = size - pixelOffset;
+        if (imageSize != 0 && imageSize < dataSize)
+            dataSize = imageSize;
+        if (!DecodeRle(&bytes[pixelOffset], dataSize, indexBits))
+        {
+            Clear();
+            return false;
+        }
+        return true;
+    }
+
+    const size_t stride = GetRowStride(m_Width, bitCount);
+    const platform::uint64 pixelSize = (platform::uint64)stride * (platform::uint64)m_Height;
+    if (pixelSize > (platform::uint64)(size - pixelOffset))
+    {
+        Clear();
+        return false;
+    }
+
+    m_BitCount = (int)bitCount;
+    m_Stride = stride;
+    m_Pixels = &bytes[pixelOffset];
+    return true;
+}
+
+bool CBmpImage::DecodeRle(const unsigned char *data, size_t size, int bitsPerIndex)
+{
+    // Expanded to one byte per index, bottom row first like the stream.
+    m_BitCount = 8;
+    m_Stride = GetRowStride(m_Width, 8);
+    m_Decoded.assign(m_Stride * (size_t)m_Height, 0);
+
+    int x = 0;
+    int y = 0;
+    size_t pos = 0;
+    while (pos + 2 <= size)
+    {
+        const int count = data[pos];
+        const int value = data[pos + 1];
+        pos += 2;
+
+        if (count > 0)
+        {
+            // A run repeating one index, or two alternating ones in RLE4.
+            if (y >= m_Height || count > m_Width - x)
+                return false;
+            unsigned char *row = &m_Decoded[(size_t)y * m_Stride];
+            if (bitsPerIndex == 8)
+            {
+                memset(&row[x], value, count);
+            }
+            else
+            {
+                int i;
+                for (i = 0; i < count; ++i)
+                    row[x + i] = (unsigned char)((i & 1) ? (value & 0x0F) : (value >> 4));
+            }
+            x += count;
+            continue;
+        }
+
+        switch (value)
+        {
+        case 0: // end of line
+            x = 0;
+            if (++y > m_Height)
+                return false;
+            break;
+
+        case 1: // end of bitmap
+            m_Pixels = &m_Decoded[0];
+            return true;
+
+        case 2: // move right and up
+            if (pos + 2 > size)
+                return false;
+            x += data[pos];
+            y += data[pos + 1];
+            pos += 2;
+            if (x > m_Width || y > m_Height)
+                return false;
+            break;
+
+        default:
+        {
+            // Literal indices, padded to a whole word.
+            const int literal = value;
+            const size_t bytesUsed = (bitsPerIndex == 8) ? (size_t)literal : ((size_t)literal + 1) / 2;
+            const size_t padded = (bytesUsed + 1) & ~(size_t)1;
+            if (pos + padded > size || y >= m_Height || literal > m_Width - x)
+                return false;
+            unsigned char *row = &m_Decoded[(size_t)y * m_Stride];
+            if (bitsPerIndex == 8)
+            {
+                memcpy(&row[x], &data[pos], literal);
+            }
+            else
+            {
+                int i;
+                for (i = 0; i < literal; ++i)
+                    row[x + i] = (unsigned char)((i & 1) ? (data[pos + i / 2] & 0x0F) : (data[pos + i / 2] >> 4));
+            }
+            x += literal;
+            pos += padded;
+            break;
+        }
+        }
+    }
+
+    // The stream ran out before its end-of-bitmap marker.
+    return false;
+}
+
+const unsigned char *CBmpImage::GetRow(int y) const
+{
+    if (!m_Pixels || y < 0 || y >= m_Height)
+        return NULL;
+    const int stored = m_TopDown ? y : m_Height - 1 - y;
+    return m_Pixels + (size_t)stored * m_Stride;
+}
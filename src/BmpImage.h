@@ -0,0 +1,94 @@
+#ifndef PLAYER_BMPIMAGE_H
+#define PLAYER_BMPIMAGE_H
+
+#include <stddef.h>
+#include <vector>
+
+#include "Platform.h"
+
+// Laid out like RGBQUAD, so a palette can be handed to GDI as it is.
+struct BmpPaletteEntry
+{
+    unsigned char blue;
+    unsigned char green;
+    unsigned char red;
+    unsigned char reserved;
+};
+
+PLATFORM_STATIC_ASSERT(sizeof(BmpPaletteEntry) == 4, bmp_palette_entry_size);
+
+enum BmpCompression
+{
+    eBmpRgb = 0,
+    eBmpRle8 = 1,
+    eBmpRle4 = 2,
+    eBmpBitfields = 3,
+};
+
+// A BMP file decoded from memory, such as a mapped file.
+//
+// Uncompressed pixels are not copied: the image points into the memory it was
+// decoded from, which must outlive it. RLE8 and RLE4 pixels are expanded into a
+// buffer of the image's own as 8-bit indices. Either way the pixels come out as
+// 8-bit indices, 24-bit BGR or 32-bit BGRX rows padded to four bytes, the
+// layout SetDIBitsToDevice takes.
+//
+// Every size and offset is checked against the memory before it is used; a file
+// that does not hold up is rejected rather than shown in part.
+class CBmpImage
+{
+public:
+    enum
+    {
+        MAX_DIMENSION = 16384,
+        MAX_PALETTE_SIZE = 256
+    };
+
+    CBmpImage();
+
+    bool Decode(const void *data, size_t size);
+    void Clear();
+
+    bool IsValid() const { return m_Pixels != NULL; }
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+
+    // Bits per pixel of GetPixels(): 8, 24 or 32.
+    int GetBitCount() const { return m_BitCount; }
+    BmpCompression GetCompression() const { return m_Compression; }
+
+    // True if the rows run from the top of the image down rather than bottom up.
+    bool IsTopDown() const { return m_TopDown; }
+
+    // True if the pixels are those of the decoded memory rather than a copy.
+    bool IsInPlace() const { return m_Decoded.empty() && m_Pixels != NULL; }
+
+    size_t GetStride() const { return m_Stride; }
+    const unsigned char *GetPixels() const { return m_Pixels; }
+
+    // Row y counted from the top, whichever way the rows are stored.
+    const unsigned char *GetRow(int y) const;
+
+    // Empty for 24 and 32-bit images.
+    int GetPaletteSize() const { return (int)m_Palette.size(); }
+    const BmpPaletteEntry *GetPalette() const { return m_Palette.empty() ? NULL : &m_Palette[0]; }
+
+private:
+    CBmpImage(const CBmpImage &);
+    CBmpImage &operator=(const CBmpImage &);
+
+    bool DecodeRle(const unsigned char *data, size_t size, int bitsPerIndex);
+
+    int m_Width;
+    int m_Height;
+    int m_BitCount;
+    BmpCompression m_Compression;
+    bool m_TopDown;
+    size_t m_Stride;
+    const unsigned char *m_Pixels;
+    std::vector<unsigned char> m_Decoded;
+    std::vector<BmpPaletteEntry> m_Palette;
+};
+
+#endif // PLAYER_BMPIMAGE_H
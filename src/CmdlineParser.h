@@ -8,6 +8,9 @@
 #include <string>
 #include <vector>
 
+// Splits a command line at blanks outside of quotes, dropping the quotes.
+void AppendCommandLineArgs(std::vector<std::string> &args, const char *cmdline);
+
 class CmdlineArg
 {
 public:
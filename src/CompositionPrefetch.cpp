@@ -0,0 +1,239 @@
+#include "CompositionPrefetch.h"
+
+#include <algorithm>
+
+namespace
+{
+    // The directories RegisterCompositionPaths() adds next to the composition.
+    const char *const CompositionDirectories[] = {
+        "Textures",
+        "Sounds",
+        "Sounds_low",
+        "3D Entities",
+    };
+}
+
+CCompositionPrefetcher::CCompositionPrefetcher(CFileSystem &fileSystem)
+    : m_FileSystem(fileSystem),
+      m_ThreadCount(1),
+      m_Cancelled(0),
+      m_Finished(0),
+      m_ByteBudget(0),
+      m_QueuedBytes(0),
+      m_PrefetchedFiles(0),
+      m_PrefetchedBytes(0),
+      m_SkippedFiles(0) {}
+
+CCompositionPrefetcher::~CCompositionPrefetcher()
+{
+    Cancel();
+    m_Thread.Join();
+}
+
+void CCompositionPrefetcher::SetComposition(const char *filename, const char *dataDirectory)
+{
+    m_CompositionCandidates.clear();
+    if (!filename || !*filename)
+        return;
+
+    m_CompositionCandidates.push_back(filename);
+    if (dataDirectory && *dataDirectory)
+        m_CompositionCandidates.push_back(filesystem::JoinPath(dataDirectory, filename));
+}
+
+void CCompositionPrefetcher::AddFile(const char *path)
+{
+    if (path && *path)
+        m_Files.push_back(path);
+}
+
+void CCompositionPrefetcher::AddDirectory(const char *directory)
+{
+    if (directory && *directory)
+        m_Directories.push_back(directory);
+}
+
+bool CCompositionPrefetcher::Start(int threadCount)
+{
+    if (m_Thread.IsStarted())
+        return false;
+
+    if (threadCount < 1)
+        threadCount = 1;
+    if (threadCount > MAX_THREADS)
+        threadCount = MAX_THREADS;
+    m_ThreadCount = threadCount;
+
+    platform::AtomicStore(&m_Cancelled, 0);
+    platform::AtomicStore(&m_Finished, 0);
+    return m_Thread.Start(ThreadMain, this);
+}
+
+void CCompositionPrefetcher::Cancel()
+{
+    platform::AtomicStore(&m_Cancelled, 1);
+}
+
+bool CCompositionPrefetcher::Wait(unsigned long timeoutMs)
+{
+    if (!m_Thread.IsStarted() || IsFinished())
+        return true;
+
+    if (!m_Done.Acquire(timeoutMs))
+        return false;
+
+    // Leave the count for the next caller.
+    m_Done.Release();
+    return true;
+}
+
+bool CCompositionPrefetcher::IsFinished() const
+{
+    return platform::AtomicLoad(&m_Finished) != 0;
+}
+
+bool CCompositionPrefetcher::IsCancelled() const
+{
+    return platform::AtomicLoad(&m_Cancelled) != 0;
+}
+
+void CCompositionPrefetcher::ThreadMain(void *arg)
+{
+    ((CCompositionPrefetcher *)arg)->Run();
+}
+
+void CCompositionPrefetcher::Run()
+{
+    m_CompositionPath.clear();
+    m_PrefetchedFiles = 0;
+    m_PrefetchedBytes = 0;
+    m_SkippedFiles = 0;
+
+    PrefetchComposition();
+    m_QueuedBytes = m_PrefetchedBytes;
+    QueueFiles();
+
+    std::vector<std::string> listed;
+    if (!m_CompositionPath.empty())
+    {
+        const std::string compositionDirectory = filesystem::GetDirectory(m_CompositionPath);
+        int i;
+        for (i = 0; i < (int)(sizeof(CompositionDirectories) / sizeof(CompositionDirectories[0])); ++i)
+            QueueDirectory(filesystem::JoinPath(compositionDirectory, CompositionDirectories[i]), listed);
+    }
+
+    size_t i;
+    for (i = 0; i < m_Directories.size(); ++i)
+        QueueDirectory(m_Directories[i], listed);
+
+    m_Results.assign(m_Queue.size(), 0);
+    m_Started.assign(m_Queue.size(), 0);
+    RunParallel((int)m_Queue.size(), m_ThreadCount, PrefetchTask, this);
+
+    for (i = 0; i < m_Results.size(); ++i)
+    {
+        if (!m_Started[i])
+        {
+            ++m_SkippedFiles;
+        }
+        else if (m_Results[i] > 0)
+        {
+            ++m_PrefetchedFiles;
+            m_PrefetchedBytes += m_Results[i];
+        }
+    }
+    m_Queue.clear();
+    m_Queued.clear();
+    m_Results.clear();
+    m_Started.clear();
+
+    Finish();
+}
+
+void CCompositionPrefetcher::PrefetchComposition()
+{
+    size_t i;
+    for (i = 0; i < m_CompositionCandidates.size(); ++i)
+    {
+        FileEntry entry;
+        if (!m_FileSystem.GetFileEntry(m_CompositionCandidates[i].c_str(), entry))
+            continue;
+
+        m_CompositionPath = m_CompositionCandidates[i];
+        if (IsCancelled())
+            return;
+
+        platform::uint64 bytes = m_FileSystem.Prefetch(m_CompositionPath.c_str());
+        if (bytes > 0)
+        {
+            ++m_PrefetchedFiles;
+            m_PrefetchedBytes += bytes;
+        }
+        return;
+    }
+}
+
+void CCompositionPrefetcher::QueueFiles()
+{
+    size_t i;
+    for (i = 0; i < m_Files.size() && !IsCancelled(); ++i)
+    {
+        FileEntry entry;
+        if (m_FileSystem.GetFileEntry(m_Files[i].c_str(), entry))
+            QueueEntry(entry);
+    }
+}
+
+void CCompositionPrefetcher::QueueDirectory(const std::string &directory, std::vector<std::string> &listed)
+{
+    if (IsCancelled())
+        return;
+
+    const std::string normalized = filesystem::NormalizePath(directory);
+    if (std::find(listed.begin(), listed.end(), normalized) != listed.end())
+        return;
+    listed.push_back(normalized);
+
+    if (!m_FileSystem.DirectoryExists(directory.c_str()))
+        return;
+
+    std::vector<FileEntry> files;
+    m_FileSystem.ListFiles(directory.c_str(), NULL, files);
+
+    size_t i;
+    for (i = 0; i < files.size(); ++i)
+        QueueEntry(files[i]);
+}
+
+bool CCompositionPrefetcher::QueueEntry(const FileEntry &entry)
+{
+    const std::string normalized = filesystem::NormalizePath(entry.path);
+    if (m_Queued.find(normalized) != m_Queued.end())
+        return false;
+
+    if (m_ByteBudget != 0 && m_QueuedBytes + entry.size > m_ByteBudget)
+    {
+        ++m_SkippedFiles;
+        return false;
+    }
+
+    m_Queued.insert(normalized);
+    m_QueuedBytes += entry.size;
+    m_Queue.push_back(entry);
+    return true;
+}
+
+void CCompositionPrefetcher::PrefetchTask(int index, void *arg)
+{
+    CCompositionPrefetcher *self = (CCompositionPrefetcher *)arg;
+    if (self->IsCancelled())
+        return;
+    self->m_Started[index] = 1;
+    self->m_Results[index] = self->m_FileSystem.Prefetch(self->m_Queue[index].path.c_str());
+}
+
+void CCompositionPrefetcher::Finish()
+{
+    platform::AtomicStore(&m_Finished, 1);
+    m_Done.Release();
+}
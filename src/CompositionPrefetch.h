@@ -0,0 +1,102 @@
+#ifndef PLAYER_COMPOSITIONPREFETCH_H
+#define PLAYER_COMPOSITIONPREFETCH_H
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "FileSystem.h"
+#include "Thread.h"
+
+// Reads the composition and the directories its assets come from on a worker
+// thread while the player starts up, so CKFile::OpenFile() and the texture and
+// sound loads that follow find the data in the page cache.
+//
+// The composition is read first and on its own; the files and directories added
+// are then read on up to MAX_THREADS threads, files first, each in the order
+// they were added.
+// Nothing is kept in memory, and reading a file that later turns out to be unused
+// costs nothing but the I/O.
+class CCompositionPrefetcher
+{
+public:
+    enum { MAX_THREADS = 2 };
+
+    explicit CCompositionPrefetcher(CFileSystem &fileSystem);
+
+    // Cancels and waits for the worker.
+    ~CCompositionPrefetcher();
+
+    // Like the path manager, a file name that does not exist as given is looked
+    // up in the data directory. The Textures, Sounds, Sounds_low and 3D Entities
+    // directories next to the composition are queued as well.
+    void SetComposition(const char *filename, const char *dataDirectory);
+
+    // Queues every file of the directory. A directory added several times, or
+    // also found next to the composition, is read once.
+    void AddDirectory(const char *directory);
+
+    // Queues a single file, ahead of every directory. Missing files are ignored
+    // and a file also found in a queued directory is read once.
+    void AddFile(const char *path);
+
+    // Skips the queued files that would take the total past this many bytes.
+    // The composition itself is always read. 0 means no limit.
+    void SetByteBudget(platform::uint64 bytes) { m_ByteBudget = bytes; }
+
+    bool Start(int threadCount);
+
+    // Files not started yet are skipped; a read in progress still completes.
+    void Cancel();
+
+    // Returns true once the worker finished, or if it was never started.
+    bool Wait(unsigned long timeoutMs = CSemaphore::WAIT_FOREVER);
+    bool IsFinished() const;
+    bool IsCancelled() const;
+
+    // The results below are valid once Wait() returned true.
+    const std::string &GetCompositionPath() const { return m_CompositionPath; }
+    int GetPrefetchedFiles() const { return m_PrefetchedFiles; }
+    platform::uint64 GetPrefetchedBytes() const { return m_PrefetchedBytes; }
+    // Queued files left out by the budget or by Cancel().
+    int GetSkippedFiles() const { return m_SkippedFiles; }
+
+private:
+    CCompositionPrefetcher(const CCompositionPrefetcher &);
+    CCompositionPrefetcher &operator=(const CCompositionPrefetcher &);
+
+    static void ThreadMain(void *arg);
+    static void PrefetchTask(int index, void *arg);
+
+    void Run();
+    void PrefetchComposition();
+    void QueueFiles();
+    void QueueDirectory(const std::string &directory, std::vector<std::string> &listed);
+    bool QueueEntry(const FileEntry &entry);
+    void Finish();
+
+    CFileSystem &m_FileSystem;
+    CThread m_Thread;
+    CSemaphore m_Done;
+    int m_ThreadCount;
+    volatile long m_Cancelled;
+    volatile long m_Finished;
+
+    std::vector<std::string> m_CompositionCandidates;
+    std::vector<std::string> m_Files;
+    std::vector<std::string> m_Directories;
+    platform::uint64 m_ByteBudget;
+
+    std::vector<FileEntry> m_Queue;
+    std::set<std::string> m_Queued;
+    platform::uint64 m_QueuedBytes;
+    std::vector<platform::uint64> m_Results;
+    std::vector<char> m_Started;
+
+    std::string m_CompositionPath;
+    int m_PrefetchedFiles;
+    platform::uint64 m_PrefetchedBytes;
+    int m_SkippedFiles;
+};
+
+#endif // PLAYER_COMPOSITIONPREFETCH_H
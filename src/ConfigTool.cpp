@@ -53,6 +53,7 @@ const ControlTextMapping g_TextMappings[] = {
     {IDOK, IDS_BTN_OK}, {IDCANCEL, IDS_BTN_CANCEL}, {IDC_BUTTON_DEFAULTS, IDS_BTN_DEFAULTS},
     {IDC_GROUP_STARTUP, IDS_GROUP_STARTUP}, {IDC_GROUP_GRAPHICS, IDS_GROUP_GRAPHICS},
     {IDC_GROUP_WINDOW, IDS_GROUP_WINDOW}, {IDC_GROUP_GAME, IDS_GROUP_GAME}, {IDC_GROUP_INTERFACE, IDS_GROUP_INTERFACE},
+    {IDC_GROUP_PERFORMANCE, IDS_GROUP_PERFORMANCE},
     {IDC_CHECK_VERBOSE, IDS_VERBOSE}, {IDC_CHECK_MANUALSETUP, IDS_MANUAL_SETUP}, {IDC_CHECK_FULLSCREEN, IDS_FULLSCREEN},
     {IDC_CHECK_CHILDWINRENDER, IDS_CHILD_WINDOW_RENDER},
     {IDC_CHECK_BORDERLESS, IDS_BORDERLESS}, {IDC_CHECK_CLIPCURSOR, IDS_CLIP_CURSOR},
@@ -60,6 +61,16 @@ const ControlTextMapping g_TextMappings[] = {
     {IDC_CHECK_APPLYHOTFIX, IDS_APPLY_HOTFIX}, {IDC_CHECK_UNLOCKFRAMERATE, IDS_UNLOCK_FRAMERATE},
     {IDC_CHECK_UNLOCKWIDESCREEN, IDS_UNLOCK_WIDESCREEN}, {IDC_CHECK_UNLOCKHIGHRES, IDS_UNLOCK_HIGHRES},
     {IDC_CHECK_DEBUG, IDS_DEBUG}, {IDC_CHECK_ROOKIE, IDS_ROOKIE},
+    {IDC_CHECK_LATENCYPROBE, IDS_LATENCY_PROBE},
+    {IDC_CHECK_PICKCACHE, IDS_PICK_CACHE},
+    {IDC_CHECK_LAZYBUILDINGBLOCKS, IDS_LAZY_BUILDING_BLOCKS},
+    {IDC_CHECK_PRELOADCOMPOSITION, IDS_PRELOAD_COMPOSITION},
+    {IDC_CHECK_MAPCOMPOSITION, IDS_MAP_COMPOSITION},
+    {IDC_CHECK_PREFETCHASSETS, IDS_PREFETCH_ASSETS},
+    {IDC_CHECK_CACHEHOTFIXPLAN, IDS_CACHE_HOTFIX_PLAN},
+    {IDC_CHECK_CACHERENDERDRIVERS, IDS_CACHE_RENDER_DRIVERS},
+    {IDC_CHECK_LOADDIAGNOSTICS, IDS_LOAD_DIAGNOSTICS},
+    {IDC_CHECK_PREFETCHPLUGINS, IDS_PREFETCH_PLUGINS},
     {0, 0} // Terminator
 };
 
@@ -71,6 +82,10 @@ typedef struct
 static const LabelTextMapping g_LabelMappings[] = {
     {IDS_LOG_MODE}, {IDS_DRIVER_ID}, {IDS_BPP}, {IDS_WIDTH}, {IDS_HEIGHT}, {IDS_POSITION_X},
     {IDS_POSITION_Y}, {IDS_LANGUAGE}, {IDS_UI_LANGUAGE},
+    {IDS_BACKGROUND_MODE},
+    {IDS_BACKGROUND_FPS},
+    {IDS_RELOAD_CACHE_SIZE},
+    {IDS_FULLSCREEN_MODE},
     {0} // Terminator
 };
 
@@ -83,6 +98,10 @@ typedef struct
 static const LabelPosition g_LabelPositions[] = {
     {14, 20}, {235, 20}, {330, 20}, {235, 36}, {330, 36}, {14, 172}, {115, 172},
     {14, 216}, {14, 350},
+    {235, 113},
+    {235, 129},
+    {235, 184},
+    {235, 239},
     {0, 0} // Terminator
 };
 
@@ -304,6 +323,24 @@ static void UpdateDialogLanguage(HWND hDlg)
     ::SendDlgItemMessage(hDlg, IDC_COMBO_LANG, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_LANG_FRENCH));
     ::SendDlgItemMessage(hDlg, IDC_COMBO_LANG, CB_SETCURSEL, (langGameSel >= 0 && langGameSel <= 4) ? langGameSel : 1, 0);
 
+    // Background Mode combo
+    int backgroundSel = (int)::SendDlgItemMessage(hDlg, IDC_COMBO_BACKGROUNDMODE, CB_GETCURSEL, 0, 0);
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_BACKGROUNDMODE, CB_RESETCONTENT, 0, 0);
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_BACKGROUNDMODE, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_BACKGROUND_CONTINUE));
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_BACKGROUNDMODE, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_BACKGROUND_THROTTLE));
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_BACKGROUNDMODE, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_BACKGROUND_PROCESS_ONLY));
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_BACKGROUNDMODE, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_BACKGROUND_PAUSE));
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_BACKGROUNDMODE, CB_SETCURSEL, (backgroundSel >= 0 && backgroundSel <= 3) ? backgroundSel : 0, 0);
+
+    // Fullscreen Mode combo
+    int fullscreenSel = (int)::SendDlgItemMessage(hDlg, IDC_COMBO_FULLSCREENMODE, CB_GETCURSEL, 0, 0);
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_FULLSCREENMODE, CB_RESETCONTENT, 0, 0);
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_FULLSCREENMODE, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_FULLSCREEN_AUTO));
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_FULLSCREENMODE, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_FULLSCREEN_EXCLUSIVE));
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_FULLSCREENMODE, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_FULLSCREEN_BORDERLESS));
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_FULLSCREENMODE, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_FULLSCREEN_SCALED));
+    ::SendDlgItemMessage(hDlg, IDC_COMBO_FULLSCREENMODE, CB_SETCURSEL, (fullscreenSel >= 0 && fullscreenSel <= 3) ? fullscreenSel : 0, 0);
+
     // Interface Language combo
     ::SendDlgItemMessage(hDlg, IDC_COMBO_LANGUAGE, CB_RESETCONTENT, 0, 0);
     ::SendDlgItemMessage(hDlg, IDC_COMBO_LANGUAGE, CB_ADDSTRING, 0, (LPARAM)StringResource::GetString(IDS_UI_ENGLISH));
@@ -417,6 +454,11 @@ static void SetConfigIntControl(HWND hDlg, int ctrlID, int value)
         ::SendDlgItemMessage(hDlg, ctrlID, CB_SETCURSEL, langSel, 0);
         return;
     }
+    if (ctrlID == IDC_COMBO_BACKGROUNDMODE || ctrlID == IDC_COMBO_FULLSCREENMODE)
+    {
+        ::SendDlgItemMessage(hDlg, ctrlID, CB_SETCURSEL, (value >= 0 && value <= 3) ? value : 0, 0);
+        return;
+    }
     if (ctrlID == IDC_EDIT_POSX || ctrlID == IDC_EDIT_POSY)
     {
         if (value != CW_USEDEFAULT)
@@ -452,6 +494,13 @@ static int GetConfigIntControl(HWND hDlg, int ctrlID, int fallback)
             return sel;
         return fallback;
     }
+    if (ctrlID == IDC_COMBO_BACKGROUNDMODE || ctrlID == IDC_COMBO_FULLSCREENMODE)
+    {
+        int sel = (int)::SendDlgItemMessage(hDlg, ctrlID, CB_GETCURSEL, 0, 0);
+        if (sel >= 0 && sel <= 3)
+            return sel;
+        return fallback;
+    }
     if (ctrlID == IDC_EDIT_POSX || ctrlID == IDC_EDIT_POSY)
     {
         return GetDlgItemIntSafe(hDlg, ctrlID, CW_USEDEFAULT);
@@ -56,6 +56,29 @@
 #define IDS_WARN_CONFIG_TITLE           1068
 #define IDS_RESTART_REQUIRED            1069
 #define IDS_RESTART_REQUIRED_TITLE      1070
+#define IDS_GROUP_PERFORMANCE           1071
+#define IDS_LATENCY_PROBE               1073
+#define IDS_PICK_CACHE                  1075
+#define IDS_BACKGROUND_MODE             1076
+#define IDS_BACKGROUND_FPS              1077
+#define IDS_BACKGROUND_CONTINUE         1078
+#define IDS_BACKGROUND_THROTTLE         1079
+#define IDS_BACKGROUND_PROCESS_ONLY     1080
+#define IDS_BACKGROUND_PAUSE            1081
+#define IDS_LAZY_BUILDING_BLOCKS        1082
+#define IDS_PRELOAD_COMPOSITION         1083
+#define IDS_MAP_COMPOSITION             1084
+#define IDS_RELOAD_CACHE_SIZE           1085
+#define IDS_PREFETCH_ASSETS             1086
+#define IDS_CACHE_HOTFIX_PLAN           1087
+#define IDS_CACHE_RENDER_DRIVERS        1088
+#define IDS_FULLSCREEN_MODE             1089
+#define IDS_FULLSCREEN_AUTO             1090
+#define IDS_FULLSCREEN_EXCLUSIVE        1091
+#define IDS_FULLSCREEN_BORDERLESS       1092
+#define IDS_FULLSCREEN_SCALED           1093
+#define IDS_LOAD_DIAGNOSTICS            1094
+#define IDS_PREFETCH_PLUGINS            1095
 
 // Config tool string table IDs, Chinese (2000-2999)
 #define IDS_CN_DIALOG_TITLE             2000
@@ -109,6 +132,29 @@
 #define IDS_CN_WARN_CONFIG_TITLE        2068
 #define IDS_CN_RESTART_REQUIRED         2069
 #define IDS_CN_RESTART_REQUIRED_TITLE   2070
+#define IDS_CN_GROUP_PERFORMANCE        2071
+#define IDS_CN_LATENCY_PROBE            2073
+#define IDS_CN_PICK_CACHE               2075
+#define IDS_CN_BACKGROUND_MODE          2076
+#define IDS_CN_BACKGROUND_FPS           2077
+#define IDS_CN_BACKGROUND_CONTINUE      2078
+#define IDS_CN_BACKGROUND_THROTTLE      2079
+#define IDS_CN_BACKGROUND_PROCESS_ONLY  2080
+#define IDS_CN_BACKGROUND_PAUSE         2081
+#define IDS_CN_LAZY_BUILDING_BLOCKS     2082
+#define IDS_CN_PRELOAD_COMPOSITION      2083
+#define IDS_CN_MAP_COMPOSITION          2084
+#define IDS_CN_RELOAD_CACHE_SIZE        2085
+#define IDS_CN_PREFETCH_ASSETS          2086
+#define IDS_CN_CACHE_HOTFIX_PLAN        2087
+#define IDS_CN_CACHE_RENDER_DRIVERS     2088
+#define IDS_CN_FULLSCREEN_MODE          2089
+#define IDS_CN_FULLSCREEN_AUTO          2090
+#define IDS_CN_FULLSCREEN_EXCLUSIVE     2091
+#define IDS_CN_FULLSCREEN_BORDERLESS    2092
+#define IDS_CN_FULLSCREEN_SCALED        2093
+#define IDS_CN_LOAD_DIAGNOSTICS         2094
+#define IDS_CN_PREFETCH_PLUGINS         2095
 
 // Config dialog controls
 #define IDC_BUTTON_DEFAULTS             2000
@@ -141,9 +187,25 @@
 #define IDC_GROUP_GRAPHICS              2402
 #define IDC_GROUP_WINDOW                2403
 #define IDC_GROUP_GAME                  2404
+#define IDC_GROUP_PERFORMANCE           2405
 #define IDC_GROUP_INTERFACE             2500
 #define IDC_COMBO_LANGUAGE              2501
 
+#define IDC_CHECK_LATENCYPROBE          2602
+#define IDC_CHECK_PICKCACHE             2604
+#define IDC_COMBO_BACKGROUNDMODE        2605
+#define IDC_EDIT_BACKGROUNDFPS          2606
+#define IDC_CHECK_LAZYBUILDINGBLOCKS    2607
+#define IDC_CHECK_PRELOADCOMPOSITION    2608
+#define IDC_CHECK_MAPCOMPOSITION        2609
+#define IDC_EDIT_RELOADCACHESIZE        2610
+#define IDC_CHECK_PREFETCHASSETS        2611
+#define IDC_CHECK_CACHEHOTFIXPLAN       2612
+#define IDC_CHECK_CACHERENDERDRIVERS    2613
+#define IDC_COMBO_FULLSCREENMODE        2614
+#define IDC_CHECK_LOADDIAGNOSTICS       2615
+#define IDC_CHECK_PREFETCHPLUGINS       2616
+
 // Config dialog controls mapped by CGameConfig member name.
 #define IDC_CONFIG_logMode              IDC_COMBO_LOGMODE
 #define IDC_CONFIG_verbose              IDC_CHECK_VERBOSE
@@ -167,5 +229,19 @@
 #define IDC_CONFIG_unlockHighResolution IDC_CHECK_UNLOCKHIGHRES
 #define IDC_CONFIG_debug                IDC_CHECK_DEBUG
 #define IDC_CONFIG_rookie               IDC_CHECK_ROOKIE
+#define IDC_CONFIG_latencyProbe         IDC_CHECK_LATENCYPROBE
+#define IDC_CONFIG_pickCache            IDC_CHECK_PICKCACHE
+#define IDC_CONFIG_backgroundMode       IDC_COMBO_BACKGROUNDMODE
+#define IDC_CONFIG_backgroundFps        IDC_EDIT_BACKGROUNDFPS
+#define IDC_CONFIG_lazyBuildingBlocks   IDC_CHECK_LAZYBUILDINGBLOCKS
+#define IDC_CONFIG_preloadComposition   IDC_CHECK_PRELOADCOMPOSITION
+#define IDC_CONFIG_mapComposition       IDC_CHECK_MAPCOMPOSITION
+#define IDC_CONFIG_reloadCacheSize      IDC_EDIT_RELOADCACHESIZE
+#define IDC_CONFIG_prefetchAssets       IDC_CHECK_PREFETCHASSETS
+#define IDC_CONFIG_cacheHotfixPlan      IDC_CHECK_CACHEHOTFIXPLAN
+#define IDC_CONFIG_cacheRenderDrivers   IDC_CHECK_CACHERENDERDRIVERS
+#define IDC_CONFIG_fullscreenMode       IDC_COMBO_FULLSCREENMODE
+#define IDC_CONFIG_loadDiagnostics      IDC_CHECK_LOADDIAGNOSTICS
+#define IDC_CONFIG_prefetchPlugins      IDC_CHECK_PREFETCHPLUGINS
 
 #endif // CONFIGTOOL_RESOURCE_H
@@ -0,0 +1,65 @@
+#include "DebounceScheduler.h"
+
+CDebounceScheduler::CDebounceScheduler()
+    : m_Delay((platform::uint64)DEFAULT_DELAY_MS * 1000),
+      m_MaxDelay((platform::uint64)DEFAULT_MAX_DELAY_MS * 1000),
+      m_Fields(0),
+      m_FirstChange(0),
+      m_LastChange(0),
+      m_FlushCount(0) {}
+
+void CDebounceScheduler::Configure(platform::uint64 delay, platform::uint64 maxDelay)
+{
+    m_Delay = delay;
+    m_MaxDelay = (maxDelay > delay) ? maxDelay : delay;
+}
+
+void CDebounceScheduler::MarkDirty(unsigned int fields, platform::uint64 now)
+{
+    if (fields == 0)
+        return;
+
+    if (m_Fields == 0)
+        m_FirstChange = now;
+    m_LastChange = now;
+    m_Fields |= fields;
+}
+
+bool CDebounceScheduler::IsDue(platform::uint64 now) const
+{
+    if (m_Fields == 0)
+        return false;
+
+    // A clock that went backwards counts as no time passed.
+    const platform::uint64 quiet = (now > m_LastChange) ? now - m_LastChange : 0;
+    const platform::uint64 waited = (now > m_FirstChange) ? now - m_FirstChange : 0;
+    return quiet >= m_Delay || waited >= m_MaxDelay;
+}
+
+platform::uint64 CDebounceScheduler::GetWaitTime(platform::uint64 now) const
+{
+    if (m_Fields == 0 || IsDue(now))
+        return 0;
+
+    const platform::uint64 quiet = (now > m_LastChange) ? now - m_LastChange : 0;
+    const platform::uint64 waited = (now > m_FirstChange) ? now - m_FirstChange : 0;
+    const platform::uint64 untilQuiet = m_Delay - quiet;
+    const platform::uint64 untilMax = m_MaxDelay - waited;
+    return (untilQuiet < untilMax) ? untilQuiet : untilMax;
+}
+
+unsigned int CDebounceScheduler::Poll(platform::uint64 now)
+{
+    if (!IsDue(now))
+        return 0;
+    return TakeAll();
+}
+
+unsigned int CDebounceScheduler::TakeAll()
+{
+    const unsigned int fields = m_Fields;
+    if (fields != 0)
+        ++m_FlushCount;
+    m_Fields = 0;
+    return fields;
+}
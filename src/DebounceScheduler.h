@@ -0,0 +1,55 @@
+#ifndef PLAYER_DEBOUNCESCHEDULER_H
+#define PLAYER_DEBOUNCESCHEDULER_H
+
+#include "Platform.h"
+
+// Collects changes as a mask of dirty fields and says when they are due to be
+// written out: once no change arrived for the delay, or once the oldest change
+// waited for the maximum delay, whichever comes first. A burst of changes, such
+// as every WM_MOVE of a window drag, ends in a single flush. Times are in
+// microseconds and come from the caller, so the scheduler runs on any clock.
+class CDebounceScheduler
+{
+public:
+    enum
+    {
+        DEFAULT_DELAY_MS = 1000,
+        DEFAULT_MAX_DELAY_MS = 10000
+    };
+
+    CDebounceScheduler();
+
+    // A maximum delay shorter than the delay is raised to it.
+    void Configure(platform::uint64 delay, platform::uint64 maxDelay);
+
+    platform::uint64 GetDelay() const { return m_Delay; }
+    platform::uint64 GetMaxDelay() const { return m_MaxDelay; }
+
+    void MarkDirty(unsigned int fields, platform::uint64 now);
+
+    bool IsDirty() const { return m_Fields != 0; }
+    unsigned int GetDirtyFields() const { return m_Fields; }
+
+    bool IsDue(platform::uint64 now) const;
+
+    // Microseconds until the dirty fields are due; 0 if they are due or clean.
+    platform::uint64 GetWaitTime(platform::uint64 now) const;
+
+    // Returns the dirty fields and clears them if they are due, 0 otherwise.
+    unsigned int Poll(platform::uint64 now);
+
+    // Returns the dirty fields and clears them whether or not they are due.
+    unsigned int TakeAll();
+
+    int GetFlushCount() const { return m_FlushCount; }
+
+private:
+    platform::uint64 m_Delay;
+    platform::uint64 m_MaxDelay;
+    unsigned int m_Fields;
+    platform::uint64 m_FirstChange;
+    platform::uint64 m_LastChange;
+    int m_FlushCount;
+};
+
+#endif // PLAYER_DEBOUNCESCHEDULER_H
@@ -0,0 +1,157 @@
+#include "DisplayModeCatalog.h"
+
+#include <algorithm>
+
+namespace
+{
+    int CompareSize(int width, int height, int bpp, int otherWidth, int otherHeight, int otherBpp)
+    {
+        if (width != otherWidth)
+            return width < otherWidth ? -1 : 1;
+        if (height != otherHeight)
+            return height < otherHeight ? -1 : 1;
+        if (bpp != otherBpp)
+            return bpp < otherBpp ? -1 : 1;
+        return 0;
+    }
+
+    // Orders mode indices by size and depth, keeping driver order among equals.
+    class ModeOrder
+    {
+    public:
+        explicit ModeOrder(const std::vector<DisplayMode> &modes) : m_Modes(modes) {}
+
+        bool operator()(int a, int b) const
+        {
+            const DisplayMode &ma = m_Modes[a];
+            const DisplayMode &mb = m_Modes[b];
+            const int order = CompareSize(ma.width, ma.height, ma.bpp, mb.width, mb.height, mb.bpp);
+            if (order != 0)
+                return order < 0;
+            return a < b;
+        }
+
+    private:
+        const std::vector<DisplayMode> &m_Modes;
+    };
+}
+
+bool DisplayModeFilter::Accepts(int width, int height, int bpp) const
+{
+    if (bpp < minBpp)
+        return false;
+    if (width < minWidth || height < minHeight)
+        return false;
+    if ((maxWidth > 0 && width > maxWidth) || (maxHeight > 0 && height > maxHeight))
+        return false;
+
+    if (aspectWidth > 0 && aspectHeight > 0)
+    {
+        // |width / height - aspectWidth / aspectHeight| within 1% of the ratio.
+        const double scaled = (double)width * aspectHeight;
+        const double expected = (double)height * aspectWidth;
+        const double difference = scaled > expected ? scaled - expected : expected - scaled;
+        if (difference * 100 > expected)
+            return false;
+    }
+    return true;
+}
+
+void CDisplayModeCatalog::Build(const DisplayMode *modes, int count)
+{
+    Clear();
+    if (!modes || count <= 0)
+        return;
+
+    m_Modes.assign(modes, modes + count);
+
+    int i;
+    m_Order.resize(count);
+    for (i = 0; i < count; ++i)
+        m_Order[i] = i;
+    std::sort(m_Order.begin(), m_Order.end(), ModeOrder(m_Modes));
+
+    for (i = 0; i < count; ++i)
+    {
+        const DisplayMode &mode = m_Modes[m_Order[i]];
+        if (m_Entries.empty() ||
+            CompareSize(m_Entries.back().width, m_Entries.back().height, m_Entries.back().bpp, mode.width, mode.height, mode.bpp) != 0)
+        {
+            DisplayModeEntry entry;
+            entry.width = mode.width;
+            entry.height = mode.height;
+            entry.bpp = mode.bpp;
+            entry.refreshRate = mode.refreshRate;
+            entry.mode = m_Order[i];
+            m_Entries.push_back(entry);
+            m_EntryStart.push_back(i);
+        }
+        else if (mode.refreshRate > m_Entries.back().refreshRate)
+        {
+            m_Entries.back().refreshRate = mode.refreshRate;
+            m_Entries.back().mode = m_Order[i];
+        }
+    }
+    m_EntryStart.push_back(count);
+}
+
+void CDisplayModeCatalog::Clear()
+{
+    m_Modes.clear();
+    m_Entries.clear();
+    m_Order.clear();
+    m_EntryStart.clear();
+}
+
+int CDisplayModeCatalog::FindEntry(int width, int height, int bpp) const
+{
+    int low = 0;
+    int high = (int)m_Entries.size();
+    while (low < high)
+    {
+        const int mid = (low + high) / 2;
+        const DisplayModeEntry &entry = m_Entries[mid];
+        const int order = CompareSize(width, height, bpp, entry.width, entry.height, entry.bpp);
+        if (order == 0)
+            return mid;
+        if (order > 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return -1;
+}
+
+int CDisplayModeCatalog::FindMode(int width, int height, int bpp) const
+{
+    const int entry = FindEntry(width, height, bpp);
+    return entry >= 0 ? m_Entries[entry].mode : -1;
+}
+
+void CDisplayModeCatalog::SelectEntries(const DisplayModeFilter &filter, std::vector<int> &entries) const
+{
+    entries.clear();
+    int i;
+    for (i = 0; i < (int)m_Entries.size(); ++i)
+    {
+        const DisplayModeEntry &entry = m_Entries[i];
+        if (filter.Accepts(entry.width, entry.height, entry.bpp))
+            entries.push_back(i);
+    }
+}
+
+void CDisplayModeCatalog::SelectModes(const DisplayModeFilter &filter, std::vector<int> &modes) const
+{
+    modes.clear();
+    int i;
+    for (i = 0; i < (int)m_Entries.size(); ++i)
+    {
+        const DisplayModeEntry &entry = m_Entries[i];
+        if (!filter.Accepts(entry.width, entry.height, entry.bpp))
+            continue;
+
+        int j;
+        for (j = m_EntryStart[i]; j < m_EntryStart[i + 1]; ++j)
+            modes.push_back(m_Order[j]);
+    }
+}
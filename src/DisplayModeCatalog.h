@@ -0,0 +1,83 @@
+#ifndef PLAYER_DISPLAYMODECATALOG_H
+#define PLAYER_DISPLAYMODECATALOG_H
+
+#include <vector>
+
+// A mode as a render driver lists it.
+struct DisplayMode
+{
+    int width;
+    int height;
+    int bpp;
+    int refreshRate;
+};
+
+// A size and depth the driver offers, with its mode of the highest refresh rate.
+struct DisplayModeEntry
+{
+    int width;
+    int height;
+    int bpp;
+    int refreshRate;
+    int mode; // index in the driver list; the first one among equal refresh rates
+};
+
+// Bounds on the modes to list. A zero bound or aspect ratio accepts anything.
+struct DisplayModeFilter
+{
+    int minBpp;
+    int minWidth;
+    int minHeight;
+    int maxWidth;
+    int maxHeight;
+    int aspectWidth;  // with aspectHeight, keeps sizes within 1% of the ratio
+    int aspectHeight;
+
+    DisplayModeFilter() : minBpp(0), minWidth(0), minHeight(0), maxWidth(0), maxHeight(0), aspectWidth(0), aspectHeight(0) {}
+
+    bool Accepts(int width, int height, int bpp) const;
+};
+
+// The display modes of one render driver, grouped by size and depth.
+//
+// Entries are sorted by width, height and depth, so a size and depth is found by
+// binary search, and each entry knows the mode of its best refresh rate. Mode
+// indices are those of the driver list, which is what the render manager expects.
+class CDisplayModeCatalog
+{
+public:
+    CDisplayModeCatalog() {}
+
+    void Build(const DisplayMode *modes, int count);
+    void Clear();
+
+    int GetModeCount() const { return (int)m_Modes.size(); }
+    const DisplayMode &GetMode(int mode) const { return m_Modes[mode]; }
+
+    int GetEntryCount() const { return (int)m_Entries.size(); }
+    const DisplayModeEntry &GetEntry(int index) const { return m_Entries[index]; }
+
+    // Returns the entry index of the size and depth, or -1.
+    int FindEntry(int width, int height, int bpp) const;
+
+    // Returns the mode of the best refresh rate for the size and depth, or -1.
+    int FindMode(int width, int height, int bpp) const;
+
+    // The entry indices the filter accepts, in catalog order.
+    void SelectEntries(const DisplayModeFilter &filter, std::vector<int> &entries) const;
+
+    // The modes of every refresh rate the filter accepts, grouped by entry and in
+    // driver order within one.
+    void SelectModes(const DisplayModeFilter &filter, std::vector<int> &modes) const;
+
+private:
+    CDisplayModeCatalog(const CDisplayModeCatalog &);
+    CDisplayModeCatalog &operator=(const CDisplayModeCatalog &);
+
+    std::vector<DisplayMode> m_Modes;
+    std::vector<DisplayModeEntry> m_Entries;
+    std::vector<int> m_Order;      // modes sorted by entry, then driver order
+    std::vector<int> m_EntryStart; // first position in m_Order of each entry, and the end
+};
+
+#endif // PLAYER_DISPLAYMODECATALOG_H
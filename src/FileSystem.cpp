@@ -0,0 +1,257 @@
+#include "FileSystem.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef INVALID_FILE_ATTRIBUTES
+#define INVALID_FILE_ATTRIBUTES ((DWORD)-1)
+#endif
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    const size_t PREFETCH_CHUNK_SIZE = 64 * 1024;
+
+    bool IsDotEntry(const char *name)
+    {
+        return strcmp(name, ".") == 0 || strcmp(name, "..") == 0;
+    }
+
+    class CNativeFileSystem : public CFileSystem
+    {
+    public:
+        virtual bool DirectoryExists(const char *path)
+        {
+            if (!path || !*path)
+                return false;
+#ifdef _WIN32
+            DWORD attributes = ::GetFileAttributesA(path);
+            return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+            struct stat st;
+            return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+        }
+
+        virtual bool ListFiles(const char *directory, const char *extension, std::vector<FileEntry> &files)
+        {
+            if (!directory || !*directory)
+                return false;
+#ifdef _WIN32
+            std::string pattern = filesystem::JoinPath(directory, "*");
+            WIN32_FIND_DATAA data;
+            HANDLE find = ::FindFirstFileA(pattern.c_str(), &data);
+            if (find == INVALID_HANDLE_VALUE)
+                return DirectoryExists(directory);
+
+            do
+            {
+                if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                    continue;
+                if (!filesystem::HasExtension(data.cFileName, extension))
+                    continue;
+
+                FileEntry entry;
+                entry.path = filesystem::JoinPath(directory, data.cFileName);
+                entry.size = ((platform::uint64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+                entry.modifiedTime = ((platform::uint64)data.ftLastWriteTime.dwHighDateTime << 32) |
+                                     data.ftLastWriteTime.dwLowDateTime;
+                files.push_back(entry);
+            } while (::FindNextFileA(find, &data));
+            ::FindClose(find);
+            return true;
+#else
+            DIR *dir = opendir(directory);
+            if (!dir)
+                return false;
+
+            struct dirent *item;
+            while ((item = readdir(dir)) != NULL)
+            {
+                if (!filesystem::HasExtension(item->d_name, extension))
+                    continue;
+
+                FileEntry entry;
+                if (GetFileEntry(filesystem::JoinPath(directory, item->d_name).c_str(), entry))
+                    files.push_back(entry);
+            }
+            closedir(dir);
+            return true;
+#endif
+        }
+
+        virtual bool ListDirectories(const char *directory, std::vector<std::string> &directories)
+        {
+            if (!directory || !*directory)
+                return false;
+#ifdef _WIN32
+            std::string pattern = filesystem::JoinPath(directory, "*");
+            WIN32_FIND_DATAA data;
+            HANDLE find = ::FindFirstFileA(pattern.c_str(), &data);
+            if (find == INVALID_HANDLE_VALUE)
+                return DirectoryExists(directory);
+
+            do
+            {
+                if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) || IsDotEntry(data.cFileName))
+                    continue;
+                directories.push_back(filesystem::JoinPath(directory, data.cFileName));
+            } while (::FindNextFileA(find, &data));
+            ::FindClose(find);
+            return true;
+#else
+            DIR *dir = opendir(directory);
+            if (!dir)
+                return false;
+
+            struct dirent *item;
+            while ((item = readdir(dir)) != NULL)
+            {
+                if (IsDotEntry(item->d_name))
+                    continue;
+
+                const std::string path = filesystem::JoinPath(directory, item->d_name);
+                if (DirectoryExists(path.c_str()))
+                    directories.push_back(path);
+            }
+            closedir(dir);
+            return true;
+#endif
+        }
+
+        virtual bool GetFileEntry(const char *path, FileEntry &entry)
+        {
+            if (!path || !*path)
+                return false;
+#ifdef _WIN32
+            WIN32_FILE_ATTRIBUTE_DATA data;
+            if (!::GetFileAttributesExA(path, GetFileExInfoStandard, &data) ||
+                (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+                return false;
+            entry.path = path;
+            entry.size = ((platform::uint64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+            entry.modifiedTime = ((platform::uint64)data.ftLastWriteTime.dwHighDateTime << 32) |
+                                 data.ftLastWriteTime.dwLowDateTime;
+            return true;
+#else
+            struct stat st;
+            if (stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+                return false;
+            entry.path = path;
+            entry.size = (platform::uint64)st.st_size;
+            entry.modifiedTime = (platform::uint64)st.st_mtime * 1000000000ULL + (platform::uint64)st.st_mtim.tv_nsec;
+            return true;
+#endif
+        }
+
+        virtual platform::uint64 Prefetch(const char *path)
+        {
+            if (!path || !*path)
+                return 0;
+
+            char buffer[PREFETCH_CHUNK_SIZE];
+            platform::uint64 total = 0;
+#ifdef _WIN32
+            HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                        FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+                return 0;
+
+            DWORD read = 0;
+            while (::ReadFile(file, buffer, sizeof(buffer), &read, NULL) && read > 0)
+                total += read;
+            ::CloseHandle(file);
+#else
+            FILE *file = fopen(path, "rb");
+            if (!file)
+                return 0;
+
+            size_t read;
+            while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+                total += read;
+            fclose(file);
+#endif
+            return total;
+        }
+    };
+}
+
+CFileSystem &CFileSystem::GetNative()
+{
+    static CNativeFileSystem fileSystem;
+    return fileSystem;
+}
+
+namespace filesystem
+{
+    char GetSeparator()
+    {
+#ifdef _WIN32
+        return '\\';
+#else
+        return '/';
+#endif
+    }
+
+    std::string JoinPath(const std::string &directory, const std::string &name)
+    {
+        if (directory.empty())
+            return name;
+
+        char last = directory[directory.size() - 1];
+        if (last == '\\' || last == '/')
+            return directory + name;
+        return directory + GetSeparator() + name;
+    }
+
+    std::string NormalizePath(const std::string &path)
+    {
+        std::string result = path;
+        size_t i;
+        for (i = 0; i < result.size(); ++i)
+        {
+            if (result[i] == '\\')
+                result[i] = '/';
+            else
+                result[i] = (char)tolower((unsigned char)result[i]);
+        }
+        while (result.size() > 1 && result[result.size() - 1] == '/')
+            result.erase(result.size() - 1);
+        return result;
+    }
+
+    std::string GetDirectory(const std::string &path)
+    {
+        const size_t separator = path.find_last_of("\\/");
+        if (separator == std::string::npos)
+            return std::string();
+        return path.substr(0, separator + 1);
+    }
+
+    bool HasExtension(const char *name, const char *extension)
+    {
+        if (!name)
+            return false;
+        if (!extension || !*extension)
+            return true;
+
+        size_t nameLength = strlen(name);
+        size_t extensionLength = strlen(extension);
+        if (nameLength <= extensionLength)
+            return false;
+
+        const char *suffix = name + nameLength - extensionLength;
+        size_t i;
+        for (i = 0; i < extensionLength; ++i)
+        {
+            if (tolower((unsigned char)suffix[i]) != tolower((unsigned char)extension[i]))
+                return false;
+        }
+        return true;
+    }
+}
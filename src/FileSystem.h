@@ -0,0 +1,61 @@
+#ifndef PLAYER_FILESYSTEM_H
+#define PLAYER_FILESYSTEM_H
+
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+
+struct FileEntry
+{
+    std::string path;
+    platform::uint64 size;
+    platform::uint64 modifiedTime; // opaque, only compared for equality
+};
+
+// The file system operations used by the startup scanners, kept behind an
+// interface so tests can substitute an in-memory tree. Implementations must be
+// safe to call from several threads at once.
+class CFileSystem
+{
+public:
+    virtual ~CFileSystem() {}
+
+    virtual bool DirectoryExists(const char *path) = 0;
+
+    // Appends the regular files of the directory (not recursive) whose name ends with
+    // the extension, compared case-insensitively. A NULL or empty extension matches all files.
+    virtual bool ListFiles(const char *directory, const char *extension, std::vector<FileEntry> &files) = 0;
+
+    // Appends the paths of the subdirectories of the directory (not recursive),
+    // leaving out "." and "..".
+    virtual bool ListDirectories(const char *directory, std::vector<std::string> &directories) = 0;
+
+    virtual bool GetFileEntry(const char *path, FileEntry &entry) = 0;
+
+    // Reads the whole file so later loads hit the page cache. Returns the bytes read.
+    virtual platform::uint64 Prefetch(const char *path) = 0;
+
+    // The file system of the running process.
+    static CFileSystem &GetNative();
+};
+
+namespace filesystem
+{
+    char GetSeparator();
+
+    // Joins a directory and a file name, inserting a separator if needed.
+    std::string JoinPath(const std::string &directory, const std::string &name);
+
+    // Lower-cases the path, unifies separators and drops a trailing separator, so two
+    // spellings of the same directory compare equal.
+    std::string NormalizePath(const std::string &path);
+
+    // Returns the directory part of the path with its trailing separator, or an
+    // empty string if the path has none.
+    std::string GetDirectory(const std::string &path);
+
+    bool HasExtension(const char *name, const char *extension);
+}
+
+#endif // PLAYER_FILESYSTEM_H
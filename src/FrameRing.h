@@ -0,0 +1,44 @@
+#ifndef PLAYER_FRAMERING_H
+#define PLAYER_FRAMERING_H
+
+#include "Platform.h"
+
+// Bounded single-producer/single-consumer ring. Capacity must be a power of two.
+template <class T, int Capacity>
+class FrameRing
+{
+public:
+    FrameRing() : m_Head(0), m_Tail(0) {}
+
+    bool TryPush(const T &value)
+    {
+        long tail = platform::AtomicLoad(&m_Tail);
+        if (tail - platform::AtomicLoad(&m_Head) >= Capacity)
+            return false;
+        m_Items[tail & (Capacity - 1)] = value;
+        platform::AtomicStore(&m_Tail, tail + 1);
+        return true;
+    }
+
+    bool TryPop(T &value)
+    {
+        long head = platform::AtomicLoad(&m_Head);
+        if (head == platform::AtomicLoad(&m_Tail))
+            return false;
+        value = m_Items[head & (Capacity - 1)];
+        platform::AtomicStore(&m_Head, head + 1);
+        return true;
+    }
+
+    int GetSize() const { return (int)(platform::AtomicLoad(&m_Tail) - platform::AtomicLoad(&m_Head)); }
+    int GetCapacity() const { return Capacity; }
+
+private:
+    PLATFORM_STATIC_ASSERT(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, capacity_power_of_two);
+
+    volatile long m_Head;
+    volatile long m_Tail;
+    T m_Items[Capacity];
+};
+
+#endif // PLAYER_FRAMERING_H
@@ -0,0 +1,204 @@
+#include "FullscreenPolicy.h"
+
+#include <string.h>
+
+bool FullscreenAction::IsEmpty() const
+{
+    return !leaveExclusive && !restoreDisplayMode && !restoreWindow && !changeDisplayMode &&
+           !popupWindow && !enterExclusive && !resizeRenderTarget;
+}
+
+bool FullscreenAction::IsExpensive() const
+{
+    return leaveExclusive || restoreDisplayMode || changeDisplayMode || enterExclusive;
+}
+
+CFullscreenPolicy::CFullscreenPolicy()
+    : m_Mode(eFullscreenAuto),
+      m_Strategy(eFullscreenWindowed),
+      m_Suspended(false),
+      m_DisplayModeChanged(false),
+      m_Width(0),
+      m_Height(0),
+      m_DesktopWidth(0),
+      m_DesktopHeight(0),
+      m_DisplayModeChanges(0),
+      m_DeviceResets(0),
+      m_ExpensiveTransitions(0) {}
+
+void CFullscreenPolicy::Configure(int mode)
+{
+    m_Mode = (mode >= 0 && mode < eFullscreenModeCount) ? (FullscreenMode)mode : eFullscreenAuto;
+}
+
+FullscreenStrategy CFullscreenPolicy::Resolve(int width, int height, int desktopWidth, int desktopHeight) const
+{
+    // Nothing is cheaper than a window covering a desktop of the requested size.
+    const bool desktopSize = width > 0 && height > 0 && width == desktopWidth && height == desktopHeight;
+
+    switch (m_Mode)
+    {
+    case eFullscreenExclusive:
+        return eFullscreenStrategyExclusive;
+    case eFullscreenBorderless:
+        return eFullscreenStrategyBorderless;
+    case eFullscreenBorderlessScaled:
+        if (desktopSize || desktopWidth <= 0 || desktopHeight <= 0 || width <= 0 || height <= 0)
+            return eFullscreenStrategyBorderless;
+        return eFullscreenStrategyScaled;
+    default:
+        return desktopSize ? eFullscreenStrategyBorderless : eFullscreenStrategyExclusive;
+    }
+}
+
+FullscreenAction CFullscreenPolicy::Enter(int width, int height, int desktopWidth, int desktopHeight)
+{
+    const FullscreenStrategy from = m_Suspended ? eFullscreenWindowed : m_Strategy;
+    const bool changed = !IsSameRequest(width, height, desktopWidth, desktopHeight);
+    m_Width = width;
+    m_Height = height;
+    m_DesktopWidth = desktopWidth;
+    m_DesktopHeight = desktopHeight;
+    m_Suspended = false;
+    return Transition(from, Resolve(width, height, desktopWidth, desktopHeight), changed);
+}
+
+FullscreenAction CFullscreenPolicy::Leave()
+{
+    if (m_Suspended)
+    {
+        // Exclusive fullscreen was already left when focus went away.
+        m_Suspended = false;
+        m_Strategy = eFullscreenWindowed;
+        return Transition(eFullscreenWindowed, eFullscreenWindowed, false);
+    }
+    return Transition(m_Strategy, eFullscreenWindowed, false);
+}
+
+FullscreenAction CFullscreenPolicy::Resize(int width, int height, int desktopWidth, int desktopHeight)
+{
+    const bool changed = !IsSameRequest(width, height, desktopWidth, desktopHeight);
+    m_Width = width;
+    m_Height = height;
+    m_DesktopWidth = desktopWidth;
+    m_DesktopHeight = desktopHeight;
+
+    // A window or a suspended device picks the new size up when it enters fullscreen.
+    if (m_Strategy == eFullscreenWindowed || m_Suspended)
+        return Transition(m_Strategy, m_Strategy, false);
+    return Transition(m_Strategy, Resolve(width, height, desktopWidth, desktopHeight), changed);
+}
+
+FullscreenAction CFullscreenPolicy::EnterFailed()
+{
+    FullscreenAction action = Transition(eFullscreenWindowed, eFullscreenWindowed, false);
+    action.restoreDisplayMode = m_DisplayModeChanged;
+    action.restoreWindow = true;
+
+    if (action.restoreDisplayMode)
+    {
+        ++m_DisplayModeChanges;
+        ++m_ExpensiveTransitions;
+    }
+    m_DisplayModeChanged = false;
+    m_Strategy = eFullscreenWindowed;
+    m_Suspended = false;
+    return action;
+}
+
+FullscreenAction CFullscreenPolicy::Deactivate()
+{
+    if (m_Strategy != eFullscreenStrategyExclusive || m_Suspended)
+        return Transition(m_Strategy, m_Strategy, false);
+
+    // An exclusive device cannot stay on screen behind another window.
+    FullscreenAction action = Transition(eFullscreenStrategyExclusive, eFullscreenWindowed, false);
+    m_Strategy = eFullscreenStrategyExclusive;
+    m_Suspended = true;
+    return action;
+}
+
+FullscreenAction CFullscreenPolicy::Activate()
+{
+    if (!m_Suspended)
+        return Transition(m_Strategy, m_Strategy, false);
+
+    m_Suspended = false;
+    return Transition(eFullscreenWindowed, Resolve(m_Width, m_Height, m_DesktopWidth, m_DesktopHeight), false);
+}
+
+FullscreenAction CFullscreenPolicy::Transition(FullscreenStrategy from, FullscreenStrategy to, bool changed)
+{
+    FullscreenAction action;
+    memset(&action, 0, sizeof(action));
+    m_Strategy = to;
+    if (from == to && (!changed || to == eFullscreenWindowed))
+        return action;
+
+    const bool fromBorderless = from == eFullscreenStrategyBorderless || from == eFullscreenStrategyScaled;
+    const bool toBorderless = to == eFullscreenStrategyBorderless || to == eFullscreenStrategyScaled;
+
+    action.leaveExclusive = from == eFullscreenStrategyExclusive;
+    action.enterExclusive = to == eFullscreenStrategyExclusive;
+    action.changeDisplayMode = to == eFullscreenStrategyExclusive;
+    action.restoreDisplayMode = m_DisplayModeChanged && to != eFullscreenStrategyExclusive;
+    action.restoreWindow = to == eFullscreenWindowed;
+    // The monitor changes size with the display mode, so the popup has to follow it.
+    action.popupWindow = to != eFullscreenWindowed &&
+                         (from == eFullscreenWindowed || from == eFullscreenStrategyExclusive || to == eFullscreenStrategyExclusive);
+    action.resizeRenderTarget = toBorderless || (to == eFullscreenWindowed && fromBorderless);
+    SetRenderRect(action, to);
+
+    if (action.changeDisplayMode)
+        ++m_DisplayModeChanges;
+    if (action.restoreDisplayMode)
+        ++m_DisplayModeChanges;
+    if (action.leaveExclusive)
+        ++m_DeviceResets;
+    if (action.enterExclusive)
+        ++m_DeviceResets;
+    if (action.IsExpensive())
+        ++m_ExpensiveTransitions;
+
+    if (action.changeDisplayMode)
+        m_DisplayModeChanged = true;
+    else if (action.restoreDisplayMode)
+        m_DisplayModeChanged = false;
+    return action;
+}
+
+bool CFullscreenPolicy::IsSameRequest(int width, int height, int desktopWidth, int desktopHeight) const
+{
+    return width == m_Width && height == m_Height && desktopWidth == m_DesktopWidth && desktopHeight == m_DesktopHeight;
+}
+
+void CFullscreenPolicy::SetRenderRect(FullscreenAction &action, FullscreenStrategy strategy) const
+{
+    action.renderX = 0;
+    action.renderY = 0;
+    action.renderWidth = m_Width;
+    action.renderHeight = m_Height;
+
+    if (strategy == eFullscreenStrategyBorderless)
+    {
+        action.renderWidth = m_DesktopWidth;
+        action.renderHeight = m_DesktopHeight;
+    }
+    else if (strategy == eFullscreenStrategyScaled)
+    {
+        // Fit the configured resolution into the desktop, keeping its aspect
+        // ratio and centring it between bars.
+        if ((double)m_Width * m_DesktopHeight > (double)m_Height * m_DesktopWidth)
+        {
+            action.renderWidth = m_DesktopWidth;
+            action.renderHeight = (int)((double)m_Height * m_DesktopWidth / m_Width);
+        }
+        else
+        {
+            action.renderWidth = (int)((double)m_Width * m_DesktopHeight / m_Height);
+            action.renderHeight = m_DesktopHeight;
+        }
+        action.renderX = (m_DesktopWidth - action.renderWidth) / 2;
+        action.renderY = (m_DesktopHeight - action.renderHeight) / 2;
+    }
+}
@@ -0,0 +1,104 @@
+#ifndef PLAYER_FULLSCREENPOLICY_H
+#define PLAYER_FULLSCREENPOLICY_H
+
+// How the player covers the screen when it goes fullscreen.
+enum FullscreenMode
+{
+    eFullscreenAuto = 0,        // borderless when the resolution is the desktop one, exclusive otherwise
+    eFullscreenExclusive,       // change the display mode and take the device exclusively
+    eFullscreenBorderless,      // cover the desktop with a popup window, rendering at desktop size
+    eFullscreenBorderlessScaled, // cover the desktop, scaling the configured resolution to fit it
+    eFullscreenModeCount
+};
+
+// What a fullscreen window currently looks like.
+enum FullscreenStrategy
+{
+    eFullscreenWindowed = 0,
+    eFullscreenStrategyExclusive,
+    eFullscreenStrategyBorderless,
+    eFullscreenStrategyScaled
+};
+
+// The steps of a transition, in the order the player carries them out.
+struct FullscreenAction
+{
+    bool leaveExclusive;      // CKRenderContext::StopFullScreen
+    bool restoreDisplayMode;  // go back to the desktop display mode
+    bool restoreWindow;       // back to the windowed style, position and size
+    bool changeDisplayMode;   // switch the display to the requested mode
+    bool popupWindow;         // cover the monitor with a popup window
+    bool enterExclusive;      // CKRenderContext::GoFullScreen
+    bool resizeRenderTarget;  // move the render context to the render rectangle
+    int renderX;
+    int renderY;
+    int renderWidth;
+    int renderHeight;
+
+    bool IsEmpty() const;
+
+    // True if the transition changes the display mode or resets the device.
+    bool IsExpensive() const;
+};
+
+// Decides how the player enters, leaves and keeps fullscreen. Exclusive
+// fullscreen changes the display mode and resets the render device on every
+// transition; the borderless strategies only restyle the window, so they
+// also stay in place when the player loses focus.
+class CFullscreenPolicy
+{
+public:
+    CFullscreenPolicy();
+
+    // Out of range values fall back to eFullscreenAuto.
+    void Configure(int mode);
+    FullscreenMode GetMode() const { return m_Mode; }
+
+    // The strategy the mode picks for a resolution on a desktop of the given size.
+    FullscreenStrategy Resolve(int width, int height, int desktopWidth, int desktopHeight) const;
+
+    FullscreenStrategy GetStrategy() const { return m_Strategy; }
+    bool IsFullscreen() const { return m_Strategy != eFullscreenWindowed && !m_Suspended; }
+
+    // True while exclusive fullscreen is left because the player lost focus.
+    bool IsSuspended() const { return m_Suspended; }
+
+    // True while the display runs in a mode the player set.
+    bool HasChangedDisplayMode() const { return m_DisplayModeChanged; }
+
+    FullscreenAction Enter(int width, int height, int desktopWidth, int desktopHeight);
+    FullscreenAction Leave();
+
+    // A new resolution; a fullscreen window moves to the strategy it resolves to.
+    FullscreenAction Resize(int width, int height, int desktopWidth, int desktopHeight);
+
+    // The engine could not take the device: back to a window.
+    FullscreenAction EnterFailed();
+
+    FullscreenAction Deactivate();
+    FullscreenAction Activate();
+
+    int GetDisplayModeChanges() const { return m_DisplayModeChanges; }
+    int GetDeviceResets() const { return m_DeviceResets; }
+    int GetExpensiveTransitions() const { return m_ExpensiveTransitions; }
+
+private:
+    // changed is true when the resolution or the desktop differs from the previous request.
+    FullscreenAction Transition(FullscreenStrategy from, FullscreenStrategy to, bool changed);
+    bool IsSameRequest(int width, int height, int desktopWidth, int desktopHeight) const;
+    void SetRenderRect(FullscreenAction &action, FullscreenStrategy strategy) const;
+
+    FullscreenMode m_Mode;
+    FullscreenStrategy m_Strategy;
+    bool m_Suspended;
+    bool m_DisplayModeChanged;
+    int m_Width;
+    int m_Height;
+    int m_DesktopWidth;
+    int m_DesktopHeight;
+    int m_DisplayModeChanges;
+    int m_DeviceResets;
+    int m_ExpensiveTransitions;
+};
+
+#endif // PLAYER_FULLSCREENPOLICY_H
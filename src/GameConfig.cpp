@@ -200,6 +200,7 @@ CGameConfig::CGameConfig()
 
     // Non-INI members
     screenMode = -1;
+    rebuildPluginCache = false;
 
     ResetPath();
     ResetFieldSnapshots();
@@ -221,6 +222,7 @@ CGameConfig &CGameConfig::operator=(const CGameConfig &config)
 
     // Non-INI members
     screenMode = config.screenMode;
+    rebuildPluginCache = config.rebuildPluginCache;
 
     // Copy paths
     int i;
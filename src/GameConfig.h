@@ -62,7 +62,21 @@ enum LogMode
   X_BOOL ("Game",     "UnlockWidescreen",        unlockWidescreen,        false,              "--unlock-widescreen",                   '\0', true) \
   X_BOOL ("Game",     "UnlockHighResolution",    unlockHighResolution,    false,              "--unlock-high-resolution",              '\0', true) \
   X_BOOL ("Game",     "Debug",                   debug,                   false,              "--debug",                               'd',  true) \
-  X_BOOL ("Game",     "Rookie",                  rookie,                  false,              "--rookie",                              'r',  true)
+  X_BOOL ("Game",     "Rookie",                  rookie,                  false,              "--rookie",                              'r',  true) \
+  X_BOOL ("Performance", "LatencyProbe",         latencyProbe,            false,              "--latency-probe",                       '\0', true) \
+  X_BOOL ("Performance", "PickCache",            pickCache,               false,              "--pick-cache",                          '\0', true) \
+  X_INT  ("Performance", "BackgroundMode",       backgroundMode,          0,                  "--background-mode",                     '\0') \
+  X_INT  ("Performance", "BackgroundFps",        backgroundFps,           10,                 "--background-fps",                      '\0') \
+  X_BOOL ("Performance", "LazyBuildingBlocks",   lazyBuildingBlocks,      false,              "--lazy-building-blocks",                '\0', true) \
+  X_BOOL ("Performance", "PrefetchPlugins",      prefetchPlugins,         false,              "--prefetch-plugins",                    '\0', true) \
+  X_BOOL ("Performance", "PreloadComposition",   preloadComposition,      false,              "--preload-composition",                 '\0', true) \
+  X_BOOL ("Performance", "MapComposition",       mapComposition,          false,              "--map-composition",                     '\0', true) \
+  X_INT  ("Performance", "ReloadCacheSize",      reloadCacheSize,         0,                  "--reload-cache-size",                   '\0') \
+  X_BOOL ("Performance", "PrefetchAssets",       prefetchAssets,          false,              "--prefetch-assets",                     '\0', true) \
+  X_BOOL ("Performance", "CacheHotfixPlan",      cacheHotfixPlan,         false,              "--hotfix-cache",                        '\0', true) \
+  X_BOOL ("Performance", "CacheRenderDrivers",   cacheRenderDrivers,      false,              "--driver-cache",                        '\0', true) \
+  X_BOOL ("Performance", "LoadDiagnostics",      loadDiagnostics,         false,              "--load-diagnostics",                    '\0', true) \
+  X_INT  ("Performance", "FullscreenMode",       fullscreenMode,          0,                  "--fullscreen-mode",                     '\0')
 
 #define GAMECONFIG_PATH_FIELDS \
   X_PATH(eConfigPath,          "Player.ini",        "--config",               false) \
@@ -91,6 +105,7 @@ public:
 
     // Non-INI members (not persisted)
     int screenMode;
+    bool rebuildPluginCache; // --rebuild-plugin-cache, for this start only
 
     CGameConfig();
     CGameConfig &operator=(const CGameConfig &config);
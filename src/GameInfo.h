@@ -7,22 +7,28 @@ class CGameInfo
 {
 public:
     CGameInfo()
-        : next(NULL),
-          hkRoot(0x80000001),
-          gameScore(0),
-          levelScore(0),
-          type(0),
-          gameID(0),
-          levelID(0),
-          gameBonus(0),
-          levelBonus(0),
-          levelReached(0)
     {
+        Reset();
+    }
+
+    // Back to the state of a new record, so one can be reused in place.
+    void Reset()
+    {
+        next = NULL;
         memset(gameName, 0, sizeof(gameName));
         memset(levelName, 0, sizeof(levelName));
         memset(fileName, 0, sizeof(fileName));
         memset(path, 0, sizeof(path));
         strcpy(regSubkey, "\"Software\\\\Ballance\\\\Settings\"");
+        hkRoot = 0x80000001;
+        gameScore = 0;
+        levelScore = 0;
+        type = 0;
+        gameID = 0;
+        levelID = 0;
+        gameBonus = 0;
+        levelBonus = 0;
+        levelReached = 0;
     }
 
     virtual ~CGameInfo() {}
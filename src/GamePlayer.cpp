@@ -10,12 +10,36 @@
 #include "Logger.h"
 #include "Utils.h"
 #include "InterfaceManager.h"
+#include "FileSystem.h"
+#include "MappedFile.h"
+#include "AssetIndex.h"
+#include "DisplayModeCatalog.h"
+#include "RenderDriverCache.h"
+#include "HotfixPlan.h"
+#include "CompositionPrefetch.h"
+#include "PluginDiscovery.h"
+#include "PluginManifest.h"
+#include "CmdlineParser.h"
+#include "PlayerOptions.h"
 
 #include "resource.h"
 
 #define ARRAY_NUM(Array) \
     (sizeof(Array) / sizeof(Array[0]))
 
+#ifndef WM_INPUT
+#define WM_INPUT 0x00FF
+#endif
+
+// Interval between two latency summaries in the log.
+#define LATENCY_REPORT_INTERVAL_US 10000000
+
+// Posted by the instance channel's thread when another launch forwarded its command line.
+#define WM_PLAYER_INSTANCE_MESSAGES (WM_APP + 1)
+
+// Posted for each composition a forwarded command line names, in order.
+#define WM_PLAYER_FORWARDED_LOAD (WM_APP + 2)
+
 #ifndef _WIN64
 #ifndef GetWindowLongPtr
 #define GetWindowLongPtr GetWindowLong
@@ -31,13 +55,137 @@
 #endif
 #endif
 
-extern bool EditScript(CKLevel *level, const CGameConfig &config, const char *resolvedFile);
+extern bool EditScript(CKLevel *level, const CGameConfig &config, const char *resolvedFile, CHotfixPlan *plan, platform::uint32 compositionKey,
+                       CLoadDiagnostics *diagnostics);
 
 static CKSTRING ToCKString(const char *value)
 {
     return const_cast<CKSTRING>(value);
 }
 
+static void GetDriverModes(VxDriverDesc *drDesc, std::vector<DisplayMode> &modes)
+{
+#if CKVERSION == 0x13022002
+    VxDisplayMode *dm = drDesc->DisplayModes;
+    const int dmCount = dm ? drDesc->DisplayModeCount : 0;
+#else
+    XArray<VxDisplayMode> &dm = drDesc->DisplayModes;
+    const int dmCount = dm.Size();
+#endif
+
+    modes.resize(dmCount);
+    for (int i = 0; i < dmCount; ++i)
+    {
+        modes[i].width = dm[i].Width;
+        modes[i].height = dm[i].Height;
+        modes[i].bpp = dm[i].Bpp;
+        modes[i].refreshRate = dm[i].RefreshRate;
+    }
+}
+
+// The drivers of the render manager, listed on the main thread for the driver
+// cache refresh, which compares and saves them on its worker thread.
+class CEngineDriverSource : public CRenderDriverSource
+{
+public:
+    CEngineDriverSource() {}
+
+    const CRenderDriverCache &GetDrivers() const { return m_Drivers; }
+
+    bool List(CKRenderManager *renderManager, const std::string &adapter, const std::string &driverVersion)
+    {
+        m_Drivers.Reset(adapter, driverVersion);
+
+        const int driverCount = renderManager->GetRenderDriverCount();
+        for (int i = 0; i < driverCount; ++i)
+        {
+            VxDriverDesc *drDesc = renderManager->GetRenderDriverDescription(i);
+            if (!drDesc)
+                return false;
+
+            CachedRenderDriver driver;
+#if CKVERSION == 0x13022002
+            driver.name = drDesc->DriverName;
+            driver.description = drDesc->DriverDesc;
+#else
+            driver.name = drDesc->DriverName.CStr();
+            driver.description = drDesc->DriverDesc.CStr();
+#endif
+            GetDriverModes(drDesc, driver.modes);
+            m_Drivers.AddDriver(driver);
+        }
+        return driverCount > 0;
+    }
+
+    virtual bool Enumerate(CRenderDriverCache &drivers)
+    {
+        for (int i = 0; i < m_Drivers.GetDriverCount(); ++i)
+            drivers.AddDriver(m_Drivers.GetDriver(i));
+        return m_Drivers.GetDriverCount() > 0;
+    }
+
+private:
+    CRenderDriverCache m_Drivers;
+};
+
+// The display modes of each render driver, built on first use or seeded from the
+// driver cache. Drivers do not change their modes while the context is open.
+static std::vector<CDisplayModeCatalog *> s_DisplayModeCatalogs;
+static CEngineDriverSource s_DriverSource;
+static CRenderDriverCacheRefresh s_DriverCacheRefresh;
+
+static void ClearDisplayModeCatalogs()
+{
+    for (size_t i = 0; i < s_DisplayModeCatalogs.size(); ++i)
+        delete s_DisplayModeCatalogs[i];
+    s_DisplayModeCatalogs.clear();
+}
+
+// Seeds only the drivers whose cached modes are the ones the engine lists, so
+// every mode index a catalog returns is valid for the render manager.
+static int SeedDisplayModeCatalogs(const CRenderDriverCache &cache, const CRenderDriverCache &listed)
+{
+    ClearDisplayModeCatalogs();
+    s_DisplayModeCatalogs.resize(listed.GetDriverCount(), NULL);
+
+    int seeded = 0;
+    for (int i = 0; i < listed.GetDriverCount(); ++i)
+    {
+        if (!cache.HasSameModes(listed, i))
+            continue;
+
+        const std::vector<DisplayMode> &modes = cache.GetDriver(i).modes;
+        CDisplayModeCatalog *catalog = new CDisplayModeCatalog;
+        catalog->Build(modes.empty() ? NULL : &modes[0], (int)modes.size());
+        s_DisplayModeCatalogs[i] = catalog;
+        ++seeded;
+    }
+    return seeded;
+}
+
+const CDisplayModeCatalog *GetDisplayModeCatalog(CKRenderManager *renderManager, int driver)
+{
+    if (!renderManager || driver < 0 || driver >= renderManager->GetRenderDriverCount())
+        return NULL;
+
+    if ((int)s_DisplayModeCatalogs.size() <= driver)
+        s_DisplayModeCatalogs.resize(driver + 1, NULL);
+    if (s_DisplayModeCatalogs[driver])
+        return s_DisplayModeCatalogs[driver];
+
+    VxDriverDesc *drDesc = renderManager->GetRenderDriverDescription(driver);
+    if (!drDesc)
+        return NULL;
+
+    std::vector<DisplayMode> modes;
+    GetDriverModes(drDesc, modes);
+
+    CDisplayModeCatalog *catalog = new CDisplayModeCatalog;
+    catalog->Build(modes.empty() ? NULL : &modes[0], (int)modes.size());
+    s_DisplayModeCatalogs[driver] = catalog;
+    return catalog;
+}
+
 static bool IsDefaultRenderEngineDll(const char *dllPath)
 {
     if (!dllPath || !*dllPath)
@@ -79,19 +227,199 @@ static bool GetExecutableDirectory(char *buffer, size_t size)
     return length > 0 && length < MAX_PATH && utils::GetFileDirectory(buffer, size, modulePath, true);
 }
 
-static bool ParsePluginsFromExecutableDirectory(CKPluginManager *pluginManager)
+// Everything the Load* functions share while the plugins are registered.
+struct PluginRegistration
 {
-    char path[MAX_PATH];
-    if (!pluginManager || !GetExecutableDirectory(path, sizeof(path)))
+    CPluginDiscovery discovery;
+    CPluginManifest cache;    // what the previous start recorded
+    CPluginManifest manifest; // what this start registered
+    CPluginLoadPlanner *planner; // set when building blocks load lazily
+    CLoadProgress *progress;     // counts the files gone through, may be NULL
+    int probed;
+    int skipped;
+    int deferred;
+
+    PluginRegistration()
+        : discovery(CFileSystem::GetNative()), planner(NULL), progress(NULL), probed(0), skipped(0), deferred(0) {}
+};
+
+PLATFORM_STATIC_ASSERT(PLUGIN_TYPE_BEHAVIOR_DLL == CKPLUGIN_BEHAVIOR_DLL, plugin_type_behavior_dll);
+
+static bool ExportsPluginInfo(const char *path)
+{
+    HMODULE module = ::LoadLibraryExA(path, NULL, DONT_RESOLVE_DLL_REFERENCES);
+    if (!module)
         return false;
+    bool exports = ::GetProcAddress(module, "CKGetPluginInfoCount") != NULL;
+    ::FreeLibrary(module);
+    return exports;
+}
+
+// Records what RegisterPlugin() made of the DLL. Returns false if the result should
+// not be cached.
+static bool DescribePluginDll(CKPluginManager *pluginManager, const FileEntry &file, bool registered,
+                              PluginManifestEntry &entry)
+{
+    entry.path = file.path;
+    entry.size = file.size;
+    entry.modifiedTime = file.modifiedTime;
+    entry.infoCount = 0;
+    entry.infos.clear();
+
+    // A plugin that failed to load (a missing dependency, say) may load next time.
+    if (!registered)
+        return !ExportsPluginInfo(file.path.c_str());
 
-    if (!utils::DirectoryExists(path))
+    int dllIndex = -1;
+    CKPluginDll *dll = pluginManager->GetPluginDllInfo(ToCKString(file.path.c_str()), &dllIndex);
+    if (!dll)
         return false;
 
-    pluginManager->ParsePlugins(ToCKString(path));
+    const int categoryCount = pluginManager->GetCategoryCount();
+    for (int category = 0; category < categoryCount; ++category)
+    {
+        const int count = pluginManager->GetPluginCount(category);
+        for (int i = 0; i < count; ++i)
+        {
+            CKPluginEntry *pluginEntry = pluginManager->GetPluginInfo(category, i);
+            if (!pluginEntry || pluginEntry->m_PluginDllIndex != dllIndex)
+                continue;
+
+            const CKPluginInfo &pluginInfo = pluginEntry->m_PluginInfo;
+            PluginManifestInfo info;
+            info.type = pluginInfo.m_Type;
+            info.flags = pluginInfo.m_InitInstanceFct ? PLUGIN_INFO_HAS_INIT_INSTANCE : 0;
+            info.guid.d1 = pluginInfo.m_GUID.d1;
+            info.guid.d2 = pluginInfo.m_GUID.d2;
+            entry.infos.push_back(info);
+
+            if (pluginEntry->m_BehaviorsInfo)
+            {
+                const XArray<CKGUID> &behaviors = pluginEntry->m_BehaviorsInfo->m_BehaviorsGUID;
+                for (int b = 0; b < behaviors.Size(); ++b)
+                {
+                    PluginGuid guid;
+                    guid.d1 = behaviors[b].d1;
+                    guid.d2 = behaviors[b].d2;
+                    entry.behaviors.push_back(guid);
+                }
+            }
+        }
+    }
+    entry.infoCount = (int)entry.infos.size();
+    return entry.infoCount == dll->m_PluginInfoCount;
+}
+
+// Whether RegisterPluginFiles() will load the DLL. The ones it skips or defers
+// are not worth reading ahead.
+static bool IsPluginFileLoadedAtStart(const FileEntry &file, void *arg)
+{
+    const PluginRegistration *registration = (const PluginRegistration *)arg;
+    const PluginManifestEntry *cached = registration->cache.FindCurrent(file);
+    if (!cached)
+        return true;
+    if (cached->infoCount == 0)
+        return false;
+    return !(registration->planner && IsDeferrablePlugin(*cached));
+}
+
+// Registers the DLLs of a scanned directory one by one. DLLs the manifest knows are
+// not plugins are skipped without being loaded. Returns the number of plugins registered.
+static int RegisterPluginFiles(CKPluginManager *pluginManager, PluginRegistration &registration,
+                               const PluginDirectoryScan &scan)
+{
+    int registered = 0;
+    size_t i;
+    for (i = 0; i < scan.files.size(); ++i)
+    {
+        const FileEntry &file = scan.files[i];
+        if (registration.progress)
+            registration.progress->Advance();
+        const PluginManifestEntry *cached = registration.cache.FindCurrent(file);
+        if (cached && cached->infoCount == 0)
+        {
+            registration.manifest.Set(*cached);
+            ++registration.skipped;
+            continue;
+        }
+        if (cached && registration.planner && IsDeferrablePlugin(*cached))
+        {
+            registration.manifest.Set(*cached);
+            registration.planner->Defer(file.path.c_str());
+            ++registration.deferred;
+            registered += cached->infoCount;
+            continue;
+        }
+
+        bool ok = pluginManager->RegisterPlugin(ToCKString(file.path.c_str())) == CK_OK;
+        if (!cached)
+            ++registration.probed;
+
+        PluginManifestEntry entry;
+        if (DescribePluginDll(pluginManager, file, ok, entry))
+            registration.manifest.Set(entry);
+        if (ok)
+            registered += entry.infoCount > 0 ? entry.infoCount : 1;
+    }
+
+    // Let the engine walk the directory itself if nothing registered file by file.
+    if (registered == 0 && !scan.files.empty())
+        registered = pluginManager->ParsePlugins(ToCKString(scan.directory.c_str()));
+    return registered;
+}
+
+// The number of files the categories will register, counting a shared directory once.
+static long CountPluginFiles(const CPluginDiscovery &discovery)
+{
+    long count = 0;
+    int category;
+    for (category = 0; category < ePluginCategoryCount; ++category)
+    {
+        const PluginDirectoryScan &scan = discovery.GetScan((PluginCategory)category);
+        bool shared = false;
+        int previous;
+        for (previous = 0; previous < category && !shared; ++previous)
+            shared = discovery.GetScan((PluginCategory)previous).directory == scan.directory;
+        if (!shared)
+            count += (long)scan.files.size();
+    }
+    return count;
+}
+
+static bool ParsePluginsFromExecutableDirectory(CKPluginManager *pluginManager, PluginRegistration &registration)
+{
+    if (!pluginManager)
+        return false;
+
+    const PluginDirectoryScan &scan = registration.discovery.GetExecutableScan();
+    if (!scan.exists)
+        return false;
+
+    // Every category may fall back here; registering the directory once is enough.
+    if (registration.discovery.ClaimDirectory(scan.directory.c_str()))
+        RegisterPluginFiles(pluginManager, registration, scan);
     return true;
 }
 
+static bool ParsePluginDirectory(CKPluginManager *pluginManager, PluginRegistration &registration, PluginCategory category)
+{
+    const PluginDirectoryScan &scan = registration.discovery.GetScan(category);
+
+    // A directory already registered by an earlier category counts as parsed.
+    if (!registration.discovery.ClaimDirectory(scan.directory.c_str()))
+        return true;
+    return RegisterPluginFiles(pluginManager, registration, scan) != 0;
+}
+
+// A cache file kept next to the config file.
+static std::string GetCachePath(const char *configPath, const char *name)
+{
+    std::string path = configPath ? configPath : "";
+    size_t separator = path.find_last_of("\\/");
+    path.erase(separator == std::string::npos ? 0 : separator + 1);
+    return path + name;
+}
+
 static bool AddPathIfMissing(CKPathManager *pathManager, int category, const char *path)
 {
     if (!pathManager || !path || !*path)
@@ -150,6 +478,119 @@ static bool SetCompositionEnvironment(const char *resolvedFile)
     return ::SetEnvironmentVariableA("Gravity", compositionDir) != 0;
 }
 
+static void MapComposition(const char *resolvedFile, CMappedFile &mapping)
+{
+    // CK2 may patch the buffer while reading, so it gets private pages.
+    if (!mapping.Open(resolvedFile, CMappedFile::eMapCopyOnWrite))
+    {
+        CLogger::Get().Warn("Failed to map %s, reading it from disk.", resolvedFile);
+        return;
+    }
+
+    // OpenMemory() takes an int size.
+    if (mapping.GetSize() > 0x7FFFFFFF)
+    {
+        CLogger::Get().Warn("%s is too large to load from memory, reading it from disk.", resolvedFile);
+        mapping.Close();
+        return;
+    }
+
+    CLogger::Get().Debug("Mapped %s (%u KB).", resolvedFile, (unsigned int)(mapping.GetSize() / 1024));
+}
+
+// The composition file contents, when it is opened from memory.
+struct CompositionImage
+{
+    void *data;
+    int size;
+};
+
+// Opens the composition from memory when there is an image, from the path otherwise.
+static CKERROR OpenComposition(CKFile *file, XString &resolvedFile, const CompositionImage &image)
+{
+    const CK_LOAD_FLAGS flags = (CK_LOAD_FLAGS)(CK_LOAD_DEFAULT | CK_LOAD_CHECKDEPENDENCIES);
+    if (image.data)
+        return file->OpenMemory(image.data, image.size, flags);
+    return file->OpenFile(resolvedFile.Str(), flags);
+}
+
+// Resolves the textures and sounds the opened composition references against its
+// asset directories and starts reading the files while LoadFileData() runs.
+static void StartAssetPrefetch(CKFile *file, const char *resolvedFile, const CGameConfig &config, CCompositionPrefetcher &prefetcher)
+{
+    CAssetIndex index(CFileSystem::GetNative());
+
+    // The directories RegisterCompositionPaths() adds, then the configured ones.
+    const std::string compositionDirectory = filesystem::GetDirectory(resolvedFile);
+    index.AddDirectory(compositionDirectory.c_str());
+    index.AddDirectory(filesystem::JoinPath(compositionDirectory, "Textures").c_str());
+    index.AddDirectory(filesystem::JoinPath(compositionDirectory, "Sounds").c_str());
+    index.AddDirectory(filesystem::JoinPath(compositionDirectory, "Sounds_low").c_str());
+    index.AddDirectory(filesystem::JoinPath(compositionDirectory, "3D Entities").c_str());
+    index.AddDirectory(config.GetPath(eBitmapPath));
+    index.AddDirectory(config.GetPath(eSoundPath));
+    index.AddDirectory(config.GetPath(eDataPath));
+
+    // Texture and sound objects are usually named after their file.
+    CAssetPrefetchPlanner planner;
+    const int count = file->m_FileObjects.Size();
+    int i;
+    for (i = 0; i < count; ++i)
+    {
+        const CKFileObject &object = file->m_FileObjects[i];
+        if (!object.Name)
+            continue;
+        if (CKIsChildClassOf(object.ObjectCid, CKCID_TEXTURE) || CKIsChildClassOf(object.ObjectCid, CKCID_SOUND))
+            planner.Add(index, object.Name);
+    }
+
+    const std::vector<std::string> &paths = planner.GetPaths();
+    if (paths.empty())
+        return;
+
+    size_t j;
+    for (j = 0; j < paths.size(); ++j)
+        prefetcher.AddFile(paths[j].c_str());
+    if (!prefetcher.Start(platform::GetProcessorCount()))
+    {
+        CLogger::Get().Warn("Failed to start asset prefetch.");
+        return;
+    }
+
+    CLogger::Get().Debug("Prefetching %d assets (%u KB) from %d indexed files, %d unresolved.",
+                         (int)paths.size(), (unsigned int)(planner.GetBytes() / 1024),
+                         index.GetFileCount(), (int)planner.GetUnresolved().size());
+}
+
+static void ReleaseCompositionImage(void *payload, void *)
+{
+    delete[] (char *)payload;
+}
+
+static unsigned int ComputeCRC(const void *data, platform::uint64 size)
+{
+    unsigned int crc = 0;
+    utils::CRC32(data, (size_t)size, 0, &crc);
+    return crc;
+}
+
+static void OnInstanceChannelMessages(void *userData)
+{
+    ::PostMessage((HWND)userData, WM_PLAYER_INSTANCE_MESSAGES, 0, 0);
+}
+
+// Keys a file by its size and modification time, so nothing has to be read.
+static bool ComputeFileKey(const char *filename, unsigned int &key)
+{
+    FileEntry entry;
+    if (!CFileSystem::GetNative().GetFileEntry(filename, entry))
+        return false;
+
+    const platform::uint64 stamp[2] = {entry.size, entry.modifiedTime};
+    utils::CRC32(stamp, sizeof(stamp), 0, &key);
+    return true;
+}
+
 CGamePlayer::CGamePlayer()
     : m_State(eInitial),
       m_hInstance(NULL),
@@ -165,7 +606,15 @@ CGamePlayer::CGamePlayer()
       m_InputManager(NULL),
       m_MsgClick(-1),
       m_MsgDoubleClick(-1),
-      m_GameInfo(NULL) {}
+      m_LatencyReportTime(0),
+      m_BackgroundPaused(false),
+      m_DeferredPluginIdleLoad(false),
+      m_LoadProgress(NULL),
+      m_InstanceChannel(NULL),
+      m_BatchResult(NULL)
+{
+    m_CompositionCache.SetReleaseFunction(ReleaseCompositionImage, NULL);
+}
 
 CGamePlayer::~CGamePlayer()
 {
@@ -228,17 +677,55 @@ bool CGamePlayer::Init(const CGameConfig &runtimeConfig, const CGameConfig &pers
 
     CLogger::Get().Debug("Render Context created.");
 
+    m_BackgroundPolicy.Configure(m_Config.backgroundMode, m_Config.backgroundFps);
+    m_FullscreenPolicy.Configure(m_Config.fullscreenMode);
+
+    if (m_Config.reloadCacheSize > 0)
+        m_CompositionCache.SetBudget((platform::uint64)m_Config.reloadCacheSize * 1024 * 1024);
+
     if (m_Config.fullscreen)
         OnGoFullscreen(false);
 
-    ::ShowWindow(m_MainWindow, SW_SHOW);
-    ::SetFocus(m_MainWindow);
+    if (!m_BatchResult)
+    {
+        ::ShowWindow(m_MainWindow, SW_SHOW);
+        ::SetFocus(m_MainWindow);
+    }
+
+    if (m_InstanceChannel)
+    {
+        m_InstanceChannel->SetCallback(OnInstanceChannelMessages, m_MainWindow);
+        // Whatever arrived while the window did not exist yet.
+        ::PostMessage(m_MainWindow, WM_PLAYER_INSTANCE_MESSAGES, 0, 0);
+    }
 
     m_State = eReady;
     return true;
 }
 
 bool CGamePlayer::Load(const char *filename)
+{
+    // Batch workers run side by side; none of them owns the diagnostics file.
+    if (!m_Config.loadDiagnostics || m_BatchResult)
+        return LoadComposition(filename);
+
+    if (m_DiagnosticsFile.GetFilename().empty())
+    {
+        const std::string path = GetCachePath(m_Config.GetPath(eConfigPath), "LoadDiagnostics.ndjson");
+        m_DiagnosticsFile.SetFilename(path.c_str());
+        m_LoadDiagnostics.SetSink(&m_DiagnosticsFile);
+    }
+
+    m_LoadDiagnostics.BeginLoad(filename && *filename ? filename : m_Config.GetPath(eCmoPath));
+    const bool loaded = LoadComposition(filename);
+    if (!m_LoadDiagnostics.EndLoad(loaded))
+        CLogger::Get().Warn("Failed to write load diagnostics: %s", m_DiagnosticsFile.GetFilename().c_str());
+    if (m_LoadDiagnostics.GetDroppedCount() != 0)
+        CLogger::Get().Warn("Load diagnostics dropped %lu events.", m_LoadDiagnostics.GetDroppedCount());
+    return loaded;
+}
+
+bool CGamePlayer::LoadComposition(const char *filename)
 {
     if (m_State == eInitial)
     {
@@ -271,6 +758,7 @@ bool CGamePlayer::Load(const char *filename)
 
     XString resolvedFile = filename;
     CKERROR err = pm->ResolveFileName(resolvedFile, DATA_PATH_IDX);
+    m_LoadDiagnostics.PathResolved(filename, err == CK_OK ? resolvedFile.CStr() : NULL);
     if (err != CK_OK)
     {
         CLogger::Get().Error("Failed to resolve filename %s", filename);
@@ -284,7 +772,41 @@ bool CGamePlayer::Load(const char *filename)
     m_CKContext->Reset();
     m_CKContext->ClearAll();
 
+    // Declared before the CKFile: a file opened from memory reads from it until it
+    // is deleted. A cached image is pinned until the next load.
+    const AssetCacheEntry *cached = NULL;
+    if (m_CompositionCache.GetBudget() > 0)
+        cached = CacheComposition(resolvedFile.CStr());
+
+    CMappedFile mapping;
+    if (!cached && m_Config.mapComposition)
+        MapComposition(resolvedFile.CStr(), mapping);
+
+    // CK2 may patch the buffer while reading, so each load gets a private copy and
+    // the cached image stays as it was read from disk.
+    std::vector<char> cachedCopy;
+    CompositionImage image = {NULL, 0};
+    if (cached)
+    {
+        cachedCopy.assign((const char *)cached->payload, (const char *)cached->payload + cached->size);
+        image.data = &cachedCopy[0];
+        image.size = (int)cachedCopy.size();
+    }
+    else if (mapping.IsOpen())
+    {
+        image.data = mapping.GetData();
+        image.size = (int)mapping.GetSize();
+    }
+
+    long compositionSize = image.size;
+    FileEntry entry;
+    if (!image.data && CFileSystem::GetNative().GetFileEntry(resolvedFile.CStr(), entry))
+        compositionSize = (long)entry.size;
+    if (m_LoadProgress)
+        m_LoadProgress->SetStage(eLoadComposition, compositionSize);
+
     // Load the file and fills the array with loaded objects
+    platform::uint64 phaseStart = platform::GetTimeMicros();
     CKFile *f = m_CKContext->CreateCKFile();
     if (!f)
     {
@@ -292,7 +814,39 @@ bool CGamePlayer::Load(const char *filename)
         return false;
     }
 
-    CKERROR res = f->OpenFile(resolvedFile.Str(), (CK_LOAD_FLAGS)(CK_LOAD_DEFAULT | CK_LOAD_CHECKDEPENDENCIES));
+    CKERROR res = OpenComposition(f, resolvedFile, image);
+    if (res != CK_OK && res != CKERR_PLUGINSMISSING && image.data)
+    {
+        CLogger::Get().Warn("Failed to open the composition from memory, reading it from disk.");
+        m_CKContext->DeleteCKFile(f);
+        if (cached)
+            m_CompositionCache.Remove(resolvedFile.CStr());
+        cached = NULL;
+        std::vector<char>().swap(cachedCopy);
+        mapping.Close();
+        image.data = NULL;
+        image.size = 0;
+        f = m_CKContext->CreateCKFile();
+        if (!f)
+        {
+            CLogger::Get().Error("Failed to create CKFile!");
+            return false;
+        }
+        res = OpenComposition(f, resolvedFile, image);
+    }
+    while (res == CKERR_PLUGINSMISSING && LoadDeferredPlugins(f))
+    {
+        // Open again now that the building blocks it depends on are registered.
+        m_CKContext->DeleteCKFile(f);
+        f = m_CKContext->CreateCKFile();
+        if (!f)
+        {
+            CLogger::Get().Error("Failed to create CKFile!");
+            return false;
+        }
+        res = OpenComposition(f, resolvedFile, image);
+    }
+    m_LoadDiagnostics.Phase(image.data ? "open_memory" : "open", platform::GetTimeMicros() - phaseStart, compositionSize);
     if (res != CK_OK)
     {
         // something failed
@@ -304,8 +858,11 @@ bool CGamePlayer::Load(const char *filename)
         m_CKContext->DeleteCKFile(f);
 
         CLogger::Get().Error("Failed to open file: %s", resolvedFile.CStr());
+        m_LoadDiagnostics.Error(res == CKERR_PLUGINSMISSING ? "Plugins missing" : "Failed to open file");
         return false;
     }
+    if (m_LoadProgress)
+        m_LoadProgress->SetDone(compositionSize);
 
     CKObjectArray *array = CreateCKObjectArray();
     if (!array)
@@ -315,10 +872,19 @@ bool CGamePlayer::Load(const char *filename)
         return false;
     }
 
+    // Joined when Load() returns; a read in progress still completes.
+    CCompositionPrefetcher assetPrefetcher(CFileSystem::GetNative());
+    if (m_Config.prefetchAssets)
+        StartAssetPrefetch(f, resolvedFile.CStr(), m_Config, assetPrefetcher);
+
+    phaseStart = platform::GetTimeMicros();
     res = f->LoadFileData(array);
+    assetPrefetcher.Cancel();
+    m_LoadDiagnostics.Phase("load_data", platform::GetTimeMicros() - phaseStart, 0);
     if (res != CK_OK)
     {
         CLogger::Get().Error("Failed to load file: %s", resolvedFile.CStr());
+        m_LoadDiagnostics.Error("Failed to load file");
         m_CKContext->DeleteCKFile(f);
         DeleteCKObjectArray(array);
         return false;
@@ -327,7 +893,10 @@ bool CGamePlayer::Load(const char *filename)
     m_CKContext->DeleteCKFile(f);
     DeleteCKObjectArray(array);
 
-    return FinishLoad(filename, resolvedFile.CStr());
+    phaseStart = platform::GetTimeMicros();
+    const bool finished = FinishLoad(filename, resolvedFile.CStr());
+    m_LoadDiagnostics.Phase("finish", platform::GetTimeMicros() - phaseStart, 0);
+    return finished;
 }
 
 void CGamePlayer::Run()
@@ -352,18 +921,56 @@ bool CGamePlayer::Update()
     }
     else
     {
+        if (m_ConfigFlush.IsDirty())
+            FlushPersistentConfig(false);
+
         float beforeRender = 0.0f;
         float beforeProcess = 0.0f;
         m_TimeManager->GetTimeToWaitForLimits(beforeRender, beforeProcess);
-        if (beforeProcess <= 0)
+
+        BackgroundAction action = m_BackgroundPolicy.Decide(platform::GetTimeMicros(), beforeProcess <= 0, beforeRender <= 0);
+        if (action.wait != eBackgroundNoWait)
+        {
+            DWORD waitMs = (action.wait == eBackgroundWaitMessage) ? INFINITE : action.waitMs;
+            if (m_ConfigFlush.IsDirty())
+            {
+                // Wake up in time for the pending config flush.
+                const DWORD flushMs = (DWORD)((m_ConfigFlush.GetWaitTime(platform::GetTimeMicros()) + 999) / 1000);
+                if (flushMs < waitMs)
+                    waitMs = flushMs;
+            }
+            if (waitMs == INFINITE)
+                ::WaitMessage();
+            else
+                ::MsgWaitForMultipleObjects(0, NULL, FALSE, waitMs, QS_ALLINPUT);
+            return true;
+        }
+
+        if (action.process)
         {
             m_TimeManager->ResetChronos(FALSE, TRUE);
             Process();
         }
-        if (beforeRender <= 0)
+        if (action.render)
         {
             m_TimeManager->ResetChronos(TRUE, FALSE);
             Render();
+            if (m_Config.latencyProbe)
+                CompleteFrameLatency(platform::GetTimeMicros());
+
+            // Levels loaded at run time by the scripts never go through Load(), so the
+            // rest of the building blocks follow one at a time: in the limiter slack
+            // below, or after the frame when the last one had none.
+            if (!m_DeferredPluginIdleLoad && HasDeferredPlugins())
+                LoadRemainingPlugins(1);
+            m_DeferredPluginIdleLoad = false;
+        }
+
+        // Nothing is due before the next frame.
+        if (!action.process && !action.render && HasDeferredPlugins())
+        {
+            LoadRemainingPlugins(1);
+            m_DeferredPluginIdleLoad = true;
         }
     }
 
@@ -372,24 +979,37 @@ bool CGamePlayer::Update()
 
 void CGamePlayer::Process()
 {
+    if (m_Config.latencyProbe)
+        m_LatencyProbe.OnProcess(platform::GetTimeMicros());
     m_CKContext->Process();
 }
 
 void CGamePlayer::Render()
 {
+    // Read before drawing, which may clear the moved flags of the entities.
+    if (m_Config.pickCache)
+        TrackPickChanges();
+
     m_RenderContext->Render();
+
+    // The splash goes away once the game has something on screen.
+    if (m_LoadProgress && m_LoadProgress->GetStage() == eLoadFirstFrame)
+        m_LoadProgress->Finish();
 }
 
 void CGamePlayer::Shutdown()
 {
-    if (m_State != eInitial && !m_PersistentConfig.SaveToIni())
-        CLogger::Get().Error("Failed to save config: %s", m_PersistentConfig.GetPath(eConfigPath));
+    // Nothing may post to the window once it is gone.
+    if (m_InstanceChannel)
+        m_InstanceChannel->SetCallback(NULL, NULL);
 
-    if (m_GameInfo)
-    {
-        delete m_GameInfo;
-        m_GameInfo = NULL;
-    }
+    if (m_Config.latencyProbe && m_State != eInitial)
+        ReportInputLatency();
+
+    if (m_State != eInitial)
+        FlushPersistentConfig(true);
+
+    m_GameSession.End();
 
     ShutdownEngine();
     ShutdownWindow();
@@ -425,6 +1045,18 @@ void CGamePlayer::Reset()
 
 static CKERROR LogRedirect(CKUICallbackStruct &cbStruct, void *userData)
 {
+    if (cbStruct.Reason == CKUIM_LOADSAVEPROGRESS)
+    {
+        // The engine reports every object it creates while loading a file.
+        CLoadProgress *progress = (CLoadProgress *)userData;
+        if (progress)
+        {
+            progress->SetStage(eLoadObjects, cbStruct.NbObjetsToLoad);
+            progress->SetDone(cbStruct.NbObjetsLoaded);
+        }
+        return CK_OK;
+    }
+
     if (cbStruct.Reason == CKUIM_OUTTOCONSOLE ||
         cbStruct.Reason == CKUIM_OUTTOINFOBAR ||
         cbStruct.Reason == CKUIM_DEBUGMESSAGESEND)
@@ -534,7 +1166,7 @@ bool CGamePlayer::InitWindow(HINSTANCE hInstance)
 
 void CGamePlayer::ShutdownWindow()
 {
-    if (m_Config.fullscreen)
+    if (m_FullscreenPolicy.HasChangedDisplayMode())
         RestoreDisplayMode();
 
     if (m_hAccelTable)
@@ -557,6 +1189,9 @@ void CGamePlayer::ShutdownWindow()
 
 bool CGamePlayer::InitEngine(HWND mainWindow)
 {
+    if (m_LoadProgress)
+        m_LoadProgress->SetStage(eLoadEngine);
+
     if (CKStartUp() != CK_OK)
     {
         CLogger::Get().Error("CK Engine can not start up!");
@@ -597,7 +1232,7 @@ bool CGamePlayer::InitEngine(HWND mainWindow)
     CLogger::Get().Debug("CK Engine initialized.");
 
     m_CKContext->SetVirtoolsVersion(CK_VIRTOOLS_DEV, 0x2000043);
-    m_CKContext->SetInterfaceMode(FALSE, LogRedirect, 0);
+    m_CKContext->SetInterfaceMode(FALSE, LogRedirect, m_LoadProgress);
 
     if (!SetupManagers())
     {
@@ -620,6 +1255,8 @@ void CGamePlayer::ShutdownEngine()
 {
     if (m_CKContext)
     {
+        s_DriverCacheRefresh.Wait();
+
         m_CKContext->Reset();
         m_CKContext->ClearAll();
 
@@ -632,6 +1269,7 @@ void CGamePlayer::ShutdownEngine()
         CKCloseContext(m_CKContext);
         m_CKContext = NULL;
 
+        ClearDisplayModeCatalogs();
         m_RenderManager = NULL;
         m_MessageManager = NULL;
         m_TimeManager = NULL;
@@ -660,12 +1298,15 @@ bool CGamePlayer::InitDriver()
         CLogger::Get().Debug("Found %d render drivers", driverCount);
     }
 
+    LoadDriverCache();
+
     if (m_Config.manualSetup)
     {
         if (OpenSetupDialog())
             SyncPersistentDisplayConfig();
         m_Config.manualSetup = false;
         m_PersistentConfig.manualSetup = false;
+        MarkPersistentConfigDirty(ePersistManualSetup);
     }
 
     bool tryFailed = false;
@@ -745,16 +1386,10 @@ bool CGamePlayer::FinishLoad(const char *filename, const char *resolvedFile)
         im->SetRookie(m_Config.rookie);
         im->SetTaskSwitchEnabled(true);
 
-        if (m_GameInfo)
-        {
-            delete m_GameInfo;
-            m_GameInfo = NULL;
-        }
-
-        m_GameInfo = new CGameInfo;
-        strcpy(m_GameInfo->path, ".");
-        strcpy(m_GameInfo->fileName, filename);
-        im->SetGameInfo(m_GameInfo);
+        // Restarts reuse the pooled records instead of allocating a new one.
+        CGameInfo *gameInfo = m_GameSession.Start(filename, ".");
+        if (gameInfo)
+            im->SetGameInfo(gameInfo);
     }
 
     // Retrieve the level
@@ -762,6 +1397,7 @@ bool CGamePlayer::FinishLoad(const char *filename, const char *resolvedFile)
     if (!level)
     {
         CLogger::Get().Error("Failed to retrieve the level!");
+        m_LoadDiagnostics.Error("Failed to retrieve the level");
         return false;
     }
 
@@ -786,10 +1422,27 @@ bool CGamePlayer::FinishLoad(const char *filename, const char *resolvedFile)
 
     if (m_Config.applyHotfix && m_CKContext->GetManagerByGuid(TT_INTERFACE_MANAGER_GUID) != NULL)
     {
-        if (!EditScript(level, m_Config, resolvedFile))
+        CHotfixPlan plan;
+        CHotfixPlan *hotfixPlan = NULL;
+        unsigned int key = 0;
+        const std::string planPath = GetCachePath(m_Config.GetPath(eConfigPath), "HotfixCache.txt");
+        if (m_Config.cacheHotfixPlan && ComputeFileKey(resolvedFile, key))
+        {
+            plan.Load(planPath.c_str());
+            hotfixPlan = &plan;
+        }
+
+        const bool edited = EditScript(level, m_Config, resolvedFile, hotfixPlan, key, &m_LoadDiagnostics);
+        if (!edited)
         {
             CLogger::Get().Warn("Failed to apply hotfixes on script!");
         }
+        if (m_BatchResult)
+            m_BatchResult->hotfix = edited ? eBatchHotfixApplied : eBatchHotfixError;
+
+        // Batch workers read the cache but leave writing it to the game.
+        if (hotfixPlan && plan.IsModified() && !m_BatchResult && !plan.Save(planPath.c_str()))
+            CLogger::Get().Warn("Failed to save hotfix cache: %s", planPath.c_str());
 
         CLogger::Get().Debug("Hotfixes applied on script.");
     }
@@ -803,12 +1456,153 @@ bool CGamePlayer::FinishLoad(const char *filename, const char *resolvedFile)
 
     // Render the first frame
     m_RenderContext->Render();
+    m_PickTracker.Invalidate();
 
     return true;
 }
 
+bool CGamePlayer::HasDeferredPlugins() const
+{
+#ifdef BALLANCE_STATIC_MODULES
+    return GetDeferredStaticPluginCount() > 0;
+#else
+    return m_PluginPlanner.GetDeferredCount() > 0;
+#endif
+}
+
+bool CGamePlayer::LoadDeferredPlugins(CKFile *file)
+{
+    if (!file || !HasDeferredPlugins())
+        return false;
+
+#ifdef BALLANCE_STATIC_MODULES
+    CKPluginManager *pluginManager = CKGetPluginManager();
+    int registered = RegisterStaticPluginsFor(pluginManager, file);
+    // The GUID table only lists plugin GUIDs; for anything else, register the rest.
+    if (registered == 0)
+        registered = RegisterRemainingStaticPlugins(pluginManager);
+
+    CLogger::Get().Debug("Registered %d deferred static modules, %d still deferred.",
+                         registered, GetDeferredStaticPluginCount());
+    return registered > 0;
+#else
+    std::vector<PluginGuid> required;
+    const XClassArray<CKFilePluginDependencies> *p = file->GetMissingPlugins();
+    for (CKFilePluginDependencies *it = p->Begin(); it != p->End(); it++)
+    {
+        const int count = it->m_Guids.Size();
+        for (int i = 0; i < count; i++)
+        {
+            PluginGuid guid;
+            guid.d1 = it->m_Guids[i].d1;
+            guid.d2 = it->m_Guids[i].d2;
+            required.push_back(guid);
+        }
+    }
+
+    std::vector<std::string> dlls;
+    std::vector<PluginGuid> unresolved;
+    if (m_PluginPlanner.Plan(m_PluginIndex, required, dlls, unresolved) == 0)
+        return false;
+
+    CKPluginManager *pluginManager = CKGetPluginManager();
+    int loaded = 0;
+    size_t i;
+    for (i = 0; i < dlls.size(); ++i)
+    {
+        // Planned DLLs leave the deferred set even if they fail, so the caller's retry loop ends.
+        m_PluginPlanner.MarkLoaded(dlls[i].c_str());
+        if (pluginManager->RegisterPlugin(ToCKString(dlls[i].c_str())) == CK_OK)
+            ++loaded;
+        else
+            CLogger::Get().Warn("Failed to register deferred plugin: %s", dlls[i].c_str());
+    }
+
+    CLogger::Get().Debug("Registered %d deferred building block DLLs, %d still deferred.",
+                         loaded, m_PluginPlanner.GetDeferredCount());
+    return true;
+#endif
+}
+
+void CGamePlayer::LoadRemainingPlugins(int maxCount)
+{
+#ifdef BALLANCE_STATIC_MODULES
+    const int registered = RegisterRemainingStaticPlugins(CKGetPluginManager(), maxCount);
+    CLogger::Get().Debug("Registered %d deferred static modules, %d still deferred.",
+                         registered, GetDeferredStaticPluginCount());
+#else
+    std::vector<std::string> dlls;
+    m_PluginPlanner.GetDeferred(dlls);
+    if (maxCount >= 0 && dlls.size() > (size_t)maxCount)
+        dlls.resize(maxCount);
+
+    CKPluginManager *pluginManager = CKGetPluginManager();
+    int loaded = 0;
+    size_t i;
+    for (i = 0; i < dlls.size(); ++i)
+    {
+        m_PluginPlanner.MarkLoaded(dlls[i].c_str());
+        if (pluginManager->RegisterPlugin(ToCKString(dlls[i].c_str())) == CK_OK)
+            ++loaded;
+        else
+            CLogger::Get().Warn("Failed to register deferred plugin: %s", dlls[i].c_str());
+    }
+
+    CLogger::Get().Debug("Registered %d deferred building block DLLs, %d still deferred.",
+                         loaded, m_PluginPlanner.GetDeferredCount());
+#endif
+}
+
+const AssetCacheEntry *CGamePlayer::CacheComposition(const char *resolvedFile)
+{
+    m_CompositionCache.BeginLoad();
+
+    FileEntry info;
+    if (!CFileSystem::GetNative().GetFileEntry(resolvedFile, info) || info.size == 0 || info.size > 0x7FFFFFFF)
+        return NULL;
+
+    // A file with the size and modification time of the cached image is served
+    // from memory without reading it again. LoadComposition() opens a copy of the
+    // image, so no load sees what an earlier one left in the buffer, and drops an
+    // image that fails to load before the file is read from disk.
+    const AssetCacheEntry *entry = m_CompositionCache.Peek(resolvedFile);
+    if (entry && entry->version == info.modifiedTime && entry->size == info.size)
+    {
+        CLogger::Get().Debug("Composition cache hit: %s", resolvedFile);
+        return m_CompositionCache.Find(resolvedFile, entry->crc);
+    }
+
+    FILE *fp = fopen(resolvedFile, "rb");
+    if (!fp)
+        return NULL;
+
+    char *data = new char[(size_t)info.size];
+    size_t read = fread(data, 1, (size_t)info.size, fp);
+    fclose(fp);
+    if (read != (size_t)info.size)
+    {
+        delete[] data;
+        return NULL;
+    }
+
+    const unsigned int crc = ComputeCRC(data, info.size);
+    if (!m_CompositionCache.Insert(resolvedFile, crc, info.modifiedTime, data, info.size))
+    {
+        CLogger::Get().Debug("Composition %s does not fit in the reload cache.", resolvedFile);
+        delete[] data;
+        return NULL;
+    }
+
+    CLogger::Get().Debug("Composition cache stored %s (%u KB, %u KB in use).", resolvedFile,
+                         (unsigned int)(info.size / 1024), (unsigned int)(m_CompositionCache.GetTotalBytes() / 1024));
+    return m_CompositionCache.Peek(resolvedFile);
+}
+
 void CGamePlayer::ReportMissingGuids(CKFile *file, const char *resolvedFile)
 {
+    // d1 and d2 of each missing GUID, for the load diagnostics
+    std::vector<platform::uint32> guids;
+
     // retrieve the list of missing plugins/guids
     const XClassArray<CKFilePluginDependencies> *p = file->GetMissingPlugins();
     for (CKFilePluginDependencies *it = p->Begin(); it != p->End(); it++)
@@ -821,9 +1615,20 @@ void CGamePlayer::ReportMissingGuids(CKFile *file, const char *resolvedFile)
                 if (resolvedFile)
                     CLogger::Get().Error("File Name : %s\nMissing GUIDS:\n", resolvedFile);
                 CLogger::Get().Error("%x,%x\n", it->m_Guids[i].d1, it->m_Guids[i].d2);
+                guids.push_back(it->m_Guids[i].d1);
+                guids.push_back(it->m_Guids[i].d2);
+                if (m_BatchResult)
+                {
+                    char guid[32];
+                    sprintf(guid, "%x,%x", it->m_Guids[i].d1, it->m_Guids[i].d2);
+                    m_BatchResult->missingGuids.push_back(guid);
+                }
             }
         }
     }
+
+    if (!guids.empty())
+        m_LoadDiagnostics.MissingGuids(&guids[0], guids.size() / 2);
 }
 
 bool CGamePlayer::InitPlugins(CKPluginManager *pluginManager)
@@ -832,51 +1637,96 @@ bool CGamePlayer::InitPlugins(CKPluginManager *pluginManager)
         return false;
 
 #ifdef BALLANCE_STATIC_MODULES
-    if (!RegisterStaticPlugins(pluginManager))
+    if (!RegisterStaticPlugins(pluginManager, m_Config.lazyBuildingBlocks))
     {
         CLogger::Get().Error("Failed to register static plugins.");
         return false;
     }
 
-    CLogger::Get().Debug("Static plugins registered.");
+    CLogger::Get().Debug("Static plugins registered, %d deferred.", GetDeferredStaticPluginCount());
     return true;
 #else
-    if (!LoadRenderEngines(pluginManager))
+    PluginRegistration registration;
+    CPluginDiscovery &discovery = registration.discovery;
+    discovery.SetDirectory(ePluginRenderEngines, m_Config.GetPath(eRenderEnginePath));
+    discovery.SetDirectory(ePluginManagers, m_Config.GetPath(eManagerPath));
+    discovery.SetDirectory(ePluginBuildingBlocks, m_Config.GetPath(eBuildingBlockPath));
+    discovery.SetDirectory(ePluginPlugins, m_Config.GetPath(ePluginPath));
+
+    char executableDir[MAX_PATH];
+    if (GetExecutableDirectory(executableDir, sizeof(executableDir)))
+        discovery.SetExecutableDirectory(executableDir);
+
+    m_PluginPlanner.Clear();
+    if (m_Config.lazyBuildingBlocks)
+        registration.planner = &m_PluginPlanner;
+
+    const std::string manifestPath = GetCachePath(m_Config.GetPath(eConfigPath), "PluginCache.txt");
+    if (m_Config.rebuildPluginCache)
+        CLogger::Get().Debug("Rebuilding plugin cache.");
+    else if (!registration.cache.Load(manifestPath.c_str()))
+        CLogger::Get().Debug("Plugin cache is missing or outdated, probing every plugin.");
+
+    // The file system work runs in parallel; registration below stays serial and in order.
+    discovery.SetPrefetchFilter(IsPluginFileLoadedAtStart, &registration);
+    discovery.Discover(platform::GetProcessorCount(), m_Config.prefetchPlugins);
+    if (m_Config.prefetchPlugins)
+        CLogger::Get().Debug("Plugin discovery prefetched %d files (%u KB).",
+                             discovery.GetPrefetchedFiles(), (unsigned int)(discovery.GetPrefetchedBytes() / 1024));
+
+    registration.progress = m_LoadProgress;
+    if (m_LoadProgress)
+        m_LoadProgress->SetStage(eLoadPlugins, CountPluginFiles(discovery));
+
+    if (!LoadRenderEngines(pluginManager, registration))
     {
         CLogger::Get().Error("Failed to load render engine!");
         return false;
     }
 
-    if (!LoadManagers(pluginManager))
+    if (!LoadManagers(pluginManager, registration))
     {
         CLogger::Get().Error("Failed to load managers!");
         return false;
     }
 
-    if (!LoadBuildingBlocks(pluginManager))
+    if (!LoadBuildingBlocks(pluginManager, registration))
     {
         CLogger::Get().Error("Failed to load building blocks!");
         return false;
     }
 
-    if (!LoadPlugins(pluginManager))
+    if (!LoadPlugins(pluginManager, registration))
     {
         CLogger::Get().Error("Failed to load plugins!");
         return false;
     }
 
+    CLogger::Get().Debug("Plugin cache: %d DLLs probed, %d skipped, %d deferred.",
+                         registration.probed, registration.skipped, registration.deferred);
+    if (registration.planner)
+        m_PluginIndex.Build(registration.manifest);
+
+    // Concurrent batch workers would race on the file, so only the game writes it.
+    if (!m_BatchResult && (registration.probed > 0 || m_Config.rebuildPluginCache ||
+        registration.manifest.GetEntryCount() != registration.cache.GetEntryCount()))
+    {
+        if (!registration.manifest.Save(manifestPath.c_str()))
+            CLogger::Get().Warn("Failed to write plugin cache: %s", manifestPath.c_str());
+    }
+
     return true;
 #endif
 }
 
-bool CGamePlayer::LoadRenderEngines(CKPluginManager *pluginManager)
+bool CGamePlayer::LoadRenderEngines(CKPluginManager *pluginManager, PluginRegistration &registration)
 {
     if (!pluginManager)
         return false;
 
-    const char *path = m_Config.GetPath(eRenderEnginePath);
-    if ((!utils::DirectoryExists(path) || pluginManager->ParsePlugins(ToCKString(path)) == 0) &&
-        !ParsePluginsFromExecutableDirectory(pluginManager))
+    if ((!registration.discovery.GetScan(ePluginRenderEngines).exists ||
+         !ParsePluginDirectory(pluginManager, registration, ePluginRenderEngines)) &&
+        !ParsePluginsFromExecutableDirectory(pluginManager, registration))
     {
         CLogger::Get().Error("Render engine parse error.");
         return false;
@@ -887,15 +1737,15 @@ bool CGamePlayer::LoadRenderEngines(CKPluginManager *pluginManager)
     return true;
 }
 
-bool CGamePlayer::LoadManagers(CKPluginManager *pluginManager)
+bool CGamePlayer::LoadManagers(CKPluginManager *pluginManager, PluginRegistration &registration)
 {
     if (!pluginManager)
         return false;
 
     const char *path = m_Config.GetPath(eManagerPath);
-    if (!utils::DirectoryExists(path))
+    if (!registration.discovery.GetScan(ePluginManagers).exists)
     {
-        if (!ParsePluginsFromExecutableDirectory(pluginManager))
+        if (!ParsePluginsFromExecutableDirectory(pluginManager, registration))
         {
             CLogger::Get().Error("Managers directory does not exist!");
             return false;
@@ -906,7 +1756,7 @@ bool CGamePlayer::LoadManagers(CKPluginManager *pluginManager)
 
     CLogger::Get().Debug("Loading managers from %s", path);
 
-    if (pluginManager->ParsePlugins(ToCKString(path)) == 0)
+    if (!ParsePluginDirectory(pluginManager, registration, ePluginManagers))
     {
         CLogger::Get().Error("Managers parse error.");
         return false;
@@ -917,15 +1767,15 @@ bool CGamePlayer::LoadManagers(CKPluginManager *pluginManager)
     return true;
 }
 
-bool CGamePlayer::LoadBuildingBlocks(CKPluginManager *pluginManager)
+bool CGamePlayer::LoadBuildingBlocks(CKPluginManager *pluginManager, PluginRegistration &registration)
 {
     if (!pluginManager)
         return false;
 
     const char *path = m_Config.GetPath(eBuildingBlockPath);
-    if (!utils::DirectoryExists(path))
+    if (!registration.discovery.GetScan(ePluginBuildingBlocks).exists)
     {
-        if (!ParsePluginsFromExecutableDirectory(pluginManager))
+        if (!ParsePluginsFromExecutableDirectory(pluginManager, registration))
         {
             CLogger::Get().Error("BuildingBlocks directory does not exist!");
             return false;
@@ -936,7 +1786,7 @@ bool CGamePlayer::LoadBuildingBlocks(CKPluginManager *pluginManager)
 
     CLogger::Get().Debug("Loading building blocks from %s", path);
 
-    if (pluginManager->ParsePlugins(ToCKString(path)) == 0)
+    if (!ParsePluginDirectory(pluginManager, registration, ePluginBuildingBlocks))
     {
         CLogger::Get().Error("Behaviors parse error.");
         return false;
@@ -947,15 +1797,15 @@ bool CGamePlayer::LoadBuildingBlocks(CKPluginManager *pluginManager)
     return true;
 }
 
-bool CGamePlayer::LoadPlugins(CKPluginManager *pluginManager)
+bool CGamePlayer::LoadPlugins(CKPluginManager *pluginManager, PluginRegistration &registration)
 {
     if (!pluginManager)
         return false;
 
     const char *path = m_Config.GetPath(ePluginPath);
-    if (!utils::DirectoryExists(path))
+    if (!registration.discovery.GetScan(ePluginPlugins).exists)
     {
-        if (!ParsePluginsFromExecutableDirectory(pluginManager))
+        if (!ParsePluginsFromExecutableDirectory(pluginManager, registration))
         {
             CLogger::Get().Error("Plugins directory does not exist!");
             return false;
@@ -966,7 +1816,7 @@ bool CGamePlayer::LoadPlugins(CKPluginManager *pluginManager)
 
     CLogger::Get().Debug("Loading plugins from %s", path);
 
-    if (pluginManager->ParsePlugins(ToCKString(path)) == 0)
+    if (!ParsePluginDirectory(pluginManager, registration, ePluginPlugins))
     {
         CLogger::Get().Error("Plugins parse error.");
         return false;
@@ -1116,6 +1966,50 @@ bool CGamePlayer::SetupPaths()
     return true;
 }
 
+void CGamePlayer::StampInputLatency(UINT uMsg)
+{
+    switch (uMsg)
+    {
+    case WM_INPUT:
+        m_LatencyProbe.RecordInput(eLatencyRawInput, platform::GetTimeMicros());
+        break;
+    case WM_KEYDOWN:
+        m_LatencyProbe.RecordInput(eLatencyKey, platform::GetTimeMicros());
+        break;
+    case WM_LBUTTONDOWN:
+        m_LatencyProbe.RecordInput(eLatencyMouseButton, platform::GetTimeMicros());
+        break;
+    default:
+        break;
+    }
+}
+
+void CGamePlayer::CompleteFrameLatency(platform::uint64 presentTime)
+{
+    m_LatencyProbe.OnRender(presentTime);
+
+    if (m_LatencyReportTime == 0)
+        m_LatencyReportTime = presentTime;
+    else if (presentTime - m_LatencyReportTime >= LATENCY_REPORT_INTERVAL_US)
+    {
+        ReportInputLatency();
+        m_LatencyReportTime = presentTime;
+    }
+}
+
+void CGamePlayer::ReportInputLatency()
+{
+    char summary[256];
+    int kind;
+    for (kind = 0; kind < eLatencyEventKindCount; ++kind)
+    {
+        if (m_LatencyProbe.FormatSummary((LatencyEventKind)kind, summary, sizeof(summary)))
+            CLogger::Get().Info("%s", summary);
+    }
+    if (m_LatencyProbe.GetDroppedCount() != 0)
+        CLogger::Get().Warn("Latency probe dropped %lu input events.", m_LatencyProbe.GetDroppedCount());
+}
+
 void CGamePlayer::ResizeWindow()
 {
     RECT rc = {0, 0, m_Config.width, m_Config.height};
@@ -1126,62 +2020,63 @@ void CGamePlayer::ResizeWindow()
         ::SetWindowPos(m_RenderWindow, NULL, 0, 0, m_Config.width, m_Config.height, SWP_NOMOVE | SWP_NOZORDER);
 }
 
-int CGamePlayer::FindScreenMode(int width, int height, int bpp, int driver)
+void CGamePlayer::LoadDriverCache()
 {
-    if (!m_RenderManager)
+    if (!m_Config.cacheRenderDrivers)
+        return;
+
+    char adapter[512];
+    char driverVersion[64];
+    if (!utils::GetDisplayAdapterIdentity(adapter, sizeof(adapter), driverVersion, sizeof(driverVersion)))
     {
-        CLogger::Get().Error("RenderManager is not initialized");
-        return -1;
+        CLogger::Get().Debug("Unable to identify the display adapter, not using the driver cache.");
+        return;
     }
 
-    VxDriverDesc *drDesc = m_RenderManager->GetRenderDriverDescription(driver);
-    if (!drDesc)
+    if (!s_DriverSource.List(m_RenderManager, adapter, driverVersion))
     {
-        CLogger::Get().Error("Unable to find render driver %d.", driver);
-        return false;
+        CLogger::Get().Debug("Unable to list the render drivers, not using the driver cache.");
+        return;
     }
 
-#if CKVERSION == 0x13022002
-    VxDisplayMode *dm = drDesc->DisplayModes;
-    const int dmCount = drDesc->DisplayModeCount;
-#else
-    XArray<VxDisplayMode> &dm = drDesc->DisplayModes;
-    const int dmCount = dm.Size();
-#endif
-
-    bool found = false;
-    int refreshRate = 0;
-    for (int i = 0; i < dmCount; ++i)
+    const std::string cachePath = GetCachePath(m_Config.GetPath(eConfigPath), "DriverCache.txt");
+    CRenderDriverCache cache;
+    if (cache.Load(cachePath.c_str()) && cache.Matches(adapter, driverVersion))
     {
-        if (dm[i].Width == width &&
-            dm[i].Height == height &&
-            dm[i].Bpp == bpp)
-        {
-            found = true;
-            if (dm[i].RefreshRate > refreshRate)
-                refreshRate = dm[i].RefreshRate;
-        }
+        const int seeded = SeedDisplayModeCatalogs(cache, s_DriverSource.GetDrivers());
+        CLogger::Get().Debug("Using cached display modes of %d of %d drivers on %s (driver %s).",
+                             seeded, s_DriverSource.GetDrivers().GetDriverCount(), adapter, driverVersion);
+    }
+    else
+    {
+        cache.Reset(adapter, driverVersion);
+        CLogger::Get().Debug("Driver cache is missing or outdated.");
     }
 
-    if (!found)
+    // The listed drivers are compared with the cache on a worker thread, which
+    // rewrites the file when they differ, except in a batch worker. It does not
+    // touch the render manager.
+    s_DriverCacheRefresh.Start(s_DriverSource, cache, m_BatchResult ? "" : cachePath.c_str());
+}
+
+int CGamePlayer::FindScreenMode(int width, int height, int bpp, int driver)
+{
+    if (!m_RenderManager)
     {
-        CLogger::Get().Error("No matching screen mode found for %d x %d x %d", width, height, bpp);
+        CLogger::Get().Error("RenderManager is not initialized");
         return -1;
     }
 
-    int screenMode = -1;
-    for (int j = 0; j < dmCount; ++j)
+    const CDisplayModeCatalog *catalog = GetDisplayModeCatalog(m_RenderManager, driver);
+    if (!catalog)
     {
-        if (dm[j].Width == width &&
-            dm[j].Height == height &&
-            dm[j].Bpp == bpp &&
-            dm[j].RefreshRate == refreshRate)
-        {
-            screenMode = j;
-            break;
-        }
+        CLogger::Get().Error("Unable to find render driver %d.", driver);
+        return -1;
     }
 
+    const int screenMode = catalog->FindMode(width, height, bpp);
+    if (screenMode == -1)
+        CLogger::Get().Error("No matching screen mode found for %d x %d x %d", width, height, bpp);
     return screenMode;
 }
 
@@ -1222,14 +2117,49 @@ void CGamePlayer::SyncPersistentDisplayConfig()
     m_PersistentConfig.width = m_Config.width;
     m_PersistentConfig.height = m_Config.height;
     m_PersistentConfig.bpp = m_Config.bpp;
+    MarkPersistentConfigDirty(ePersistDisplayMode);
 }
 
 void CGamePlayer::SyncPersistentWindowPosition()
 {
+    // Window moves are only marked while they happen, so read where the window ended up.
+    if (!m_Config.fullscreen && m_MainWindow)
+    {
+        RECT rect;
+        if (::GetWindowRect(m_MainWindow, &rect))
+        {
+            m_Config.posX = rect.left;
+            m_Config.posY = rect.top;
+        }
+    }
+
     m_PersistentConfig.posX = m_Config.posX;
     m_PersistentConfig.posY = m_Config.posY;
 }
 
+void CGamePlayer::MarkPersistentConfigDirty(unsigned int fields)
+{
+    m_ConfigFlush.MarkDirty(fields, platform::GetTimeMicros());
+}
+
+void CGamePlayer::FlushPersistentConfig(bool shutdown)
+{
+    // Batch workers run side by side; none of them owns the config file.
+    if (m_BatchResult)
+        return;
+
+    // Called from the main loop between messages, never from a message handler.
+    const unsigned int fields = shutdown ? m_ConfigFlush.TakeAll() : m_ConfigFlush.Poll(platform::GetTimeMicros());
+    if (fields == 0 && !shutdown)
+        return;
+
+    if (fields & ePersistWindowPosition)
+        SyncPersistentWindowPosition();
+
+    if (!m_PersistentConfig.SaveToIni())
+        CLogger::Get().Error("Failed to save config: %s", m_PersistentConfig.GetPath(eConfigPath));
+}
+
 bool CGamePlayer::IsRenderFullscreen() const
 {
     if (!m_RenderContext)
@@ -1352,6 +2282,55 @@ void CGamePlayer::SetWindowedWindowStyle()
         ::SetWindowPos(m_RenderWindow, NULL, 0, 0, m_Config.width, m_Config.height, SWP_NOZORDER);
 }
 
+void CGamePlayer::GetDesktopSize(int &width, int &height)
+{
+    // While the player holds another mode, the desktop is the one in the registry.
+    if (m_FullscreenPolicy.HasChangedDisplayMode())
+    {
+        DEVMODEA dm;
+        memset(&dm, 0, sizeof(dm));
+        dm.dmSize = sizeof(dm);
+        if (::EnumDisplaySettingsA(NULL, ENUM_REGISTRY_SETTINGS, &dm))
+        {
+            width = static_cast<int>(dm.dmPelsWidth);
+            height = static_cast<int>(dm.dmPelsHeight);
+            return;
+        }
+    }
+
+    RECT monitorRect;
+    utils::GetMonitorRectForWindow(m_MainWindow, monitorRect);
+    width = monitorRect.right - monitorRect.left;
+    height = monitorRect.bottom - monitorRect.top;
+}
+
+bool CGamePlayer::ApplyFullscreenAction(const FullscreenAction &action)
+{
+    if (action.leaveExclusive && !StopFullscreen())
+        return false;
+    if (action.restoreDisplayMode)
+        RestoreDisplayMode();
+    if (action.restoreWindow)
+        SetWindowedWindowStyle();
+    if (action.changeDisplayMode)
+        SetFullscreenDisplayMode();
+    if (action.popupWindow)
+        SetFullscreenWindowStyle();
+
+    if (action.enterExclusive && !GoFullscreen())
+    {
+        ApplyFullscreenAction(m_FullscreenPolicy.EnterFailed());
+        m_Config.fullscreen = false;
+        return false;
+    }
+
+    if (action.resizeRenderTarget && m_RenderContext)
+        m_RenderContext->Resize(action.renderX, action.renderY, action.renderWidth, action.renderHeight);
+
+    m_Config.fullscreen = m_FullscreenPolicy.IsFullscreen();
+    return true;
+}
+
 bool CGamePlayer::ClipCursor()
 {
     if (!m_Config.clipCursor)
@@ -1386,6 +2365,10 @@ bool CGamePlayer::ReleaseCursorClip()
 
 bool CGamePlayer::OpenSetupDialog()
 {
+    // Nobody is there to answer it; the driver defaults are used instead.
+    if (m_BatchResult)
+        return false;
+
     return ::DialogBoxParam(m_hInstance, MAKEINTRESOURCE(IDD_FULLSCREEN_SETUP), NULL, CGamePlayer::FullscreenSetupDlgProc, reinterpret_cast<LPARAM>(this)) == IDOK;
 }
 
@@ -1402,15 +2385,19 @@ void CGamePlayer::OnDestroy()
 
 void CGamePlayer::OnMove()
 {
-    if (!m_Config.fullscreen)
+    if (m_Config.fullscreen)
+        return;
+
+    if (m_State != eInitial)
     {
-        RECT rect;
-        ::GetWindowRect(m_MainWindow, &rect);
-        m_Config.posX = rect.left;
-        m_Config.posY = rect.top;
-        if (m_State != eInitial)
-            SyncPersistentWindowPosition();
+        MarkPersistentConfigDirty(ePersistWindowPosition);
+        return;
     }
+
+    RECT rect;
+    ::GetWindowRect(m_MainWindow, &rect);
+    m_Config.posX = rect.left;
+    m_Config.posY = rect.top;
 }
 
 void CGamePlayer::OnSize()
@@ -1431,9 +2418,6 @@ void CGamePlayer::OnClose()
 
 void CGamePlayer::OnActivateApp(bool active)
 {
-    static bool wasFullscreen = false;
-    static bool firstDeActivate = true;
-
     if (m_State == eInitial)
         return;
 
@@ -1446,32 +2430,52 @@ void CGamePlayer::OnActivateApp(bool active)
 
             ReleaseCursorClip();
 
-            if (IsRenderFullscreen())
-            {
-                if (firstDeActivate)
-                    wasFullscreen = true;
-                OnStopFullscreen(false);
-            }
-            else if (firstDeActivate)
+            // Only an exclusive device has to give the screen back.
+            const FullscreenAction action = m_FullscreenPolicy.Deactivate();
+            if (!action.IsEmpty())
             {
-                wasFullscreen = false;
+                Pause();
+                ApplyFullscreenAction(action);
+                Play();
             }
         }
-        firstDeActivate = false;
         m_State = eFocusLost;
+        m_BackgroundPolicy.SetActive(false);
+
+        // Stop the game clock too, or the first frame back would make up for the whole pause.
+        if (m_CKContext && m_BackgroundPolicy.GetMode() == eBackgroundPause && m_CKContext->IsPlaying())
+        {
+            m_CKContext->Pause();
+            m_BackgroundPaused = true;
+        }
     }
     else
     {
-        if (wasFullscreen && !firstDeActivate)
-            OnGoFullscreen(false);
+        const FullscreenAction action = m_FullscreenPolicy.Activate();
+        if (!action.IsEmpty())
+        {
+            Pause();
+            if (ApplyFullscreenAction(action))
+            {
+                ::ShowWindow(m_MainWindow, SW_SHOW);
+                ::SetFocus(m_MainWindow);
+            }
+            Play();
+        }
 
         ClipCursor();
 
         if (!m_Config.alwaysHandleInput)
             m_InputManager->Pause(FALSE);
 
-        firstDeActivate = true;
+        if (m_BackgroundPaused)
+        {
+            m_CKContext->Play();
+            m_BackgroundPaused = false;
+        }
+
         m_State = ePlaying;
+        m_BackgroundPolicy.SetActive(true);
     }
 }
 
@@ -1525,6 +2529,10 @@ void CGamePlayer::OnClick(bool dblClk)
 
     CKMessageType msgType = (!dblClk) ? m_MsgClick : m_MsgDoubleClick;
 
+    // Nothing to send when the click is on nothing.
+    if (m_Config.pickCache && IsClickOnNothing(pt))
+        return;
+
 #if CKVERSION == 0x13022002
     CKPOINT ckpt = {(int)pt.x, (int)pt.y};
     CKPICKRESULT res;
@@ -1547,6 +2555,152 @@ void CGamePlayer::OnClick(bool dblClk)
 #endif
 }
 
+// A key of what places the entities on screen: the viewpoint, its projection
+// and the size of the render context.
+platform::uint32 CGamePlayer::GetPickViewKey()
+{
+    unsigned int key = 0;
+    const int size[2] = {m_RenderContext->GetWidth(), m_RenderContext->GetHeight()};
+    utils::CRC32(size, sizeof(size), key, &key);
+
+    CK3dEntity *viewpoint = m_RenderContext->GetViewpoint();
+    if (!viewpoint)
+        return key;
+
+    const VxMatrix &world = viewpoint->GetWorldMatrix();
+    utils::CRC32(&world, sizeof(VxMatrix), key, &key);
+    if (CKIsChildClassOf(viewpoint, CKCID_CAMERA))
+    {
+        CKCamera *camera = (CKCamera *)viewpoint;
+        const float projection[3] = {camera->GetFov(), camera->GetOrthographicZoom(), (float)camera->GetProjectionType()};
+        utils::CRC32(projection, sizeof(projection), key, &key);
+    }
+    return key;
+}
+
+// The set of pickable objects, as their count and the sum of their IDs.
+static platform::uint32 GetPickSceneKey(const XObjectPointerArray &sprites, const XObjectPointerArray &entities)
+{
+    platform::uint32 key = (platform::uint32)(sprites.Size() + entities.Size()) * 0x9E3779B9u;
+    int i;
+    for (i = 0; i < sprites.Size(); ++i)
+        key += sprites[i] ? (platform::uint32)sprites[i]->GetID() : 0;
+    for (i = 0; i < entities.Size(); ++i)
+        key += entities[i] ? (platform::uint32)entities[i]->GetID() * 31u : 0;
+    return key;
+}
+
+static void UpdatePickSprite(CPickGrid &grid, CK2dEntity *sprite)
+{
+    VxRect rect;
+    sprite->GetRect(rect);
+    PickRect pickRect = {rect.left, rect.top, rect.right, rect.bottom};
+    // Unpickable sprites are still hit by the engine pick, see OnClick().
+    grid.Update(sprite->GetID(), ePickSprite, pickRect, sprite->GetZOrder(), sprite->IsVisible() != FALSE);
+}
+
+// Render extents are only those of the last frame for the entities it drew, so
+// the ones outside the view are left out rather than kept where they were.
+static void UpdatePickEntity(CPickGrid &grid, CKRenderContext *renderContext, CK3dEntity *entity)
+{
+    PickRect pickRect = {0, 0, 0, 0};
+    const bool drawn = entity->IsVisible() && entity->IsInViewFrustrum(renderContext);
+    if (drawn)
+    {
+        VxRect rect;
+        entity->GetRenderExtents(rect);
+        pickRect.left = rect.left;
+        pickRect.top = rect.top;
+        pickRect.right = rect.right;
+        pickRect.bottom = rect.bottom;
+    }
+    grid.Update(entity->GetID(), ePickEntity, pickRect, 0, drawn);
+}
+
+void CGamePlayer::TrackPickChanges()
+{
+    // A moving view moves everything, so the next click reads the whole scene
+    // and nothing is gained by looking at the entities one by one.
+    if (!m_PickTracker.BeginFrame(GetPickViewKey()))
+        return;
+
+    const XObjectPointerArray sprites = m_CKContext->GetObjectListByType(CKCID_2DENTITY, TRUE);
+    const XObjectPointerArray entities = m_CKContext->GetObjectListByType(CKCID_3DENTITY, TRUE);
+    for (int i = 0; i < entities.Size(); ++i)
+    {
+        CK3dEntity *entity = (CK3dEntity *)entities[i];
+        if (!entity)
+            continue;
+        const bool shown = entity->IsVisible() != FALSE;
+        if (m_PickTracker.SetShown(entity->GetID(), shown) || (entity->GetMoveableFlags() & VX_MOVEABLE_HASMOVED))
+            m_PickTracker.MarkMoved(entity->GetID());
+    }
+    m_PickTracker.EndFrame(GetPickSceneKey(sprites, entities));
+}
+
+void CGamePlayer::RefreshPickGrid()
+{
+    const int width = m_RenderContext->GetWidth();
+    const int height = m_RenderContext->GetHeight();
+    if (width != m_PickGrid.GetWidth() || height != m_PickGrid.GetHeight())
+    {
+        m_PickGrid.Reset(width, height);
+        m_PickTracker.Invalidate();
+    }
+
+    int i;
+    const XObjectPointerArray sprites = m_CKContext->GetObjectListByType(CKCID_2DENTITY, TRUE);
+    if (!m_PickTracker.NeedsFullRefresh())
+    {
+        // Sprites are few and carry no moved flag, so they are always read.
+        for (i = 0; i < sprites.Size(); ++i)
+        {
+            if (sprites[i])
+                UpdatePickSprite(m_PickGrid, (CK2dEntity *)sprites[i]);
+        }
+
+        const std::vector<platform::uint32> &moved = m_PickTracker.GetMoved();
+        for (size_t j = 0; j < moved.size(); ++j)
+        {
+            CKObject *obj = m_CKContext->GetObject((CK_ID)moved[j]);
+            if (obj && CKIsChildClassOf(obj, CKCID_3DENTITY))
+                UpdatePickEntity(m_PickGrid, m_RenderContext, (CK3dEntity *)obj);
+            else
+                m_PickGrid.Remove(moved[j]);
+        }
+        m_PickTracker.ClearMoved();
+        return;
+    }
+
+    const XObjectPointerArray entities = m_CKContext->GetObjectListByType(CKCID_3DENTITY, TRUE);
+    m_PickGrid.BeginRefresh();
+    for (i = 0; i < sprites.Size(); ++i)
+    {
+        if (sprites[i])
+            UpdatePickSprite(m_PickGrid, (CK2dEntity *)sprites[i]);
+    }
+    for (i = 0; i < entities.Size(); ++i)
+    {
+        CK3dEntity *entity = (CK3dEntity *)entities[i];
+        if (!entity)
+            continue;
+        UpdatePickEntity(m_PickGrid, m_RenderContext, entity);
+        m_PickTracker.SetShown(entity->GetID(), entity->IsVisible() != FALSE);
+    }
+    m_PickGrid.EndRefresh();
+
+    m_PickTracker.Reset(GetPickViewKey(), GetPickSceneKey(sprites, entities));
+}
+
+bool CGamePlayer::IsClickOnNothing(const POINT &pt)
+{
+    RefreshPickGrid();
+
+    // Any candidate goes through the engine pick, which decides between the
+    // object and the sprite under the cursor.
+    return m_PickGrid.Query((float)pt.x, (float)pt.y, NULL, 0) == 0;
+}
+
 int CGamePlayer::OnCommand(UINT id, UINT code)
 {
     if (id == IDM_APP_ABOUT)
@@ -1564,8 +2718,8 @@ void CGamePlayer::OnExceptionCMO()
 
 void CGamePlayer::OnReturn()
 {
-    XString filename = m_GameInfo->fileName;
-    if (!Load(filename.CStr()))
+    const char *filename = m_GameSession.GetFileName();
+    if (!filename || !Load(filename))
     {
         OnClose();
         return;
@@ -1579,6 +2733,60 @@ bool CGamePlayer::OnLoadCMO(const char *filename)
     return Load(filename);
 }
 
+void CGamePlayer::OnInstanceMessages()
+{
+    std::vector<InstanceMessage> messages;
+    if (!m_InstanceChannel || m_InstanceChannel->TakeMessages(messages) == 0)
+        return;
+
+    size_t i;
+    for (i = 0; i < messages.size(); ++i)
+    {
+        if (messages[i].type == eInstanceCommandLine)
+            ApplyForwardedCommandLine(messages[i].payload.c_str());
+    }
+}
+
+void CGamePlayer::ApplyForwardedCommandLine(const char *cmdline)
+{
+    CLogger::Get().Debug("Command line forwarded by another launch: %s", cmdline);
+
+    // Start from the running config without a composition, so only a composition
+    // the launch names is loaded.
+    CGameConfig config = m_Config;
+    config.SetPath(eCmoPath, "");
+    CmdlineParser parser(cmdline);
+    playeroptions::ApplyRuntimeOptions(config, parser);
+
+    if (::IsIconic(m_MainWindow))
+        ::ShowWindow(m_MainWindow, SW_RESTORE);
+    ::SetForegroundWindow(m_MainWindow);
+
+    if (config.fullscreen && !m_Config.fullscreen)
+        OnGoFullscreen();
+    else if (!config.fullscreen && m_Config.fullscreen)
+        OnStopFullscreen();
+
+    if (config.HasPath(eCmoPath))
+    {
+        // Loaded from the message loop like a script switching levels, then
+        // straight into play. The queue owns the names until then.
+        m_ForwardedCompositions.push_back(config.GetPath(eCmoPath));
+        ::PostMessage(m_MainWindow, WM_PLAYER_FORWARDED_LOAD, 0, 0);
+    }
+}
+
+void CGamePlayer::OnForwardedLoad()
+{
+    if (m_ForwardedCompositions.empty())
+        return;
+
+    const std::string filename = m_ForwardedCompositions.front();
+    m_ForwardedCompositions.pop_front();
+    if (Load(filename.c_str()))
+        Play();
+}
+
 void CGamePlayer::OnExitToSystem()
 {
     bool fullscreen = m_Config.fullscreen;
@@ -1600,11 +2808,11 @@ int CGamePlayer::OnChangeScreenMode(int driver, int screenMode)
         return 0;
     }
 
-    bool fullscreen = m_Config.fullscreen;
+    const bool fullscreen = m_FullscreenPolicy.IsFullscreen();
     if (fullscreen)
-        OnStopFullscreen(false);
-
-    ClipCursor();
+        Pause();
+    else
+        ClipCursor();
 
     m_Config.driver = driver;
     m_Config.screenMode = screenMode;
@@ -1620,11 +2828,22 @@ int CGamePlayer::OnChangeScreenMode(int driver, int screenMode)
         im->SetScreenMode(m_Config.screenMode);
     }
 
-    ResizeWindow();
-    m_RenderContext->Resize();
+    int desktopWidth, desktopHeight;
+    GetDesktopSize(desktopWidth, desktopHeight);
+    const FullscreenAction action = m_FullscreenPolicy.Resize(width, height, desktopWidth, desktopHeight);
 
     if (fullscreen)
-        OnGoFullscreen(false);
+    {
+        // The borderless strategies only move the render target; exclusive
+        // fullscreen switches to the new mode.
+        ApplyFullscreenAction(action);
+        Play();
+    }
+    else
+    {
+        ResizeWindow();
+        m_RenderContext->Resize();
+    }
 
     return 1;
 }
@@ -1635,14 +2854,21 @@ void CGamePlayer::OnGoFullscreen(bool persistChange)
 
     ReleaseCursorClip();
 
-    m_Config.fullscreen = true;
-    SetFullscreenDisplayMode();
-    SetFullscreenWindowStyle();
+    // The windowed position has to be known before the window covers the screen.
+    if (m_ConfigFlush.GetDirtyFields() & ePersistWindowPosition)
+        SyncPersistentWindowPosition();
+
+    int desktopWidth, desktopHeight;
+    GetDesktopSize(desktopWidth, desktopHeight);
+    const FullscreenAction action = m_FullscreenPolicy.Enter(m_Config.width, m_Config.height, desktopWidth, desktopHeight);
 
-    if (GoFullscreen())
+    if (ApplyFullscreenAction(action) && m_FullscreenPolicy.IsFullscreen())
     {
         if (persistChange)
+        {
             m_PersistentConfig.fullscreen = true;
+            MarkPersistentConfigDirty(ePersistFullscreen);
+        }
 
         ::ShowWindow(m_MainWindow, SW_SHOW);
         ::SetFocus(m_MainWindow);
@@ -1657,11 +2883,6 @@ void CGamePlayer::OnGoFullscreen(bool persistChange)
         if (m_Config.childWindowRendering)
             ::UpdateWindow(m_RenderWindow);
     }
-    else
-    {
-        RestoreDisplayMode();
-        SetWindowedWindowStyle();
-    }
 
     Play();
 }
@@ -1670,16 +2891,12 @@ void CGamePlayer::OnStopFullscreen(bool persistChange)
 {
     Pause();
 
-    bool fullscreen = m_Config.fullscreen || IsRenderFullscreen();
-    if (StopFullscreen())
+    if (ApplyFullscreenAction(m_FullscreenPolicy.Leave()))
     {
         if (persistChange)
-            m_PersistentConfig.fullscreen = false;
-
-        if (fullscreen)
         {
-            RestoreDisplayMode();
-            SetWindowedWindowStyle();
+            m_PersistentConfig.fullscreen = false;
+            MarkPersistentConfigDirty(ePersistFullscreen);
         }
 
         ::ShowWindow(m_MainWindow, SW_SHOW);
@@ -1705,7 +2922,7 @@ void CGamePlayer::OnSwitchFullscreen()
     if (m_State == eInitial)
         return;
 
-    if (!IsRenderFullscreen())
+    if (!m_FullscreenPolicy.IsFullscreen())
         OnGoFullscreen(true);
     else
         OnStopFullscreen(true);
@@ -1713,6 +2930,9 @@ void CGamePlayer::OnSwitchFullscreen()
 
 LRESULT CGamePlayer::HandleMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
+    if (m_Config.latencyProbe)
+        StampInputLatency(uMsg);
+
     switch (uMsg)
     {
     case WM_DESTROY:
@@ -1773,6 +2993,14 @@ LRESULT CGamePlayer::HandleMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM l
         OnLoadCMO((const char *)wParam);
         break;
 
+    case WM_PLAYER_INSTANCE_MESSAGES:
+        OnInstanceMessages();
+        break;
+
+    case WM_PLAYER_FORWARDED_LOAD:
+        OnForwardedLoad();
+        break;
+
     case TT_MSG_EXIT_TO_SYS:
         OnExitToSystem();
         break;
@@ -1826,47 +3054,26 @@ bool CGamePlayer::FillScreenModeList(HWND hWnd, int driver)
 {
     char buffer[256];
 
-    VxDriverDesc *drDesc = m_RenderManager->GetRenderDriverDescription(driver);
-    if (!drDesc)
-        return false;
-
-#if CKVERSION == 0x13022002
-    VxDisplayMode *dm = drDesc->DisplayModes;
-    if (!dm)
-        return false;
-
-    const int dmCount = drDesc->DisplayModeCount;
-    if (dmCount == 0)
-        return false;
-#else
-    XArray<VxDisplayMode> &dm = drDesc->DisplayModes;
-    if (dm.Size() == 0)
+    const CDisplayModeCatalog *catalog = GetDisplayModeCatalog(m_RenderManager, driver);
+    if (!catalog || catalog->GetModeCount() == 0)
         return false;
 
-    const int dmCount = dm.Size();
-    if (dmCount == 0)
-        return false;
-#endif
+    DisplayModeFilter filter;
+    filter.minBpp = 9;
+    std::vector<int> modes;
+    catalog->SelectModes(filter, modes);
 
-    int i = 0;
-    while (i < dmCount)
+    for (size_t i = 0; i < modes.size(); ++i)
     {
-        int width = dm[i].Width;
-        int height = dm[i].Height;
-        while (i < dmCount && dm[i].Width == width && dm[i].Height == height)
+        const int mode = modes[i];
+        const DisplayMode &dm = catalog->GetMode(mode);
+        sprintf(buffer, "%d x %d x %d x %dHz", dm.width, dm.height, dm.bpp, dm.refreshRate);
+        int index = static_cast<int>(::SendDlgItemMessage(hWnd, IDC_LB_SCREEN_MODE, LB_ADDSTRING, 0, (LPARAM)buffer));
+        ::SendDlgItemMessage(hWnd, IDC_LB_SCREEN_MODE, LB_SETITEMDATA, index, mode);
+        if (mode == m_Config.screenMode)
         {
-            if (dm[i].Bpp > 8)
-            {
-                sprintf(buffer, "%d x %d x %d x %dHz", dm[i].Width, dm[i].Height, dm[i].Bpp, dm[i].RefreshRate);
-                int index = static_cast<int>(::SendDlgItemMessage(hWnd, IDC_LB_SCREEN_MODE, LB_ADDSTRING, 0, (LPARAM)buffer));
-                ::SendDlgItemMessage(hWnd, IDC_LB_SCREEN_MODE, LB_SETITEMDATA, index, i);
-                if (i == m_Config.screenMode)
-                {
-                    ::SendDlgItemMessage(hWnd, IDC_LB_SCREEN_MODE, LB_SETCURSEL, index, 0);
-                    ::SendDlgItemMessage(hWnd, IDC_LB_SCREEN_MODE, LB_SETTOPINDEX, index, 0);
-                }
-            }
-            ++i;
+            ::SendDlgItemMessage(hWnd, IDC_LB_SCREEN_MODE, LB_SETCURSEL, index, 0);
+            ::SendDlgItemMessage(hWnd, IDC_LB_SCREEN_MODE, LB_SETTOPINDEX, index, 0);
         }
     }
 
@@ -9,9 +9,24 @@
 #undef WIN32_LEAN_AND_MEAN
 #endif
 
+#include <deque>
+#include <string>
+
 #include "CKAll.h"
 
 #include "GameConfig.h"
+#include "LatencyProbe.h"
+#include "PickGrid.h"
+#include "BackgroundPolicy.h"
+#include "FullscreenPolicy.h"
+#include "DebounceScheduler.h"
+#include "LoadProgress.h"
+#include "LoadDiagnostics.h"
+#include "GameSession.h"
+#include "InstanceChannel.h"
+#include "BatchRunner.h"
+#include "PluginIndex.h"
+#include "AssetCache.h"
 
 #if defined(_MSC_VER) && (_MSC_VER <= 1200)
 typedef BOOL PLAYER_DIALOG_RESULT;
@@ -19,7 +34,7 @@ typedef BOOL PLAYER_DIALOG_RESULT;
 typedef INT_PTR PLAYER_DIALOG_RESULT;
 #endif
 
-class CGameInfo;
+struct PluginRegistration;
 
 class CGamePlayer
 {
@@ -47,6 +62,19 @@ public:
     CKRenderContext *GetRenderContext() const { return m_RenderContext; }
     CKRenderManager *GetRenderManager() const { return m_RenderManager; }
 
+    // Reports the progress of Init and Load, up to the first rendered frame, to
+    // whoever reads it; the splash screen draws it while the player starts up.
+    void SetLoadProgress(CLoadProgress *progress) { m_LoadProgress = progress; }
+
+    // Applies the command lines later launches forward through the channel, once
+    // the window exists.
+    void SetInstanceChannel(CInstanceChannel *channel) { m_InstanceChannel = channel; }
+
+    // Runs the player as a batch worker: the window stays hidden, no dialog opens,
+    // the config file is left alone, and Load reports the missing GUIDs and the
+    // hotfix outcome into the result. Set before Init.
+    void SetBatchResult(BatchResult *result) { m_BatchResult = result; }
+
 private:
     enum PlayerState
     {
@@ -57,6 +85,15 @@ private:
         eFocusLost,
     };
 
+    // Runtime changes waiting to be saved to the config file.
+    enum PersistentField
+    {
+        ePersistWindowPosition = 1,
+        ePersistDisplayMode = 2,
+        ePersistFullscreen = 4,
+        ePersistManualSetup = 8
+    };
+
     CGamePlayer(const CGamePlayer &);
     CGamePlayer &operator=(const CGamePlayer &);
 
@@ -68,14 +105,19 @@ private:
 
     bool InitDriver();
 
+    bool LoadComposition(const char *filename);
     bool FinishLoad(const char *filename, const char *resolvedFile);
     void ReportMissingGuids(CKFile *file, const char *resolvedFile);
+    bool HasDeferredPlugins() const;
+    bool LoadDeferredPlugins(CKFile *file);
+    void LoadRemainingPlugins(int maxCount);
+    const AssetCacheEntry *CacheComposition(const char *resolvedFile);
 
     bool InitPlugins(CKPluginManager *pluginManager);
-    bool LoadRenderEngines(CKPluginManager *pluginManager);
-    bool LoadManagers(CKPluginManager *pluginManager);
-    bool LoadBuildingBlocks(CKPluginManager *pluginManager);
-    bool LoadPlugins(CKPluginManager *pluginManager);
+    bool LoadRenderEngines(CKPluginManager *pluginManager, PluginRegistration &registration);
+    bool LoadManagers(CKPluginManager *pluginManager, PluginRegistration &registration);
+    bool LoadBuildingBlocks(CKPluginManager *pluginManager, PluginRegistration &registration);
+    bool LoadPlugins(CKPluginManager *pluginManager, PluginRegistration &registration);
     bool UnloadPlugins(CKPluginManager *pluginManager, CK_PLUGIN_TYPE type, CKGUID guid);
 
     int FindRenderEngine(CKPluginManager *pluginManager);
@@ -83,13 +125,20 @@ private:
     bool SetupManagers();
     bool SetupPaths();
 
+    void StampInputLatency(UINT uMsg);
+    void CompleteFrameLatency(platform::uint64 presentTime);
+    void ReportInputLatency();
+
     void ResizeWindow();
 
+    void LoadDriverCache();
     int FindScreenMode(int width, int height, int bpp, int driver);
     bool GetDisplayMode(int &width, int &height, int &bpp, int driver, int screenMode);
     void SetDefaultValuesForDriver();
     void SyncPersistentDisplayConfig();
     void SyncPersistentWindowPosition();
+    void MarkPersistentConfigDirty(unsigned int fields);
+    void FlushPersistentConfig(bool shutdown);
 
     bool IsRenderFullscreen() const;
     bool GoFullscreen();
@@ -98,6 +147,8 @@ private:
     void RestoreDisplayMode();
     void SetFullscreenWindowStyle();
     void SetWindowedWindowStyle();
+    void GetDesktopSize(int &width, int &height);
+    bool ApplyFullscreenAction(const FullscreenAction &action);
 
     bool ClipCursor();
     bool ReleaseCursorClip();
@@ -115,10 +166,18 @@ private:
     void OnGetMinMaxInfo(LPMINMAXINFO lpmmi);
     int OnSysKeyDown(UINT uKey);
     void OnClick(bool dblClk = false);
+
+    platform::uint32 GetPickViewKey();
+    void TrackPickChanges();
+    void RefreshPickGrid();
+    bool IsClickOnNothing(const POINT &pt);
     int OnCommand(UINT id, UINT code);
     void OnExceptionCMO();
     void OnReturn();
     bool OnLoadCMO(const char *filename);
+    void OnInstanceMessages();
+    void OnForwardedLoad();
+    void ApplyForwardedCommandLine(const char *cmdline);
     void OnExitToSystem();
     void OnExitToTitle();
     int OnChangeScreenMode(int driver, int screenMode);
@@ -157,7 +216,33 @@ private:
     CKMessageType m_MsgClick;
     CKMessageType m_MsgDoubleClick;
 
-    CGameInfo *m_GameInfo;
+    CLatencyProbe m_LatencyProbe;
+    platform::uint64 m_LatencyReportTime;
+    CPickGrid m_PickGrid;
+    CPickTracker m_PickTracker;
+    CBackgroundPolicy m_BackgroundPolicy;
+    // Whether the CK context was paused by the background policy.
+    bool m_BackgroundPaused;
+    CFullscreenPolicy m_FullscreenPolicy;
+    CDebounceScheduler m_ConfigFlush;
+    CPluginGuidIndex m_PluginIndex;
+    CPluginLoadPlanner m_PluginPlanner;
+    // Whether a deferred plugin was registered in the limiter slack since the last frame.
+    bool m_DeferredPluginIdleLoad;
+
+    // Composition images kept between loads, see ReloadCacheSize.
+    CAssetCache m_CompositionCache;
+
+    CLoadProgress *m_LoadProgress;
+    // Events of the load in progress, see LoadDiagnostics.
+    CLoadDiagnostics m_LoadDiagnostics;
+    CDiagnosticsFileSink m_DiagnosticsFile;
+    CInstanceChannel *m_InstanceChannel;
+    BatchResult *m_BatchResult;
+    std::deque<std::string> m_ForwardedCompositions; // one per pending WM_PLAYER_FORWARDED_LOAD
+
+    // The game info the InterfaceManager points to, reused across loads.
+    CGameSession m_GameSession;
     CGameConfig m_Config;
     CGameConfig m_PersistentConfig;
 };
@@ -0,0 +1,143 @@
+#include "GameSession.h"
+
+#include <string.h>
+
+static void CopyField(char *field, size_t size, const char *text)
+{
+    if (!text)
+        text = "";
+    strncpy(field, text, size - 1);
+    field[size - 1] = '\0';
+}
+
+CGameInfoPool::CGameInfoPool()
+{
+    int i;
+    for (i = 0; i < CAPACITY; ++i)
+        m_Used[i] = false;
+}
+
+CGameInfo *CGameInfoPool::Acquire()
+{
+    int i;
+    for (i = 0; i < CAPACITY; ++i)
+    {
+        if (!m_Used[i])
+        {
+            m_Used[i] = true;
+            m_Records[i].Reset();
+            return &m_Records[i];
+        }
+    }
+    return NULL;
+}
+
+bool CGameInfoPool::Release(CGameInfo *info)
+{
+    const int i = IndexOf(info);
+    if (i < 0 || !m_Used[i])
+        return false;
+    m_Used[i] = false;
+    return true;
+}
+
+bool CGameInfoPool::Owns(const CGameInfo *info) const
+{
+    return IndexOf(info) >= 0;
+}
+
+size_t CGameInfoPool::GetUsedCount() const
+{
+    size_t count = 0;
+    int i;
+    for (i = 0; i < CAPACITY; ++i)
+    {
+        if (m_Used[i])
+            ++count;
+    }
+    return count;
+}
+
+int CGameInfoPool::IndexOf(const CGameInfo *info) const
+{
+    int i;
+    for (i = 0; i < CAPACITY; ++i)
+    {
+        if (info == &m_Records[i])
+            return i;
+    }
+    return -1;
+}
+
+CStringTable::CStringTable() : m_Used(0), m_Count(0) {}
+
+const char *CStringTable::Intern(const char *text)
+{
+    if (!text)
+        return NULL;
+
+    // FNV-1a, so most lookups compare a hash rather than the strings.
+    platform::uint32 hash = 2166136261u;
+    const char *p;
+    for (p = text; *p; ++p)
+    {
+        hash ^= (unsigned char)*p;
+        hash *= 16777619u;
+    }
+    const size_t size = (p - text) + 1;
+
+    size_t i;
+    for (i = 0; i < m_Count; ++i)
+    {
+        if (m_Hashes[i] == hash && strcmp(m_Strings[i], text) == 0)
+            return m_Strings[i];
+    }
+
+    if (m_Count == MAX_STRINGS || size > ARENA_SIZE - m_Used)
+        return NULL;
+
+    char *copy = m_Arena + m_Used;
+    memcpy(copy, text, size);
+    m_Used += size;
+    m_Strings[m_Count] = copy;
+    m_Hashes[m_Count] = hash;
+    ++m_Count;
+    return copy;
+}
+
+void CStringTable::Clear()
+{
+    m_Used = 0;
+    m_Count = 0;
+}
+
+CGameSession::CGameSession() : m_Current(NULL), m_FileName(NULL) {}
+
+CGameInfo *CGameSession::Start(const char *fileName, const char *path)
+{
+    CGameInfo *info = m_Pool.Acquire();
+    if (!info)
+        return NULL;
+
+    // A full table only costs the copy; the record holds the name either way.
+    const char *internedFile = m_Strings.Intern(fileName);
+    const char *internedPath = m_Strings.Intern(path);
+    CopyField(info->fileName, sizeof(info->fileName), internedFile ? internedFile : fileName);
+    CopyField(info->path, sizeof(info->path), internedPath ? internedPath : path);
+
+    if (m_Current)
+        m_Pool.Release(m_Current);
+    m_Current = info;
+    m_FileName = internedFile ? internedFile : info->fileName;
+    return info;
+}
+
+void CGameSession::End()
+{
+    if (m_Current)
+    {
+        m_Pool.Release(m_Current);
+        m_Current = NULL;
+        m_FileName = NULL;
+    }
+}
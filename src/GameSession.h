@@ -0,0 +1,135 @@
+#ifndef PLAYER_GAMESESSION_H
+#define PLAYER_GAMESESSION_H
+
+#include <stddef.h>
+
+#include "Platform.h"
+#include "GameInfo.h"
+
+// The layout of CGameInfo the InterfaceManager of the game's building blocks
+// was built against: a vtable pointer, then the fields in order. CGameInfo must
+// not gain fields or virtual functions.
+struct GameInfoLayout
+{
+    void *vtable;
+    CGameInfo *next;
+    char gameName[128];
+    char levelName[128];
+    char fileName[128];
+    char path[128];
+    char regSubkey[512];
+    unsigned long hkRoot;
+    int gameScore;
+    int levelScore;
+    int type;
+    int gameID;
+    int levelID;
+    int gameBonus;
+    int levelBonus;
+    int levelReached;
+};
+
+PLATFORM_STATIC_ASSERT(sizeof(CGameInfo) == sizeof(GameInfoLayout), game_info_layout_size);
+#if defined(_WIN32) && !defined(_WIN64)
+PLATFORM_STATIC_ASSERT(sizeof(CGameInfo) == 1068, game_info_size);
+#endif
+
+// A fixed set of game info records, constructed once and reset in place when
+// acquired again.
+class CGameInfoPool
+{
+public:
+    enum
+    {
+        CAPACITY = 4
+    };
+
+    CGameInfoPool();
+
+    // A reset record, or NULL when all of them are in use.
+    CGameInfo *Acquire();
+
+    // Returns false for a record that is not from the pool or not in use.
+    bool Release(CGameInfo *info);
+
+    bool Owns(const CGameInfo *info) const;
+    size_t GetUsedCount() const;
+
+private:
+    CGameInfoPool(const CGameInfoPool &);
+    CGameInfoPool &operator=(const CGameInfoPool &);
+
+    int IndexOf(const CGameInfo *info) const;
+
+    CGameInfo m_Records[CAPACITY];
+    bool m_Used[CAPACITY];
+};
+
+// Keeps one copy of each string in a fixed arena. Interned strings stay valid
+// until Clear().
+class CStringTable
+{
+public:
+    enum
+    {
+        ARENA_SIZE = 4096,
+        MAX_STRINGS = 64
+    };
+
+    CStringTable();
+
+    // The copy of text in the table, or NULL when text is NULL or the table is full.
+    const char *Intern(const char *text);
+    void Clear();
+
+    size_t GetCount() const { return m_Count; }
+    size_t GetUsedSize() const { return m_Used; }
+
+private:
+    CStringTable(const CStringTable &);
+    CStringTable &operator=(const CStringTable &);
+
+    char m_Arena[ARENA_SIZE];
+    size_t m_Used;
+    const char *m_Strings[MAX_STRINGS];
+    platform::uint32 m_Hashes[MAX_STRINGS];
+    size_t m_Count;
+};
+
+// The game info handed to the InterfaceManager for the composition being
+// played. Starting a session, on every load and level restart, reuses the
+// records and strings of the previous ones instead of allocating.
+class CGameSession
+{
+public:
+    CGameSession();
+
+    // Fills a record for the composition and makes it current. The previous
+    // record goes back to the pool once the new one is filled, so its fields
+    // can be passed in. Names too long for the record are cut short.
+    CGameInfo *Start(const char *fileName, const char *path);
+
+    // Releases the current record.
+    void End();
+
+    CGameInfo *GetCurrent() const { return m_Current; }
+
+    // The file the current session was started with, NULL when there is none.
+    // Unlike the record, the scripts have no hold on it, unless the string
+    // table was full.
+    const char *GetFileName() const { return m_FileName; }
+
+    const CGameInfoPool &GetPool() const { return m_Pool; }
+    const CStringTable &GetStrings() const { return m_Strings; }
+
+private:
+    CGameSession(const CGameSession &);
+    CGameSession &operator=(const CGameSession &);
+
+    CGameInfoPool m_Pool;
+    CStringTable m_Strings;
+    CGameInfo *m_Current;
+    const char *m_FileName;
+};
+
+#endif // PLAYER_GAMESESSION_H
@@ -5,19 +5,276 @@
 #include "InterfaceManager.h"
 #include "GameConfig.h"
 #include "Utils.h"
+#include "HotfixPlan.h"
+#include "DisplayModeCatalog.h"
+#include "LoadDiagnostics.h"
+
+extern const CDisplayModeCatalog *GetDisplayModeCatalog(CKRenderManager *renderManager, int driver);
+
+// Bits of the config the plan depends on: each selects patches, and so the
+// objects they look up.
+enum HotfixPlanFlags
+{
+    HOTFIX_PLAN_DEBUG = 0x01,
+    HOTFIX_PLAN_UNLOCK_WIDESCREEN = 0x02,
+    HOTFIX_PLAN_UNLOCK_HIGH_RESOLUTION = 0x04,
+    HOTFIX_PLAN_UNLOCK_FRAMERATE = 0x08,
+    HOTFIX_PLAN_SKIP_OPENING = 0x10
+};
+
+static platform::uint32 GetHotfixPlanFlags(const CGameConfig &config)
+{
+    platform::uint32 flags = 0;
+    if (config.debug)
+        flags |= HOTFIX_PLAN_DEBUG;
+    if (config.unlockWidescreen)
+        flags |= HOTFIX_PLAN_UNLOCK_WIDESCREEN;
+    if (config.unlockHighResolution)
+        flags |= HOTFIX_PLAN_UNLOCK_HIGH_RESOLUTION;
+    if (config.unlockFramerate)
+        flags |= HOTFIX_PLAN_UNLOCK_FRAMERATE;
+    if (config.skipOpening)
+        flags |= HOTFIX_PLAN_SKIP_OPENING;
+    return flags;
+}
+
+// Describes the behaviors and links of the loaded composition for the plan.
+class CContextObjectLookup : public CHotfixObjectLookup
+{
+public:
+    explicit CContextObjectLookup(CKContext *context) : m_Context(context) {}
+
+    virtual bool Describe(platform::uint32 id, HotfixObjectInfo &info)
+    {
+        CKObject *obj = m_Context->GetObject((CK_ID)id);
+        if (!obj)
+            return false;
+
+        if (CKIsChildClassOf(obj, CKCID_BEHAVIOR))
+        {
+            CKBehavior *beh = (CKBehavior *)obj;
+            info.kind = HOTFIX_SITE_BEHAVIOR;
+            info.owner = CKOBJID(beh->GetParent());
+            info.target = 0;
+            info.name = beh->GetName() ? beh->GetName() : "";
+            return true;
+        }
+
+        if (CKIsChildClassOf(obj, CKCID_BEHAVIORLINK))
+        {
+            CKBehaviorLink *link = (CKBehaviorLink *)obj;
+            CKBehaviorIO *in = link->GetInBehaviorIO();
+            CKBehaviorIO *out = link->GetOutBehaviorIO();
+            if (!in || !out)
+                return false;
+            info.kind = HOTFIX_SITE_LINK;
+            info.owner = CKOBJID(in->GetOwner());
+            info.target = CKOBJID(out->GetOwner());
+            info.name.clear();
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    CKContext *m_Context;
+};
+
+// Finds the objects the patches touch: by ID when the plan has them, by searching
+// the scripts otherwise, recording what the search found. A script is indexed on
+// its first search; the edits below keep the index in step with the script.
+class CHotfixResolver
+{
+public:
+    CHotfixResolver(CKContext *context, CHotfixPlan *plan) : m_Context(context), m_Plan(plan), m_Planned(0), m_Searched(0) {}
+
+    ~CHotfixResolver()
+    {
+        for (IndexMap::iterator it = m_Indexes.begin(); it != m_Indexes.end(); ++it)
+            delete it->second;
+    }
+
+    bool Find(const char *key, CKBehavior *&behavior)
+    {
+        CKObject *obj = FindPlanned(key, HOTFIX_SITE_BEHAVIOR);
+        if (!obj)
+            return false;
+        behavior = (CKBehavior *)obj;
+        return true;
+    }
+
+    bool Find(const char *key, CKBehaviorLink *&link)
+    {
+        CKObject *obj = FindPlanned(key, HOTFIX_SITE_LINK);
+        if (!obj)
+            return false;
+        link = (CKBehaviorLink *)obj;
+        return true;
+    }
+
+    CKBehavior *Record(const char *key, CKBehavior *behavior)
+    {
+        ++m_Searched;
+        if (behavior && m_Plan)
+        {
+            HotfixPlanSite site;
+            site.key = key;
+            site.kind = HOTFIX_SITE_BEHAVIOR;
+            site.id = behavior->GetID();
+            site.owner = CKOBJID(behavior->GetParent());
+            site.name = behavior->GetName() ? behavior->GetName() : "";
+            m_Plan->Record(site);
+        }
+        return behavior;
+    }
+
+    CKBehaviorLink *Record(const char *key, CKBehaviorLink *link)
+    {
+        ++m_Searched;
+        if (link && m_Plan)
+        {
+            HotfixPlanSite site;
+            site.key = key;
+            site.kind = HOTFIX_SITE_LINK;
+            site.id = link->GetID();
+            site.owner = CKOBJID(link->GetInBehaviorIO()->GetOwner());
+            site.target = CKOBJID(link->GetOutBehaviorIO()->GetOwner());
+            m_Plan->Record(site);
+        }
+        return link;
+    }
+
+    CKBehavior *GetBehavior(const char *key, CKBehavior *script, const char *name)
+    {
+        CKBehavior *behavior = NULL;
+        if (Find(key, behavior))
+            return behavior;
+        return Record(key, GetIndex(script).FindBehavior(name));
+    }
+
+    CKBehavior *GetBehavior(const char *key, CKBehavior *script, const char *name, const char *targetName)
+    {
+        CKBehavior *behavior = NULL;
+        if (Find(key, behavior))
+            return behavior;
+        return Record(key, GetIndex(script).FindBehavior(name, targetName));
+    }
+
+    template <typename In, typename Out>
+    CKBehaviorLink *GetBehaviorLink(const char *key, CKBehavior *script, In in, Out out, int inPos, int outPos,
+                                    CKBehaviorLink *previous = NULL)
+    {
+        CKBehaviorLink *link = NULL;
+        if (Find(key, link))
+            return link;
+        return Record(key, GetIndex(script).FindLink(in, out, inPos, outPos, previous));
+    }
+
+    // Unlinks the link from the script; it is destroyed as well when asked.
+    template <typename In, typename Out>
+    CKBehaviorLink *RemoveBehaviorLink(const char *key, CKBehavior *script, In in, Out out, int inPos, int outPos,
+                                       bool destroy = false)
+    {
+        CKBehaviorLink *link = GetBehaviorLink(key, script, in, out, inPos, outPos);
+        if (!link)
+            return NULL;
+        return RemoveBehaviorLink(script, link, destroy);
+    }
+
+    CKBehaviorLink *RemoveBehaviorLink(CKBehavior *script, CKBehaviorLink *link, bool destroy = false)
+    {
+        scriptutils::BehaviorGraphIndex *index = FindIndex(script);
+        if (index)
+            return scriptutils::RemoveBehaviorLink(*index, link, destroy);
+
+        script->RemoveSubBehaviorLink(link);
+        if (destroy)
+        {
+            CKDestroyObject(link);
+            return NULL;
+        }
+        return link;
+    }
+
+    CKBehaviorLink *CreateBehaviorLink(CKBehavior *script, CKBehavior *inBeh, CKBehavior *outBeh, int inPos, int outPos)
+    {
+        scriptutils::BehaviorGraphIndex *index = FindIndex(script);
+        if (index)
+            return scriptutils::CreateBehaviorLink(*index, inBeh, outBeh, inPos, outPos);
+        return scriptutils::CreateBehaviorLink(script, inBeh, outBeh, inPos, outPos);
+    }
+
+    void SetBehaviorLinkOutput(CKBehavior *script, CKBehaviorLink *link, CKBehaviorIO *out)
+    {
+        scriptutils::BehaviorGraphIndex *index = FindIndex(script);
+        if (index)
+            scriptutils::SetBehaviorLinkOutput(*index, link, out);
+        else
+            link->SetOutBehaviorIO(out);
+    }
+
+    scriptutils::BehaviorGraphIndex &GetIndex(CKBehavior *script)
+    {
+        scriptutils::BehaviorGraphIndex *index = FindIndex(script);
+        if (!index)
+        {
+            index = new scriptutils::BehaviorGraphIndex;
+            index->Build(script);
+            m_Indexes[script] = index;
+        }
+        return *index;
+    }
+
+    int GetPlanned() const { return m_Planned; }
+    int GetSearched() const { return m_Searched; }
+
+private:
+    typedef std::map<CKBehavior *, scriptutils::BehaviorGraphIndex *> IndexMap;
+
+    CHotfixResolver(const CHotfixResolver &);
+    CHotfixResolver &operator=(const CHotfixResolver &);
+
+    scriptutils::BehaviorGraphIndex *FindIndex(CKBehavior *script)
+    {
+        IndexMap::iterator it = m_Indexes.find(script);
+        return it != m_Indexes.end() ? it->second : NULL;
+    }
+
+    CKObject *FindPlanned(const char *key, int kind)
+    {
+        if (!m_Plan)
+            return NULL;
+
+        const HotfixPlanSite *site = m_Plan->Find(key);
+        if (!site || site->kind != kind)
+            return NULL;
+
+        CKObject *obj = m_Context->GetObject((CK_ID)site->id);
+        if (obj)
+            ++m_Planned;
+        return obj;
+    }
+
+    CKContext *m_Context;
+    CHotfixPlan *m_Plan;
+    int m_Planned;
+    int m_Searched;
+    IndexMap m_Indexes;
+};
 
 static bool GetCompositionDirectory(char *buffer, size_t size, const char *resolvedFile, bool trailing)
 {
     return utils::GetFileDirectory(buffer, size, resolvedFile, trailing);
 }
 
-static bool PatchReplacePathRoot(CKBehavior *defaultLevel, const char *resolvedFile)
+static bool PatchReplacePathRoot(CHotfixResolver &resolver, CKBehavior *defaultLevel, const char *resolvedFile)
 {
-    CKBehavior *getSystemVersion = scriptutils::GetBehavior(defaultLevel, "GetSystemVersion");
+    CKBehavior *getSystemVersion = resolver.GetBehavior("GetSystemVersion", defaultLevel, "GetSystemVersion");
     if (!getSystemVersion)
         return false;
 
-    CKBehavior *replacePath = scriptutils::GetBehavior(getSystemVersion, "TT_ReplacePath");
+    CKBehavior *replacePath = resolver.GetBehavior("GetSystemVersion/TT_ReplacePath", getSystemVersion, "TT_ReplacePath");
     if (!replacePath || replacePath->GetInputParameterCount() <= 2)
         return false;
 
@@ -29,9 +286,9 @@ static bool PatchReplacePathRoot(CKBehavior *defaultLevel, const char *resolvedF
     return true;
 }
 
-static bool PatchPlayerActiveRoot(CKBehavior *defaultLevel, const char *resolvedFile)
+static bool PatchPlayerActiveRoot(CHotfixResolver &resolver, CKBehavior *defaultLevel, const char *resolvedFile)
 {
-    CKBehavior *playerActive = scriptutils::GetBehavior(defaultLevel, "Player Active?");
+    CKBehavior *playerActive = resolver.GetBehavior("Player Active?", defaultLevel, "Player Active?");
     if (!playerActive)
         return false;
 
@@ -52,12 +309,12 @@ static bool PatchPlayerActiveRoot(CKBehavior *defaultLevel, const char *resolved
     return false;
 }
 
-static bool SetDebugMode(CKBehavior *setDebugMode)
+static bool SetDebugMode(CHotfixResolver &resolver, CKBehavior *setDebugMode)
 {
     if (!setDebugMode)
         return false;
 
-    CKBehavior *bs = scriptutils::GetBehavior(setDebugMode, "Binary Switch");
+    CKBehavior *bs = resolver.GetBehavior("set DebugMode/Binary Switch", setDebugMode, "Binary Switch");
     if (!bs)
         return false;
 
@@ -67,28 +324,31 @@ static bool SetDebugMode(CKBehavior *setDebugMode)
     return true;
 }
 
-static bool SetLanguage(CKBehavior *setLanguage, int langId)
+static bool SetLanguage(CHotfixResolver &resolver, CKBehavior *setLanguage, int langId)
 {
     if (!setLanguage)
         return false;
 
-    CKBehavior *gc = scriptutils::GetBehavior(setLanguage, "Get Cell");
+    CKBehavior *gc = resolver.GetBehavior("Set Language/Get Cell", setLanguage, "Get Cell");
     if (!gc)
         return false;
 
     CKBehaviorLink *linkIn0 = NULL;
-    const int linkCount = setLanguage->GetSubBehaviorLinkCount();
-    for (int i = 0; i < linkCount; ++i)
+    if (!resolver.Find("Set Language/-> Get Cell", linkIn0))
     {
-        CKBehaviorLink *link = setLanguage->GetSubBehaviorLink(i);
-        CKBehaviorIO *outIO = link->GetOutBehaviorIO();
-        if (outIO->GetOwner() == gc && gc->GetInput(0) == outIO)
-            linkIn0 = link;
+        std::vector<CKBehaviorLink *> links;
+        resolver.GetIndex(setLanguage).GetLinksTo(gc, links);
+        for (size_t i = 0; i < links.size(); ++i)
+        {
+            if (links[i]->GetOutBehaviorIO() == gc->GetInput(0))
+                linkIn0 = links[i];
+        }
+        resolver.Record("Set Language/-> Get Cell", linkIn0);
     }
     if (!linkIn0)
         return false;
 
-    CKBehaviorLink *linkRrOp = scriptutils::RemoveBehaviorLink(setLanguage, "TT_ReadRegistry", "Op", 0, 0);
+    CKBehaviorLink *linkRrOp = resolver.RemoveBehaviorLink("Set Language/TT_ReadRegistry -> Op", setLanguage, "TT_ReadRegistry", "Op", 0, 0);
     if (!linkRrOp)
         return false;
 
@@ -96,7 +356,7 @@ static bool SetLanguage(CKBehavior *setLanguage, int langId)
     scriptutils::SetInputParameterValue(op2, 0, langId);
     CKDestroyObject(linkRrOp);
 
-    linkIn0->SetOutBehaviorIO(op2->GetInput(0));
+    resolver.SetBehaviorLinkOutput(setLanguage, linkIn0, op2->GetInput(0));
 
     return true;
 }
@@ -155,12 +415,12 @@ static int ListDriver(const CKBehaviorContext &behcontext)
     return CKBR_OK;
 }
 
-static bool ReplaceListDriver(CKBehavior *screenModes)
+static bool ReplaceListDriver(CHotfixResolver &resolver, CKBehavior *screenModes)
 {
     if (!screenModes)
         return false;
 
-    CKBehavior *ld = scriptutils::GetBehavior(screenModes, "TT List Driver");
+    CKBehavior *ld = resolver.GetBehavior("Screen Modes/TT List Driver", screenModes, "TT List Driver");
     if (!ld)
         return false;
 
@@ -193,46 +453,44 @@ static int ListScreenModes(const CKBehaviorContext &behcontext)
     screenModes->InsertColumn(1, CKARRAYTYPE_INT, "Width");
     screenModes->InsertColumn(2, CKARRAYTYPE_INT, "Height");
 
-    VxDriverDesc *drDesc = context->GetRenderManager()->GetRenderDriverDescription(driverId);
-    if (!drDesc)
+    const CDisplayModeCatalog *catalog = GetDisplayModeCatalog(context->GetRenderManager(), driverId);
+    if (!catalog)
     {
         context->OutputToConsoleExBeep("ListScreenModes: No Driver Description for Driver-ID '%d' is found", driverId);
         beh->ActivateOutput(1);
         return CKBR_OK;
     }
 
-#if CKVERSION == 0x13022002
-    VxDisplayMode *dm = drDesc->DisplayModes;
-    const int dmCount = drDesc->DisplayModeCount;
-#else
-    XArray<VxDisplayMode> &dm = drDesc->DisplayModes;
-    const int dmCount = dm.Size();
-#endif
+    // The rows the original building block lists: in driver order, the modes of
+    // each run of one size that reach the run's best refresh rate.
+    const int dmCount = catalog->GetModeCount();
     int i = 0, row = 0;
     while (i < dmCount)
     {
-        int width = dm[i].Width;
-        int height = dm[i].Height;
+        const int width = catalog->GetMode(i).width;
+        const int height = catalog->GetMode(i).height;
 
         int maxRefreshRate = 0;
-        for (int j = i; j < dmCount && dm[j].Width == width && dm[j].Height == height; ++j)
+        int j;
+        for (j = i; j < dmCount && catalog->GetMode(j).width == width && catalog->GetMode(j).height == height; ++j)
         {
-            if (dm[j].Bpp > 8 && dm[j].RefreshRate > maxRefreshRate)
-                maxRefreshRate = dm[j].RefreshRate;
+            const DisplayMode &mode = catalog->GetMode(j);
+            if (mode.bpp > 8 && mode.refreshRate > maxRefreshRate)
+                maxRefreshRate = mode.refreshRate;
         }
 
-        while (i < dmCount && dm[i].Width == width && dm[i].Height == height)
+        for (; i < j; ++i)
         {
-            if (dm[i].Bpp > 8 && dm[i].RefreshRate == maxRefreshRate)
+            DisplayMode mode = catalog->GetMode(i);
+            if (mode.bpp > 8 && mode.refreshRate == maxRefreshRate)
             {
                 screenModes->InsertRow();
                 screenModes->SetElementValue(row, 0, &i, sizeof(int));
-                screenModes->SetElementValue(row, 1, &dm[i].Width, sizeof(int));
-                screenModes->SetElementValue(row, 2, &dm[i].Height, sizeof(int));
-                screenModes->SetElementValue(row, 3, &dm[i].Bpp, sizeof(int));
+                screenModes->SetElementValue(row, 1, &mode.width, sizeof(int));
+                screenModes->SetElementValue(row, 2, &mode.height, sizeof(int));
+                screenModes->SetElementValue(row, 3, &mode.bpp, sizeof(int));
                 ++row;
             }
-            ++i;
         }
     }
 
@@ -250,12 +508,12 @@ static int ListScreenModes(const CKBehaviorContext &behcontext)
     return CKBR_OK;
 }
 
-static bool ReplaceListScreenModes(CKBehavior *screenModes)
+static bool ReplaceListScreenModes(CHotfixResolver &resolver, CKBehavior *screenModes)
 {
     if (!screenModes)
         return false;
 
-    CKBehavior *ls = scriptutils::GetBehavior(screenModes, "TT List ScreenModes");
+    CKBehavior *ls = resolver.GetBehavior("Screen Modes/TT List ScreenModes", screenModes, "TT List ScreenModes");
     if (!ls)
         return false;
 
@@ -263,43 +521,52 @@ static bool ReplaceListScreenModes(CKBehavior *screenModes)
     return true;
 }
 
-static bool UnlockWidescreen(CKBehavior *screenModes, CKBehavior *minWidth)
+static bool UnlockWidescreen(CHotfixResolver &resolver, CKBehavior *screenModes, CKBehavior *minWidth)
 {
     if (!screenModes || !minWidth)
         return false;
 
-    CKBehavior *ic = scriptutils::GetBehavior(screenModes, "Insert Column", "ScreenModes");
+    CKBehavior *ic = resolver.GetBehavior("Screen Modes/Insert Column", screenModes, "Insert Column", "ScreenModes");
     if (!ic)
         return false;
 
-    CKBehaviorLink *linkScIc = scriptutils::RemoveBehaviorLink(screenModes, "Set Cell", ic, 0, 0);
+    CKBehaviorLink *linkScIc = resolver.RemoveBehaviorLink("Screen Modes/Set Cell -> Insert Column", screenModes, "Set Cell", ic, 0, 0);
     if (!linkScIc)
         return false;
 
     CKBehavior *sc = linkScIc->GetInBehaviorIO()->GetOwner();
     CKDestroyObject(linkScIc);
 
-    scriptutils::RemoveBehaviorLink(screenModes, "Remove Column", minWidth, 0, 0, true);
-    scriptutils::CreateBehaviorLink(screenModes, sc, minWidth, 0, 0);
+    resolver.RemoveBehaviorLink("Screen Modes/Remove Column -> Min Width", screenModes, "Remove Column", minWidth, 0, 0, true);
+    resolver.CreateBehaviorLink(screenModes, sc, minWidth, 0, 0);
 
     return true;
 }
 
-static bool UnlockHighResolution(CKBehavior *screenModes, CKBehavior *bppFilter, CKBehavior *minWidth, CKBehavior *maxWidth, bool unlockWidescreen)
+static bool UnlockHighResolution(CHotfixResolver &resolver, CKBehavior *screenModes, CKBehavior *bppFilter, CKBehavior *minWidth, CKBehavior *maxWidth, bool unlockWidescreen)
 {
     if (!screenModes || !bppFilter || !minWidth || !maxWidth)
         return false;
 
-    const char *inBehName = (unlockWidescreen) ? "Set Cell" : "Remove Column";
-    CKBehaviorLink *linkRri = scriptutils::RemoveBehaviorLink(screenModes, inBehName, minWidth, 0, 0);
+    // With the widescreen patch, the link into the minimum width filter is the one
+    // it just created, which a plan could not find on the next load.
+    CKBehaviorLink *linkRri = NULL;
+    if (unlockWidescreen)
+    {
+        linkRri = resolver.GetIndex(screenModes).FindLink("Set Cell", minWidth, 0, 0);
+        if (linkRri)
+            resolver.RemoveBehaviorLink(screenModes, linkRri);
+    }
+    else
+        linkRri = resolver.RemoveBehaviorLink("Screen Modes/Remove Column -> Min Width", screenModes, "Remove Column", minWidth, 0, 0);
     if (!linkRri)
         return false;
 
     CKBehavior *inBeh = linkRri->GetInBehaviorIO()->GetOwner();
     CKDestroyObject(linkRri);
 
-    scriptutils::RemoveBehaviorLink(screenModes, maxWidth, bppFilter, 0, 0, true);
-    scriptutils::CreateBehaviorLink(screenModes, inBeh, bppFilter, 0, 0);
+    resolver.RemoveBehaviorLink("Screen Modes/Max Width -> Bpp Filter", screenModes, maxWidth, bppFilter, 0, 0, true);
+    resolver.CreateBehaviorLink(screenModes, inBeh, bppFilter, 0, 0);
 
     return true;
 }
@@ -327,104 +594,111 @@ static bool UnlockFramerate(CKBehavior *synchToScreen)
     return changed;
 }
 
-static bool SkipResolutionCheck(CKBehavior *synchToScreen)
+static bool SkipResolutionCheck(CHotfixResolver &resolver, CKBehavior *synchToScreen)
 {
     if (!synchToScreen)
         return false;
 
-    CKBehavior *ii = scriptutils::GetBehavior(synchToScreen, "Iterator If");
-    CKBehavior *delayer = scriptutils::GetBehavior(synchToScreen, "Delayer");
+    CKBehavior *ii = resolver.GetBehavior("Synch to Screen/Iterator If", synchToScreen, "Iterator If");
+    CKBehavior *delayer = resolver.GetBehavior("Synch to Screen/Delayer", synchToScreen, "Delayer");
     if (!(ii && delayer))
         return false;
 
-    CKBehaviorLink *linkTsIi1 = scriptutils::GetBehaviorLink(synchToScreen, "Time Settings", ii, 0, 0);
-    CKBehaviorLink *linkTsIi2 = scriptutils::GetBehaviorLink(synchToScreen, "Time Settings", ii, 0, 0, linkTsIi1);
-    if (!(linkTsIi1 && linkTsIi2))
+    CKBehaviorLink *linkTsIi1 = resolver.GetBehaviorLink("Synch to Screen/Time Settings -> Iterator If #1", synchToScreen, "Time Settings", ii, 0, 0);
+    if (!linkTsIi1)
+        return false;
+    CKBehaviorLink *linkTsIi2 = resolver.GetBehaviorLink("Synch to Screen/Time Settings -> Iterator If #2", synchToScreen, "Time Settings", ii, 0, 0, linkTsIi1);
+    if (!linkTsIi2)
         return false;
 
-    CKBehaviorLink *linkDelayerCsm = scriptutils::RemoveBehaviorLink(synchToScreen, delayer, "TT Change ScreenMode", 0, 0);
+    CKBehaviorLink *linkDelayerCsm = resolver.RemoveBehaviorLink("Synch to Screen/Delayer -> TT Change ScreenMode", synchToScreen, delayer, "TT Change ScreenMode", 0, 0);
     if (!linkDelayerCsm)
         return false;
 
-    linkTsIi1->SetOutBehaviorIO(linkDelayerCsm->GetOutBehaviorIO());
-    linkTsIi2->SetOutBehaviorIO(linkDelayerCsm->GetOutBehaviorIO());
+    resolver.SetBehaviorLinkOutput(synchToScreen, linkTsIi1, linkDelayerCsm->GetOutBehaviorIO());
+    resolver.SetBehaviorLinkOutput(synchToScreen, linkTsIi2, linkDelayerCsm->GetOutBehaviorIO());
     CKDestroyObject(linkDelayerCsm);
 
     return true;
 }
 
-static bool SkipOpeningAnimation(CKBehavior *defaultLevel, CKBehavior *synchToScreen)
+static bool SkipOpeningAnimation(CHotfixResolver &resolver, CKBehavior *defaultLevel, CKBehavior *synchToScreen)
 {
     if (!defaultLevel || !synchToScreen)
         return false;
 
-    CKBehavior *is = scriptutils::GetBehavior(defaultLevel, "Intro Start");
-    CKBehavior *ie = scriptutils::GetBehavior(defaultLevel, "Intro Ende");
-    CKBehavior *ml = scriptutils::GetBehavior(defaultLevel, "Main Loading");
-    CKBehavior *ps = scriptutils::GetBehavior(defaultLevel, "Preload Sound");
+    CKBehavior *is = resolver.GetBehavior("Intro Start", defaultLevel, "Intro Start");
+    CKBehavior *ie = resolver.GetBehavior("Intro Ende", defaultLevel, "Intro Ende");
+    CKBehavior *ml = resolver.GetBehavior("Main Loading", defaultLevel, "Main Loading");
+    CKBehavior *ps = resolver.GetBehavior("Preload Sound", defaultLevel, "Preload Sound");
     if (!(is && ie && ml && ps))
         return false;
 
-    CKBehaviorLink *linkStsIs = scriptutils::GetBehaviorLink(defaultLevel, synchToScreen, is, 0, 0);
+    CKBehaviorLink *linkStsIs = resolver.GetBehaviorLink("Synch to Screen -> Intro Start", defaultLevel, synchToScreen, is, 0, 0);
     if (!linkStsIs)
         return false;
 
-    linkStsIs->SetOutBehaviorIO(ml->GetInput(0));
+    resolver.SetBehaviorLinkOutput(defaultLevel, linkStsIs, ml->GetInput(0));
 
-    CKBehaviorLink *linkIeAs = scriptutils::GetBehaviorLink(defaultLevel, ie, "Activate Script", 0, 0);
+    CKBehaviorLink *linkIeAs = resolver.GetBehaviorLink("Intro Ende -> Activate Script", defaultLevel, ie, "Activate Script", 0, 0);
     if (!linkIeAs)
         return false;
 
-    CKBehaviorLink *linkPsWfa = scriptutils::GetBehaviorLink(defaultLevel, ps, "Wait For All", 0, 0);
+    CKBehaviorLink *linkPsWfa = resolver.GetBehaviorLink("Preload Sound -> Wait For All", defaultLevel, ps, "Wait For All", 0, 0);
     if (!linkPsWfa)
         return false;
 
-    linkPsWfa->SetOutBehaviorIO(linkIeAs->GetOutBehaviorIO());
+    resolver.SetBehaviorLinkOutput(defaultLevel, linkPsWfa, linkIeAs->GetOutBehaviorIO());
     return true;
 }
 
-bool EditScript(CKLevel *level, const CGameConfig &config, const char *resolvedFile)
+// Records the outcome of a step in the diagnostics of the load, if any, and passes it on.
+static bool Report(CLoadDiagnostics *diagnostics, const char *step, bool applied)
 {
-    if (!level || !resolvedFile || !*resolvedFile)
-        return false;
+    if (diagnostics)
+        diagnostics->Hotfix(step, applied);
+    return applied;
+}
 
-    CKBehavior *defaultLevel = scriptutils::GetBehavior(level->ComputeObjectList(CKCID_BEHAVIOR), "Default Level");
-    if (!defaultLevel)
+static bool ApplyPatches(CHotfixResolver &resolver, CKLevel *level, const CGameConfig &config, const char *resolvedFile, CLoadDiagnostics *diagnostics)
+{
+    CKBehavior *defaultLevel = NULL;
+    if (!resolver.Find("Default Level", defaultLevel))
+        defaultLevel = resolver.Record("Default Level", scriptutils::GetBehavior(level->ComputeObjectList(CKCID_BEHAVIOR), "Default Level"));
+    if (!Report(diagnostics, "default_level", defaultLevel != NULL))
     {
         CLogger::Get().Warn("Unable to find Default Level");
         return false;
     }
 
-    PatchReplacePathRoot(defaultLevel, resolvedFile);
-    PatchPlayerActiveRoot(defaultLevel, resolvedFile);
+    Report(diagnostics, "replace_path_root", PatchReplacePathRoot(resolver, defaultLevel, resolvedFile));
+    Report(diagnostics, "player_active_root", PatchPlayerActiveRoot(resolver, defaultLevel, resolvedFile));
 
     // Set debug mode
     if (config.debug)
     {
-        if (!SetDebugMode(scriptutils::GetBehavior(defaultLevel, "set DebugMode")))
+        if (!Report(diagnostics, "debug_mode", SetDebugMode(resolver, resolver.GetBehavior("set DebugMode", defaultLevel, "set DebugMode"))))
             CLogger::Get().Warn("Failed to set debug mode");
     }
 
     // Bypass "Set Language" script and set our language id
-    if (!SetLanguage(scriptutils::GetBehavior(defaultLevel, "Set Language"), config.langId))
+    if (!Report(diagnostics, "language", SetLanguage(resolver, resolver.GetBehavior("Set Language", defaultLevel, "Set Language"), config.langId)))
         CLogger::Get().Warn("Failed to set language id");
 
-    int i;
-
-    CKBehavior *sm = scriptutils::GetBehavior(defaultLevel, "Screen Modes");
-    if (!sm)
+    CKBehavior *sm = resolver.GetBehavior("Screen Modes", defaultLevel, "Screen Modes");
+    if (!Report(diagnostics, "screen_modes", sm != NULL))
     {
         CLogger::Get().Warn("Unable to find script Screen Modes");
         return false;
     }
 
-    if (!ReplaceListDriver(sm))
+    if (!Report(diagnostics, "list_driver", ReplaceListDriver(resolver, sm)))
     {
         CLogger::Get().Warn("Failed to set driver");
         return false;
     }
 
-    if (!ReplaceListScreenModes(sm))
+    if (!Report(diagnostics, "list_screen_modes", ReplaceListScreenModes(resolver, sm)))
     {
         CLogger::Get().Warn("Failed to set screen mode");
         return false;
@@ -433,10 +707,15 @@ bool EditScript(CKLevel *level, const CGameConfig &config, const char *resolvedF
     CKBehavior *bbpFilter = NULL;
     CKBehavior *minWidth = NULL;
     CKBehavior *maxWidth = NULL;
-    for (i = 0; i < sm->GetSubBehaviorCount(); ++i)
+    if (!(resolver.Find("Screen Modes/Bpp Filter", bbpFilter) &&
+          resolver.Find("Screen Modes/Min Width", minWidth) &&
+          resolver.Find("Screen Modes/Max Width", maxWidth)))
     {
-        CKBehavior *beh = sm->GetSubBehavior(i);
-        if (strcmp(beh->GetName(), "Remove Row If") == 0)
+        bbpFilter = NULL;
+        minWidth = NULL;
+        maxWidth = NULL;
+        scriptutils::BehaviorGraphIndex &index = resolver.GetIndex(sm);
+        for (CKBehavior *beh = index.FindBehavior("Remove Row If"); beh; beh = index.FindBehavior("Remove Row If", beh))
         {
             switch (scriptutils::GetInputParameterValue<int>(beh, 2))
             {
@@ -453,10 +732,13 @@ bool EditScript(CKLevel *level, const CGameConfig &config, const char *resolvedF
                     break;
             }
         }
+        resolver.Record("Screen Modes/Bpp Filter", bbpFilter);
+        resolver.Record("Screen Modes/Min Width", minWidth);
+        resolver.Record("Screen Modes/Max Width", maxWidth);
     }
 
     // Correct the bbp filter
-    if (!bbpFilter)
+    if (!Report(diagnostics, "bpp_filter", bbpFilter != NULL))
     {
         CLogger::Get().Warn("Failed to correct the bbp filter");
     }
@@ -468,19 +750,19 @@ bool EditScript(CKLevel *level, const CGameConfig &config, const char *resolvedF
     // Unlock widescreen (Not 4:3)
     if (config.unlockWidescreen)
     {
-        if (!UnlockWidescreen(sm, minWidth))
+        if (!Report(diagnostics, "unlock_widescreen", UnlockWidescreen(resolver, sm, minWidth)))
             CLogger::Get().Warn("Failed to unlock widescreen");
     }
 
     // Unlock high resolution
     if (config.unlockHighResolution)
     {
-        if (!UnlockHighResolution(sm, bbpFilter, minWidth, maxWidth, config.unlockWidescreen))
+        if (!Report(diagnostics, "unlock_high_resolution", UnlockHighResolution(resolver, sm, bbpFilter, minWidth, maxWidth, config.unlockWidescreen)))
             CLogger::Get().Warn("Failed to unlock high resolution");
     }
 
-    CKBehavior *sts = scriptutils::GetBehavior(defaultLevel, "Synch to Screen");
-    if (!sts)
+    CKBehavior *sts = resolver.GetBehavior("Synch to Screen", defaultLevel, "Synch to Screen");
+    if (!Report(diagnostics, "synch_to_screen", sts != NULL))
     {
         CLogger::Get().Warn("Unable to find script Synch to Screen");
         return false;
@@ -489,20 +771,53 @@ bool EditScript(CKLevel *level, const CGameConfig &config, const char *resolvedF
     // Unlock frame rate limitation
     if (config.unlockFramerate)
     {
-        if (!UnlockFramerate(sts))
+        if (!Report(diagnostics, "unlock_framerate", UnlockFramerate(sts)))
             CLogger::Get().Warn("Failed to unlock frame rate limitation");
     }
 
     // Make it not to test 640x480 resolution
-    if (!SkipResolutionCheck(sts))
+    if (!Report(diagnostics, "skip_resolution_check", SkipResolutionCheck(resolver, sts)))
         CLogger::Get().Warn("Failed to bypass 640x480 resolution test");
 
     // Skip Opening Animation
     if (config.skipOpening)
     {
-        if (!SkipOpeningAnimation(defaultLevel, sts))
+        if (!Report(diagnostics, "skip_opening", SkipOpeningAnimation(resolver, defaultLevel, sts)))
             CLogger::Get().Warn("Failed to skip opening animation");
     }
 
     return true;
 }
+
+// Patches the scripts of the loaded composition. With a plan, the objects it
+// recorded for the same file and flags are patched by ID, once it is confirmed
+// they are all still there; whatever the plan lacks is searched and added to it.
+// The outcome of each step goes to the diagnostics of the load, when given.
+bool EditScript(CKLevel *level, const CGameConfig &config, const char *resolvedFile, CHotfixPlan *plan, platform::uint32 compositionKey,
+                CLoadDiagnostics *diagnostics)
+{
+    if (!level || !resolvedFile || !*resolvedFile)
+        return false;
+
+    CKContext *context = level->GetCKContext();
+    if (plan)
+    {
+        const platform::uint32 flags = GetHotfixPlanFlags(config);
+        CContextObjectLookup lookup(context);
+        std::string staleKey;
+        if (!plan->Matches(compositionKey, flags))
+        {
+            plan->Reset(compositionKey, flags);
+        }
+        else if (!plan->Validate(lookup, &staleKey))
+        {
+            CLogger::Get().Debug("Hotfix plan no longer matches %s, searching the scripts.", staleKey.c_str());
+            plan->Reset(compositionKey, flags);
+        }
+    }
+
+    CHotfixResolver resolver(context, plan);
+    const bool result = ApplyPatches(resolver, level, config, resolvedFile, diagnostics);
+    CLogger::Get().Debug("Hotfixes found %d objects by ID and searched for %d.", resolver.GetPlanned(), resolver.GetSearched());
+    return result;
+}
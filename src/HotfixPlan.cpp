@@ -0,0 +1,269 @@
+#include "HotfixPlan.h"
+
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+    const char PLAN_MAGIC[] = "BallancePlayerHotfixPlan";
+
+    bool ParseHex32(const std::string &text, platform::uint32 &value)
+    {
+        if (text.empty() || text.size() > 8)
+            return false;
+
+        platform::uint32 result = 0;
+        size_t i;
+        for (i = 0; i < text.size(); ++i)
+        {
+            char c = text[i];
+            int digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+            else
+                return false;
+            result = (result << 4) | (platform::uint32)digit;
+        }
+        value = result;
+        return true;
+    }
+
+    void AppendHex32(std::string &text, platform::uint32 value)
+    {
+        char buffer[16];
+        sprintf(buffer, "%08x", (unsigned int)value);
+        text += buffer;
+    }
+
+    void SplitFields(const std::string &line, std::vector<std::string> &fields)
+    {
+        fields.clear();
+        size_t start = 0;
+        for (;;)
+        {
+            size_t tab = line.find('\t', start);
+            if (tab == std::string::npos)
+            {
+                fields.push_back(line.substr(start));
+                return;
+            }
+            fields.push_back(line.substr(start, tab - start));
+            start = tab + 1;
+        }
+    }
+
+    bool IsStorable(const std::string &text)
+    {
+        return text.find_first_of("\t\r\n") == std::string::npos;
+    }
+
+    char KindToChar(int kind)
+    {
+        return kind == HOTFIX_SITE_LINK ? 'l' : 'b';
+    }
+
+    bool ParseKind(const std::string &text, int &kind)
+    {
+        if (text == "b")
+            kind = HOTFIX_SITE_BEHAVIOR;
+        else if (text == "l")
+            kind = HOTFIX_SITE_LINK;
+        else
+            return false;
+        return true;
+    }
+}
+
+void CHotfixPlan::Reset(platform::uint32 key, platform::uint32 flags)
+{
+    m_Sites.clear();
+    m_Key = key;
+    m_Flags = flags;
+    m_Modified = true;
+}
+
+bool CHotfixPlan::Record(const HotfixPlanSite &site)
+{
+    if (site.key.empty() || site.id == 0)
+        return false;
+    if (site.kind != HOTFIX_SITE_BEHAVIOR && site.kind != HOTFIX_SITE_LINK)
+        return false;
+    if (!IsStorable(site.key) || !IsStorable(site.name))
+        return false;
+
+    m_Sites[site.key] = site;
+    m_Modified = true;
+    return true;
+}
+
+const HotfixPlanSite *CHotfixPlan::Find(const char *key) const
+{
+    if (!key)
+        return NULL;
+
+    SiteMap::const_iterator it = m_Sites.find(key);
+    if (it == m_Sites.end())
+        return NULL;
+    return &it->second;
+}
+
+bool CHotfixPlan::Validate(CHotfixObjectLookup &lookup, std::string *staleKey) const
+{
+    for (SiteMap::const_iterator it = m_Sites.begin(); it != m_Sites.end(); ++it)
+    {
+        const HotfixPlanSite &site = it->second;
+        HotfixObjectInfo info;
+        if (!lookup.Describe(site.id, info) ||
+            info.kind != site.kind ||
+            info.owner != site.owner ||
+            info.target != site.target ||
+            info.name != site.name)
+        {
+            if (staleKey)
+                *staleKey = site.key;
+            return false;
+        }
+    }
+    return true;
+}
+
+void CHotfixPlan::Write(std::string &text) const
+{
+    char buffer[32];
+    sprintf(buffer, " %d\n", (int)VERSION);
+    text = PLAN_MAGIC;
+    text += buffer;
+
+    AppendHex32(text, m_Key);
+    text += '\t';
+    AppendHex32(text, m_Flags);
+    text += '\n';
+
+    for (SiteMap::const_iterator it = m_Sites.begin(); it != m_Sites.end(); ++it)
+    {
+        const HotfixPlanSite &site = it->second;
+        text += KindToChar(site.kind);
+        text += '\t';
+        AppendHex32(text, site.id);
+        text += '\t';
+        AppendHex32(text, site.owner);
+        text += '\t';
+        AppendHex32(text, site.target);
+        text += '\t';
+        text += site.key;
+        text += '\t';
+        text += site.name;
+        text += '\n';
+    }
+}
+
+bool CHotfixPlan::Read(const std::string &text)
+{
+    m_Sites.clear();
+    m_Key = 0;
+    m_Flags = 0;
+    m_Modified = false;
+
+    char buffer[32];
+    sprintf(buffer, " %d", (int)VERSION);
+    const std::string header = std::string(PLAN_MAGIC) + buffer;
+
+    SiteMap sites;
+    platform::uint32 key = 0;
+    platform::uint32 flags = 0;
+    std::vector<std::string> fields;
+    int lineNumber = 0;
+    size_t start = 0;
+    while (start < text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+
+        ++lineNumber;
+        if (lineNumber == 1)
+        {
+            if (line != header)
+                return false;
+            continue;
+        }
+
+        SplitFields(line, fields);
+        if (lineNumber == 2)
+        {
+            if (fields.size() != 2 || !ParseHex32(fields[0], key) || !ParseHex32(fields[1], flags))
+                return false;
+            continue;
+        }
+
+        if (line.empty())
+            continue;
+
+        HotfixPlanSite site;
+        if (fields.size() != 6 ||
+            !ParseKind(fields[0], site.kind) ||
+            !ParseHex32(fields[1], site.id) ||
+            !ParseHex32(fields[2], site.owner) ||
+            !ParseHex32(fields[3], site.target) ||
+            fields[4].empty() || site.id == 0)
+            return false;
+        site.key = fields[4];
+        site.name = fields[5];
+        sites[site.key] = site;
+    }
+
+    if (lineNumber < 2)
+        return false;
+
+    m_Sites.swap(sites);
+    m_Key = key;
+    m_Flags = flags;
+    return true;
+}
+
+bool CHotfixPlan::Load(const char *filename)
+{
+    m_Sites.clear();
+    if (!filename || !*filename)
+        return false;
+
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+        return false;
+
+    std::string text;
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.append(buffer, read);
+    fclose(file);
+
+    return Read(text);
+}
+
+bool CHotfixPlan::Save(const char *filename) const
+{
+    if (!filename || !*filename)
+        return false;
+
+    std::string text;
+    Write(text);
+
+    FILE *file = fopen(filename, "wb");
+    if (!file)
+        return false;
+
+    bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (fclose(file) != 0)
+        ok = false;
+    return ok;
+}
@@ -0,0 +1,99 @@
+#ifndef PLAYER_HOTFIXPLAN_H
+#define PLAYER_HOTFIXPLAN_H
+
+#include <map>
+#include <string>
+
+#include "Platform.h"
+
+enum HotfixSiteKind
+{
+    HOTFIX_SITE_BEHAVIOR = 1,
+    HOTFIX_SITE_LINK = 2
+};
+
+// An object a hotfix patches, as the script search found it.
+struct HotfixPlanSite
+{
+    std::string key;        // names the lookup, e.g. "Screen Modes/TT List Driver"
+    int kind;               // HotfixSiteKind
+    platform::uint32 id;    // CK_ID
+    platform::uint32 owner; // behavior: parent script; link: behavior of the input end
+    platform::uint32 target; // link: behavior of the output end; 0 for a behavior
+    std::string name;       // behavior name; empty for a link
+
+    HotfixPlanSite() : kind(0), id(0), owner(0), target(0) {}
+};
+
+// What the loaded composition holds under an ID, in the terms of a site.
+struct HotfixObjectInfo
+{
+    int kind;
+    platform::uint32 owner;
+    platform::uint32 target;
+    std::string name;
+
+    HotfixObjectInfo() : kind(0), owner(0), target(0) {}
+};
+
+// Describes loaded objects so a plan can be checked without the engine in tests.
+class CHotfixObjectLookup
+{
+public:
+    virtual ~CHotfixObjectLookup() {}
+
+    // Returns false if there is no behavior or link with the ID.
+    virtual bool Describe(platform::uint32 id, HotfixObjectInfo &info) = 0;
+};
+
+// The objects the hotfixes patched on a previous load of a composition, so the
+// next load of the same file can patch them by ID instead of searching the scripts.
+//
+// A plan belongs to a key of the composition file, derived from its size and
+// modification time, and to the config flags that select the patches. It is only used after Validate() confirmed that every site
+// still names the same kind of object with the same name and ends; a plan that
+// fails is discarded and the scripts are searched again.
+class CHotfixPlan
+{
+public:
+    enum { VERSION = 2 };
+
+    CHotfixPlan() : m_Key(0), m_Flags(0), m_Modified(false) {}
+
+    // Drops every site and starts a plan for the composition and flags.
+    void Reset(platform::uint32 key, platform::uint32 flags);
+
+    bool Matches(platform::uint32 key, platform::uint32 flags) const { return m_Key == key && m_Flags == flags; }
+    platform::uint32 GetKey() const { return m_Key; }
+    platform::uint32 GetFlags() const { return m_Flags; }
+
+    // Adds or replaces the site of the key. Returns false for a site that cannot
+    // be stored: no key or ID, an unknown kind, or a tab or line break in the text.
+    bool Record(const HotfixPlanSite &site);
+
+    const HotfixPlanSite *Find(const char *key) const;
+    int GetSiteCount() const { return (int)m_Sites.size(); }
+
+    // True once sites were recorded or the plan was reset since it was read.
+    bool IsModified() const { return m_Modified; }
+
+    // Returns false, with the key of the first stale site if asked, when any site
+    // no longer matches the loaded objects.
+    bool Validate(CHotfixObjectLookup &lookup, std::string *staleKey = NULL) const;
+
+    void Write(std::string &text) const;
+    bool Read(const std::string &text);
+
+    bool Load(const char *filename);
+    bool Save(const char *filename) const;
+
+private:
+    typedef std::map<std::string, HotfixPlanSite> SiteMap;
+
+    SiteMap m_Sites;
+    platform::uint32 m_Key;
+    platform::uint32 m_Flags;
+    bool m_Modified;
+};
+
+#endif // PLAYER_HOTFIXPLAN_H
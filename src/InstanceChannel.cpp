@@ -0,0 +1,546 @@
+#include "InstanceChannel.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef PIPE_REJECT_REMOTE_CLIENTS
+#define PIPE_REJECT_REMOTE_CLIENTS 0x00000008
+#endif
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // "BPIC" read as a little-endian value.
+    const platform::uint32 FRAME_MAGIC = 0x43495042;
+
+    enum { RETRY_INTERVAL_MS = 20 };
+
+    void PutU32(std::string &out, platform::uint32 value)
+    {
+        out += (char)(value & 0xFF);
+        out += (char)((value >> 8) & 0xFF);
+        out += (char)((value >> 16) & 0xFF);
+        out += (char)((value >> 24) & 0xFF);
+    }
+
+    platform::uint32 GetU32(const char *p)
+    {
+        const unsigned char *b = (const unsigned char *)p;
+        return (platform::uint32)b[0] | ((platform::uint32)b[1] << 8) |
+               ((platform::uint32)b[2] << 16) | ((platform::uint32)b[3] << 24);
+    }
+
+    // Milliseconds left until the deadline, 0 once it passed.
+    unsigned long GetRemainingMs(platform::uint64 deadline)
+    {
+        const platform::uint64 now = platform::GetTimeMicros();
+        return (now < deadline) ? (unsigned long)((deadline - now + 999) / 1000) : 0;
+    }
+
+#ifdef _WIN32
+    std::string GetPipePath(const char *name)
+    {
+        return std::string("\\\\.\\pipe\\") + name;
+    }
+#else
+    // An abstract socket address: it disappears with the last socket bound to
+    // it, so a crashed player leaves nothing behind to clean up.
+    bool MakeAddress(const char *name, sockaddr_un &address, socklen_t &length)
+    {
+        const size_t size = strlen(name);
+        memset(&address, 0, sizeof(address));
+        if (size == 0 || size + 1 > sizeof(address.sun_path))
+            return false;
+        address.sun_family = AF_UNIX;
+        memcpy(address.sun_path + 1, name, size);
+        length = (socklen_t)(offsetof(sockaddr_un, sun_path) + 1 + size);
+        return true;
+    }
+#endif
+}
+
+CInstanceMessageReader::CInstanceMessageReader() : m_Offset(0), m_Error(false) {}
+
+void CInstanceMessageReader::Reset()
+{
+    m_Buffer.clear();
+    m_Offset = 0;
+    m_Error = false;
+}
+
+bool CInstanceMessageReader::Feed(const char *data, size_t size)
+{
+    if (m_Error)
+        return false;
+
+    if (m_Offset > 0 && m_Offset * 2 >= m_Buffer.size())
+    {
+        m_Buffer.erase(0, m_Offset);
+        m_Offset = 0;
+    }
+    if (data && size > 0)
+        m_Buffer.append(data, size);
+
+    // Catch a bad header as soon as it is complete rather than after the whole stream.
+    if (GetPendingSize() >= HEADER_SIZE)
+    {
+        const char *header = m_Buffer.data() + m_Offset;
+        if (GetU32(header) != FRAME_MAGIC || GetU32(header + 8) > MAX_PAYLOAD_SIZE)
+            m_Error = true;
+    }
+    return !m_Error;
+}
+
+bool CInstanceMessageReader::Next(InstanceMessage &message)
+{
+    if (m_Error || GetPendingSize() < HEADER_SIZE)
+        return false;
+
+    const char *header = m_Buffer.data() + m_Offset;
+    const platform::uint32 length = GetU32(header + 8);
+    if (GetU32(header) != FRAME_MAGIC || length > MAX_PAYLOAD_SIZE)
+    {
+        m_Error = true;
+        return false;
+    }
+    if (GetPendingSize() < HEADER_SIZE + (size_t)length)
+        return false;
+
+    message.type = GetU32(header + 4);
+    message.payload.assign(header + HEADER_SIZE, length);
+    m_Offset += HEADER_SIZE + length;
+    return true;
+}
+
+CInstanceChannel::CInstanceChannel()
+    :
+#ifdef _WIN32
+      m_Pipe(NULL),
+      m_StopEvent(NULL),
+      m_IoEvent(NULL),
+#else
+      m_Socket(-1),
+      m_Client(-1),
+      m_WakeRead(-1),
+      m_WakeWrite(-1),
+#endif
+      m_Callback(NULL),
+      m_UserData(NULL),
+      m_Stopping(0),
+      m_Rejected(0)
+{
+}
+
+CInstanceChannel::~CInstanceChannel()
+{
+    Close();
+}
+
+void CInstanceChannel::SetCallback(MessageCallback callback, void *userData)
+{
+    CMutexLock lock(m_Mutex);
+    m_Callback = callback;
+    m_UserData = userData;
+}
+
+bool CInstanceChannel::Encode(const InstanceMessage &message, std::string &frame)
+{
+    if (message.payload.size() > CInstanceMessageReader::MAX_PAYLOAD_SIZE)
+        return false;
+
+    frame.clear();
+    frame.reserve(CInstanceMessageReader::HEADER_SIZE + message.payload.size());
+    PutU32(frame, FRAME_MAGIC);
+    PutU32(frame, message.type);
+    PutU32(frame, (platform::uint32)message.payload.size());
+    frame += message.payload;
+    return true;
+}
+
+size_t CInstanceChannel::TakeMessages(std::vector<InstanceMessage> &messages)
+{
+    CMutexLock lock(m_Mutex);
+    const size_t count = m_Queue.size();
+    messages.insert(messages.end(), m_Queue.begin(), m_Queue.end());
+    m_Queue.clear();
+    return count;
+}
+
+void CInstanceChannel::ListenThread(void *arg)
+{
+    ((CInstanceChannel *)arg)->Serve();
+}
+
+void CInstanceChannel::Deliver(CInstanceMessageReader &reader)
+{
+    // A sender that breaks the framing is not trusted with any of what it sent.
+    std::vector<InstanceMessage> messages;
+    InstanceMessage message;
+    while (reader.Next(message))
+        messages.push_back(message);
+    if (reader.HasError())
+    {
+        platform::AtomicIncrement(&m_Rejected);
+        return;
+    }
+    if (messages.empty())
+        return;
+
+    MessageCallback callback;
+    void *userData;
+    {
+        CMutexLock lock(m_Mutex);
+        m_Queue.insert(m_Queue.end(), messages.begin(), messages.end());
+        callback = m_Callback;
+        userData = m_UserData;
+    }
+    if (callback)
+        callback(userData);
+}
+
+#ifdef _WIN32
+
+bool CInstanceChannel::Listen(const char *name)
+{
+    Close();
+    if (!name || !*name)
+        return false;
+
+    // One pipe instance, created first or not at all: whoever holds it is the running player.
+    const std::string path = GetPipePath(name);
+    HANDLE pipe = ::CreateNamedPipeA(path.c_str(),
+                                     PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                                     PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                     1, 0, 4096, 0, NULL);
+    if (pipe == INVALID_HANDLE_VALUE)
+        return false;
+
+    m_Pipe = pipe;
+    m_StopEvent = ::CreateEventA(NULL, TRUE, FALSE, NULL);
+    m_IoEvent = ::CreateEventA(NULL, TRUE, FALSE, NULL);
+    platform::AtomicStore(&m_Stopping, 0);
+    if (!m_StopEvent || !m_IoEvent || !m_Thread.Start(ListenThread, this))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void CInstanceChannel::Close()
+{
+    platform::AtomicStore(&m_Stopping, 1);
+    if (m_StopEvent)
+        ::SetEvent(m_StopEvent);
+    m_Thread.Join();
+
+    if (m_Pipe)
+    {
+        ::CloseHandle(m_Pipe);
+        m_Pipe = NULL;
+    }
+    if (m_StopEvent)
+    {
+        ::CloseHandle(m_StopEvent);
+        m_StopEvent = NULL;
+    }
+    if (m_IoEvent)
+    {
+        ::CloseHandle(m_IoEvent);
+        m_IoEvent = NULL;
+    }
+}
+
+void CInstanceChannel::Serve()
+{
+    HANDLE handles[2] = {m_IoEvent, m_StopEvent};
+    while (!platform::AtomicLoad(&m_Stopping))
+    {
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.hEvent = m_IoEvent;
+        ::ResetEvent(m_IoEvent);
+
+        DWORD error = ::ConnectNamedPipe(m_Pipe, &overlapped) ? ERROR_PIPE_CONNECTED : ::GetLastError();
+        if (error == ERROR_IO_PENDING)
+        {
+            DWORD transferred = 0;
+            if (::WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0)
+            {
+                ::CancelIo(m_Pipe);
+                ::GetOverlappedResult(m_Pipe, &overlapped, &transferred, TRUE);
+                break;
+            }
+            error = ::GetOverlappedResult(m_Pipe, &overlapped, &transferred, FALSE) ? ERROR_PIPE_CONNECTED : ::GetLastError();
+        }
+
+        if (error == ERROR_PIPE_CONNECTED)
+        {
+            CInstanceMessageReader reader;
+            ReadClient(reader);
+            Deliver(reader);
+        }
+        else
+        {
+            // A sender that gave up between connecting and being seen; wait a little
+            // before trying again so a persistent error cannot spin the thread.
+            if (::WaitForSingleObject(m_StopEvent, RETRY_INTERVAL_MS) == WAIT_OBJECT_0)
+                break;
+        }
+        ::DisconnectNamedPipe(m_Pipe);
+    }
+}
+
+void CInstanceChannel::ReadClient(CInstanceMessageReader &reader)
+{
+    HANDLE handles[2] = {m_IoEvent, m_StopEvent};
+    char buffer[4096];
+    for (;;)
+    {
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.hEvent = m_IoEvent;
+        ::ResetEvent(m_IoEvent);
+
+        DWORD read = 0;
+        if (!::ReadFile(m_Pipe, buffer, sizeof(buffer), &read, &overlapped))
+        {
+            // ERROR_BROKEN_PIPE: the sender wrote everything and closed its end.
+            if (::GetLastError() != ERROR_IO_PENDING)
+                return;
+            if (::WaitForMultipleObjects(2, handles, FALSE, READ_TIMEOUT_MS) != WAIT_OBJECT_0)
+            {
+                ::CancelIo(m_Pipe);
+                ::GetOverlappedResult(m_Pipe, &overlapped, &read, TRUE);
+                return;
+            }
+            if (!::GetOverlappedResult(m_Pipe, &overlapped, &read, FALSE))
+                return;
+        }
+        if (!reader.Feed(buffer, read))
+            return;
+    }
+}
+
+bool CInstanceChannel::Send(const char *name, const InstanceMessage &message, unsigned long timeoutMs)
+{
+    std::string frame;
+    if (!name || !*name || !Encode(message, frame))
+        return false;
+
+    const std::string path = GetPipePath(name);
+    const platform::uint64 deadline = platform::GetTimeMicros() + (platform::uint64)timeoutMs * 1000;
+    HANDLE pipe;
+    for (;;)
+    {
+        pipe = ::CreateFileA(path.c_str(), GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+        if (pipe != INVALID_HANDLE_VALUE)
+            break;
+
+        const DWORD error = ::GetLastError();
+        const unsigned long remaining = GetRemainingMs(deadline);
+        if (remaining == 0)
+            return false;
+        if (error == ERROR_PIPE_BUSY)
+            ::WaitNamedPipeA(path.c_str(), remaining);
+        else if (error == ERROR_FILE_NOT_FOUND)
+            platform::SleepMs(remaining < (unsigned long)RETRY_INTERVAL_MS ? remaining : (unsigned long)RETRY_INTERVAL_MS);
+        else
+            return false;
+    }
+
+    const char *data = frame.data();
+    size_t left = frame.size();
+    while (left > 0)
+    {
+        DWORD written = 0;
+        if (!::WriteFile(pipe, data, (DWORD)left, &written, NULL) || written == 0)
+            break;
+        data += written;
+        left -= written;
+    }
+    ::CloseHandle(pipe);
+    return left == 0;
+}
+
+#else
+
+bool CInstanceChannel::Listen(const char *name)
+{
+    Close();
+
+    sockaddr_un address;
+    socklen_t length;
+    if (!name || !MakeAddress(name, address, length))
+        return false;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    // Binding fails while another instance holds the address.
+    if (::bind(fd, (const sockaddr *)&address, length) != 0 || ::listen(fd, 8) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    int wake[2];
+    if (::pipe(wake) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    ::fcntl(wake[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(wake[1], F_SETFD, FD_CLOEXEC);
+
+    m_Socket = fd;
+    m_WakeRead = wake[0];
+    m_WakeWrite = wake[1];
+    platform::AtomicStore(&m_Stopping, 0);
+    if (!m_Thread.Start(ListenThread, this))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void CInstanceChannel::Close()
+{
+    platform::AtomicStore(&m_Stopping, 1);
+    if (m_WakeWrite >= 0)
+    {
+        const char wake = 1;
+        while (::write(m_WakeWrite, &wake, 1) < 0 && errno == EINTR)
+            continue;
+    }
+    m_Thread.Join();
+
+    if (m_Socket >= 0)
+        ::close(m_Socket);
+    if (m_WakeRead >= 0)
+        ::close(m_WakeRead);
+    if (m_WakeWrite >= 0)
+        ::close(m_WakeWrite);
+    m_Socket = -1;
+    m_WakeRead = -1;
+    m_WakeWrite = -1;
+}
+
+void CInstanceChannel::Serve()
+{
+    while (!platform::AtomicLoad(&m_Stopping))
+    {
+        pollfd fds[2];
+        fds[0].fd = m_Socket;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = m_WakeRead;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[1].revents != 0)
+            break;
+        if ((fds[0].revents & POLLIN) == 0)
+            continue;
+
+        m_Client = ::accept(m_Socket, NULL, NULL);
+        if (m_Client < 0)
+            continue;
+
+        CInstanceMessageReader reader;
+        ReadClient(reader);
+        ::close(m_Client);
+        m_Client = -1;
+        Deliver(reader);
+    }
+}
+
+void CInstanceChannel::ReadClient(CInstanceMessageReader &reader)
+{
+    char buffer[4096];
+    for (;;)
+    {
+        pollfd fds[2];
+        fds[0].fd = m_Client;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = m_WakeRead;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        const int ready = ::poll(fds, 2, READ_TIMEOUT_MS);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready <= 0 || fds[1].revents != 0)
+            return;
+
+        const ssize_t received = ::recv(m_Client, buffer, sizeof(buffer), 0);
+        if (received < 0 && errno == EINTR)
+            continue;
+        // 0: the sender wrote everything and closed its end.
+        if (received <= 0 || !reader.Feed(buffer, (size_t)received))
+            return;
+    }
+}
+
+bool CInstanceChannel::Send(const char *name, const InstanceMessage &message, unsigned long timeoutMs)
+{
+    std::string frame;
+    sockaddr_un address;
+    socklen_t length;
+    if (!name || !MakeAddress(name, address, length) || !Encode(message, frame))
+        return false;
+
+    const platform::uint64 deadline = platform::GetTimeMicros() + (platform::uint64)timeoutMs * 1000;
+    int fd;
+    for (;;)
+    {
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return false;
+        if (::connect(fd, (const sockaddr *)&address, length) == 0)
+            break;
+
+        const int error = errno;
+        ::close(fd);
+        const unsigned long remaining = GetRemainingMs(deadline);
+        if (remaining == 0)
+            return false;
+        // Nobody listening yet, or the backlog is full.
+        if (error != ECONNREFUSED && error != EAGAIN && error != ENOENT && error != EINTR)
+            return false;
+        platform::SleepMs(remaining < (unsigned long)RETRY_INTERVAL_MS ? remaining : (unsigned long)RETRY_INTERVAL_MS);
+    }
+
+    const char *data = frame.data();
+    size_t left = frame.size();
+    while (left > 0)
+    {
+        const ssize_t sent = ::send(fd, data, left, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent <= 0)
+            break;
+        data += sent;
+        left -= (size_t)sent;
+    }
+    ::close(fd);
+    return left == 0;
+}
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef PLAYER_INSTANCECHANNEL_H
+#define PLAYER_INSTANCECHANNEL_H
+
+#include <string>
+#include <vector>
+
+#include "Thread.h"
+
+enum InstanceMessageType
+{
+    // The payload is the command line of a second launch.
+    eInstanceCommandLine = 1,
+};
+
+struct InstanceMessage
+{
+    platform::uint32 type;
+    std::string payload;
+};
+
+// Splits a byte stream back into the messages CInstanceChannel::Encode() framed.
+// A frame is a 12-byte header, the magic, the type and the payload length as
+// little-endian 32-bit values, followed by the payload.
+class CInstanceMessageReader
+{
+public:
+    enum
+    {
+        HEADER_SIZE = 12,
+        MAX_PAYLOAD_SIZE = 32768
+    };
+
+    CInstanceMessageReader();
+
+    // Returns false once the stream turned out not to be framed messages; the
+    // rest of it is then ignored.
+    bool Feed(const char *data, size_t size);
+
+    // Takes the next complete message, if any.
+    bool Next(InstanceMessage &message);
+
+    bool HasError() const { return m_Error; }
+
+    // Bytes of an incomplete message still waiting for the rest.
+    size_t GetPendingSize() const { return m_Buffer.size() - m_Offset; }
+
+    void Reset();
+
+private:
+    std::string m_Buffer;
+    size_t m_Offset;
+    bool m_Error;
+};
+
+// Lets the first player of an installation hear from the ones started after it.
+//
+// The first instance claims the channel with Listen(); a named pipe on Windows,
+// an abstract Unix domain socket elsewhere. Later instances find it taken, Send()
+// their command line to it and exit. The listener waits for connections on a
+// thread of its own, queues what arrives and calls back, so the owner only has
+// to wake up and TakeMessages().
+class CInstanceChannel
+{
+public:
+    typedef void (*MessageCallback)(void *userData);
+
+    enum
+    {
+        // How long a connected sender may stay silent before it is dropped.
+        READ_TIMEOUT_MS = 1000
+    };
+
+    CInstanceChannel();
+    ~CInstanceChannel();
+
+    // Fails if another process already listens on the channel.
+    bool Listen(const char *name);
+    void Close();
+    bool IsListening() const { return m_Thread.IsStarted(); }
+
+    // Called on the listener thread after new messages were queued. NULL stops the calls.
+    void SetCallback(MessageCallback callback, void *userData);
+
+    // Moves the queued messages to the end of the vector and returns how many there were.
+    size_t TakeMessages(std::vector<InstanceMessage> &messages);
+
+    // Connections dropped for sending something other than framed messages.
+    int GetRejectedCount() const { return (int)platform::AtomicLoad(&m_Rejected); }
+
+    // Sends one message to the instance listening on the channel, waiting up to
+    // timeoutMs for it to start listening or to become free.
+    static bool Send(const char *name, const InstanceMessage &message, unsigned long timeoutMs);
+
+    static bool Encode(const InstanceMessage &message, std::string &frame);
+
+private:
+    CInstanceChannel(const CInstanceChannel &);
+    CInstanceChannel &operator=(const CInstanceChannel &);
+
+    static void ListenThread(void *arg);
+    void Serve();
+    void ReadClient(CInstanceMessageReader &reader);
+    void Deliver(CInstanceMessageReader &reader);
+
+#ifdef _WIN32
+    HANDLE m_Pipe;
+    HANDLE m_StopEvent;
+    HANDLE m_IoEvent;
+#else
+    int m_Socket;
+    int m_Client;
+    int m_WakeRead;
+    int m_WakeWrite;
+#endif
+    CThread m_Thread;
+    CMutex m_Mutex;
+    std::vector<InstanceMessage> m_Queue;
+    MessageCallback m_Callback;
+    void *m_UserData;
+    volatile long m_Stopping;
+    volatile long m_Rejected;
+};
+
+#endif // PLAYER_INSTANCECHANNEL_H
@@ -0,0 +1,60 @@
+#include "JsonText.h"
+
+namespace jsontext
+{
+    size_t Escape(unsigned char c, char escape[MAX_ESCAPE_LENGTH])
+    {
+        static const char HEX[] = "0123456789abcdef";
+
+        if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\')
+            return 0;
+
+        escape[0] = '\\';
+        switch (c)
+        {
+        case '"':
+            escape[1] = '"';
+            return 2;
+        case '\\':
+            escape[1] = '\\';
+            return 2;
+        case '\n':
+            escape[1] = 'n';
+            return 2;
+        case '\r':
+            escape[1] = 'r';
+            return 2;
+        case '\t':
+            escape[1] = 't';
+            return 2;
+        default:
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = HEX[c >> 4];
+            escape[5] = HEX[c & 15];
+            return 6;
+        }
+    }
+
+    void AppendString(std::string &json, const std::string &text)
+    {
+        json += '"';
+        size_t run = 0;
+        size_t i;
+        for (i = 0; i < text.size(); ++i)
+        {
+            char escape[MAX_ESCAPE_LENGTH];
+            const size_t length = Escape((unsigned char)text[i], escape);
+            if (length == 0)
+                continue;
+
+            // Copies the plain characters before the one that needs escaping in one go.
+            json.append(text, run, i - run);
+            json.append(escape, length);
+            run = i + 1;
+        }
+        json.append(text, run, text.size() - run);
+        json += '"';
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef PLAYER_JSONTEXT_H
+#define PLAYER_JSONTEXT_H
+
+#include <stddef.h>
+#include <string>
+
+// String escaping shared by the JSON writers (batch reports, load diagnostics).
+namespace jsontext
+{
+    enum { MAX_ESCAPE_LENGTH = 6 };
+
+    // Writes the escape sequence of a byte that may not appear as is inside a JSON
+    // string and returns its length, or returns 0 for a byte copied unchanged. Bytes
+    // from 0x80 up are escaped as the code point of the same value: paths come in the
+    // ANSI code page, which is not always valid UTF-8.
+    size_t Escape(unsigned char c, char escape[MAX_ESCAPE_LENGTH]);
+
+    // Appends the text as a quoted JSON string.
+    void AppendString(std::string &json, const std::string &text);
+}
+
+#endif // PLAYER_JSONTEXT_H
@@ -0,0 +1,173 @@
+#include "LatencyProbe.h"
+
+#include <stdio.h>
+#include <string.h>
+
+CLatencyHistogram::CLatencyHistogram()
+{
+    Clear();
+}
+
+void CLatencyHistogram::Clear()
+{
+    memset(m_Buckets, 0, sizeof(m_Buckets));
+    m_Count = 0;
+    m_Sum = 0;
+    m_Min = 0;
+    m_Max = 0;
+}
+
+void CLatencyHistogram::Add(platform::uint64 latencyUs)
+{
+    platform::uint64 bucket = latencyUs / BUCKET_WIDTH_US;
+    if (bucket >= BUCKET_COUNT)
+        bucket = BUCKET_COUNT - 1;
+    ++m_Buckets[(int)bucket];
+
+    if (m_Count == 0 || latencyUs < m_Min)
+        m_Min = latencyUs;
+    if (latencyUs > m_Max)
+        m_Max = latencyUs;
+    m_Sum += latencyUs;
+    ++m_Count;
+}
+
+platform::uint64 CLatencyHistogram::GetPercentile(int percentile) const
+{
+    if (m_Count == 0)
+        return 0;
+    if (percentile < 0)
+        percentile = 0;
+    if (percentile > 100)
+        percentile = 100;
+
+    // Rank of the sample, rounded up so p100 is the last one.
+    unsigned long rank = (unsigned long)(((platform::uint64)m_Count * percentile + 99) / 100);
+    if (rank == 0)
+        rank = 1;
+
+    unsigned long seen = 0;
+    int i;
+    for (i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += m_Buckets[i];
+        if (seen >= rank)
+            break;
+    }
+
+    platform::uint64 upper = (platform::uint64)(i + 1) * BUCKET_WIDTH_US;
+    return upper < m_Max ? upper : m_Max;
+}
+
+CLatencyProbe::CLatencyProbe() : m_ProcessedCount(0), m_Dropped(0) {}
+
+void CLatencyProbe::Reset()
+{
+    InputStamp stamp;
+    while (m_Inputs.TryPop(stamp))
+        continue;
+    m_ProcessedCount = 0;
+    m_Dropped = 0;
+
+    int i;
+    for (i = 0; i < eLatencyEventKindCount; ++i)
+    {
+        m_ProcessLatency[i].Clear();
+        m_RenderLatency[i].Clear();
+    }
+}
+
+bool CLatencyProbe::RecordInput(LatencyEventKind kind, platform::uint64 time)
+{
+    if (kind < 0 || kind >= eLatencyEventKindCount)
+        return false;
+
+    InputStamp stamp;
+    stamp.kind = kind;
+    stamp.inputTime = time;
+    stamp.processTime = 0;
+    if (!m_Inputs.TryPush(stamp))
+    {
+        ++m_Dropped;
+        return false;
+    }
+    return true;
+}
+
+void CLatencyProbe::OnProcess(platform::uint64 time)
+{
+    InputStamp stamp;
+    while (m_Inputs.TryPop(stamp))
+    {
+        if (m_ProcessedCount >= INPUT_CAPACITY)
+        {
+            ++m_Dropped;
+            continue;
+        }
+
+        // Inputs stamped after this tick began are picked up by the next one.
+        stamp.processTime = (time > stamp.inputTime) ? time : stamp.inputTime;
+        m_Processed[m_ProcessedCount++] = stamp;
+    }
+}
+
+void CLatencyProbe::OnRender(platform::uint64 time)
+{
+    unsigned long i;
+    for (i = 0; i < m_ProcessedCount; ++i)
+    {
+        const InputStamp &stamp = m_Processed[i];
+        platform::uint64 renderTime = (time > stamp.processTime) ? time : stamp.processTime;
+        m_ProcessLatency[stamp.kind].Add(stamp.processTime - stamp.inputTime);
+        m_RenderLatency[stamp.kind].Add(renderTime - stamp.inputTime);
+    }
+    m_ProcessedCount = 0;
+}
+
+unsigned long CLatencyProbe::GetSampleCount() const
+{
+    unsigned long count = 0;
+    int i;
+    for (i = 0; i < eLatencyEventKindCount; ++i)
+        count += m_RenderLatency[i].GetCount();
+    return count;
+}
+
+bool CLatencyProbe::FormatSummary(LatencyEventKind kind, char *buffer, size_t size) const
+{
+    if (!buffer || size == 0 || kind < 0 || kind >= eLatencyEventKindCount)
+        return false;
+
+    const CLatencyHistogram &process = m_ProcessLatency[kind];
+    const CLatencyHistogram &render = m_RenderLatency[kind];
+    if (render.GetCount() == 0)
+    {
+        buffer[0] = '\0';
+        return false;
+    }
+
+    _snprintf(buffer, size,
+              "%s latency (n=%lu): input->process p50 %.2fms p95 %.2fms, "
+              "input->present p50 %.2fms p95 %.2fms p99 %.2fms max %.2fms",
+              GetKindName(kind), render.GetCount(),
+              process.GetPercentile(50) / 1000.0, process.GetPercentile(95) / 1000.0,
+              render.GetPercentile(50) / 1000.0, render.GetPercentile(95) / 1000.0,
+              render.GetPercentile(99) / 1000.0, render.GetMax() / 1000.0);
+    buffer[size - 1] = '\0';
+    return true;
+}
+
+const char *CLatencyProbe::GetKindName(LatencyEventKind kind)
+{
+    switch (kind)
+    {
+    case eLatencyKey:
+        return "Key";
+    case eLatencyMouseButton:
+        return "Mouse button";
+    case eLatencyRawInput:
+        return "Raw input";
+    default:
+        return "Unknown";
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef PLAYER_LATENCYPROBE_H
+#define PLAYER_LATENCYPROBE_H
+
+#include <stddef.h>
+
+#include "Platform.h"
+#include "FrameRing.h"
+
+enum LatencyEventKind
+{
+    eLatencyKey = 0,
+    eLatencyMouseButton,
+    eLatencyRawInput,
+    eLatencyEventKindCount
+};
+
+// Fixed-bucket latency histogram in microseconds.
+class CLatencyHistogram
+{
+public:
+    enum
+    {
+        BUCKET_WIDTH_US = 250,
+        BUCKET_COUNT = 400 // 100 ms, anything above lands in the last bucket
+    };
+
+    CLatencyHistogram();
+
+    void Clear();
+    void Add(platform::uint64 latencyUs);
+
+    unsigned long GetCount() const { return m_Count; }
+    platform::uint64 GetMin() const { return m_Count ? m_Min : 0; }
+    platform::uint64 GetMax() const { return m_Max; }
+    platform::uint64 GetMean() const { return m_Count ? m_Sum / m_Count : 0; }
+
+    // Upper bound of the bucket holding the given percentile (0-100), clamped to the max.
+    platform::uint64 GetPercentile(int percentile) const;
+
+private:
+    unsigned long m_Buckets[BUCKET_COUNT];
+    unsigned long m_Count;
+    platform::uint64 m_Sum;
+    platform::uint64 m_Min;
+    platform::uint64 m_Max;
+};
+
+// Correlates input arrival with the Process() that consumes it and the Render() that shows it.
+//
+// All calls are made from the main thread: inputs are stamped in the window procedure,
+// OnProcess() is called right before the context processes, and OnRender() once the
+// frame that followed has been presented.
+class CLatencyProbe
+{
+public:
+    enum
+    {
+        INPUT_CAPACITY = 256
+    };
+
+    CLatencyProbe();
+
+    void Reset();
+
+    bool RecordInput(LatencyEventKind kind, platform::uint64 time);
+    void OnProcess(platform::uint64 time);
+    void OnRender(platform::uint64 time);
+
+    const CLatencyHistogram &GetProcessLatency(LatencyEventKind kind) const { return m_ProcessLatency[kind]; }
+    const CLatencyHistogram &GetRenderLatency(LatencyEventKind kind) const { return m_RenderLatency[kind]; }
+
+    unsigned long GetPendingCount() const { return (unsigned long)m_Inputs.GetSize() + m_ProcessedCount; }
+    unsigned long GetDroppedCount() const { return m_Dropped; }
+    unsigned long GetSampleCount() const;
+
+    // Writes a one line summary; returns false if the kind has no samples.
+    bool FormatSummary(LatencyEventKind kind, char *buffer, size_t size) const;
+
+    static const char *GetKindName(LatencyEventKind kind);
+
+private:
+    struct InputStamp
+    {
+        int kind;
+        platform::uint64 inputTime;
+        platform::uint64 processTime;
+    };
+
+    FrameRing<InputStamp, INPUT_CAPACITY> m_Inputs;
+    InputStamp m_Processed[INPUT_CAPACITY];
+    unsigned long m_ProcessedCount;
+    unsigned long m_Dropped;
+
+    CLatencyHistogram m_ProcessLatency[eLatencyEventKindCount];
+    CLatencyHistogram m_RenderLatency[eLatencyEventKindCount];
+};
+
+#endif // PLAYER_LATENCYPROBE_H
@@ -0,0 +1,276 @@
+#include "LoadDiagnostics.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "JsonText.h"
+
+bool CDiagnosticsFileSink::Write(const char *data, size_t size)
+{
+    if (m_Filename.empty())
+        return false;
+
+    FILE *file = fopen(m_Filename.c_str(), "ab");
+    if (!file)
+        return false;
+
+    if (m_MaxSize > 0 && fseek(file, 0, SEEK_END) == 0)
+    {
+        const long used = ftell(file);
+        if (used > 0 && (size_t)used + size > (size_t)m_MaxSize)
+        {
+            fclose(file);
+            const std::string previous = m_Filename + ".1";
+            remove(previous.c_str());
+            rename(m_Filename.c_str(), previous.c_str());
+            file = fopen(m_Filename.c_str(), "ab");
+            if (!file)
+                return false;
+        }
+    }
+
+    bool ok = fwrite(data, 1, size, file) == size;
+    if (fclose(file) != 0)
+        ok = false;
+    return ok;
+}
+
+CLoadDiagnostics::CLoadDiagnostics(size_t capacity)
+    : m_Size(0),
+      m_EventStart(0),
+      m_Limit(0),
+      m_Overflow(false),
+      m_Loading(false),
+      m_Clock(platform::GetTimeMicros),
+      m_Sink(NULL),
+      m_LoadStart(0),
+      m_Load(0),
+      m_Events(0),
+      m_Dropped(0)
+{
+    m_Buffer.resize(capacity < (size_t)MIN_CAPACITY ? (size_t)MIN_CAPACITY : capacity);
+}
+
+void CLoadDiagnostics::SetClock(Clock clock)
+{
+    m_Clock = clock ? clock : platform::GetTimeMicros;
+}
+
+void CLoadDiagnostics::BeginLoad(const char *composition)
+{
+    m_Size = 0;
+    m_Events = 0;
+    m_Dropped = 0;
+    m_Loading = true;
+    ++m_Load;
+    m_LoadStart = m_Clock();
+
+    BeginEvent("begin", m_Buffer.size() - END_RESERVE);
+    AppendKey("file");
+    AppendString(composition);
+    EndEvent();
+}
+
+void CLoadDiagnostics::Phase(const char *phase, platform::uint64 durationUs, platform::uint64 bytes)
+{
+    if (!m_Loading)
+        return;
+
+    BeginEvent("phase", m_Buffer.size() - END_RESERVE);
+    AppendKey("phase");
+    AppendString(phase);
+    AppendKey("us");
+    AppendNumber(durationUs);
+    AppendKey("bytes");
+    AppendNumber(bytes);
+    EndEvent();
+}
+
+void CLoadDiagnostics::PathResolved(const char *requested, const char *resolved)
+{
+    if (!m_Loading)
+        return;
+
+    BeginEvent("path", m_Buffer.size() - END_RESERVE);
+    AppendKey("requested");
+    AppendString(requested);
+    AppendKey("resolved");
+    if (resolved)
+        AppendString(resolved);
+    else
+        AppendText("null");
+    EndEvent();
+}
+
+void CLoadDiagnostics::MissingGuids(const platform::uint32 *guids, size_t count)
+{
+    if (!m_Loading || !guids || count == 0)
+        return;
+
+    BeginEvent("missing_guids", m_Buffer.size() - END_RESERVE);
+    AppendKey("count");
+    AppendNumber(count);
+    AppendKey("guids");
+    Append("[", 1);
+    size_t i;
+    for (i = 0; i < count && !m_Overflow; ++i)
+    {
+        // The same "d1,d2" the log has always shown, so the two can be matched up.
+        Append(i == 0 ? "\"" : ",\"", i == 0 ? 1 : 2);
+        AppendHex(guids[2 * i]);
+        Append(",", 1);
+        AppendHex(guids[2 * i + 1]);
+        Append("\"", 1);
+    }
+    Append("]", 1);
+    EndEvent();
+}
+
+void CLoadDiagnostics::Hotfix(const char *step, bool applied)
+{
+    if (!m_Loading)
+        return;
+
+    BeginEvent("hotfix", m_Buffer.size() - END_RESERVE);
+    AppendKey("step");
+    AppendString(step);
+    AppendKey("ok");
+    AppendText(applied ? "true" : "false");
+    EndEvent();
+}
+
+void CLoadDiagnostics::Error(const char *message)
+{
+    if (!m_Loading)
+        return;
+
+    BeginEvent("error", m_Buffer.size() - END_RESERVE);
+    AppendKey("message");
+    AppendString(message);
+    EndEvent();
+}
+
+bool CLoadDiagnostics::EndLoad(bool loaded)
+{
+    if (!m_Loading)
+        return true;
+    m_Loading = false;
+
+    const unsigned long events = m_Events + 1;
+    BeginEvent("end", m_Buffer.size());
+    AppendKey("ok");
+    AppendText(loaded ? "true" : "false");
+    AppendKey("us");
+    AppendNumber(m_Clock() - m_LoadStart);
+    AppendKey("events");
+    AppendNumber(events);
+    AppendKey("dropped");
+    AppendNumber(m_Dropped);
+    EndEvent();
+
+    if (!m_Sink || m_Size == 0)
+        return true;
+    return m_Sink->Write(&m_Buffer[0], m_Size);
+}
+
+void CLoadDiagnostics::BeginEvent(const char *name, size_t limit)
+{
+    m_EventStart = m_Size;
+    m_Limit = limit;
+    m_Overflow = false;
+
+    AppendText("{\"load\":");
+    AppendNumber(m_Load);
+    AppendText(",\"t\":");
+    AppendNumber(m_Clock() - m_LoadStart);
+    AppendText(",\"event\":\"");
+    AppendText(name);
+    Append("\"", 1);
+}
+
+void CLoadDiagnostics::EndEvent()
+{
+    Append("}\n", 2);
+    if (m_Overflow)
+    {
+        m_Size = m_EventStart;
+        ++m_Dropped;
+        return;
+    }
+    ++m_Events;
+}
+
+void CLoadDiagnostics::Append(const char *data, size_t size)
+{
+    if (m_Overflow || size > m_Limit - m_Size)
+    {
+        m_Overflow = true;
+        return;
+    }
+    memcpy(&m_Buffer[m_Size], data, size);
+    m_Size += size;
+}
+
+void CLoadDiagnostics::AppendText(const char *text)
+{
+    Append(text, strlen(text));
+}
+
+void CLoadDiagnostics::AppendNumber(platform::uint64 value)
+{
+    char digits[24];
+    size_t count = sizeof(digits);
+    do
+    {
+        digits[--count] = (char)('0' + (int)(value % 10));
+        value /= 10;
+    } while (value != 0);
+    Append(digits + count, sizeof(digits) - count);
+}
+
+void CLoadDiagnostics::AppendHex(platform::uint32 value)
+{
+    static const char HEX[] = "0123456789abcdef";
+    char digits[8];
+    size_t count = sizeof(digits);
+    do
+    {
+        digits[--count] = HEX[value & 15];
+        value >>= 4;
+    } while (value != 0);
+    Append(digits + count, sizeof(digits) - count);
+}
+
+void CLoadDiagnostics::AppendKey(const char *key)
+{
+    Append(",\"", 2);
+    AppendText(key);
+    Append("\":", 2);
+}
+
+void CLoadDiagnostics::AppendString(const char *text)
+{
+    if (!text)
+    {
+        AppendText("null");
+        return;
+    }
+
+    Append("\"", 1);
+    const char *run = text;
+    const char *p = text;
+    for (; *p && !m_Overflow; ++p)
+    {
+        char escape[jsontext::MAX_ESCAPE_LENGTH];
+        const size_t length = jsontext::Escape((unsigned char)*p, escape);
+        if (length == 0)
+            continue;
+
+        // Copies the plain characters before the one that needs escaping in one go.
+        Append(run, p - run);
+        Append(escape, length);
+        run = p + 1;
+    }
+    Append(run, p - run);
+    Append("\"", 1);
+}
@@ -0,0 +1,132 @@
+#ifndef PLAYER_LOADDIAGNOSTICS_H
+#define PLAYER_LOADDIAGNOSTICS_H
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+
+// Where the events of a load end up; written once per load.
+class CDiagnosticsSink
+{
+public:
+    virtual ~CDiagnosticsSink() {}
+
+    virtual bool Write(const char *data, size_t size) = 0;
+};
+
+// Appends to a file, opening it only for the write, so several players can
+// share it and it can be moved away between loads. A write that would grow the
+// file past the maximum size first renames it to "<filename>.1", replacing the
+// previous one, so at most two files are kept.
+class CDiagnosticsFileSink : public CDiagnosticsSink
+{
+public:
+    enum { DEFAULT_MAX_SIZE = 4 * 1024 * 1024 };
+
+    explicit CDiagnosticsFileSink(const char *filename = NULL, long maxSize = DEFAULT_MAX_SIZE)
+        : m_Filename(filename ? filename : ""), m_MaxSize(maxSize) {}
+
+    virtual bool Write(const char *data, size_t size);
+
+    void SetFilename(const char *filename) { m_Filename = filename ? filename : ""; }
+    const std::string &GetFilename() const { return m_Filename; }
+
+    // Zero or less never rotates the file.
+    void SetMaxSize(long maxSize) { m_MaxSize = maxSize; }
+    long GetMaxSize() const { return m_MaxSize; }
+
+private:
+    std::string m_Filename;
+    long m_MaxSize;
+};
+
+// Records what happens while a composition loads as newline-delimited JSON,
+// one object per event:
+//   {"load":2,"t":1520,"event":"phase","phase":"open","us":1480,"bytes":5242880}
+// "load" numbers the loads of the process and "t" counts microseconds from
+// the start of the load.
+//
+// Events go to a buffer of fixed size, allocated once; an event that does not
+// fit is dropped and counted, never the end of the load. EndLoad() hands the
+// whole load to the sink in a single write.
+class CLoadDiagnostics
+{
+public:
+    typedef platform::uint64 (*Clock)();
+
+    enum
+    {
+        DEFAULT_CAPACITY = 64 * 1024,
+        MIN_CAPACITY = 1024,
+        END_RESERVE = 192 // kept free for the end event
+    };
+
+    explicit CLoadDiagnostics(size_t capacity = DEFAULT_CAPACITY);
+
+    void SetSink(CDiagnosticsSink *sink) { m_Sink = sink; }
+    CDiagnosticsSink *GetSink() const { return m_Sink; }
+
+    // Replaces the clock, platform::GetTimeMicros by default.
+    void SetClock(Clock clock);
+
+    // Drops whatever an unfinished load recorded and starts a new one.
+    void BeginLoad(const char *composition);
+    bool IsLoading() const { return m_Loading; }
+
+    void Phase(const char *phase, platform::uint64 durationUs, platform::uint64 bytes);
+
+    // A file name looked up in the engine's paths; resolved is NULL if it was not found.
+    void PathResolved(const char *requested, const char *resolved);
+
+    // Pairs of the d1 and d2 parts of the GUIDs a composition depends on but
+    // no plugin provides.
+    void MissingGuids(const platform::uint32 *guids, size_t count);
+
+    void Hotfix(const char *step, bool applied);
+    void Error(const char *message);
+
+    // Adds the end event and writes the load to the sink. Returns false if the
+    // sink failed; nothing is written when no load was begun.
+    bool EndLoad(bool loaded);
+
+    // The events of the load in progress, or of the last one after it ended.
+    const char *GetData() const { return m_Buffer.empty() ? "" : &m_Buffer[0]; }
+    size_t GetSize() const { return m_Size; }
+    size_t GetCapacity() const { return m_Buffer.size(); }
+
+    unsigned long GetEventCount() const { return m_Events; }
+    unsigned long GetDroppedCount() const { return m_Dropped; }
+    unsigned long GetLoadCount() const { return m_Load; }
+
+private:
+    CLoadDiagnostics(const CLoadDiagnostics &);
+    CLoadDiagnostics &operator=(const CLoadDiagnostics &);
+
+    void BeginEvent(const char *name, size_t limit);
+    void EndEvent();
+
+    void Append(const char *data, size_t size);
+    void AppendText(const char *text);
+    void AppendNumber(platform::uint64 value);
+    void AppendString(const char *text);
+    void AppendHex(platform::uint32 value);
+    void AppendKey(const char *key);
+
+    std::vector<char> m_Buffer;
+    size_t m_Size;
+    size_t m_EventStart;
+    size_t m_Limit;
+    bool m_Overflow;
+    bool m_Loading;
+    Clock m_Clock;
+    CDiagnosticsSink *m_Sink;
+    platform::uint64 m_LoadStart;
+    unsigned long m_Load;
+    unsigned long m_Events;
+    unsigned long m_Dropped;
+};
+
+#endif // PLAYER_LOADDIAGNOSTICS_H
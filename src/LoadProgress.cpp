@@ -0,0 +1,161 @@
+#include "LoadProgress.h"
+
+namespace
+{
+    enum { READ_ATTEMPTS = 16 };
+
+    // Thousandths of the wait each stage takes on a typical start; the running stages sum to 1000.
+    const int STAGE_WEIGHTS[eLoadStageCount] = {
+        0,   // eLoadStarting
+        100, // eLoadEngine
+        300, // eLoadPlugins
+        200, // eLoadComposition
+        350, // eLoadObjects
+        50,  // eLoadFirstFrame
+        0,   // eLoadDone
+        0,   // eLoadFailed
+    };
+
+    const char *const STAGE_NAMES[eLoadStageCount] = {
+        "Starting",
+        "Starting engine",
+        "Loading plugins",
+        "Reading composition",
+        "Loading objects",
+        "Starting game",
+        "Done",
+        "Failed",
+    };
+
+    bool IsTerminal(long stage)
+    {
+        return stage == eLoadDone || stage == eLoadFailed;
+    }
+}
+
+CLoadProgress::CLoadProgress()
+    : m_Sequence(0), m_Stage(eLoadStarting), m_Done(0), m_Total(0) {}
+
+void CLoadProgress::SetStage(LoadStage stage, long total)
+{
+    const long current = m_Stage;
+    if (IsTerminal(current) || stage < current || stage >= eLoadStageCount)
+        return;
+
+    if (stage == current)
+        Publish(current, m_Done, total);
+    else
+        Publish(stage, 0, total);
+}
+
+void CLoadProgress::SetTotal(long total)
+{
+    if (IsTerminal(m_Stage))
+        return;
+    Publish(m_Stage, m_Done, total);
+}
+
+void CLoadProgress::SetDone(long done)
+{
+    if (IsTerminal(m_Stage))
+        return;
+    Publish(m_Stage, done, m_Total);
+}
+
+void CLoadProgress::Advance(long amount)
+{
+    if (IsTerminal(m_Stage))
+        return;
+    Publish(m_Stage, m_Done + amount, m_Total);
+}
+
+void CLoadProgress::Finish()
+{
+    if (IsTerminal(m_Stage))
+        return;
+    Publish(eLoadDone, 0, 0);
+}
+
+void CLoadProgress::Fail()
+{
+    if (IsTerminal(m_Stage))
+        return;
+    Publish(eLoadFailed, 0, 0);
+}
+
+void CLoadProgress::Publish(long stage, long done, long total)
+{
+    // Only the writer changes the fields, so it may read them back without atomics.
+    platform::AtomicIncrement(&m_Sequence);
+    platform::AtomicStore(&m_Stage, stage);
+    platform::AtomicStore(&m_Done, done);
+    platform::AtomicStore(&m_Total, total);
+    platform::AtomicIncrement(&m_Sequence);
+}
+
+bool CLoadProgress::Read(LoadProgressSnapshot &snapshot) const
+{
+    int attempt;
+    for (attempt = 0; attempt < READ_ATTEMPTS; ++attempt)
+    {
+        const long before = platform::AtomicLoad(&m_Sequence);
+        if (before & 1)
+        {
+            platform::YieldThread();
+            continue;
+        }
+
+        const long stage = platform::AtomicLoad(&m_Stage);
+        const long done = platform::AtomicLoad(&m_Done);
+        const long total = platform::AtomicLoad(&m_Total);
+        if (platform::AtomicLoad(&m_Sequence) != before)
+            continue;
+
+        snapshot.stage = (LoadStage)stage;
+        snapshot.done = done;
+        snapshot.total = total;
+        snapshot.sequence = before;
+        return true;
+    }
+    return false;
+}
+
+LoadStage CLoadProgress::GetStage() const
+{
+    return (LoadStage)platform::AtomicLoad(&m_Stage);
+}
+
+long CLoadProgress::GetSequence() const
+{
+    return platform::AtomicLoad(&m_Sequence);
+}
+
+bool CLoadProgress::IsFinished() const
+{
+    return IsTerminal(platform::AtomicLoad(&m_Stage));
+}
+
+int CLoadProgress::GetPermille(const LoadProgressSnapshot &snapshot)
+{
+    if (snapshot.stage < 0 || snapshot.stage >= eLoadStageCount || IsTerminal(snapshot.stage))
+        return 1000;
+
+    int permille = 0;
+    int stage;
+    for (stage = 0; stage < snapshot.stage; ++stage)
+        permille += STAGE_WEIGHTS[stage];
+
+    if (snapshot.total > 0 && snapshot.done > 0)
+    {
+        const long done = (snapshot.done < snapshot.total) ? snapshot.done : snapshot.total;
+        permille += (int)((double)STAGE_WEIGHTS[snapshot.stage] * done / snapshot.total);
+    }
+    return permille;
+}
+
+const char *CLoadProgress::GetStageName(LoadStage stage)
+{
+    if (stage < 0 || stage >= eLoadStageCount)
+        return "";
+    return STAGE_NAMES[stage];
+}
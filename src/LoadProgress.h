@@ -0,0 +1,72 @@
+#ifndef PLAYER_LOADPROGRESS_H
+#define PLAYER_LOADPROGRESS_H
+
+#include "Platform.h"
+
+// The steps from launch to the first rendered frame, in the order they happen.
+enum LoadStage
+{
+    eLoadStarting = 0,
+    eLoadEngine,      // starting the engine and creating its context
+    eLoadPlugins,     // registering plugin DLLs, counted in files
+    eLoadComposition, // reading the composition, counted in bytes
+    eLoadObjects,     // creating the objects of the composition, counted in objects
+    eLoadFirstFrame,  // waiting for the first frame to be rendered
+    eLoadDone,
+    eLoadFailed,
+    eLoadStageCount
+};
+
+struct LoadProgressSnapshot
+{
+    LoadStage stage;
+    long done;
+    long total;
+    long sequence; // changes with every update
+};
+
+// Carries the loading progress from the thread doing the work to the splash
+// screen. One thread writes, any thread reads; neither side ever waits for the
+// other. The writer publishes each update under a sequence number that is odd
+// while it writes, so a reader can tell a torn read from a consistent one.
+//
+// Stages only move forward, and nothing changes once the load is done or failed.
+class CLoadProgress
+{
+public:
+    CLoadProgress();
+
+    // Writer side.
+    void SetStage(LoadStage stage, long total = 0);
+    void SetTotal(long total);
+    void SetDone(long done);
+    void Advance(long amount = 1);
+    void Finish();
+    void Fail();
+
+    // Reader side. Returns false, leaving the snapshot untouched, if the writer
+    // kept updating through every attempt.
+    bool Read(LoadProgressSnapshot &snapshot) const;
+
+    LoadStage GetStage() const;
+    long GetSequence() const;
+    bool IsFinished() const;
+
+    // Overall progress of a snapshot in thousandths, weighting each stage by its usual share of the wait.
+    static int GetPermille(const LoadProgressSnapshot &snapshot);
+
+    static const char *GetStageName(LoadStage stage);
+
+private:
+    CLoadProgress(const CLoadProgress &);
+    CLoadProgress &operator=(const CLoadProgress &);
+
+    void Publish(long stage, long done, long total);
+
+    volatile long m_Sequence;
+    volatile long m_Stage;
+    volatile long m_Done;
+    volatile long m_Total;
+};
+
+#endif // PLAYER_LOADPROGRESS_H
@@ -0,0 +1,98 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef INVALID_FILE_SIZE
+#define INVALID_FILE_SIZE ((DWORD)0xFFFFFFFF)
+#endif
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CMappedFile::CMappedFile() : m_Data(NULL), m_Size(0) {}
+
+CMappedFile::~CMappedFile()
+{
+    Close();
+}
+
+bool CMappedFile::Open(const char *path, MapMode mode)
+{
+    Close();
+    if (!path || !*path)
+        return false;
+
+#ifdef _WIN32
+    HANDLE file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    DWORD sizeHigh = 0;
+    DWORD sizeLow = ::GetFileSize(file, &sizeHigh);
+    if (sizeLow == INVALID_FILE_SIZE && ::GetLastError() != NO_ERROR)
+    {
+        ::CloseHandle(file);
+        return false;
+    }
+
+    platform::uint64 size = ((platform::uint64)sizeHigh << 32) | sizeLow;
+    if (size == 0 || size != (platform::uint64)(size_t)size)
+    {
+        ::CloseHandle(file);
+        return false;
+    }
+
+    const bool copyOnWrite = mode == eMapCopyOnWrite;
+    HANDLE mapping = ::CreateFileMappingA(file, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    // The view keeps the mapping and the file open on its own.
+    ::CloseHandle(file);
+    if (!mapping)
+        return false;
+
+    void *data = ::MapViewOfFile(mapping, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if (!data)
+        return false;
+#else
+    int file = open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(file, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+        (platform::uint64)st.st_size != (platform::uint64)(size_t)st.st_size)
+    {
+        close(file);
+        return false;
+    }
+
+    platform::uint64 size = (platform::uint64)st.st_size;
+    int protection = mode == eMapCopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *data = mmap(NULL, (size_t)size, protection, MAP_PRIVATE, file, 0);
+    // The mapping keeps its own reference to the file.
+    close(file);
+    if (data == MAP_FAILED)
+        return false;
+#endif
+
+    m_Data = data;
+    m_Size = size;
+    return true;
+}
+
+void CMappedFile::Close()
+{
+    if (!m_Data)
+        return;
+
+#ifdef _WIN32
+    ::UnmapViewOfFile(m_Data);
+#else
+    munmap(m_Data, (size_t)m_Size);
+#endif
+    m_Data = NULL;
+    m_Size = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef PLAYER_MAPPEDFILE_H
+#define PLAYER_MAPPEDFILE_H
+
+#include "Platform.h"
+
+// A whole file mapped into memory, paged in by the OS as it is touched.
+//
+// The view stays valid until Close() or destruction, so anything handed the
+// data must be done with it first.
+class CMappedFile
+{
+public:
+    enum MapMode
+    {
+        // Pages are read-only; writing to them faults.
+        eMapReadOnly = 0,
+        // Pages may be written; writes stay private to the process and never
+        // reach the file.
+        eMapCopyOnWrite,
+    };
+
+    CMappedFile();
+    ~CMappedFile();
+
+    // Fails for a missing or empty file, or a file too large for the address space.
+    bool Open(const char *path, MapMode mode = eMapReadOnly);
+    void Close();
+
+    bool IsOpen() const { return m_Data != NULL; }
+    void *GetData() const { return m_Data; }
+    platform::uint64 GetSize() const { return m_Size; }
+
+private:
+    CMappedFile(const CMappedFile &);
+    CMappedFile &operator=(const CMappedFile &);
+
+    void *m_Data;
+    platform::uint64 m_Size;
+};
+
+#endif // PLAYER_MAPPEDFILE_H
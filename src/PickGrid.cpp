@@ -0,0 +1,303 @@
+#include "PickGrid.h"
+
+CPickGrid::CPickGrid()
+    : m_Width(0), m_Height(0), m_CellSize(DEFAULT_CELL_SIZE), m_Columns(0), m_Rows(0),
+      m_Generation(0), m_Rebuckets(0) {}
+
+void CPickGrid::Reset(int width, int height, int cellSize)
+{
+    m_Width = (width > 0) ? width : 0;
+    m_Height = (height > 0) ? height : 0;
+    m_CellSize = (cellSize > 0) ? cellSize : DEFAULT_CELL_SIZE;
+    m_Columns = (m_Width + m_CellSize - 1) / m_CellSize;
+    m_Rows = (m_Height + m_CellSize - 1) / m_CellSize;
+    Clear();
+}
+
+void CPickGrid::Clear()
+{
+    m_Items.clear();
+    m_FreeSlots.clear();
+    m_Index.clear();
+    m_Cells.clear();
+    m_Cells.resize(m_Columns * m_Rows);
+    m_Rebuckets = 0;
+}
+
+void CPickGrid::BeginRefresh()
+{
+    ++m_Generation;
+}
+
+bool CPickGrid::Update(platform::uint32 id, PickItemKind kind, const PickRect &rect, int order, bool visible)
+{
+    int x0, y0, x1, y1;
+    ComputeSpan(rect, visible, x0, y0, x1, y1);
+
+    IndexMap::iterator it = m_Index.find(id);
+    if (it != m_Index.end())
+    {
+        Item &item = m_Items[it->second];
+        item.generation = m_Generation;
+
+        bool moved = item.x0 != x0 || item.y0 != y0 || item.x1 != x1 || item.y1 != y1;
+        bool changed = moved || item.kind != kind || item.order != order || item.visible != visible ||
+                       item.rect.left != rect.left || item.rect.top != rect.top ||
+                       item.rect.right != rect.right || item.rect.bottom != rect.bottom;
+        if (!changed)
+            return false;
+
+        if (moved)
+            Unlink(it->second);
+        item.kind = kind;
+        item.order = order;
+        item.rect = rect;
+        item.visible = visible;
+        if (moved)
+        {
+            item.x0 = x0;
+            item.y0 = y0;
+            item.x1 = x1;
+            item.y1 = y1;
+            Link(it->second);
+        }
+        return true;
+    }
+
+    int slot;
+    if (!m_FreeSlots.empty())
+    {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        slot = (int)m_Items.size();
+        m_Items.push_back(Item());
+    }
+
+    Item &item = m_Items[slot];
+    item.id = id;
+    item.kind = kind;
+    item.order = order;
+    item.rect = rect;
+    item.visible = visible;
+    item.generation = m_Generation;
+    item.x0 = x0;
+    item.y0 = y0;
+    item.x1 = x1;
+    item.y1 = y1;
+    m_Index[id] = slot;
+    Link(slot);
+    return true;
+}
+
+bool CPickGrid::Remove(platform::uint32 id)
+{
+    IndexMap::iterator it = m_Index.find(id);
+    if (it == m_Index.end())
+        return false;
+
+    int slot = it->second;
+    m_Index.erase(it);
+    Release(slot);
+    return true;
+}
+
+int CPickGrid::EndRefresh()
+{
+    int removed = 0;
+    IndexMap::iterator it = m_Index.begin();
+    while (it != m_Index.end())
+    {
+        if (m_Items[it->second].generation != m_Generation)
+        {
+            Release(it->second);
+            m_Index.erase(it++);
+            ++removed;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return removed;
+}
+
+int CPickGrid::Query(float x, float y, PickHit *hits, int maxHits) const
+{
+    if (x < 0 || y < 0 || x >= m_Width || y >= m_Height)
+        return 0;
+
+    int column = (int)x / m_CellSize;
+    int row = (int)y / m_CellSize;
+    const std::vector<int> &cell = m_Cells[row * m_Columns + column];
+
+    int count = 0;
+    size_t i;
+    for (i = 0; i < cell.size(); ++i)
+    {
+        const Item &item = m_Items[cell[i]];
+        if (x < item.rect.left || x >= item.rect.right || y < item.rect.top || y >= item.rect.bottom)
+            continue;
+
+        if (count < maxHits && hits)
+        {
+            PickHit hit;
+            hit.id = item.id;
+            hit.kind = item.kind;
+            hit.order = item.order;
+
+            // Insertion sort: sprites before entities, higher order first.
+            int j = count;
+            while (j > 0 && (hits[j - 1].kind > hit.kind ||
+                             (hits[j - 1].kind == hit.kind && hits[j - 1].order < hit.order)))
+            {
+                hits[j] = hits[j - 1];
+                --j;
+            }
+            hits[j] = hit;
+        }
+        ++count;
+    }
+    return count;
+}
+
+void CPickGrid::ComputeSpan(const PickRect &rect, bool visible, int &x0, int &y0, int &x1, int &y1) const
+{
+    x0 = y0 = 0;
+    x1 = y1 = -1;
+    if (!visible || m_Columns == 0 || m_Rows == 0)
+        return;
+    if (rect.right <= 0 || rect.bottom <= 0 || rect.left >= m_Width || rect.top >= m_Height)
+        return;
+    if (rect.right <= rect.left || rect.bottom <= rect.top)
+        return;
+
+    x0 = (rect.left > 0) ? (int)rect.left / m_CellSize : 0;
+    y0 = (rect.top > 0) ? (int)rect.top / m_CellSize : 0;
+    x1 = (rect.right < m_Width) ? (int)rect.right / m_CellSize : m_Columns - 1;
+    y1 = (rect.bottom < m_Height) ? (int)rect.bottom / m_CellSize : m_Rows - 1;
+    if (x1 >= m_Columns)
+        x1 = m_Columns - 1;
+    if (y1 >= m_Rows)
+        y1 = m_Rows - 1;
+}
+
+void CPickGrid::Link(int slot)
+{
+    const Item &item = m_Items[slot];
+    if (item.x0 > item.x1)
+        return;
+
+    int x, y;
+    for (y = item.y0; y <= item.y1; ++y)
+        for (x = item.x0; x <= item.x1; ++x)
+            m_Cells[y * m_Columns + x].push_back(slot);
+    ++m_Rebuckets;
+}
+
+void CPickGrid::Unlink(int slot)
+{
+    const Item &item = m_Items[slot];
+    if (item.x0 > item.x1)
+        return;
+
+    int x, y;
+    for (y = item.y0; y <= item.y1; ++y)
+    {
+        for (x = item.x0; x <= item.x1; ++x)
+        {
+            std::vector<int> &cell = m_Cells[y * m_Columns + x];
+            size_t i;
+            for (i = 0; i < cell.size(); ++i)
+            {
+                if (cell[i] == slot)
+                {
+                    cell[i] = cell.back();
+                    cell.pop_back();
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void CPickGrid::Release(int slot)
+{
+    Unlink(slot);
+    m_FreeSlots.push_back(slot);
+}
+
+enum
+{
+    PICK_TRACK_SHOWN = 1,
+    PICK_TRACK_MOVED = 2
+};
+
+void CPickTracker::Reset(platform::uint32 viewKey, platform::uint32 sceneKey)
+{
+    m_ViewKey = viewKey;
+    m_SceneKey = sceneKey;
+    m_Full = false;
+    ClearMoved();
+}
+
+void CPickTracker::Invalidate()
+{
+    m_Full = true;
+    ClearMoved();
+}
+
+bool CPickTracker::BeginFrame(platform::uint32 viewKey)
+{
+    if (viewKey != m_ViewKey)
+        Invalidate();
+    return !m_Full;
+}
+
+void CPickTracker::MarkMoved(platform::uint32 id)
+{
+    if (m_Full)
+        return;
+
+    unsigned char &flags = GetFlags(id);
+    if (flags & PICK_TRACK_MOVED)
+        return;
+    if (m_Moved.size() >= (size_t)MAX_MOVED)
+    {
+        Invalidate();
+        return;
+    }
+    flags |= PICK_TRACK_MOVED;
+    m_Moved.push_back(id);
+}
+
+void CPickTracker::EndFrame(platform::uint32 sceneKey)
+{
+    if (sceneKey != m_SceneKey)
+        Invalidate();
+}
+
+bool CPickTracker::SetShown(platform::uint32 id, bool shown)
+{
+    unsigned char &flags = GetFlags(id);
+    if (((flags & PICK_TRACK_SHOWN) != 0) == shown)
+        return false;
+    flags ^= PICK_TRACK_SHOWN;
+    return true;
+}
+
+void CPickTracker::ClearMoved()
+{
+    for (size_t i = 0; i < m_Moved.size(); ++i)
+        m_Flags[m_Moved[i]] &= ~PICK_TRACK_MOVED;
+    m_Moved.clear();
+}
+
+unsigned char &CPickTracker::GetFlags(platform::uint32 id)
+{
+    if (id >= m_Flags.size())
+        m_Flags.resize(id + 1, 0);
+    return m_Flags[id];
+}
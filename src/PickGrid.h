@@ -0,0 +1,139 @@
+#ifndef PLAYER_PICKGRID_H
+#define PLAYER_PICKGRID_H
+
+#include <map>
+#include <vector>
+
+#include "Platform.h"
+
+enum PickItemKind
+{
+    ePickSprite = 0, // 2D entity
+    ePickEntity      // 3D entity, by its render extents
+};
+
+struct PickRect
+{
+    float left;
+    float top;
+    float right;
+    float bottom;
+};
+
+struct PickHit
+{
+    platform::uint32 id;
+    int kind;
+    int order;
+};
+
+// Screen-space uniform grid over the clickable objects of a render context.
+//
+// Items are keyed by object ID and only re-bucketed when their rectangle moves to
+// other cells or their visibility changes, so refreshing an unchanged scene is a
+// lookup per object. A refresh pass is bracketed by BeginRefresh()/EndRefresh();
+// items not updated in between are considered deleted.
+class CPickGrid
+{
+public:
+    enum { DEFAULT_CELL_SIZE = 64 };
+
+    CPickGrid();
+
+    // Sets the screen size and drops every item.
+    void Reset(int width, int height, int cellSize = DEFAULT_CELL_SIZE);
+    void Clear();
+
+    void BeginRefresh();
+    // Inserts or updates an item. Returns true if the grid changed.
+    bool Update(platform::uint32 id, PickItemKind kind, const PickRect &rect, int order, bool visible);
+    bool Remove(platform::uint32 id);
+    // Removes the items not updated since BeginRefresh(). Returns how many were removed.
+    int EndRefresh();
+
+    // Collects the visible items containing the point: sprites first, topmost first,
+    // then entities. Returns the total number of matches, which may exceed maxHits.
+    int Query(float x, float y, PickHit *hits, int maxHits) const;
+
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    int GetItemCount() const { return (int)m_Index.size(); }
+    unsigned long GetRebucketCount() const { return m_Rebuckets; }
+
+private:
+    struct Item
+    {
+        platform::uint32 id;
+        int kind;
+        int order;
+        PickRect rect;
+        bool visible;
+        unsigned long generation;
+        // Covered cell span, empty when x0 > x1.
+        int x0, y0, x1, y1;
+    };
+
+    typedef std::map<platform::uint32, int> IndexMap;
+
+    void ComputeSpan(const PickRect &rect, bool visible, int &x0, int &y0, int &x1, int &y1) const;
+    void Link(int slot);
+    void Unlink(int slot);
+    void Release(int slot);
+
+    int m_Width;
+    int m_Height;
+    int m_CellSize;
+    int m_Columns;
+    int m_Rows;
+    unsigned long m_Generation;
+    unsigned long m_Rebuckets;
+
+    std::vector<Item> m_Items;
+    std::vector<int> m_FreeSlots;
+    IndexMap m_Index;
+    std::vector<std::vector<int> > m_Cells;
+};
+
+// What changed on screen since the pick grid was last refreshed, fed once per
+// drawn frame so a click only reads again the entities that moved.
+//
+// The view key stands for whatever places every entity on screen (viewpoint,
+// projection, screen size) and the scene key for the set of pickable objects.
+// When either changes, or more entities moved than are worth tracking one by
+// one, the next refresh has to read the whole scene.
+class CPickTracker
+{
+public:
+    enum { MAX_MOVED = 1024 };
+
+    CPickTracker() : m_ViewKey(0), m_SceneKey(0), m_Full(true) {}
+
+    // Called after a refresh that read the whole scene.
+    void Reset(platform::uint32 viewKey, platform::uint32 sceneKey);
+    void Invalidate();
+
+    // Returns false once the next refresh has to read everything anyway, so the
+    // caller can skip looking at the entities.
+    bool BeginFrame(platform::uint32 viewKey);
+    void MarkMoved(platform::uint32 id);
+    void EndFrame(platform::uint32 sceneKey);
+
+    // Records whether an entity is shown. Returns true if that changed.
+    bool SetShown(platform::uint32 id, bool shown);
+
+    bool NeedsFullRefresh() const { return m_Full; }
+    const std::vector<platform::uint32> &GetMoved() const { return m_Moved; }
+    // Forgets the moved entities once a refresh read them again.
+    void ClearMoved();
+
+private:
+    unsigned char &GetFlags(platform::uint32 id);
+
+    platform::uint32 m_ViewKey;
+    platform::uint32 m_SceneKey;
+    bool m_Full;
+    std::vector<platform::uint32> m_Moved;
+    std::vector<unsigned char> m_Flags; // by ID, CK IDs being dense
+};
+
+#endif // PLAYER_PICKGRID_H
@@ -0,0 +1,65 @@
+#include "Platform.h"
+
+#ifndef _WIN32
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace platform
+{
+    uint64 GetTimeMicros()
+    {
+#ifdef _WIN32
+        static LARGE_INTEGER frequency = {0};
+        if (frequency.QuadPart == 0)
+            ::QueryPerformanceFrequency(&frequency);
+
+        LARGE_INTEGER counter;
+        ::QueryPerformanceCounter(&counter);
+
+        // Split the conversion to avoid overflowing counter * 1000000.
+        uint64 ticks = (uint64)counter.QuadPart;
+        uint64 freq = (uint64)frequency.QuadPart;
+        return (ticks / freq) * 1000000 + (ticks % freq) * 1000000 / freq;
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64)ts.tv_sec * 1000000 + (uint64)ts.tv_nsec / 1000;
+#endif
+    }
+
+    void SleepMs(unsigned int milliseconds)
+    {
+#ifdef _WIN32
+        ::Sleep(milliseconds);
+#else
+        struct timespec ts;
+        ts.tv_sec = milliseconds / 1000;
+        ts.tv_nsec = (long)(milliseconds % 1000) * 1000000L;
+        while (nanosleep(&ts, &ts) != 0)
+            continue;
+#endif
+    }
+
+    void YieldThread()
+    {
+#ifdef _WIN32
+        ::Sleep(0);
+#else
+        sched_yield();
+#endif
+    }
+
+    int GetProcessorCount()
+    {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        ::GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (int)count : 1;
+#endif
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef PLAYER_PLATFORM_H
+#define PLAYER_PLATFORM_H
+
+#include <stddef.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#ifdef WIN32_LEAN_AND_MEAN
+#undef WIN32_LEAN_AND_MEAN
+#endif
+#else
+#include <stdio.h>
+#ifndef _snprintf
+#define _snprintf snprintf
+#endif
+#endif
+
+// Fails to compile when the condition is false. Usable at namespace and class scope.
+#define PLATFORM_STATIC_ASSERT(cond, name) \
+    typedef char platform_static_assert_##name[(cond) ? 1 : -1]
+
+namespace platform
+{
+    typedef unsigned char uint8;
+    typedef unsigned short uint16;
+    typedef unsigned int uint32;
+    typedef int int32;
+#if defined(_MSC_VER)
+    typedef __int64 int64;
+    typedef unsigned __int64 uint64;
+#else
+    typedef long long int64;
+    typedef unsigned long long uint64;
+#endif
+
+    PLATFORM_STATIC_ASSERT(sizeof(uint16) == 2, uint16_size);
+    PLATFORM_STATIC_ASSERT(sizeof(uint32) == 4, uint32_size);
+    PLATFORM_STATIC_ASSERT(sizeof(uint64) == 8, uint64_size);
+
+    // Atomic operations on a shared long. Loads have acquire and stores release semantics,
+    // everything else is a full barrier.
+
+    // Returns the previous value; the exchange happened if it equals comparand.
+    inline long AtomicCompareExchange(volatile long *value, long newValue, long comparand)
+    {
+#if defined(_MSC_VER) && (_MSC_VER <= 1200)
+        return (long)::InterlockedCompareExchange((PVOID *)value, (PVOID)newValue, (PVOID)comparand);
+#elif defined(_WIN32)
+        return ::InterlockedCompareExchange((LONG *)value, newValue, comparand);
+#else
+        return __sync_val_compare_and_swap(value, comparand, newValue);
+#endif
+    }
+
+    inline long AtomicLoad(const volatile long *value)
+    {
+#ifdef _WIN32
+        return AtomicCompareExchange(const_cast<volatile long *>(value), 0, 0);
+#else
+        return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    inline void AtomicStore(volatile long *value, long newValue)
+    {
+#ifdef _WIN32
+        ::InterlockedExchange((LONG *)value, newValue);
+#else
+        __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+#endif
+    }
+
+    inline long AtomicIncrement(volatile long *value)
+    {
+#ifdef _WIN32
+        return ::InterlockedIncrement((LONG *)value);
+#else
+        return __sync_add_and_fetch(value, 1);
+#endif
+    }
+
+    inline long AtomicDecrement(volatile long *value)
+    {
+#ifdef _WIN32
+        return ::InterlockedDecrement((LONG *)value);
+#else
+        return __sync_sub_and_fetch(value, 1);
+#endif
+    }
+
+    inline long AtomicExchange(volatile long *value, long newValue)
+    {
+#ifdef _WIN32
+        return ::InterlockedExchange((LONG *)value, newValue);
+#else
+        return __atomic_exchange_n(value, newValue, __ATOMIC_SEQ_CST);
+#endif
+    }
+
+    // Monotonic clock in microseconds; only differences are meaningful.
+    uint64 GetTimeMicros();
+
+    void SleepMs(unsigned int milliseconds);
+    void YieldThread();
+
+    int GetProcessorCount();
+}
+
+#endif // PLAYER_PLATFORM_H
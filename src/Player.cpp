@@ -4,19 +4,34 @@
 #include <Windows.h>
 #include <tchar.h>
 
+#include "BatchRunner.h"
 #include "CmdlineParser.h"
+#include "CompositionPrefetch.h"
 #include "GameConfig.h"
 #include "GamePlayer.h"
+#include "InstanceChannel.h"
+#include "LatencyProbe.h"
+#include "LoadProgress.h"
 #include "PlayerOptions.h"
 #include "Splash.h"
 #include "LockGuard.h"
 #include "Logger.h"
 #include "Utils.h"
 
-static HANDLE CreateNamedMutex();
+static bool GetInstanceName(char *name, size_t size);
+static HANDLE CreateNamedMutex(const char *name);
+static bool ForwardCommandLine(const char *name, LPTSTR lpCmdLine);
+static std::string GetCommandLineText(LPTSTR lpCmdLine);
+static int RunBatch(HINSTANCE hInstance, CmdlineParser &parser, const BatchOptions &options, LPTSTR lpCmdLine);
+static int RunBatchWorker(HINSTANCE hInstance, CmdlineParser &parser, const BatchOptions &options);
+static void RunBatchJob(HINSTANCE hInstance, const CGameConfig &runtimeConfig, const CGameConfig &persistentConfig,
+                        int frames, BatchResult &result);
 static void EnableDpiAwareness();
 static void UseExecutableDirectoryAsWorkingDirectory();
 static bool EnsurePersistentConfigReady(HINSTANCE hInstance, CGameConfig &config);
+static bool LoadConfig(HINSTANCE hInstance, CmdlineParser &parser, CGameConfig &persistentConfig, CGameConfig &runtimeConfig);
+static void StartPreload(CCompositionPrefetcher &prefetcher, const CGameConfig &config);
+static void FinishPreload(CCompositionPrefetcher &prefetcher);
 
 int APIENTRY _tWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCmdLine, int nCmdShow)
 {
@@ -24,9 +39,24 @@ int APIENTRY _tWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCm
 
     CmdlineParser parser(lpCmdLine);
 
-    HANDLE hMutex = CreateNamedMutex();
+    // Batch runs start no game and leave the running player alone.
+    BatchOptions batchOptions;
+    playeroptions::ApplyBatchOptions(batchOptions, parser);
+    if (batchOptions.IsWorker())
+        return RunBatchWorker(hInstance, parser, batchOptions);
+    if (batchOptions.IsBatch())
+        return RunBatch(hInstance, parser, batchOptions, lpCmdLine);
+
+    char instanceName[MAX_PATH];
+    if (!GetInstanceName(instanceName, sizeof(instanceName)))
+        return -1;
+
+    HANDLE hMutex = CreateNamedMutex(instanceName);
     if (!hMutex)
     {
+        // Let the running player act on this launch instead of starting a second one.
+        if (ForwardCommandLine(instanceName, lpCmdLine))
+            return 0;
         ::MessageBox(NULL, TEXT("Another player is running!"), TEXT("Error"), MB_OK);
         return -1;
     }
@@ -34,16 +64,10 @@ int APIENTRY _tWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCm
     LockGuard guard(hMutex);
 
     CGameConfig persistentConfig;
-
-    playeroptions::ApplyPathOptions(persistentConfig, parser);
-
-    if (!EnsurePersistentConfigReady(hInstance, persistentConfig))
+    CGameConfig runtimeConfig;
+    if (!LoadConfig(hInstance, parser, persistentConfig, runtimeConfig))
         return -1;
 
-    persistentConfig.LoadFromIni();
-    CGameConfig runtimeConfig = persistentConfig;
-    playeroptions::ApplyRuntimeOptions(runtimeConfig, parser);
-
     bool overwrite = true;
     if (runtimeConfig.logMode == eLogAppend)
         overwrite = false;
@@ -52,36 +76,58 @@ int APIENTRY _tWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCm
     if (runtimeConfig.verbose)
         CLogger::Get().SetLevel(CLogger::LEVEL_DEBUG);
 
+    // Later launches hand their command line over this channel.
+    CInstanceChannel instanceChannel;
+    if (!instanceChannel.Listen(instanceName))
+        CLogger::Get().Warn("Failed to open the instance channel, later launches will not be forwarded.");
+
+    // Warm the page cache with the composition while the engine starts up.
+    CCompositionPrefetcher prefetcher(CFileSystem::GetNative());
+    if (runtimeConfig.preloadComposition)
+        StartPreload(prefetcher, runtimeConfig);
+
     EnableDpiAwareness();
 
+    // The splash runs on a thread of its own and follows the progress until the first frame.
+    CLoadProgress progress;
     CSplash splash(hInstance);
-    splash.Show();
+    splash.Show(&progress);
 
     CGamePlayer player;
+    player.SetLoadProgress(&progress);
+    player.SetInstanceChannel(&instanceChannel);
     if (!player.Init(runtimeConfig, persistentConfig, hInstance))
     {
+        progress.Fail();
+        splash.Close();
         CLogger::Get().Error("Failed to initialize player!");
         ::MessageBox(NULL, TEXT("Failed to initialize player!"), TEXT("Error"), MB_OK);
         return -1;
     }
 
     CLogger::Get().Debug("Loading game composition: %s", runtimeConfig.GetPath(eCmoPath));
-    if (!player.Load(runtimeConfig.GetPath(eCmoPath)))
+    bool loaded = player.Load(runtimeConfig.GetPath(eCmoPath));
+    FinishPreload(prefetcher);
+    if (!loaded)
     {
+        progress.Fail();
+        splash.Close();
         CLogger::Get().Error("Failed to load game composition!");
         ::MessageBox(NULL, TEXT("Failed to load game composition!"), TEXT("Error"), MB_OK);
         player.Shutdown();
         return -1;
     }
 
+    progress.SetStage(eLoadFirstFrame);
     player.Play();
     player.Run();
+    splash.Close();
     player.Shutdown();
 
     return 0;
 }
 
-static HANDLE CreateNamedMutex()
+static bool GetInstanceName(char *name, size_t size)
 {
     char buf[MAX_PATH];
     char drive[4];
@@ -91,17 +137,23 @@ static HANDLE CreateNamedMutex()
     if (!::GetModuleFileNameA(NULL, buf, MAX_PATH))
     {
         CLogger::Get().Error("Failed to get module filename, error code: %d", GetLastError());
-        return NULL;
+        return false;
     }
 
     _splitpath(buf, drive, dir, filename, NULL);
     _snprintf(buf, MAX_PATH, "%s%s", drive, dir);
 
+    // One player per installation.
     unsigned int crc32 = 0;
     utils::CRC32(buf, strlen(buf), 0, &crc32);
-    _snprintf(buf, MAX_PATH, "Ballance-%X", crc32);
+    _snprintf(name, size, "Ballance-%X", crc32);
+    name[size - 1] = '\0';
+    return true;
+}
 
-    HANDLE hMutex = ::CreateMutexA(NULL, FALSE, buf);
+static HANDLE CreateNamedMutex(const char *name)
+{
+    HANDLE hMutex = ::CreateMutexA(NULL, FALSE, name);
     DWORD error = ::GetLastError();
 
     if (!hMutex)
@@ -119,6 +171,196 @@ static HANDLE CreateNamedMutex()
     return hMutex;
 }
 
+static bool ForwardCommandLine(const char *name, LPTSTR lpCmdLine)
+{
+    InstanceMessage message;
+    message.type = eInstanceCommandLine;
+    message.payload = GetCommandLineText(lpCmdLine);
+
+    // The running player may still be starting up; give it a moment to listen.
+    return CInstanceChannel::Send(name, message, 3000);
+}
+
+static std::string GetCommandLineText(LPTSTR lpCmdLine)
+{
+    std::string text;
+#ifdef _UNICODE
+    int size = ::WideCharToMultiByte(CP_ACP, 0, lpCmdLine, -1, NULL, 0, NULL, NULL);
+    if (size > 0)
+    {
+        text.resize(size);
+        ::WideCharToMultiByte(CP_ACP, 0, lpCmdLine, -1, &text[0], size, NULL, NULL);
+        text.resize(size - 1);
+    }
+#else
+    if (lpCmdLine)
+        text = lpCmdLine;
+#endif
+    return text;
+}
+
+static int RunBatch(HINSTANCE hInstance, CmdlineParser &parser, const BatchOptions &options, LPTSTR lpCmdLine)
+{
+    CGameConfig persistentConfig;
+    CGameConfig runtimeConfig;
+    if (!LoadConfig(hInstance, parser, persistentConfig, runtimeConfig))
+        return -1;
+
+    CLogger::Get().Open(runtimeConfig.GetPath(eLogPath), runtimeConfig.logMode != eLogAppend);
+    if (runtimeConfig.verbose)
+        CLogger::Get().SetLevel(CLogger::LEVEL_DEBUG);
+
+    std::vector<std::string> compositions;
+    if (!batchrunner::LoadJobList(options.listFile.c_str(), compositions))
+    {
+        CLogger::Get().Error("Failed to read the batch list: %s", options.listFile.c_str());
+        return -1;
+    }
+
+    char executable[MAX_PATH];
+    DWORD len = ::GetModuleFileNameA(NULL, executable, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH)
+    {
+        CLogger::Get().Error("Failed to get module filename, error code: %d", GetLastError());
+        return -1;
+    }
+
+    // The workers get the same options, less the batch ones.
+    std::vector<std::string> arguments;
+    AppendCommandLineArgs(arguments, GetCommandLineText(lpCmdLine).c_str());
+    batchrunner::RemoveOptions(arguments);
+    char frames[16];
+    sprintf(frames, "%d", options.frames);
+    arguments.push_back("--batch-frames");
+    arguments.push_back(frames);
+
+    // Worker results and logs are kept next to the report, named after it.
+    std::string resultPrefix = options.reportFile;
+    const size_t dot = resultPrefix.find_last_of('.');
+    const size_t separator = resultPrefix.find_last_of("/\\");
+    if (dot != std::string::npos && (separator == std::string::npos || dot > separator))
+        resultPrefix.erase(dot);
+
+    CBatchProcessLauncher launcher(executable, arguments, resultPrefix);
+    CBatchScheduler scheduler;
+    scheduler.SetConcurrency(options.jobs > 0 ? options.jobs : platform::GetProcessorCount());
+    scheduler.SetTimeout((platform::uint64)options.timeoutSeconds * 1000000);
+    size_t i;
+    for (i = 0; i < compositions.size(); ++i)
+        scheduler.AddJob(compositions[i]);
+
+    CLogger::Get().Info("Validating %d compositions with up to %d workers.",
+                        scheduler.GetJobCount(), scheduler.GetConcurrency());
+    const platform::uint64 start = platform::GetTimeMicros();
+    scheduler.Run(launcher, 50);
+
+    CBatchReport report;
+    report.AddAll(scheduler.GetResults());
+    report.SetWallTime(platform::GetTimeMicros() - start);
+    if (!report.Save(options.reportFile.c_str()))
+    {
+        CLogger::Get().Error("Failed to write the batch report: %s", options.reportFile.c_str());
+        return -1;
+    }
+
+    const BatchSummary &summary = report.GetSummary();
+    CLogger::Get().Info("%d of %d compositions passed, report written to %s",
+                        summary.statusCounts[eBatchPassed], summary.jobs, options.reportFile.c_str());
+    return report.AllPassed() ? 0 : 1;
+}
+
+static int RunBatchWorker(HINSTANCE hInstance, CmdlineParser &parser, const BatchOptions &options)
+{
+    CGameConfig persistentConfig;
+    CGameConfig runtimeConfig;
+    if (!LoadConfig(hInstance, parser, persistentConfig, runtimeConfig))
+        return -1;
+
+    // Each worker keeps a log of its own next to its result.
+    const std::string logFile = CBatchProcessLauncher::GetLogFile(options.resultFile);
+    CLogger::Get().Open(logFile.c_str(), true);
+    if (runtimeConfig.verbose)
+        CLogger::Get().SetLevel(CLogger::LEVEL_DEBUG);
+
+    // A worker never takes over the screen.
+    runtimeConfig.fullscreen = false;
+    runtimeConfig.manualSetup = false;
+
+    BatchResult result;
+    result.Reset(runtimeConfig.GetPath(eCmoPath));
+    RunBatchJob(hInstance, runtimeConfig, persistentConfig, options.frames, result);
+
+    if (!batchrunner::SaveResult(options.resultFile.c_str(), result))
+    {
+        CLogger::Get().Error("Failed to write the batch result: %s", options.resultFile.c_str());
+        return -1;
+    }
+    return result.status == eBatchPassed ? 0 : 1;
+}
+
+static void RunBatchJob(HINSTANCE hInstance, const CGameConfig &runtimeConfig, const CGameConfig &persistentConfig,
+                        int frames, BatchResult &result)
+{
+    CGamePlayer player;
+    player.SetBatchResult(&result);
+    if (!player.Init(runtimeConfig, persistentConfig, hInstance))
+    {
+        result.status = eBatchLoadFailed;
+        result.error = "Failed to initialize player.";
+        return;
+    }
+
+    const platform::uint64 loadStart = platform::GetTimeMicros();
+    const bool loaded = player.Load(runtimeConfig.GetPath(eCmoPath));
+    result.loadUs = platform::GetTimeMicros() - loadStart;
+    if (!loaded)
+    {
+        result.status = eBatchLoadFailed;
+        result.error = "Failed to load the composition.";
+        player.Shutdown();
+        return;
+    }
+
+    // Frames run back to back without the frame rate limits, as fast as the
+    // composition allows.
+    player.Play();
+    CLatencyHistogram frameTimes;
+    platform::uint64 totalUs = 0;
+    bool quit = false;
+    int i;
+    for (i = 0; i < frames && !quit; ++i)
+    {
+        MSG msg;
+        while (::PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+        {
+            if (msg.message == WM_QUIT)
+            {
+                quit = true;
+                break;
+            }
+            ::TranslateMessage(&msg);
+            ::DispatchMessage(&msg);
+        }
+        if (quit)
+            break;
+
+        const platform::uint64 frameStart = platform::GetTimeMicros();
+        player.Process();
+        player.Render();
+        const platform::uint64 frameUs = platform::GetTimeMicros() - frameStart;
+        frameTimes.Add(frameUs);
+        totalUs += frameUs;
+    }
+
+    result.frameStats.frames = (int)frameTimes.GetCount();
+    result.frameStats.totalUs = totalUs;
+    result.frameStats.minUs = frameTimes.GetMin();
+    result.frameStats.maxUs = frameTimes.GetMax();
+    result.frameStats.p95Us = frameTimes.GetPercentile(95);
+    result.status = (result.hotfix == eBatchHotfixError) ? eBatchHotfixFailed : eBatchPassed;
+    player.Shutdown();
+}
+
 static void UseExecutableDirectoryAsWorkingDirectory()
 {
     char modulePath[MAX_PATH];
@@ -145,6 +387,42 @@ static bool EnsurePersistentConfigReady(HINSTANCE hInstance, CGameConfig &config
     return false;
 }
 
+static bool LoadConfig(HINSTANCE hInstance, CmdlineParser &parser, CGameConfig &persistentConfig, CGameConfig &runtimeConfig)
+{
+    playeroptions::ApplyPathOptions(persistentConfig, parser);
+
+    if (!EnsurePersistentConfigReady(hInstance, persistentConfig))
+        return false;
+
+    persistentConfig.LoadFromIni();
+    runtimeConfig = persistentConfig;
+    playeroptions::ApplyRuntimeOptions(runtimeConfig, parser);
+    return true;
+}
+
+static void StartPreload(CCompositionPrefetcher &prefetcher, const CGameConfig &config)
+{
+    prefetcher.SetComposition(config.GetPath(eCmoPath), config.GetPath(eDataPath));
+    prefetcher.AddDirectory(config.GetPath(eBitmapPath));
+    prefetcher.AddDirectory(config.GetPath(eSoundPath));
+    if (!prefetcher.Start(platform::GetProcessorCount()))
+        CLogger::Get().Warn("Failed to start composition preload.");
+}
+
+static void FinishPreload(CCompositionPrefetcher &prefetcher)
+{
+    // Whatever is not read by now would only compete with the game for the disk.
+    prefetcher.Cancel();
+    if (!prefetcher.Wait())
+        return;
+
+    if (prefetcher.GetPrefetchedFiles() > 0)
+        CLogger::Get().Debug("Composition preload read %d files (%u KB), skipped %d.",
+                             prefetcher.GetPrefetchedFiles(),
+                             (unsigned int)(prefetcher.GetPrefetchedBytes() / 1024),
+                             prefetcher.GetSkippedFiles());
+}
+
 static void EnableDpiAwareness()
 {
     // DPI awareness enums and types for VC6.0 compatibility
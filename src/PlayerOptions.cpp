@@ -105,6 +105,10 @@ namespace playeroptions
         {
             bool matched = false;
 
+            // Not an INI field: a rebuild is asked for one start at a time.
+            if (ApplyBoolOption(config, parser, "--rebuild-plugin-cache", '\0', &CGameConfig::rebuildPluginCache, true))
+                continue;
+
 #define X_BOOL(sec,key,member,def,cliLong,cliShort,cliValue) \
             if (ApplyBoolOption(config, parser, cliLong, cliShort, &CGameConfig::member, cliValue)) \
                 matched = true; \
@@ -137,6 +141,53 @@ namespace playeroptions
         ApplyConfigOptions(config, parser);
     }
 
+    void ApplyBatchOptions(BatchOptions &options, CmdlineParser &parser)
+    {
+        CmdlineArg arg;
+        std::string value;
+        long number = 0;
+
+        while (!parser.Done())
+        {
+            if (parser.Next(arg, "--batch", '\0', 1))
+            {
+                if (arg.GetValue(0, value))
+                    options.listFile = value;
+            }
+            else if (parser.Next(arg, "--batch-report", '\0', 1))
+            {
+                if (arg.GetValue(0, value))
+                    options.reportFile = value;
+            }
+            else if (parser.Next(arg, "--batch-worker", '\0', 1))
+            {
+                if (arg.GetValue(0, value))
+                    options.resultFile = value;
+            }
+            else if (parser.Next(arg, "--batch-jobs", '\0', 1))
+            {
+                if (arg.GetValue(0, number) && number >= 0)
+                    options.jobs = (int)number;
+            }
+            else if (parser.Next(arg, "--batch-frames", '\0', 1))
+            {
+                if (arg.GetValue(0, number) && number >= 0)
+                    options.frames = (int)number;
+            }
+            else if (parser.Next(arg, "--batch-timeout", '\0', 1))
+            {
+                if (arg.GetValue(0, number) && number >= 0)
+                    options.timeoutSeconds = (int)number;
+            }
+            else
+            {
+                parser.Skip();
+            }
+        }
+
+        parser.Reset();
+    }
+
     int GetConfigOptionCount()
     {
         int count = 0;
@@ -2,6 +2,7 @@
 #define PLAYER_PLAYEROPTIONS_H
 
 #include "GameConfig.h"
+#include "BatchRunner.h"
 
 class CmdlineParser;
 
@@ -11,6 +12,10 @@ namespace playeroptions
     void ApplyConfigOptions(CGameConfig &config, CmdlineParser &parser);
     void ApplyRuntimeOptions(CGameConfig &config, CmdlineParser &parser);
 
+    // Takes the --batch options, which run the player over a list of compositions
+    // instead of starting the game.
+    void ApplyBatchOptions(BatchOptions &options, CmdlineParser &parser);
+
     int GetConfigOptionCount();
     int GetPathOptionCount();
     bool HasConfigOption(const char *longopt, char shortopt);
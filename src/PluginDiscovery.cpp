@@ -0,0 +1,181 @@
+#include "PluginDiscovery.h"
+
+#include <algorithm>
+
+#include "Thread.h"
+
+namespace
+{
+    struct PluginScanJob
+    {
+        CPluginDiscovery *self;
+        const std::vector<int> *indices;
+    };
+
+    // Largest files first so the slowest reads start early.
+    struct LargerFileFirst
+    {
+        bool operator()(const FileEntry *a, const FileEntry *b) const { return a->size > b->size; }
+    };
+}
+
+CPluginDiscovery::CPluginDiscovery(CFileSystem &fileSystem)
+    : m_FileSystem(fileSystem), m_PrefetchFilter(NULL), m_PrefetchFilterArg(NULL),
+      m_PrefetchedFiles(0), m_PrefetchedBytes(0)
+{
+    int i;
+    for (i = 0; i <= ePluginCategoryCount; ++i)
+        m_Scans[i].exists = false;
+}
+
+void CPluginDiscovery::SetDirectory(PluginCategory category, const char *directory)
+{
+    if (category < 0 || category >= ePluginCategoryCount)
+        return;
+    m_Scans[category].directory = directory ? directory : "";
+}
+
+void CPluginDiscovery::SetExecutableDirectory(const char *directory)
+{
+    m_Scans[ePluginCategoryCount].directory = directory ? directory : "";
+}
+
+void CPluginDiscovery::SetPrefetchFilter(PluginPrefetchFilter filter, void *arg)
+{
+    m_PrefetchFilter = filter;
+    m_PrefetchFilterArg = arg;
+}
+
+void CPluginDiscovery::Discover(int threadCount, bool prefetch)
+{
+    if (threadCount > MAX_THREADS)
+        threadCount = MAX_THREADS;
+
+    // Several categories may share a directory; scan each one once and copy the result.
+    int owners[ePluginCategoryCount + 1];
+    std::vector<int> unique;
+    int i, j;
+    for (i = 0; i <= ePluginCategoryCount; ++i)
+    {
+        m_Scans[i].exists = false;
+        m_Scans[i].files.clear();
+        owners[i] = i;
+
+        const std::string normalized = filesystem::NormalizePath(m_Scans[i].directory);
+        for (j = 0; j < i; ++j)
+        {
+            if (!m_Scans[j].directory.empty() && filesystem::NormalizePath(m_Scans[j].directory) == normalized)
+            {
+                owners[i] = owners[j];
+                break;
+            }
+        }
+        if (owners[i] == i && !m_Scans[i].directory.empty())
+            unique.push_back(i);
+    }
+
+    PluginScanJob scanJob = {this, &unique};
+    RunParallel((int)unique.size(), threadCount, ScanTask, &scanJob);
+
+    for (i = 0; i <= ePluginCategoryCount; ++i)
+    {
+        if (owners[i] != i)
+        {
+            m_Scans[i].exists = m_Scans[owners[i]].exists;
+            m_Scans[i].files = m_Scans[owners[i]].files;
+        }
+    }
+
+    m_PrefetchedFiles = 0;
+    m_PrefetchedBytes = 0;
+    if (!prefetch)
+        return;
+
+    m_PrefetchQueue.clear();
+    for (i = 0; i < (int)unique.size(); ++i)
+    {
+        const std::vector<FileEntry> &files = m_Scans[unique[i]].files;
+        size_t k;
+        for (k = 0; k < files.size(); ++k)
+        {
+            if (!m_PrefetchFilter || m_PrefetchFilter(files[k], m_PrefetchFilterArg))
+                m_PrefetchQueue.push_back(&files[k]);
+        }
+    }
+
+    std::stable_sort(m_PrefetchQueue.begin(), m_PrefetchQueue.end(), LargerFileFirst());
+
+    m_PrefetchResults.assign(m_PrefetchQueue.size(), 0);
+    RunParallel((int)m_PrefetchQueue.size(), threadCount, PrefetchTask, this);
+
+    size_t k;
+    for (k = 0; k < m_PrefetchResults.size(); ++k)
+    {
+        if (m_PrefetchResults[k] > 0)
+        {
+            ++m_PrefetchedFiles;
+            m_PrefetchedBytes += m_PrefetchResults[k];
+        }
+    }
+    m_PrefetchQueue.clear();
+    m_PrefetchResults.clear();
+}
+
+bool CPluginDiscovery::HasPlugins(PluginCategory category) const
+{
+    if (category < 0 || category >= ePluginCategoryCount)
+        return false;
+    return m_Scans[category].exists && !m_Scans[category].files.empty();
+}
+
+bool CPluginDiscovery::ClaimDirectory(const char *directory)
+{
+    if (!directory || !*directory)
+        return false;
+
+    const std::string normalized = filesystem::NormalizePath(directory);
+    if (std::find(m_Claimed.begin(), m_Claimed.end(), normalized) != m_Claimed.end())
+        return false;
+
+    m_Claimed.push_back(normalized);
+    return true;
+}
+
+bool CPluginDiscovery::IsDirectoryClaimed(const char *directory) const
+{
+    if (!directory || !*directory)
+        return false;
+
+    const std::string normalized = filesystem::NormalizePath(directory);
+    return std::find(m_Claimed.begin(), m_Claimed.end(), normalized) != m_Claimed.end();
+}
+
+void CPluginDiscovery::ScanTask(int index, void *arg)
+{
+    PluginScanJob *job = (PluginScanJob *)arg;
+    CPluginDiscovery *self = job->self;
+    PluginDirectoryScan &scan = self->m_Scans[(*job->indices)[index]];
+
+    scan.exists = self->m_FileSystem.DirectoryExists(scan.directory.c_str());
+    if (scan.exists)
+        self->ScanDirectory(scan.directory, 0, scan.files);
+}
+
+void CPluginDiscovery::ScanDirectory(const std::string &directory, int depth, std::vector<FileEntry> &files)
+{
+    m_FileSystem.ListFiles(directory.c_str(), ".dll", files);
+    if (depth >= MAX_SCAN_DEPTH)
+        return;
+
+    std::vector<std::string> subdirectories;
+    m_FileSystem.ListDirectories(directory.c_str(), subdirectories);
+    size_t i;
+    for (i = 0; i < subdirectories.size(); ++i)
+        ScanDirectory(subdirectories[i], depth + 1, files);
+}
+
+void CPluginDiscovery::PrefetchTask(int index, void *arg)
+{
+    CPluginDiscovery *self = (CPluginDiscovery *)arg;
+    self->m_PrefetchResults[index] = self->m_FileSystem.Prefetch(self->m_PrefetchQueue[index]->path.c_str());
+}
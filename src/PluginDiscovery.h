@@ -0,0 +1,89 @@
+#ifndef PLAYER_PLUGINDISCOVERY_H
+#define PLAYER_PLUGINDISCOVERY_H
+
+#include <string>
+#include <vector>
+
+#include "FileSystem.h"
+
+// Plugin directories, in the order the player registers them.
+enum PluginCategory
+{
+    ePluginRenderEngines = 0,
+    ePluginManagers,
+    ePluginBuildingBlocks,
+    ePluginPlugins,
+    ePluginCategoryCount
+};
+
+struct PluginDirectoryScan
+{
+    std::string directory;
+    bool exists;
+    std::vector<FileEntry> files;
+};
+
+// Tells whether a DLL found by discovery should be prefetched.
+typedef bool (*PluginPrefetchFilter)(const FileEntry &file, void *arg);
+
+// Lists the plugin directories and reads their DLLs ahead of registration.
+// Subdirectories are scanned too, as CKPluginManager::ParsePlugins() does.
+//
+// Discover() does all the file system work up front on worker threads; the caller
+// then registers the directories one by one on its own thread and asks
+// ClaimDirectory() before each parse, so a directory reached twice (typically the
+// executable directory used as a fallback by several categories) is parsed once.
+class CPluginDiscovery
+{
+public:
+    enum { MAX_THREADS = 4 };
+
+    // How deep discovery follows subdirectories, which also stops link loops.
+    enum { MAX_SCAN_DEPTH = 8 };
+
+    explicit CPluginDiscovery(CFileSystem &fileSystem);
+
+    void SetDirectory(PluginCategory category, const char *directory);
+    void SetExecutableDirectory(const char *directory);
+
+    // DLLs the filter turns down are not prefetched. NULL prefetches every DLL.
+    void SetPrefetchFilter(PluginPrefetchFilter filter, void *arg);
+
+    // Scans every configured directory, then optionally prefetches every DLL found.
+    void Discover(int threadCount, bool prefetch);
+
+    const PluginDirectoryScan &GetScan(PluginCategory category) const { return m_Scans[category]; }
+    const PluginDirectoryScan &GetExecutableScan() const { return m_Scans[ePluginCategoryCount]; }
+
+    // True if the category directory exists and contains at least one DLL.
+    bool HasPlugins(PluginCategory category) const;
+
+    // Returns true the first time a directory is claimed, false for any later spelling of it.
+    bool ClaimDirectory(const char *directory);
+    bool IsDirectoryClaimed(const char *directory) const;
+
+    int GetPrefetchedFiles() const { return m_PrefetchedFiles; }
+    platform::uint64 GetPrefetchedBytes() const { return m_PrefetchedBytes; }
+
+private:
+    CPluginDiscovery(const CPluginDiscovery &);
+    CPluginDiscovery &operator=(const CPluginDiscovery &);
+
+    void ScanDirectory(const std::string &directory, int depth, std::vector<FileEntry> &files);
+
+    static void ScanTask(int index, void *arg);
+    static void PrefetchTask(int index, void *arg);
+
+    CFileSystem &m_FileSystem;
+    PluginDirectoryScan m_Scans[ePluginCategoryCount + 1];
+    std::vector<std::string> m_Claimed;
+    PluginPrefetchFilter m_PrefetchFilter;
+    void *m_PrefetchFilterArg;
+
+    std::vector<const FileEntry *> m_PrefetchQueue;
+    std::vector<platform::uint64> m_PrefetchResults;
+    int m_PrefetchedFiles;
+    platform::uint64 m_PrefetchedBytes;
+};
+
+#endif // PLAYER_PLUGINDISCOVERY_H
@@ -0,0 +1,108 @@
+#include "PluginIndex.h"
+
+bool IsDeferrablePlugin(const PluginManifestEntry &entry)
+{
+    if (entry.infoCount == 0 || entry.infos.empty())
+        return false;
+
+    size_t i;
+    for (i = 0; i < entry.infos.size(); ++i)
+    {
+        if (entry.infos[i].type != PLUGIN_TYPE_BEHAVIOR_DLL)
+            return false;
+        if (entry.infos[i].flags & PLUGIN_INFO_HAS_INIT_INSTANCE)
+            return false;
+    }
+    return true;
+}
+
+void CPluginGuidIndex::Build(const CPluginManifest &manifest)
+{
+    m_Dlls.clear();
+
+    std::vector<const PluginManifestEntry *> entries;
+    manifest.GetEntries(entries);
+
+    size_t i, j;
+    for (i = 0; i < entries.size(); ++i)
+    {
+        const PluginManifestEntry &entry = *entries[i];
+        for (j = 0; j < entry.infos.size(); ++j)
+            Add(entry.infos[j].guid, entry.path);
+        for (j = 0; j < entry.behaviors.size(); ++j)
+            Add(entry.behaviors[j], entry.path);
+    }
+}
+
+const char *CPluginGuidIndex::Find(const PluginGuid &guid) const
+{
+    std::map<platform::uint64, std::string>::const_iterator it = m_Dlls.find(MakeKey(guid));
+    if (it == m_Dlls.end())
+        return NULL;
+    return it->second.c_str();
+}
+
+void CPluginGuidIndex::Add(const PluginGuid &guid, const std::string &path)
+{
+    // insert() keeps an existing mapping.
+    m_Dlls.insert(std::make_pair(MakeKey(guid), path));
+}
+
+void CPluginLoadPlanner::Defer(const char *path)
+{
+    if (!path || !*path)
+        return;
+    m_Deferred[filesystem::NormalizePath(path)] = path;
+}
+
+bool CPluginLoadPlanner::IsDeferred(const char *path) const
+{
+    if (!path)
+        return false;
+    return m_Deferred.find(filesystem::NormalizePath(path)) != m_Deferred.end();
+}
+
+void CPluginLoadPlanner::MarkLoaded(const char *path)
+{
+    if (!path)
+        return;
+    m_Deferred.erase(filesystem::NormalizePath(path));
+}
+
+int CPluginLoadPlanner::Plan(const CPluginGuidIndex &index, const std::vector<PluginGuid> &required,
+                             std::vector<std::string> &dlls, std::vector<PluginGuid> &unresolved) const
+{
+    std::vector<std::string> planned;
+    size_t i;
+    for (i = 0; i < required.size(); ++i)
+    {
+        const char *path = index.Find(required[i]);
+        std::map<std::string, std::string>::const_iterator it = m_Deferred.end();
+        if (path)
+            it = m_Deferred.find(filesystem::NormalizePath(path));
+        if (it == m_Deferred.end())
+        {
+            unresolved.push_back(required[i]);
+            continue;
+        }
+
+        size_t j;
+        for (j = 0; j < planned.size(); ++j)
+        {
+            if (planned[j] == it->first)
+                break;
+        }
+        if (j < planned.size())
+            continue;
+
+        planned.push_back(it->first);
+        dlls.push_back(it->second);
+    }
+    return (int)planned.size();
+}
+
+void CPluginLoadPlanner::GetDeferred(std::vector<std::string> &dlls) const
+{
+    for (std::map<std::string, std::string>::const_iterator it = m_Deferred.begin(); it != m_Deferred.end(); ++it)
+        dlls.push_back(it->second);
+}
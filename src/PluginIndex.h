@@ -0,0 +1,77 @@
+#ifndef PLAYER_PLUGININDEX_H
+#define PLAYER_PLUGININDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "PluginManifest.h"
+
+// CK_PLUGIN_TYPE values the index needs, checked against CKAll.h by the player.
+enum
+{
+    PLUGIN_TYPE_BEHAVIOR_DLL = 4 // CKPLUGIN_BEHAVIOR_DLL
+};
+
+// True for a DLL whose registration can wait until a composition needs it: every
+// plugin it exports is a behavior plugin and none needs a context callback.
+bool IsDeferrablePlugin(const PluginManifestEntry &entry);
+
+// Maps plugin and behavior prototype GUIDs to the DLL providing them.
+class CPluginGuidIndex
+{
+public:
+    CPluginGuidIndex() {}
+
+    void Clear() { m_Dlls.clear(); }
+    int GetGuidCount() const { return (int)m_Dlls.size(); }
+
+    // Indexes every entry of the manifest. When two DLLs declare a GUID, the
+    // first one by path wins.
+    void Build(const CPluginManifest &manifest);
+
+    // Returns the DLL path declaring the GUID, or NULL.
+    const char *Find(const PluginGuid &guid) const;
+
+private:
+    static platform::uint64 MakeKey(const PluginGuid &guid)
+    {
+        return ((platform::uint64)guid.d1 << 32) | guid.d2;
+    }
+
+    void Add(const PluginGuid &guid, const std::string &path);
+
+    std::map<platform::uint64, std::string> m_Dlls;
+};
+
+// Tracks the DLLs whose registration was deferred and decides which of them a
+// composition needs.
+class CPluginLoadPlanner
+{
+public:
+    CPluginLoadPlanner() {}
+
+    void Clear() { m_Deferred.clear(); }
+
+    void Defer(const char *path);
+    bool IsDeferred(const char *path) const;
+    int GetDeferredCount() const { return (int)m_Deferred.size(); }
+
+    // Called once a deferred DLL has been registered.
+    void MarkLoaded(const char *path);
+
+    // Appends the deferred DLLs providing the required GUIDs to dlls, each once and
+    // in the order the GUIDs ask for them. GUIDs that no deferred DLL provides are
+    // appended to unresolved. Returns the number of DLLs appended.
+    int Plan(const CPluginGuidIndex &index, const std::vector<PluginGuid> &required,
+             std::vector<std::string> &dlls, std::vector<PluginGuid> &unresolved) const;
+
+    // Lists the DLLs still deferred, in path order.
+    void GetDeferred(std::vector<std::string> &dlls) const;
+
+private:
+    // Normalized path -> path as given.
+    std::map<std::string, std::string> m_Deferred;
+};
+
+#endif // PLAYER_PLUGININDEX_H
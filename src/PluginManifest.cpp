@@ -0,0 +1,306 @@
+#include "PluginManifest.h"
+
+#include <stdio.h>
+
+namespace
+{
+    const char MANIFEST_MAGIC[] = "BallancePlayerPluginManifest";
+
+    void AppendUInt64(std::string &text, platform::uint64 value)
+    {
+        char digits[24];
+        int count = 0;
+        do
+        {
+            digits[count++] = (char)('0' + (int)(value % 10));
+            value /= 10;
+        } while (value != 0);
+
+        while (count > 0)
+            text += digits[--count];
+    }
+
+    bool ParseUInt64(const std::string &text, platform::uint64 &value)
+    {
+        if (text.empty() || text.size() > 20)
+            return false;
+
+        platform::uint64 result = 0;
+        size_t i;
+        for (i = 0; i < text.size(); ++i)
+        {
+            if (text[i] < '0' || text[i] > '9')
+                return false;
+            platform::uint64 digit = (platform::uint64)(text[i] - '0');
+            if (result > (~(platform::uint64)0 - digit) / 10)
+                return false;
+            result = result * 10 + digit;
+        }
+        value = result;
+        return true;
+    }
+
+    bool ParseInt(const std::string &text, int &value)
+    {
+        platform::uint64 result;
+        if (!ParseUInt64(text, result) || result > 0x7fffffff)
+            return false;
+        value = (int)result;
+        return true;
+    }
+
+    bool ParseHex32(const char *text, size_t length, platform::uint32 &value)
+    {
+        if (length == 0 || length > 8)
+            return false;
+
+        platform::uint32 result = 0;
+        size_t i;
+        for (i = 0; i < length; ++i)
+        {
+            char c = text[i];
+            int digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+            else
+                return false;
+            result = (result << 4) | (platform::uint32)digit;
+        }
+        value = result;
+        return true;
+    }
+
+    // "d1:d2" in hexadecimal.
+    bool ParseGuid(const std::string &text, size_t start, PluginGuid &guid)
+    {
+        size_t colon = text.find(':', start);
+        if (colon == std::string::npos)
+            return false;
+
+        return ParseHex32(text.c_str() + start, colon - start, guid.d1) &&
+               ParseHex32(text.c_str() + colon + 1, text.size() - colon - 1, guid.d2);
+    }
+
+    // "type:flags:d1:d2".
+    bool ParseInfo(const std::string &text, PluginManifestInfo &info)
+    {
+        size_t first = text.find(':');
+        if (first == std::string::npos)
+            return false;
+        size_t second = text.find(':', first + 1);
+        if (second == std::string::npos)
+            return false;
+
+        return ParseInt(text.substr(0, first), info.type) &&
+               ParseInt(text.substr(first + 1, second - first - 1), info.flags) &&
+               ParseGuid(text, second + 1, info.guid);
+    }
+
+    void AppendGuid(std::string &text, const PluginGuid &guid)
+    {
+        char buffer[24];
+        sprintf(buffer, "%08x:%08x", (unsigned int)guid.d1, (unsigned int)guid.d2);
+        text += buffer;
+    }
+
+    void SplitFields(const std::string &line, std::vector<std::string> &fields)
+    {
+        fields.clear();
+        size_t start = 0;
+        for (;;)
+        {
+            size_t tab = line.find('\t', start);
+            if (tab == std::string::npos)
+            {
+                fields.push_back(line.substr(start));
+                return;
+            }
+            fields.push_back(line.substr(start, tab - start));
+            start = tab + 1;
+        }
+    }
+}
+
+const PluginManifestEntry *CPluginManifest::Find(const char *path) const
+{
+    if (!path)
+        return NULL;
+
+    EntryMap::const_iterator it = m_Entries.find(filesystem::NormalizePath(path));
+    if (it == m_Entries.end())
+        return NULL;
+    return &it->second;
+}
+
+const PluginManifestEntry *CPluginManifest::FindCurrent(const FileEntry &file) const
+{
+    const PluginManifestEntry *entry = Find(file.path.c_str());
+    if (!entry || entry->size != file.size || entry->modifiedTime != file.modifiedTime)
+        return NULL;
+    return entry;
+}
+
+void CPluginManifest::Set(const PluginManifestEntry &entry)
+{
+    if (entry.path.empty())
+        return;
+    m_Entries[filesystem::NormalizePath(entry.path)] = entry;
+}
+
+void CPluginManifest::GetEntries(std::vector<const PluginManifestEntry *> &entries) const
+{
+    entries.clear();
+    for (EntryMap::const_iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+        entries.push_back(&it->second);
+}
+
+void CPluginManifest::Write(std::string &text) const
+{
+    text = MANIFEST_MAGIC;
+    text += ' ';
+    AppendUInt64(text, VERSION);
+    text += '\n';
+
+    for (EntryMap::const_iterator it = m_Entries.begin(); it != m_Entries.end(); ++it)
+    {
+        const PluginManifestEntry &entry = it->second;
+        text += entry.path;
+        text += '\t';
+        AppendUInt64(text, entry.size);
+        text += '\t';
+        AppendUInt64(text, entry.modifiedTime);
+        text += '\t';
+        AppendUInt64(text, (platform::uint64)entry.infoCount);
+
+        size_t i;
+        for (i = 0; i < entry.infos.size(); ++i)
+        {
+            char buffer[32];
+            sprintf(buffer, "\t%d:%d:", entry.infos[i].type, entry.infos[i].flags);
+            text += buffer;
+            AppendGuid(text, entry.infos[i].guid);
+        }
+        for (i = 0; i < entry.behaviors.size(); ++i)
+        {
+            text += "\tb:";
+            AppendGuid(text, entry.behaviors[i]);
+        }
+        text += '\n';
+    }
+}
+
+bool CPluginManifest::Read(const std::string &text)
+{
+    m_Entries.clear();
+
+    EntryMap entries;
+    std::vector<std::string> fields;
+    bool header = true;
+    size_t start = 0;
+    while (start < text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+
+        if (header)
+        {
+            std::string expected = MANIFEST_MAGIC;
+            expected += ' ';
+            AppendUInt64(expected, VERSION);
+            if (line != expected)
+                return false;
+            header = false;
+            continue;
+        }
+
+        if (line.empty())
+            continue;
+
+        SplitFields(line, fields);
+        if (fields.size() < 4 || fields[0].empty())
+            return false;
+
+        PluginManifestEntry entry;
+        entry.path = fields[0];
+        if (!ParseUInt64(fields[1], entry.size) ||
+            !ParseUInt64(fields[2], entry.modifiedTime) ||
+            !ParseInt(fields[3], entry.infoCount))
+            return false;
+
+        size_t i;
+        for (i = 4; i < fields.size(); ++i)
+        {
+            if (fields[i].size() > 2 && fields[i][0] == 'b' && fields[i][1] == ':')
+            {
+                PluginGuid guid;
+                if (!ParseGuid(fields[i], 2, guid))
+                    return false;
+                entry.behaviors.push_back(guid);
+                continue;
+            }
+
+            PluginManifestInfo info;
+            if (!ParseInfo(fields[i], info))
+                return false;
+            entry.infos.push_back(info);
+        }
+        if ((size_t)entry.infoCount != entry.infos.size())
+            return false;
+
+        entries[filesystem::NormalizePath(entry.path)] = entry;
+    }
+
+    if (header)
+        return false;
+
+    m_Entries.swap(entries);
+    return true;
+}
+
+bool CPluginManifest::Load(const char *filename)
+{
+    m_Entries.clear();
+    if (!filename || !*filename)
+        return false;
+
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+        return false;
+
+    std::string text;
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.append(buffer, read);
+    fclose(file);
+
+    return Read(text);
+}
+
+bool CPluginManifest::Save(const char *filename) const
+{
+    if (!filename || !*filename)
+        return false;
+
+    std::string text;
+    Write(text);
+
+    FILE *file = fopen(filename, "wb");
+    if (!file)
+        return false;
+
+    bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (fclose(file) != 0)
+        ok = false;
+    return ok;
+}
@@ -0,0 +1,82 @@
+#ifndef PLAYER_PLUGINMANIFEST_H
+#define PLAYER_PLUGINMANIFEST_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FileSystem.h"
+
+struct PluginGuid
+{
+    platform::uint32 d1;
+    platform::uint32 d2;
+};
+
+// Flags of a PluginManifestInfo.
+enum PluginInfoFlags
+{
+    PLUGIN_INFO_HAS_INIT_INSTANCE = 0x1 // needs a callback when a context is created
+};
+
+// One CKPluginInfo exported by a plugin DLL.
+struct PluginManifestInfo
+{
+    int type; // CK_PLUGIN_TYPE
+    int flags;
+    PluginGuid guid;
+};
+
+struct PluginManifestEntry
+{
+    std::string path;
+    platform::uint64 size;
+    platform::uint64 modifiedTime;
+    int infoCount; // 0 for a DLL that is not a Virtools plugin
+    std::vector<PluginManifestInfo> infos;
+    std::vector<PluginGuid> behaviors; // prototypes declared by behavior plugins
+
+    PluginManifestEntry() : size(0), modifiedTime(0), infoCount(0) {}
+};
+
+// What the player learned about each plugin DLL on a previous start.
+//
+// An entry stays valid while the DLL keeps the size and modification time it was
+// recorded with. A manifest with another version, a malformed line or an entry whose
+// info count disagrees with its infos is discarded as a whole, which falls back to
+// probing every DLL.
+class CPluginManifest
+{
+public:
+    enum { VERSION = 2 };
+
+    CPluginManifest() {}
+
+    void Clear() { m_Entries.clear(); }
+    bool IsEmpty() const { return m_Entries.empty(); }
+    int GetEntryCount() const { return (int)m_Entries.size(); }
+
+    // Looks an entry up by path, ignoring case and separator differences.
+    const PluginManifestEntry *Find(const char *path) const;
+
+    // Returns the entry recorded for the file if it still matches its size and time.
+    const PluginManifestEntry *FindCurrent(const FileEntry &file) const;
+
+    void Set(const PluginManifestEntry &entry);
+
+    // Lists every entry, ordered by normalized path.
+    void GetEntries(std::vector<const PluginManifestEntry *> &entries) const;
+
+    void Write(std::string &text) const;
+    bool Read(const std::string &text);
+
+    bool Load(const char *filename);
+    bool Save(const char *filename) const;
+
+private:
+    typedef std::map<std::string, PluginManifestEntry> EntryMap;
+
+    EntryMap m_Entries;
+};
+
+#endif // PLAYER_PLUGINMANIFEST_H
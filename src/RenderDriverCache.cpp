@@ -0,0 +1,343 @@
+#include "RenderDriverCache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace
+{
+    const char CACHE_MAGIC[] = "BallancePlayerDriverCache";
+
+    // Driver names come from the system; the fields of the format cannot hold
+    // tabs or line breaks.
+    std::string MakeStorable(const std::string &text)
+    {
+        std::string result = text;
+        size_t i;
+        for (i = 0; i < result.size(); ++i)
+        {
+            if (result[i] == '\t' || result[i] == '\r' || result[i] == '\n')
+                result[i] = ' ';
+        }
+        return result;
+    }
+
+    void SplitFields(const std::string &line, std::vector<std::string> &fields)
+    {
+        fields.clear();
+        size_t start = 0;
+        for (;;)
+        {
+            size_t tab = line.find('\t', start);
+            if (tab == std::string::npos)
+            {
+                fields.push_back(line.substr(start));
+                return;
+            }
+            fields.push_back(line.substr(start, tab - start));
+            start = tab + 1;
+        }
+    }
+
+    bool ParseInt(const std::string &text, int &value)
+    {
+        if (text.empty() || text.size() > 10)
+            return false;
+
+        char *end = NULL;
+        const long result = strtol(text.c_str(), &end, 10);
+        if (!end || *end != '\0' || result < 0)
+            return false;
+        value = (int)result;
+        return true;
+    }
+
+    void AppendInt(std::string &text, int value)
+    {
+        char buffer[16];
+        sprintf(buffer, "%d", value);
+        text += buffer;
+    }
+
+    bool SameModes(const std::vector<DisplayMode> &a, const std::vector<DisplayMode> &b)
+    {
+        if (a.size() != b.size())
+            return false;
+
+        size_t i;
+        for (i = 0; i < a.size(); ++i)
+        {
+            if (a[i].width != b[i].width || a[i].height != b[i].height ||
+                a[i].bpp != b[i].bpp || a[i].refreshRate != b[i].refreshRate)
+                return false;
+        }
+        return true;
+    }
+}
+
+void CRenderDriverCache::Reset(const std::string &adapter, const std::string &driverVersion)
+{
+    m_Adapter = MakeStorable(adapter);
+    m_DriverVersion = MakeStorable(driverVersion);
+    m_Drivers.clear();
+}
+
+bool CRenderDriverCache::Matches(const std::string &adapter, const std::string &driverVersion) const
+{
+    if (m_Drivers.empty() || m_Adapter.empty())
+        return false;
+    return m_Adapter == MakeStorable(adapter) && m_DriverVersion == MakeStorable(driverVersion);
+}
+
+void CRenderDriverCache::AddDriver(const CachedRenderDriver &driver)
+{
+    m_Drivers.push_back(driver);
+    m_Drivers.back().name = MakeStorable(driver.name);
+    m_Drivers.back().description = MakeStorable(driver.description);
+}
+
+bool CRenderDriverCache::Equals(const CRenderDriverCache &other) const
+{
+    if (m_Adapter != other.m_Adapter || m_DriverVersion != other.m_DriverVersion)
+        return false;
+    if (m_Drivers.size() != other.m_Drivers.size())
+        return false;
+
+    size_t i;
+    for (i = 0; i < m_Drivers.size(); ++i)
+    {
+        const CachedRenderDriver &a = m_Drivers[i];
+        const CachedRenderDriver &b = other.m_Drivers[i];
+        if (a.name != b.name || a.description != b.description || !SameModes(a.modes, b.modes))
+            return false;
+    }
+    return true;
+}
+
+bool CRenderDriverCache::HasSameModes(const CRenderDriverCache &other, int index) const
+{
+    if (index < 0 || index >= (int)m_Drivers.size() || index >= (int)other.m_Drivers.size())
+        return false;
+    return SameModes(m_Drivers[index].modes, other.m_Drivers[index].modes);
+}
+
+void CRenderDriverCache::Write(std::string &text) const
+{
+    text = CACHE_MAGIC;
+    text += ' ';
+    AppendInt(text, VERSION);
+    text += '\n';
+
+    text += m_Adapter;
+    text += '\t';
+    text += m_DriverVersion;
+    text += '\n';
+
+    size_t i;
+    for (i = 0; i < m_Drivers.size(); ++i)
+    {
+        const CachedRenderDriver &driver = m_Drivers[i];
+        text += "d\t";
+        text += driver.name;
+        text += '\t';
+        text += driver.description;
+        text += '\n';
+
+        size_t j;
+        for (j = 0; j < driver.modes.size(); ++j)
+        {
+            const DisplayMode &mode = driver.modes[j];
+            text += "m\t";
+            AppendInt(text, mode.width);
+            text += '\t';
+            AppendInt(text, mode.height);
+            text += '\t';
+            AppendInt(text, mode.bpp);
+            text += '\t';
+            AppendInt(text, mode.refreshRate);
+            text += '\n';
+        }
+    }
+}
+
+bool CRenderDriverCache::Read(const std::string &text)
+{
+    m_Adapter.clear();
+    m_DriverVersion.clear();
+    m_Drivers.clear();
+
+    std::string header = CACHE_MAGIC;
+    header += ' ';
+    AppendInt(header, VERSION);
+
+    std::string adapter;
+    std::string driverVersion;
+    std::vector<CachedRenderDriver> drivers;
+    std::vector<std::string> fields;
+    int lineNumber = 0;
+    size_t start = 0;
+    while (start < text.size())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+            end = text.size();
+        std::string line = text.substr(start, end - start);
+        start = end + 1;
+
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+
+        ++lineNumber;
+        if (lineNumber == 1)
+        {
+            if (line != header)
+                return false;
+            continue;
+        }
+
+        SplitFields(line, fields);
+        if (lineNumber == 2)
+        {
+            if (fields.size() != 2)
+                return false;
+            adapter = fields[0];
+            driverVersion = fields[1];
+            continue;
+        }
+
+        if (line.empty())
+            continue;
+
+        if (fields[0] == "d" && fields.size() == 3)
+        {
+            CachedRenderDriver driver;
+            driver.name = fields[1];
+            driver.description = fields[2];
+            drivers.push_back(driver);
+        }
+        else if (fields[0] == "m" && fields.size() == 5 && !drivers.empty())
+        {
+            DisplayMode mode;
+            if (!ParseInt(fields[1], mode.width) ||
+                !ParseInt(fields[2], mode.height) ||
+                !ParseInt(fields[3], mode.bpp) ||
+                !ParseInt(fields[4], mode.refreshRate))
+                return false;
+            drivers.back().modes.push_back(mode);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (lineNumber < 2)
+        return false;
+
+    m_Adapter = adapter;
+    m_DriverVersion = driverVersion;
+    m_Drivers.swap(drivers);
+    return true;
+}
+
+bool CRenderDriverCache::Load(const char *filename)
+{
+    m_Drivers.clear();
+    if (!filename || !*filename)
+        return false;
+
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+        return false;
+
+    std::string text;
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        text.append(buffer, read);
+    fclose(file);
+
+    return Read(text);
+}
+
+bool CRenderDriverCache::Save(const char *filename) const
+{
+    if (!filename || !*filename)
+        return false;
+
+    std::string text;
+    Write(text);
+
+    FILE *file = fopen(filename, "wb");
+    if (!file)
+        return false;
+
+    bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (fclose(file) != 0)
+        ok = false;
+    return ok;
+}
+
+CRenderDriverCacheRefresh::CRenderDriverCacheRefresh()
+    : m_Source(NULL), m_Done(0), m_Changed(0), m_ChangeTaken(0) {}
+
+CRenderDriverCacheRefresh::~CRenderDriverCacheRefresh()
+{
+    Wait();
+}
+
+bool CRenderDriverCacheRefresh::Start(CRenderDriverSource &source, const CRenderDriverCache &cached, const char *filename)
+{
+    if (m_Thread.IsStarted())
+        return false;
+
+    m_Source = &source;
+    m_Cached = cached;
+    m_Drivers.Reset(cached.GetAdapter(), cached.GetDriverVersion());
+    m_Filename = filename ? filename : "";
+    platform::AtomicStore(&m_Done, 0);
+    platform::AtomicStore(&m_Changed, 0);
+    platform::AtomicStore(&m_ChangeTaken, 0);
+
+    if (!m_Thread.Start(Run, this))
+    {
+        Run(this);
+        return false;
+    }
+    return true;
+}
+
+void CRenderDriverCacheRefresh::Wait()
+{
+    if (m_Thread.IsStarted())
+        m_Thread.Join();
+}
+
+bool CRenderDriverCacheRefresh::IsDone() const
+{
+    return platform::AtomicLoad(&m_Done) != 0;
+}
+
+bool CRenderDriverCacheRefresh::HasChanged() const
+{
+    return IsDone() && platform::AtomicLoad(&m_Changed) != 0;
+}
+
+bool CRenderDriverCacheRefresh::TakeChange()
+{
+    if (!HasChanged())
+        return false;
+    return platform::AtomicExchange(&m_ChangeTaken, 1) == 0;
+}
+
+void CRenderDriverCacheRefresh::Run(void *arg)
+{
+    CRenderDriverCacheRefresh *refresh = (CRenderDriverCacheRefresh *)arg;
+
+    if (refresh->m_Source->Enumerate(refresh->m_Drivers) && !refresh->m_Drivers.Equals(refresh->m_Cached))
+    {
+        if (!refresh->m_Filename.empty())
+            refresh->m_Drivers.Save(refresh->m_Filename.c_str());
+        platform::AtomicStore(&refresh->m_Changed, 1);
+    }
+    platform::AtomicStore(&refresh->m_Done, 1);
+}
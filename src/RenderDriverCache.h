@@ -0,0 +1,109 @@
+#ifndef PLAYER_RENDERDRIVERCACHE_H
+#define PLAYER_RENDERDRIVERCACHE_H
+
+#include <string>
+#include <vector>
+
+#include "DisplayModeCatalog.h"
+#include "Thread.h"
+
+struct CachedRenderDriver
+{
+    std::string name;
+    std::string description;
+    std::vector<DisplayMode> modes;
+};
+
+// The render drivers and display modes of a previous launch, with the display
+// adapter and adapter driver version they were listed on. A launch on the same
+// adapter and version can validate its display settings against the cache
+// before the engine lists the drivers again.
+class CRenderDriverCache
+{
+public:
+    enum { VERSION = 1 };
+
+    CRenderDriverCache() {}
+
+    // Drops every driver and starts a cache for the adapter and driver version.
+    void Reset(const std::string &adapter, const std::string &driverVersion);
+
+    // True if the cache holds drivers listed on the adapter and driver version.
+    bool Matches(const std::string &adapter, const std::string &driverVersion) const;
+
+    const std::string &GetAdapter() const { return m_Adapter; }
+    const std::string &GetDriverVersion() const { return m_DriverVersion; }
+
+    void AddDriver(const CachedRenderDriver &driver);
+    int GetDriverCount() const { return (int)m_Drivers.size(); }
+    const CachedRenderDriver &GetDriver(int index) const { return m_Drivers[index]; }
+
+    // True if both hold the same identity, drivers and modes, in the same order.
+    bool Equals(const CRenderDriverCache &other) const;
+
+    // True if both hold the driver and it lists the same modes in the same order.
+    bool HasSameModes(const CRenderDriverCache &other, int index) const;
+
+    void Write(std::string &text) const;
+    bool Read(const std::string &text);
+
+    bool Load(const char *filename);
+    bool Save(const char *filename) const;
+
+private:
+    std::string m_Adapter;
+    std::string m_DriverVersion;
+    std::vector<CachedRenderDriver> m_Drivers;
+};
+
+// Lists the drivers the engine found, so a refresh can run without the engine in tests.
+class CRenderDriverSource
+{
+public:
+    virtual ~CRenderDriverSource() {}
+
+    // Adds every driver to the cache, which was reset for the current adapter.
+    virtual bool Enumerate(CRenderDriverCache &drivers) = 0;
+};
+
+// Lists the drivers on a worker thread, compares them with the cache the launch
+// started from and saves them when they differ.
+class CRenderDriverCacheRefresh
+{
+public:
+    CRenderDriverCacheRefresh();
+    ~CRenderDriverCacheRefresh();
+
+    // The cache gives the adapter identity; it may hold no drivers. The file is
+    // not written when the filename is empty.
+    bool Start(CRenderDriverSource &source, const CRenderDriverCache &cached, const char *filename);
+    void Wait();
+
+    bool IsDone() const;
+
+    // True once a finished refresh found drivers that differ from the cache.
+    bool HasChanged() const;
+
+    // Returns true only the first time it is called after HasChanged() became true.
+    bool TakeChange();
+
+    // The drivers the refresh listed; only valid once it is done.
+    const CRenderDriverCache &GetDrivers() const { return m_Drivers; }
+
+private:
+    CRenderDriverCacheRefresh(const CRenderDriverCacheRefresh &);
+    CRenderDriverCacheRefresh &operator=(const CRenderDriverCacheRefresh &);
+
+    static void Run(void *arg);
+
+    CThread m_Thread;
+    CRenderDriverSource *m_Source;
+    CRenderDriverCache m_Cached;
+    CRenderDriverCache m_Drivers;
+    std::string m_Filename;
+    volatile long m_Done;
+    volatile long m_Changed;
+    volatile long m_ChangeTaken;
+};
+
+#endif // PLAYER_RENDERDRIVERCACHE_H
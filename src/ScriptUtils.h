@@ -14,6 +14,8 @@
 #include "CKParameterLocal.h"
 #include "CKParameterManager.h"
 
+#include "BehaviorGraphIndex.h"
+
 namespace scriptutils
 {
     inline CKSTRING ToCKString(const char *value)
@@ -21,6 +23,34 @@ namespace scriptutils
         return const_cast<CKSTRING>(value);
     }
 
+    // Accessors of the behavior graph for CBehaviorGraphIndex.
+    struct CKBehaviorGraph
+    {
+        typedef CKBehavior *Behavior;
+        typedef CKBehaviorLink *Link;
+        typedef CKBehaviorIO *IO;
+
+        static int GetSubBehaviorCount(CKBehavior *script) { return script->GetSubBehaviorCount(); }
+        static CKBehavior *GetSubBehavior(CKBehavior *script, int index) { return script->GetSubBehavior(index); }
+        static int GetSubLinkCount(CKBehavior *script) { return script->GetSubBehaviorLinkCount(); }
+        static CKBehaviorLink *GetSubLink(CKBehavior *script, int index) { return script->GetSubBehaviorLink(index); }
+        static const char *GetName(CKBehavior *beh) { return beh->GetName(); }
+
+        static const char *GetTargetName(CKBehavior *beh)
+        {
+            CKObject *target = beh->GetTarget();
+            return target ? target->GetName() : NULL;
+        }
+
+        static CKBehaviorIO *GetInput(CKBehavior *beh, int pos) { return beh->GetInput(pos); }
+        static CKBehaviorIO *GetOutput(CKBehavior *beh, int pos) { return beh->GetOutput(pos); }
+        static CKBehaviorIO *GetLinkInput(CKBehaviorLink *link) { return link->GetInBehaviorIO(); }
+        static CKBehaviorIO *GetLinkOutput(CKBehaviorLink *link) { return link->GetOutBehaviorIO(); }
+        static CKBehavior *GetOwner(CKBehaviorIO *io) { return io->GetOwner(); }
+    };
+
+    typedef CBehaviorGraphIndex<CKBehaviorGraph> BehaviorGraphIndex;
+
     inline CKBehaviorLink *CreateBehaviorLink(CKBehavior *script, CKBehaviorIO *in, CKBehaviorIO *out, int delay = 0)
     {
         assert(script != NULL);
@@ -350,6 +380,47 @@ namespace scriptutils
         return link;
     }
 
+    // The helpers below edit the script of the index and keep the index up to date.
+
+    inline CKBehaviorLink *CreateBehaviorLink(BehaviorGraphIndex &index, CKBehaviorIO *in, CKBehaviorIO *out, int delay = 0)
+    {
+        CKBehaviorLink *link = CreateBehaviorLink(index.GetScript(), in, out, delay);
+        index.AddLink(link);
+        return link;
+    }
+
+    inline CKBehaviorLink *CreateBehaviorLink(BehaviorGraphIndex &index, CKBehavior *inBeh, CKBehavior *outBeh, int inPos = 0, int outPos = 0, int delay = 0)
+    {
+        assert(inBeh != NULL);
+        assert(outBeh != NULL);
+
+        return CreateBehaviorLink(index, inBeh->GetOutput(inPos), outBeh->GetInput(outPos), delay);
+    }
+
+    inline void SetBehaviorLinkOutput(BehaviorGraphIndex &index, CKBehaviorLink *link, CKBehaviorIO *out)
+    {
+        assert(link != NULL);
+        assert(out != NULL);
+
+        link->SetOutBehaviorIO(out);
+        index.UpdateLink(link);
+    }
+
+    inline CKBehaviorLink *RemoveBehaviorLink(BehaviorGraphIndex &index, CKBehaviorLink *link, bool destroy = false)
+    {
+        assert(index.GetScript() != NULL);
+        assert(link != NULL);
+
+        index.RemoveLink(link);
+        index.GetScript()->RemoveSubBehaviorLink(link);
+        if (destroy)
+        {
+            CKDestroyObject(link);
+            return NULL;
+        }
+        return link;
+    }
+
     inline CKBehavior *CreateBehavior(CKBehavior *script, CKGUID guid, bool useTarget = false)
     {
         assert(script != NULL);
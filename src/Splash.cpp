@@ -2,58 +2,72 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "resource.h"
+#include "LoadProgress.h"
+#include "Logger.h"
 
 #define PALVERSION 0x300
 
-static CSplash gSplash;
-static HPALETTE hPalette = NULL;
+// How often the window thread looks at the progress when no message arrives.
+#define SPLASH_REFRESH_MS 33
+#define SPLASH_BAR_HEIGHT 4
+
+// The splash being shown; only one window of the class exists at a time.
+static CSplash *gSplash = NULL;
+static CLoadProgress *gProgress = NULL;
+
+// A BITMAPINFO with room for a full 8-bit palette.
+struct SplashBitmapInfo
+{
+    BITMAPINFOHEADER header;
+    RGBQUAD colors[CBmpImage::MAX_PALETTE_SIZE];
+};
+
+static void GetProgressBarRect(HWND hWnd, RECT &rect)
+{
+    ::GetClientRect(hWnd, &rect);
+    rect.top = rect.bottom - SPLASH_BAR_HEIGHT;
+}
+
+static void PaintProgressBar(HWND hWnd, HDC hDc)
+{
+    if (!gProgress)
+        return;
+
+    LoadProgressSnapshot snapshot;
+    if (!gProgress->Read(snapshot))
+        return;
+
+    RECT bar;
+    GetProgressBarRect(hWnd, bar);
+    RECT filled = bar;
+    filled.right = bar.left + (bar.right - bar.left) * CLoadProgress::GetPermille(snapshot) / 1000;
+    RECT rest = bar;
+    rest.left = filled.right;
+
+    ::FillRect(hDc, &filled, (HBRUSH)::GetStockObject(WHITE_BRUSH));
+    ::FillRect(hDc, &rest, (HBRUSH)::GetStockObject(BLACK_BRUSH));
+}
 
 LRESULT CALLBACK SplashWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
     HDC hDc;
     PAINTSTRUCT ps;
-
-    static HINSTANCE hInstance;
-    static DWORD dwNewWidth, dwNewHeight;
+    HPALETTE hPalette = gSplash ? gSplash->GetPalette() : NULL;
 
     switch (uMsg)
     {
     case WM_CREATE:
-        hInstance = ((LPCREATESTRUCT)lParam)->hInstance;
-        hPalette = gSplash.GetPalette();
         ::SetCursor(::LoadCursorA(NULL, (LPCSTR)IDC_ARROW));
         return 0;
 
-    case WM_DESTROY:
-        ::DeleteObject(hPalette);
-        return 0;
-
-    case WM_SIZE:
-        dwNewWidth = LOWORD(lParam);
-        dwNewHeight = HIWORD(lParam);
-        return 0;
-
     case WM_PAINT:
         hDc = ::BeginPaint(hWnd, &ps);
-        if (hPalette)
-        {
-            ::SelectPalette(hDc, hPalette, FALSE);
-            ::RealizePalette(hDc);
-        }
-        ::SetDIBitsToDevice(hDc,
-                            0,
-                            0,
-                            gSplash.GetWidth(),
-                            gSplash.GetHeight(),
-                            0,
-                            0,
-                            0,
-                            gSplash.GetHeight(),
-                            gSplash.GetBitmapData(),
-                            gSplash.GetBitmapInfo(),
-                            DIB_RGB_COLORS);
+        if (gSplash)
+            gSplash->Paint(hDc);
+        PaintProgressBar(hWnd, hDc);
         ::EndPaint(hWnd, &ps);
         return 0;
 
@@ -80,6 +94,10 @@ LRESULT CALLBACK SplashWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPara
         }
         break;
 
+    case WM_CLOSE:
+        // Only the window thread takes the splash down, once its loop sees the close request.
+        return 0;
+
     default:
         break;
     }
@@ -87,20 +105,74 @@ LRESULT CALLBACK SplashWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPara
     return DefWindowProc(hWnd, uMsg, wParam, lParam);
 }
 
-CSplash::CSplash() : m_Data(NULL), m_hWnd(NULL), m_hInstance(NULL) {}
+CSplash::CSplash()
+    : m_Width(0), m_Height(0), m_hPalette(NULL), m_hCache(NULL), m_hWnd(NULL), m_hInstance(NULL),
+      m_Progress(NULL), m_Visible(0), m_Closing(0) {}
 
-CSplash::CSplash(HINSTANCE hInstance) : m_Data(NULL), m_hWnd(NULL), m_hInstance(hInstance) {}
+CSplash::CSplash(HINSTANCE hInstance)
+    : m_Width(0), m_Height(0), m_hPalette(NULL), m_hCache(NULL), m_hWnd(NULL), m_hInstance(hInstance),
+      m_Progress(NULL), m_Visible(0), m_Closing(0) {}
 
 CSplash::~CSplash()
 {
-    if (m_Data)
-        delete[] m_Data;
+    Close();
+    ReleaseBitmap();
+}
+
+bool CSplash::Show(CLoadProgress *progress)
+{
+    if (m_Thread.IsStarted())
+        return IsVisible();
+
+    m_Progress = progress;
+    platform::AtomicStore(&m_Closing, 0);
+    if (!m_Thread.Start(WindowThread, this))
+        return false;
+
+    // Wait until the window is up so a fast load cannot close it before it exists.
+    m_Ready.Acquire();
+    if (!IsVisible())
+    {
+        m_Thread.Join();
+        return false;
+    }
+    return true;
+}
+
+void CSplash::Close()
+{
+    if (!m_Thread.IsStarted())
+        return;
+
+    platform::AtomicStore(&m_Closing, 1);
+    HWND hWnd = m_hWnd;
+    if (hWnd)
+        ::PostMessageA(hWnd, WM_CLOSE, 0, 0);
+    m_Thread.Join();
 }
 
-bool CSplash::Show()
+void CSplash::WindowThread(void *arg)
 {
-    m_Data = NULL;
+    CSplash *splash = (CSplash *)arg;
+
+    // The window belongs to the thread that creates it, so all of its life is spent here.
+    bool created = splash->CreateSplashWindow();
+    if (created)
+        platform::AtomicStore(&splash->m_Visible, 1);
+    splash->m_Ready.Release();
+    if (!created)
+    {
+        splash->DestroySplashWindow();
+        return;
+    }
+
+    splash->RunMessageLoop();
+    splash->DestroySplashWindow();
+    platform::AtomicStore(&splash->m_Visible, 0);
+}
 
+bool CSplash::CreateSplashWindow()
+{
     WNDCLASSA wndclass;
     memset(&wndclass, 0, sizeof(WNDCLASSA));
     wndclass.style = CS_HREDRAW | CS_VREDRAW;
@@ -122,15 +194,17 @@ bool CSplash::Show()
     char drive[4];
     char dir[MAX_PATH];
     char filename[MAX_PATH];
-    ::GetModuleFileNameA(NULL, buffer, 1024);
+    ::GetModuleFileNameA(NULL, buffer, MAX_PATH);
     _splitpath(buffer, drive, dir, filename, NULL);
     _snprintf(buffer, MAX_PATH, "%s%ssplash.bmp", drive, dir);
-    if (!gSplash.LoadBMP(buffer))
+    if (!LoadBMP(buffer))
         return false;
 
-    int width = gSplash.GetWidth();
-    int height = gSplash.GetHeight();
+    int width = m_Width;
+    int height = m_Height;
 
+    gSplash = this;
+    gProgress = m_Progress;
     m_hWnd = ::CreateWindowExA(
         WS_EX_LEFT,
         "SPLASH",
@@ -144,179 +218,213 @@ bool CSplash::Show()
         NULL,
         m_hInstance,
         NULL);
-    ::UpdateWindow(m_hWnd);
+    if (!m_hWnd)
+        return false;
+
+    // Convert the picture once, so painting is a plain copy however often it happens.
+    if (!CacheBitmap())
+        CLogger::Get().Debug("Failed to cache the splash bitmap, drawing it from the file.");
+
     ::ShowWindow(m_hWnd, SW_SHOW);
+    ::UpdateWindow(m_hWnd);
+    return true;
+}
 
-    MSG msg;
-    int counter = 0;
-    while (::GetMessageA(&msg, NULL, 0, 0))
+void CSplash::RunMessageLoop()
+{
+    long painted = m_Progress ? m_Progress->GetSequence() : 0;
+    for (;;)
     {
-        if (msg.message == WM_QUIT)
-        {
+        if (platform::AtomicLoad(&m_Closing) || (m_Progress && m_Progress->IsFinished()))
             break;
-        }
 
-        ::TranslateMessage(&msg);
-        ::DispatchMessageA(&msg);
-        ::InvalidateRect(m_hWnd, NULL, FALSE);
+        ::MsgWaitForMultipleObjects(0, NULL, FALSE, SPLASH_REFRESH_MS, QS_ALLINPUT);
 
-        if (counter++ == 500)
+        MSG msg;
+        while (::PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE))
         {
-            ::Sleep(100);
-            ::DestroyWindow(m_hWnd);
-            break;
+            ::TranslateMessage(&msg);
+            ::DispatchMessageA(&msg);
+        }
+
+        // Redraw only the bar, and only when the loader reported something new.
+        if (m_Progress)
+        {
+            const long sequence = m_Progress->GetSequence();
+            if (sequence != painted && (sequence & 1) == 0)
+            {
+                painted = sequence;
+                RECT bar;
+                GetProgressBarRect(m_hWnd, bar);
+                ::InvalidateRect(m_hWnd, &bar, FALSE);
+            }
         }
     }
+}
 
-    ::DeleteObject(hPalette);
-    return true;
+void CSplash::DestroySplashWindow()
+{
+    if (m_hWnd)
+    {
+        ::DestroyWindow(m_hWnd);
+        m_hWnd = NULL;
+    }
+    gSplash = NULL;
+    gProgress = NULL;
+    ::UnregisterClassA("SPLASH", m_hInstance);
+    ReleaseBitmap();
 }
 
 bool CSplash::LoadBMP(LPCSTR lpFileName)
 {
-    if (m_Data)
-        delete[] m_Data;
-
-    HANDLE hFile = ::CreateFileA(lpFileName,
-                                 GENERIC_READ,
-                                 1,
-                                 NULL,
-                                 OPEN_EXISTING,
-                                 FILE_FLAG_SEQUENTIAL_SCAN,
-                                 NULL);
-    if (hFile == (HANDLE)-1)
-        return false;
+    ReleaseBitmap();
 
-    DWORD dwBytesRead, dwBytesToRead;
-    char buffer[16];
-    if (!::ReadFile(hFile, buffer, 14, &dwBytesRead, NULL) || dwBytesRead != 14 ||
-        (buffer[0] != 'B' || buffer[1] != 'M'))
-    {
-        ::CloseHandle(hFile);
+    if (!m_File.Open(lpFileName))
         return false;
-    }
 
-    dwBytesToRead = *(DWORD *)&buffer[2] - 14;
-    m_Data = new BYTE[dwBytesToRead];
-    if (!::ReadFile(hFile, m_Data, dwBytesToRead, &dwBytesRead, NULL) || dwBytesRead != dwBytesToRead)
+    if (!m_Image.Decode(m_File.GetData(), (size_t)m_File.GetSize()))
     {
-        ::CloseHandle(hFile);
-        delete[] m_Data;
+        CLogger::Get().Warn("Splash bitmap is not a supported BMP file: %s", lpFileName);
+        m_File.Close();
         return false;
     }
 
-    ::CloseHandle(hFile);
+    m_Width = m_Image.GetWidth();
+    m_Height = m_Image.GetHeight();
+    CreateSplashPalette();
     return true;
 }
 
-DWORD CSplash::GetWidth() const
+void CSplash::Paint(HDC hDc)
 {
-    DWORD dwHeaderSize = *(DWORD *)&m_Data[0];
-    return (dwHeaderSize == 12) ? *(WORD *)&m_Data[4] : *(DWORD *)&m_Data[4];
-}
+    if (m_hPalette)
+    {
+        ::SelectPalette(hDc, m_hPalette, FALSE);
+        ::RealizePalette(hDc);
+    }
 
-DWORD CSplash::GetHeight() const
-{
-    DWORD dwHeaderSize = *(DWORD *)&m_Data[0];
-    return (dwHeaderSize == 12) ? *(WORD *)&m_Data[6] : *(DWORD *)&m_Data[8];
-}
+    if (m_hCache)
+    {
+        HDC hMemDc = ::CreateCompatibleDC(hDc);
+        if (hMemDc)
+        {
+            HGDIOBJ hOld = ::SelectObject(hMemDc, m_hCache);
+            ::BitBlt(hDc, 0, 0, m_Width, m_Height, hMemDc, 0, 0, SRCCOPY);
+            ::SelectObject(hMemDc, hOld);
+            ::DeleteDC(hMemDc);
+            return;
+        }
+    }
 
-DWORD CSplash::GetBPP() const
-{
-    DWORD dwHeaderSize = *(DWORD *)&m_Data[0];
-    return (dwHeaderSize == 12) ? *(WORD *)&m_Data[10] : *(DWORD *)&m_Data[14];
-}
+    if (!m_Image.IsValid())
+        return;
 
-DWORD CSplash::GetDIBHeaderSize() const
-{
-    DWORD dwHeaderSize = *(DWORD *)&m_Data[0];
-    if (dwHeaderSize == 40 && *(DWORD *)&m_Data[16] == 3)
-        return 52;
-    return dwHeaderSize;
+    SplashBitmapInfo info;
+    FillBitmapInfo((BITMAPINFO *)&info);
+    ::SetDIBitsToDevice(hDc, 0, 0, m_Width, m_Height, 0, 0, 0, m_Height,
+                        m_Image.GetPixels(), (BITMAPINFO *)&info, DIB_RGB_COLORS);
 }
 
-DWORD CSplash::GetPaletteNumColors() const
+void CSplash::CreateSplashPalette()
 {
-    DWORD dwHeaderSize = *(DWORD *)&m_Data[0];
-    return (dwHeaderSize == 12) ? 0 : *(DWORD *)&m_Data[32];
-}
+    const int count = m_Image.GetPaletteSize();
+    if (count == 0)
+        return;
 
-DWORD CSplash::GetPaletteNumEntries() const
-{
-    DWORD dwPaletteNumColors = GetPaletteNumColors();
-    if (dwPaletteNumColors || GetBPP() >= 16)
-        return dwPaletteNumColors;
-    else
-        return 1 << GetBPP();
+    LPLOGPALETTE lpLogPalette = (LPLOGPALETTE)malloc(sizeof(LOGPALETTE) + count * sizeof(PALETTEENTRY));
+    if (!lpLogPalette)
+        return;
+    lpLogPalette->palVersion = PALVERSION;
+    lpLogPalette->palNumEntries = (WORD)count;
+
+    const BmpPaletteEntry *entries = m_Image.GetPalette();
+    for (int i = 0; i < count; i++)
+    {
+        lpLogPalette->palPalEntry[i].peRed = entries[i].red;
+        lpLogPalette->palPalEntry[i].peGreen = entries[i].green;
+        lpLogPalette->palPalEntry[i].peBlue = entries[i].blue;
+        lpLogPalette->palPalEntry[i].peFlags = PC_NONE;
+    }
+
+    m_hPalette = ::CreatePalette(lpLogPalette);
+    free(lpLogPalette);
 }
 
-DWORD CSplash::GetPaletteSize() const
+void CSplash::FillBitmapInfo(BITMAPINFO *bmi) const
 {
-    DWORD dwHeaderSize = *(DWORD *)&m_Data[0];
-    return (dwHeaderSize == 12) ? 3 * GetPaletteNumEntries() : 4 * GetPaletteNumEntries();
+    memset(bmi, 0, sizeof(SplashBitmapInfo));
+    bmi->bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi->bmiHeader.biWidth = m_Width;
+    bmi->bmiHeader.biHeight = m_Image.IsTopDown() ? -m_Height : m_Height;
+    bmi->bmiHeader.biPlanes = 1;
+    bmi->bmiHeader.biBitCount = (WORD)m_Image.GetBitCount();
+    bmi->bmiHeader.biCompression = BI_RGB;
+    bmi->bmiHeader.biClrUsed = m_Image.GetPaletteSize();
+
+    // The decoder already laid the palette out as RGBQUADs.
+    if (m_Image.GetPaletteSize() > 0)
+        memcpy(bmi->bmiColors, m_Image.GetPalette(), m_Image.GetPaletteSize() * sizeof(RGBQUAD));
 }
 
-BYTE *CSplash::GetPaletteData() const
+bool CSplash::CacheBitmap()
 {
-    if (!GetPaletteNumEntries())
-        return NULL;
+    if (!m_Image.IsValid() || !m_hWnd)
+        return false;
 
-    return &m_Data[GetDIBHeaderSize()];
-}
+    HDC hDc = ::GetDC(m_hWnd);
+    if (!hDc)
+        return false;
 
-BYTE *CSplash::GetPaletteEntry(DWORD index) const
-{
-    if (!GetPaletteNumEntries())
-        return NULL;
+    bool cached = false;
+    HDC hMemDc = ::CreateCompatibleDC(hDc);
+    HBITMAP hBitmap = ::CreateCompatibleBitmap(hDc, m_Width, m_Height);
+    if (hMemDc && hBitmap)
+    {
+        HGDIOBJ hOld = ::SelectObject(hMemDc, hBitmap);
+        if (m_hPalette)
+        {
+            ::SelectPalette(hMemDc, m_hPalette, FALSE);
+            ::RealizePalette(hMemDc);
+        }
 
-    DWORD dwHeaderSize = *(DWORD *)&m_Data[0];
-    return (dwHeaderSize == 12) ? &GetPaletteData()[3 * index] : &GetPaletteData()[4 * index];
-}
+        SplashBitmapInfo info;
+        FillBitmapInfo((BITMAPINFO *)&info);
+        cached = ::SetDIBitsToDevice(hMemDc, 0, 0, m_Width, m_Height, 0, 0, 0, m_Height,
+                                     m_Image.GetPixels(), (BITMAPINFO *)&info, DIB_RGB_COLORS) != 0;
+        ::SelectObject(hMemDc, hOld);
+    }
+    if (hMemDc)
+        ::DeleteDC(hMemDc);
+    ::ReleaseDC(m_hWnd, hDc);
 
-BITMAPINFO *CSplash::GetBitmapInfo() const
-{
-    static BITMAPINFO bmi;
-    memset(&bmi, 0, sizeof(bmi));
-    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = GetWidth();
-    bmi.bmiHeader.biHeight = GetHeight();
-    bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = (WORD)GetBPP();
-    bmi.bmiHeader.biCompression = BI_RGB;
-    bmi.bmiHeader.biSizeImage = 0;
-    return &bmi;
-}
+    if (!cached)
+    {
+        if (hBitmap)
+            ::DeleteObject(hBitmap);
+        return false;
+    }
 
-BYTE *CSplash::GetBitmapData() const
-{
-    return &m_Data[GetDIBHeaderSize() + GetPaletteSize()];
+    // The converted copy is all painting needs; the file can go.
+    m_hCache = hBitmap;
+    m_Image.Clear();
+    m_File.Close();
+    return true;
 }
 
-HPALETTE CSplash::GetPalette() const
+void CSplash::ReleaseBitmap()
 {
-    WORD palNumEntries = (WORD)GetPaletteNumEntries();
-    if (palNumEntries == 0)
-        return NULL;
-
-    LPLOGPALETTE lpLogPalette = (LPLOGPALETTE)malloc(sizeof(LOGPALETTE) + palNumEntries * sizeof(PALETTEENTRY));
-    if (!lpLogPalette)
-        return NULL;
-    lpLogPalette->palVersion = PALVERSION;
-    lpLogPalette->palNumEntries = palNumEntries;
-
-    BYTE *lpEntry = NULL;
-    LPPALETTEENTRY lpPalEntry = &lpLogPalette->palPalEntry[0];
-    for (int i = 0; i < palNumEntries; i++)
+    if (m_hCache)
     {
-        lpEntry = GetPaletteEntry(i);
-        lpPalEntry->peRed = lpEntry[0];
-        lpPalEntry->peGreen = lpEntry[1];
-        lpPalEntry->peBlue = lpEntry[2];
-        lpPalEntry->peFlags = PC_NONE;
-        ++lpPalEntry;
+        ::DeleteObject(m_hCache);
+        m_hCache = NULL;
     }
-
-    HPALETTE hPal = ::CreatePalette(lpLogPalette);
-    free(lpLogPalette);
-    return hPal;
-}
\ No newline at end of file
+    if (m_hPalette)
+    {
+        ::DeleteObject(m_hPalette);
+        m_hPalette = NULL;
+    }
+    m_Image.Clear();
+    m_File.Close();
+    m_Width = 0;
+    m_Height = 0;
+}
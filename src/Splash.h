@@ -9,6 +9,12 @@
 #undef WIN32_LEAN_AND_MEAN
 #endif
 
+#include "Thread.h"
+#include "MappedFile.h"
+#include "BmpImage.h"
+
+class CLoadProgress;
+
 class CSplash
 {
 public:
@@ -16,28 +22,50 @@ public:
     explicit CSplash(HINSTANCE hInstance);
     ~CSplash();
 
-    bool Show();
+    // Shows the splash from a thread of its own, so it keeps painting while the
+    // caller starts the engine. It draws the progress as a bar along its bottom
+    // edge and goes away by itself once the progress is finished, or at Close().
+    bool Show(CLoadProgress *progress = NULL);
+    void Close();
+    bool IsVisible() const { return platform::AtomicLoad(&m_Visible) != 0; }
+
+    // Maps the file and decodes it in place; the pixels are not copied until
+    // they are converted for the screen.
     bool LoadBMP(LPCSTR lpFileName);
-    DWORD GetWidth() const;
-    DWORD GetHeight() const;
-    DWORD GetBPP() const;
-    DWORD GetDIBHeaderSize() const;
-    DWORD GetPaletteNumColors() const;
-    DWORD GetPaletteNumEntries() const;
-    DWORD GetPaletteSize() const;
-    BYTE *GetPaletteData() const;
-    BYTE *GetPaletteEntry(DWORD index) const;
-    BITMAPINFO *GetBitmapInfo() const;
-    BYTE *GetBitmapData() const;
-    HPALETTE GetPalette() const;
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    HPALETTE GetPalette() const { return m_hPalette; }
+
+    // Draws the splash picture, from the screen-format copy once there is one.
+    void Paint(HDC hDc);
 
 private:
     CSplash(const CSplash &);
     CSplash &operator=(const CSplash &);
 
-    BYTE *m_Data;
+    static void WindowThread(void *arg);
+    bool CreateSplashWindow();
+    void RunMessageLoop();
+    void DestroySplashWindow();
+
+    void CreateSplashPalette();
+    void FillBitmapInfo(BITMAPINFO *bmi) const;
+    bool CacheBitmap();
+    void ReleaseBitmap();
+
+    CMappedFile m_File;
+    CBmpImage m_Image;
+    int m_Width;
+    int m_Height;
+    HPALETTE m_hPalette;
+    HBITMAP m_hCache; // the picture converted to the screen's format
     HWND m_hWnd;
     HINSTANCE m_hInstance;
+    CLoadProgress *m_Progress;
+    CThread m_Thread;
+    CSemaphore m_Ready;
+    volatile long m_Visible;
+    volatile long m_Closing;
 };
 
 #endif /* PLAYER_SPLASH_H */
\ No newline at end of file
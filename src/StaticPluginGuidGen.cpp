@@ -0,0 +1,117 @@
+// Build-time tool: writes the plugin infos of the static plugin table, ordered by
+// GUID, as the StaticPluginGuids.inc that StaticPlugins.cpp compiles in.
+//
+// Only the GetInfoCount/GetInfo entry points are called. They return static data,
+// so no CK context is created.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CKPluginManager.h"
+
+#include "StaticPluginTable.inc"
+
+namespace
+{
+    int CompareGuids(const void *lhs, const void *rhs)
+    {
+        const StaticPluginGuid *a = (const StaticPluginGuid *)lhs;
+        const StaticPluginGuid *b = (const StaticPluginGuid *)rhs;
+        if (a->D1 != b->D1)
+            return a->D1 < b->D1 ? -1 : 1;
+        if (a->D2 != b->D2)
+            return a->D2 < b->D2 ? -1 : 1;
+        return a->Plugin - b->Plugin;
+    }
+
+    int CollectGuids(StaticPluginGuid *guids, int capacity)
+    {
+        int count = 0;
+        int i, j;
+        for (i = 0; i < kStaticPluginCount; ++i)
+        {
+            const StaticPlugin &plugin = kStaticPlugins[i];
+            const int infoCount = plugin.GetInfoCount ? plugin.GetInfoCount() : 1;
+            for (j = 0; j < infoCount; ++j)
+            {
+                const CKPluginInfo *info = plugin.GetInfo(j);
+                if (!info)
+                    continue;
+                if (count == capacity)
+                    return -1;
+
+                StaticPluginGuid &guid = guids[count++];
+                guid.D1 = (unsigned long)info->m_GUID.d1;
+                guid.D2 = (unsigned long)info->m_GUID.d2;
+                guid.Plugin = i;
+                guid.Type = (int)info->m_Type;
+                guid.Flags = info->m_InitInstanceFct ? STATIC_PLUGIN_HAS_INIT_INSTANCE : 0;
+            }
+        }
+        return count;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s <output>\n", argv[0]);
+        return 2;
+    }
+
+    enum { MAX_GUIDS = 1024 };
+    static StaticPluginGuid guids[MAX_GUIDS];
+    const int count = CollectGuids(guids, MAX_GUIDS);
+    if (count < 0)
+    {
+        fprintf(stderr, "More than %d static plugin infos\n", (int)MAX_GUIDS);
+        return 1;
+    }
+    if (count == 0)
+    {
+        fprintf(stderr, "No static plugin infos\n");
+        return 1;
+    }
+
+    qsort(guids, count, sizeof(guids[0]), CompareGuids);
+
+    int i;
+    for (i = 1; i < count; ++i)
+    {
+        if (guids[i].D1 == guids[i - 1].D1 && guids[i].D2 == guids[i - 1].D2)
+        {
+            fprintf(stderr, "%s and %s both provide the plugin 0x%08lx,0x%08lx\n",
+                    kStaticPlugins[guids[i - 1].Plugin].Name, kStaticPlugins[guids[i].Plugin].Name,
+                    guids[i].D1, guids[i].D2);
+            return 1;
+        }
+    }
+
+    FILE *fp = fopen(argv[1], "w");
+    if (!fp)
+    {
+        fprintf(stderr, "Cannot write %s\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(fp, "// Generated by StaticPluginGuidGen from the static plugin table; do not edit.\n\n");
+    fprintf(fp, "// Plugin infos ordered by GUID, for FindStaticPluginGuid().\n");
+    fprintf(fp, "static const StaticPluginGuid kStaticPluginGuids[] = {\n");
+    for (i = 0; i < count; ++i)
+    {
+        fprintf(fp, "    {0x%08lxUL, 0x%08lxUL, %d, %d, %d}, // %s\n",
+                guids[i].D1, guids[i].D2, guids[i].Plugin, guids[i].Type, guids[i].Flags,
+                kStaticPlugins[guids[i].Plugin].Name);
+    }
+    fprintf(fp, "};\n\nstatic const int kStaticPluginGuidCount = %d;\n", count);
+
+    const bool ok = ferror(fp) == 0;
+    if (fclose(fp) != 0 || !ok)
+    {
+        fprintf(stderr, "Cannot write %s\n", argv[1]);
+        remove(argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+# Generates the static plugin table compiled into StaticPlugins.cpp.
+#
+# Each module is declared once with ballance_add_static_plugin(); the same list
+# then yields the generated table and the targets the player links against, so
+# the two can no longer drift apart.
+#
+#   ballance_add_static_plugin(<name> INFO <function>
+#                              [TARGET <target>]
+#                              [INFO_COUNT <function>]
+#                              [READER <function>]
+#                              [DECLARATIONS <function>])
+#
+#   ballance_generate_static_plugin_table(<output file> [TARGETS <variable>])
+#
+#   ballance_generate_static_plugin_guids(<output file> TOOL <target>
+#                                         TABLE_DIR <directory of the table>
+#                                         [SOURCES <sources>...]
+#                                         [LIBRARIES <libraries>...])
+#
+# Generating a table consumes the declared modules, so another table can be
+# declared afterwards.
+#
+# The plugin GUIDs are only known to the modules themselves, so the GUID table is
+# written at build time by a tool linked against them (see StaticPluginGuidGen.cpp).
+# List the output file among the sources of the target including it.
+
+set(_BALLANCE_STATIC_PLUGIN_TEMPLATE "${CMAKE_CURRENT_LIST_DIR}/StaticPluginTable.inc.in")
+set(_BALLANCE_STATIC_PLUGIN_GUID_GEN "${CMAKE_CURRENT_LIST_DIR}/StaticPluginGuidGen.cpp")
+
+function(ballance_add_static_plugin name)
+    cmake_parse_arguments(PLUGIN "" "TARGET;INFO;INFO_COUNT;READER;DECLARATIONS" "" ${ARGN})
+
+    if (NOT PLUGIN_INFO)
+        message(FATAL_ERROR "Static plugin ${name} needs an INFO function")
+    endif ()
+    if (NOT name MATCHES "^[A-Za-z0-9_]+$")
+        message(FATAL_ERROR "Static plugin name ${name} must be a C identifier-like name")
+    endif ()
+
+    get_property(_names GLOBAL PROPERTY BALLANCE_STATIC_PLUGIN_NAMES)
+    if (name IN_LIST _names)
+        message(FATAL_ERROR "Static plugin ${name} is declared twice")
+    endif ()
+
+    foreach (_field IN ITEMS TARGET INFO INFO_COUNT READER DECLARATIONS)
+        set_property(GLOBAL PROPERTY BALLANCE_STATIC_PLUGIN_${name}_${_field} "${PLUGIN_${_field}}")
+    endforeach ()
+    set_property(GLOBAL APPEND PROPERTY BALLANCE_STATIC_PLUGIN_NAMES "${name}")
+endfunction()
+
+function(ballance_generate_static_plugin_table output)
+    cmake_parse_arguments(TABLE "" "TARGETS" "" ${ARGN})
+
+    get_property(_names GLOBAL PROPERTY BALLANCE_STATIC_PLUGIN_NAMES)
+    list(LENGTH _names STATIC_PLUGIN_COUNT)
+    if (STATIC_PLUGIN_COUNT EQUAL 0)
+        message(FATAL_ERROR "No static plugins declared")
+    endif ()
+
+    set(STATIC_PLUGIN_DECLARATIONS "")
+    set(STATIC_PLUGIN_ENTRIES "")
+    set(_targets "")
+    foreach (_name IN LISTS _names)
+        foreach (_field IN ITEMS TARGET INFO INFO_COUNT READER DECLARATIONS)
+            get_property(_${_field} GLOBAL PROPERTY BALLANCE_STATIC_PLUGIN_${_name}_${_field})
+        endforeach ()
+
+        string(APPEND STATIC_PLUGIN_DECLARATIONS "extern CKPluginInfo *${_INFO}(int);\n")
+        set(_count_fn NULL)
+        set(_reader_fn NULL)
+        set(_declarations_fn NULL)
+        if (_INFO_COUNT)
+            string(APPEND STATIC_PLUGIN_DECLARATIONS "extern int ${_INFO_COUNT}();\n")
+            set(_count_fn ${_INFO_COUNT})
+        endif ()
+        if (_READER)
+            string(APPEND STATIC_PLUGIN_DECLARATIONS "extern CKDataReader *${_READER}(int);\n")
+            set(_reader_fn ${_READER})
+        endif ()
+        if (_DECLARATIONS)
+            string(APPEND STATIC_PLUGIN_DECLARATIONS "extern void ${_DECLARATIONS}(XObjectDeclarationArray *);\n")
+            set(_declarations_fn ${_DECLARATIONS})
+        endif ()
+
+        string(APPEND STATIC_PLUGIN_ENTRIES
+                "    {\"${_name}\", ${_count_fn}, ${_INFO}, ${_reader_fn}, ${_declarations_fn}},\n")
+
+        if (_TARGET)
+            list(APPEND _targets ${_TARGET})
+        endif ()
+    endforeach ()
+
+    configure_file("${_BALLANCE_STATIC_PLUGIN_TEMPLATE}" "${output}" @ONLY)
+    set_property(GLOBAL PROPERTY BALLANCE_STATIC_PLUGIN_NAMES "")
+
+    if (TABLE_TARGETS)
+        set(${TABLE_TARGETS} ${_targets} PARENT_SCOPE)
+    endif ()
+endfunction()
+
+function(ballance_generate_static_plugin_guids output)
+    cmake_parse_arguments(GUIDS "" "TOOL;TABLE_DIR" "SOURCES;LIBRARIES" ${ARGN})
+
+    if (NOT GUIDS_TOOL OR NOT GUIDS_TABLE_DIR)
+        message(FATAL_ERROR "ballance_generate_static_plugin_guids needs TOOL and TABLE_DIR")
+    endif ()
+
+    add_executable(${GUIDS_TOOL} "${_BALLANCE_STATIC_PLUGIN_GUID_GEN}" ${GUIDS_SOURCES})
+    target_include_directories(${GUIDS_TOOL} PRIVATE "${GUIDS_TABLE_DIR}")
+    target_link_libraries(${GUIDS_TOOL} PRIVATE ${GUIDS_LIBRARIES})
+
+    add_custom_command(OUTPUT "${output}"
+            COMMAND ${GUIDS_TOOL} "${output}"
+            DEPENDS ${GUIDS_TOOL}
+            COMMENT "Generating ${output}"
+            VERBATIM)
+endfunction()
@@ -2,7 +2,21 @@
 #define PLAYER_BALLANCESTATICPLUGINS_H
 
 class CKPluginManager;
+class CKFile;
 
-bool RegisterStaticPlugins(CKPluginManager *pluginManager);
+// Registers the static modules in table order. With deferBehaviors, the modules
+// providing only building blocks are left for RegisterStaticPluginsFor() and
+// RegisterRemainingStaticPlugins().
+bool RegisterStaticPlugins(CKPluginManager *pluginManager, bool deferBehaviors = false);
+
+// Registers the deferred modules providing the plugins the file misses, looked up
+// in the generated GUID table. Returns the number of modules registered.
+int RegisterStaticPluginsFor(CKPluginManager *pluginManager, CKFile *file);
+
+// Registers up to maxCount modules still deferred in table order, all of them when
+// maxCount is negative. Returns the number of modules registered.
+int RegisterRemainingStaticPlugins(CKPluginManager *pluginManager, int maxCount = -1);
+
+int GetDeferredStaticPluginCount();
 
 #endif /* PLAYER_BALLANCESTATICPLUGINS_H */
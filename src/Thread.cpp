@@ -0,0 +1,229 @@
+#include "Thread.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <sys/time.h>
+#endif
+
+CThread::CThread() : m_Handle(), m_Function(NULL), m_Arg(NULL), m_Started(false) {}
+
+CThread::~CThread()
+{
+    Join();
+}
+
+bool CThread::Start(ThreadFunction function, void *arg)
+{
+    if (m_Started || !function)
+        return false;
+
+    m_Function = function;
+    m_Arg = arg;
+
+#ifdef _WIN32
+    DWORD threadId = 0;
+    m_Handle = ::CreateThread(NULL, 0, ThreadProc, this, 0, &threadId);
+    if (!m_Handle)
+        return false;
+#else
+    if (pthread_create(&m_Handle, NULL, ThreadProc, this) != 0)
+        return false;
+#endif
+
+    m_Started = true;
+    return true;
+}
+
+void CThread::Join()
+{
+    if (!m_Started)
+        return;
+
+#ifdef _WIN32
+    ::WaitForSingleObject(m_Handle, INFINITE);
+    ::CloseHandle(m_Handle);
+    m_Handle = NULL;
+#else
+    pthread_join(m_Handle, NULL);
+#endif
+    m_Started = false;
+}
+
+#ifdef _WIN32
+DWORD WINAPI CThread::ThreadProc(LPVOID param)
+{
+    CThread *thread = (CThread *)param;
+    thread->m_Function(thread->m_Arg);
+    return 0;
+}
+#else
+void *CThread::ThreadProc(void *param)
+{
+    CThread *thread = (CThread *)param;
+    thread->m_Function(thread->m_Arg);
+    return NULL;
+}
+#endif
+
+CMutex::CMutex()
+{
+#ifdef _WIN32
+    ::InitializeCriticalSection(&m_Lock);
+#else
+    pthread_mutex_init(&m_Lock, NULL);
+#endif
+}
+
+CMutex::~CMutex()
+{
+#ifdef _WIN32
+    ::DeleteCriticalSection(&m_Lock);
+#else
+    pthread_mutex_destroy(&m_Lock);
+#endif
+}
+
+void CMutex::Lock()
+{
+#ifdef _WIN32
+    ::EnterCriticalSection(&m_Lock);
+#else
+    pthread_mutex_lock(&m_Lock);
+#endif
+}
+
+void CMutex::Unlock()
+{
+#ifdef _WIN32
+    ::LeaveCriticalSection(&m_Lock);
+#else
+    pthread_mutex_unlock(&m_Lock);
+#endif
+}
+
+CSemaphore::CSemaphore(long initialCount)
+{
+#ifdef _WIN32
+    m_Handle = ::CreateSemaphoreA(NULL, initialCount, 0x7FFFFFFF, NULL);
+#else
+    pthread_mutex_init(&m_Lock, NULL);
+    pthread_cond_init(&m_Cond, NULL);
+    m_Count = initialCount;
+#endif
+}
+
+CSemaphore::~CSemaphore()
+{
+#ifdef _WIN32
+    if (m_Handle)
+        ::CloseHandle(m_Handle);
+#else
+    pthread_cond_destroy(&m_Cond);
+    pthread_mutex_destroy(&m_Lock);
+#endif
+}
+
+void CSemaphore::Release(long count)
+{
+    if (count <= 0)
+        return;
+
+#ifdef _WIN32
+    ::ReleaseSemaphore(m_Handle, count, NULL);
+#else
+    pthread_mutex_lock(&m_Lock);
+    m_Count += count;
+    if (count == 1)
+        pthread_cond_signal(&m_Cond);
+    else
+        pthread_cond_broadcast(&m_Cond);
+    pthread_mutex_unlock(&m_Lock);
+#endif
+}
+
+bool CSemaphore::Acquire(unsigned long timeoutMs)
+{
+#ifdef _WIN32
+    DWORD timeout = (timeoutMs == WAIT_FOREVER) ? INFINITE : (DWORD)timeoutMs;
+    return ::WaitForSingleObject(m_Handle, timeout) == WAIT_OBJECT_0;
+#else
+    pthread_mutex_lock(&m_Lock);
+    if (timeoutMs == WAIT_FOREVER)
+    {
+        while (m_Count == 0)
+            pthread_cond_wait(&m_Cond, &m_Lock);
+    }
+    else
+    {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        struct timespec deadline;
+        unsigned long long nsec = (unsigned long long)now.tv_usec * 1000 + (unsigned long long)(timeoutMs % 1000) * 1000000;
+        deadline.tv_sec = now.tv_sec + (time_t)(timeoutMs / 1000) + (time_t)(nsec / 1000000000);
+        deadline.tv_nsec = (long)(nsec % 1000000000);
+
+        while (m_Count == 0)
+        {
+            if (pthread_cond_timedwait(&m_Cond, &m_Lock, &deadline) == ETIMEDOUT)
+                break;
+        }
+    }
+
+    bool acquired = m_Count > 0;
+    if (acquired)
+        --m_Count;
+    pthread_mutex_unlock(&m_Lock);
+    return acquired;
+#endif
+}
+
+namespace
+{
+    struct ParallelJob
+    {
+        volatile long next;
+        int count;
+        ParallelTask task;
+        void *arg;
+    };
+
+    void RunParallelWorker(void *param)
+    {
+        ParallelJob *job = (ParallelJob *)param;
+        for (;;)
+        {
+            long index = platform::AtomicIncrement(&job->next) - 1;
+            if (index >= job->count)
+                break;
+            job->task((int)index, job->arg);
+        }
+    }
+}
+
+void RunParallel(int count, int threadCount, ParallelTask task, void *arg)
+{
+    if (count <= 0 || !task)
+        return;
+    if (threadCount > count)
+        threadCount = count;
+    if (threadCount < 1)
+        threadCount = 1;
+
+    ParallelJob job;
+    job.next = 0;
+    job.count = count;
+    job.task = task;
+    job.arg = arg;
+
+    CThread *workers = (threadCount > 1) ? new CThread[threadCount - 1] : NULL;
+    int i;
+    for (i = 0; i < threadCount - 1; ++i)
+        workers[i].Start(RunParallelWorker, &job);
+
+    // Whatever the workers do not pick up, including everything when none could start, runs here.
+    RunParallelWorker(&job);
+
+    for (i = 0; i < threadCount - 1; ++i)
+        workers[i].Join();
+    delete[] workers;
+}
@@ -0,0 +1,105 @@
+#ifndef PLAYER_THREAD_H
+#define PLAYER_THREAD_H
+
+#include "Platform.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+typedef void (*ThreadFunction)(void *arg);
+
+class CThread
+{
+public:
+    CThread();
+    ~CThread();
+
+    bool Start(ThreadFunction function, void *arg);
+    void Join();
+
+    bool IsStarted() const { return m_Started; }
+
+private:
+    CThread(const CThread &);
+    CThread &operator=(const CThread &);
+
+#ifdef _WIN32
+    static DWORD WINAPI ThreadProc(LPVOID param);
+    HANDLE m_Handle;
+#else
+    static void *ThreadProc(void *param);
+    pthread_t m_Handle;
+#endif
+    ThreadFunction m_Function;
+    void *m_Arg;
+    bool m_Started;
+};
+
+class CMutex
+{
+public:
+    CMutex();
+    ~CMutex();
+
+    void Lock();
+    void Unlock();
+
+private:
+    CMutex(const CMutex &);
+    CMutex &operator=(const CMutex &);
+
+#ifdef _WIN32
+    CRITICAL_SECTION m_Lock;
+#else
+    pthread_mutex_t m_Lock;
+#endif
+};
+
+class CMutexLock
+{
+public:
+    explicit CMutexLock(CMutex &mutex) : m_Mutex(mutex) { m_Mutex.Lock(); }
+    ~CMutexLock() { m_Mutex.Unlock(); }
+
+private:
+    CMutexLock(const CMutexLock &);
+    CMutexLock &operator=(const CMutexLock &);
+
+    CMutex &m_Mutex;
+};
+
+class CSemaphore
+{
+public:
+    enum { WAIT_FOREVER = 0xFFFFFFFF };
+
+    explicit CSemaphore(long initialCount = 0);
+    ~CSemaphore();
+
+    void Release(long count = 1);
+
+    // Returns false if the timeout expired before a count could be taken.
+    bool Acquire(unsigned long timeoutMs = WAIT_FOREVER);
+
+private:
+    CSemaphore(const CSemaphore &);
+    CSemaphore &operator=(const CSemaphore &);
+
+#ifdef _WIN32
+    HANDLE m_Handle;
+#else
+    pthread_mutex_t m_Lock;
+    pthread_cond_t m_Cond;
+    long m_Count;
+#endif
+};
+
+typedef void (*ParallelTask)(int index, void *arg);
+
+// Runs task(i, arg) for every i in [0, count) on up to threadCount threads, the
+// calling thread included, and returns once all of them finished. Indices are
+// handed out in increasing order.
+void RunParallel(int count, int threadCount, ParallelTask task, void *arg);
+
+#endif // PLAYER_THREAD_H
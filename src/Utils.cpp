@@ -85,6 +85,76 @@ namespace utils
         return true;
     }
 
+    typedef struct tagBP_DISPLAY_DEVICEA
+    {
+        DWORD cb;
+        CHAR DeviceName[32];
+        CHAR DeviceString[128];
+        DWORD StateFlags;
+        CHAR DeviceID[128];
+        CHAR DeviceKey[128];
+    } BP_DISPLAY_DEVICEA;
+
+#ifndef DISPLAY_DEVICE_PRIMARY_DEVICE
+#define DISPLAY_DEVICE_PRIMARY_DEVICE 0x00000004
+#endif
+
+    typedef BOOL(WINAPI *EnumDisplayDevicesAProc)(LPCSTR, DWORD, BP_DISPLAY_DEVICEA *, DWORD);
+
+    static void ReadDriverVersion(const char *deviceKey, char *driverVersion, size_t versionSize)
+    {
+        // DeviceKey names the adapter's key as \Registry\Machine\System\...
+        static const char machinePrefix[] = "\\Registry\\Machine\\";
+        const size_t prefixLength = sizeof(machinePrefix) - 1;
+        if (strlen(deviceKey) <= prefixLength || _strnicmp(deviceKey, machinePrefix, prefixLength) != 0)
+            return;
+
+        HKEY key = NULL;
+        if (::RegOpenKeyExA(HKEY_LOCAL_MACHINE, deviceKey + prefixLength, 0, KEY_READ, &key) != ERROR_SUCCESS)
+            return;
+
+        DWORD type = 0;
+        DWORD size = static_cast<DWORD>(versionSize - 1);
+        if (::RegQueryValueExA(key, "DriverVersion", NULL, &type, (LPBYTE)driverVersion, &size) == ERROR_SUCCESS && type == REG_SZ)
+            driverVersion[size] = '\0';
+        else
+            driverVersion[0] = '\0';
+        ::RegCloseKey(key);
+    }
+
+    bool GetDisplayAdapterIdentity(char *adapter, size_t adapterSize, char *driverVersion, size_t versionSize)
+    {
+        if (!adapter || adapterSize == 0 || !driverVersion || versionSize == 0)
+            return false;
+        adapter[0] = '\0';
+        driverVersion[0] = '\0';
+
+        EnsureMonitorApisLoaded();
+        if (!g_User32)
+            return false;
+
+        EnumDisplayDevicesAProc enumDisplayDevices = (EnumDisplayDevicesAProc)::GetProcAddress(g_User32, "EnumDisplayDevicesA");
+        if (!enumDisplayDevices)
+            return false;
+
+        BP_DISPLAY_DEVICEA device;
+        DWORD i;
+        for (i = 0;; ++i)
+        {
+            memset(&device, 0, sizeof(device));
+            device.cb = sizeof(device);
+            if (!enumDisplayDevices(NULL, i, &device, 0))
+                return false;
+            if (device.StateFlags & DISPLAY_DEVICE_PRIMARY_DEVICE)
+                break;
+        }
+
+        _snprintf(adapter, adapterSize, "%s %s", device.DeviceString, device.DeviceID);
+        adapter[adapterSize - 1] = '\0';
+        ReadDriverVersion(device.DeviceKey, driverVersion, versionSize);
+        return true;
+    }
+
     bool FileOrDirectoryExists(const char *file)
     {
         if (!file || file[0] == '\0')
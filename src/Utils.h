@@ -44,6 +44,10 @@ namespace utils
     // Returns the monitor bounds for the monitor nearest to the specified window.
     // Falls back to primary monitor metrics if multi-monitor APIs are unavailable.
     bool GetMonitorRectForWindow(HWND window, RECT &outRect);
+
+    // Describes the primary display adapter: its name and device ID, and the
+    // version of its driver. The version is empty if the registry does not list it.
+    bool GetDisplayAdapterIdentity(char *adapter, size_t adapterSize, char *driverVersion, size_t versionSize);
 }
 
 #endif // PLAYER_UTILS_H
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "AssetCache.h"
+
+namespace {
+    struct Payload {
+        explicit Payload(const std::string &name) : name(name) {}
+        std::string name;
+    };
+
+    void ReleasePayload(void *payload, void *context) {
+        std::vector<std::string> *released = (std::vector<std::string> *)context;
+        Payload *p = (Payload *)payload;
+        released->push_back(p->name);
+        delete p;
+    }
+
+    struct CacheFixture {
+        CacheFixture() { cache.SetReleaseFunction(ReleasePayload, &released); }
+
+        bool Insert(const char *path, platform::uint32 crc, platform::uint64 size) {
+            Payload *payload = new Payload(path);
+            if (cache.Insert(path, crc, 1, payload, size))
+                return true;
+            delete payload;
+            return false;
+        }
+
+        // Declared first so it outlives the cache releasing into it.
+        std::vector<std::string> released;
+        CAssetCache cache;
+    };
+}
+
+TEST(AssetCacheTest, FindsEntriesByPathAndContent) {
+    CacheFixture f;
+    f.cache.SetBudget(1000);
+    f.cache.BeginLoad();
+    ASSERT_TRUE(f.Insert("Levels/Level_01.NMO", 0xAAAA, 100));
+
+    const AssetCacheEntry *entry = f.cache.Find("levels\\level_01.nmo", 0xAAAA);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(((Payload *)entry->payload)->name, "Levels/Level_01.NMO");
+    EXPECT_EQ(entry->size, 100u);
+
+    // Same path, different content.
+    EXPECT_EQ(f.cache.Find("Levels/Level_01.NMO", 0xBBBB), nullptr);
+    EXPECT_EQ(f.cache.Find("Levels/Level_02.NMO", 0xAAAA), nullptr);
+    EXPECT_EQ(f.cache.Find(nullptr, 0xAAAA), nullptr);
+    EXPECT_EQ(f.cache.GetHits(), 1);
+    EXPECT_EQ(f.cache.GetMisses(), 2);
+}
+
+TEST(AssetCacheTest, PeekDoesNotCountAsUse) {
+    CacheFixture f;
+    f.cache.SetBudget(300);
+    f.cache.BeginLoad();
+    ASSERT_TRUE(f.Insert("a.cmo", 1, 100));
+    ASSERT_TRUE(f.Insert("b.cmo", 2, 100));
+
+    f.cache.BeginLoad();
+    ASSERT_NE(f.cache.Find("b.cmo", 2), nullptr);
+    const AssetCacheEntry *a = f.cache.Peek("A.CMO");
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(a->crc, 1u);
+    EXPECT_EQ(f.cache.GetHits(), 1);
+
+    // Peek did not pin a.cmo, so it is the one to go.
+    ASSERT_TRUE(f.Insert("c.cmo", 3, 150));
+    EXPECT_EQ(f.cache.Peek("a.cmo"), nullptr);
+    ASSERT_EQ(f.released.size(), 1u);
+    EXPECT_EQ(f.released[0], "a.cmo");
+}
+
+TEST(AssetCacheTest, EvictsLeastRecentlyUsedOutsideTheCurrentLoad) {
+    CacheFixture f;
+    f.cache.SetBudget(300);
+
+    f.cache.BeginLoad();
+    ASSERT_TRUE(f.Insert("one.cmo", 1, 100));
+    f.cache.BeginLoad();
+    ASSERT_TRUE(f.Insert("two.cmo", 2, 100));
+    f.cache.BeginLoad();
+    ASSERT_TRUE(f.Insert("three.cmo", 3, 100));
+
+    // Rotation comes back to one.cmo, which becomes the most recent.
+    f.cache.BeginLoad();
+    ASSERT_NE(f.cache.Find("one.cmo", 1), nullptr);
+    ASSERT_TRUE(f.Insert("four.cmo", 4, 100));
+
+    ASSERT_EQ(f.released.size(), 1u);
+    EXPECT_EQ(f.released[0], "two.cmo");
+    EXPECT_EQ(f.cache.GetEvictions(), 1);
+    EXPECT_EQ(f.cache.GetEntryCount(), 3);
+    EXPECT_EQ(f.cache.GetTotalBytes(), 300u);
+}
+
+TEST(AssetCacheTest, NeverEvictsWhatTheCurrentLoadUses) {
+    CacheFixture f;
+    f.cache.SetBudget(250);
+    f.cache.BeginLoad();
+    ASSERT_TRUE(f.Insert("base.cmo", 1, 100));
+    ASSERT_TRUE(f.Insert("level.nmo", 2, 100));
+
+    // Both are pinned, so a third does not fit and stays with the caller.
+    EXPECT_FALSE(f.Insert("extra.nmo", 3, 100));
+    EXPECT_TRUE(f.released.empty());
+    EXPECT_EQ(f.cache.GetEntryCount(), 2);
+
+    // Next load: both become evictable.
+    f.cache.BeginLoad();
+    EXPECT_TRUE(f.Insert("extra.nmo", 3, 100));
+    EXPECT_EQ(f.cache.GetEntryCount(), 2);
+    ASSERT_EQ(f.released.size(), 1u);
+    EXPECT_EQ(f.released[0], "base.cmo");
+}
+
+TEST(AssetCacheTest, ReplacingAPathReleasesTheOldContent) {
+    CacheFixture f;
+    f.cache.SetBudget(1000);
+    f.cache.BeginLoad();
+    ASSERT_TRUE(f.Insert("base.cmo", 1, 400));
+    ASSERT_TRUE(f.Insert("BASE.cmo", 2, 300));
+
+    EXPECT_EQ(f.cache.GetEntryCount(), 1);
+    EXPECT_EQ(f.cache.GetTotalBytes(), 300u);
+    ASSERT_EQ(f.released.size(), 1u);
+    EXPECT_EQ(f.cache.Find("base.cmo", 1), nullptr);
+    EXPECT_NE(f.cache.Find("base.cmo", 2), nullptr);
+    // A replacement is not an eviction.
+    EXPECT_EQ(f.cache.GetEvictions(), 0);
+}
+
+TEST(AssetCacheTest, RejectsWhatCanNeverFit) {
+    CacheFixture f;
+    f.cache.BeginLoad();
+    EXPECT_FALSE(f.Insert("base.cmo", 1, 1));
+
+    f.cache.SetBudget(100);
+    EXPECT_FALSE(f.Insert("huge.cmo", 1, 101));
+    EXPECT_TRUE(f.Insert("fits.cmo", 1, 100));
+    EXPECT_TRUE(f.released.empty());
+}
+
+TEST(AssetCacheTest, ShrinkingTheBudgetEvictsAndClearReleasesAll) {
+    CacheFixture f;
+    f.cache.SetBudget(1000);
+    f.cache.BeginLoad();
+    ASSERT_TRUE(f.Insert("a.cmo", 1, 300));
+    ASSERT_TRUE(f.Insert("b.cmo", 2, 300));
+    ASSERT_TRUE(f.Insert("c.cmo", 3, 300));
+
+    f.cache.BeginLoad();
+    f.cache.SetBudget(400);
+    EXPECT_EQ(f.cache.GetEntryCount(), 1);
+    EXPECT_NE(f.cache.Peek("c.cmo"), nullptr);
+
+    EXPECT_TRUE(f.cache.Remove("c.cmo"));
+    EXPECT_FALSE(f.cache.Remove("c.cmo"));
+    ASSERT_TRUE(f.Insert("d.cmo", 4, 100));
+    f.cache.Clear();
+    EXPECT_EQ(f.cache.GetEntryCount(), 0);
+    EXPECT_EQ(f.cache.GetTotalBytes(), 0u);
+    EXPECT_EQ(f.released.size(), 4u);
+}
+
+TEST(AssetCacheTest, DestructorReleasesPayloads) {
+    std::vector<std::string> released;
+    {
+        CAssetCache cache;
+        cache.SetReleaseFunction(ReleasePayload, &released);
+        cache.SetBudget(100);
+        cache.BeginLoad();
+        ASSERT_TRUE(cache.Insert("a.cmo", 1, 0, new Payload("a.cmo"), 10));
+    }
+    ASSERT_EQ(released.size(), 1u);
+    EXPECT_EQ(released[0], "a.cmo");
+}
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "AssetIndex.h"
+
+namespace {
+    // In-memory tree that counts directory listings.
+    class FakeFileSystem : public CFileSystem {
+    public:
+        void AddFile(const std::string &directory, const std::string &name, platform::uint64 size) {
+            m_Directories.insert(filesystem::NormalizePath(directory));
+            FileEntry entry;
+            entry.path = filesystem::JoinPath(directory, name);
+            entry.size = size;
+            entry.modifiedTime = 1;
+            m_Files[filesystem::NormalizePath(directory)].push_back(entry);
+        }
+
+        bool DirectoryExists(const char *path) override {
+            return m_Directories.count(filesystem::NormalizePath(path)) != 0;
+        }
+
+        bool ListFiles(const char *directory, const char *extension, std::vector<FileEntry> &files) override {
+            const std::string key = filesystem::NormalizePath(directory);
+            ++m_ListCalls;
+            if (m_Directories.count(key) == 0)
+                return false;
+            const std::vector<FileEntry> &entries = m_Files[key];
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (filesystem::HasExtension(entries[i].path.c_str(), extension))
+                    files.push_back(entries[i]);
+            }
+            return true;
+        }
+
+        bool ListDirectories(const char *directory, std::vector<std::string> &) override {
+            return DirectoryExists(directory);
+        }
+
+        bool GetFileEntry(const char *, FileEntry &) override { return false; }
+        platform::uint64 Prefetch(const char *) override { return 0; }
+
+        int ListCalls() const { return m_ListCalls; }
+
+    private:
+        std::set<std::string> m_Directories;
+        std::map<std::string, std::vector<FileEntry> > m_Files;
+        int m_ListCalls = 0;
+    };
+
+    void BuildGame(FakeFileSystem &fs) {
+        fs.AddFile("/game/Textures/", "Ball_Wood.bmp", 300);
+        fs.AddFile("/game/Textures/", "Sky_A.bmp", 200);
+        fs.AddFile("/game/Textures/", "Rail.tga", 150);
+        fs.AddFile("/game/Sounds/", "Hit_Wood.wav", 100);
+        fs.AddFile("/game/Sounds_low/", "Hit_Wood.wav", 40);
+        fs.AddFile("/game/Sounds_low/", "Roll.wav", 60);
+    }
+}
+
+TEST(AssetIndexTest, ListsEachDirectoryOnce) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+
+    CAssetIndex index(fs);
+    EXPECT_TRUE(index.AddDirectory("/game/Textures"));
+    EXPECT_TRUE(index.AddDirectory("/game/textures/"));
+    EXPECT_TRUE(index.AddDirectory("/game/Sounds"));
+    EXPECT_FALSE(index.AddDirectory("/game/Missing"));
+    EXPECT_FALSE(index.AddDirectory(nullptr));
+
+    EXPECT_EQ(index.GetDirectoryCount(), 2);
+    EXPECT_EQ(index.GetFileCount(), 4);
+    EXPECT_EQ(fs.ListCalls(), 2);
+
+    // Lookups never go back to the file system.
+    ASSERT_NE(index.Find("Sky_A.bmp"), nullptr);
+    ASSERT_NE(index.Find("Hit_Wood.wav"), nullptr);
+    EXPECT_EQ(fs.ListCalls(), 2);
+}
+
+TEST(AssetIndexTest, MatchesBaseNamesCaseInsensitively) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+
+    CAssetIndex index(fs);
+    index.AddDirectory("/game/Textures");
+
+    const FileEntry *entry = index.Find("BALL_WOOD.BMP");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->path, "/game/Textures/Ball_Wood.bmp");
+    EXPECT_EQ(entry->size, 300u);
+
+    // References saved with the author's absolute path still resolve.
+    entry = index.Find("C:\\Ballance\\Textures\\sky_a.bmp");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->path, "/game/Textures/Sky_A.bmp");
+
+    EXPECT_EQ(index.Find("Ball_Stone.bmp"), nullptr);
+    EXPECT_EQ(index.Find("Textures/"), nullptr);
+    EXPECT_EQ(index.Find(""), nullptr);
+    EXPECT_EQ(index.Find(nullptr), nullptr);
+}
+
+TEST(AssetIndexTest, MatchesReferencesWithoutExtensionByStem) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+
+    CAssetIndex index(fs);
+    index.AddDirectory("/game/Textures");
+
+    const FileEntry *entry = index.Find("rail");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->path, "/game/Textures/Rail.tga");
+
+    // A reference with another extension is a different file.
+    EXPECT_EQ(index.Find("Rail.bmp"), nullptr);
+}
+
+TEST(AssetIndexTest, FirstDirectoryWinsAName) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+
+    CAssetIndex index(fs);
+    index.AddDirectory("/game/Sounds_low");
+    index.AddDirectory("/game/Sounds");
+
+    const FileEntry *entry = index.Find("hit_wood.wav");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->path, "/game/Sounds_low/Hit_Wood.wav");
+    EXPECT_EQ(index.GetFileCount(), 2);
+
+    index.Clear();
+    EXPECT_EQ(index.GetFileCount(), 0);
+    EXPECT_EQ(index.Find("Hit_Wood.wav"), nullptr);
+    index.AddDirectory("/game/Sounds");
+    entry = index.Find("hit_wood.wav");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->path, "/game/Sounds/Hit_Wood.wav");
+}
+
+TEST(AssetPrefetchPlannerTest, PlansEachFileOnceInReferenceOrder) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+
+    CAssetIndex index(fs);
+    index.AddDirectory("/game/Textures");
+    index.AddDirectory("/game/Sounds");
+
+    CAssetPrefetchPlanner planner;
+    EXPECT_TRUE(planner.Add(index, "Sky_A.bmp"));
+    EXPECT_TRUE(planner.Add(index, "Hit_Wood.wav"));
+    EXPECT_TRUE(planner.Add(index, "sky_a.BMP"));
+    EXPECT_FALSE(planner.Add(index, "Missing.bmp"));
+    EXPECT_TRUE(planner.Add(index, "Ball_Wood.bmp"));
+    EXPECT_FALSE(planner.Add(index, ""));
+
+    const std::vector<std::string> &paths = planner.GetPaths();
+    ASSERT_EQ(paths.size(), 3u);
+    EXPECT_EQ(paths[0], "/game/Textures/Sky_A.bmp");
+    EXPECT_EQ(paths[1], "/game/Sounds/Hit_Wood.wav");
+    EXPECT_EQ(paths[2], "/game/Textures/Ball_Wood.bmp");
+    EXPECT_EQ(planner.GetBytes(), 600u);
+
+    ASSERT_EQ(planner.GetUnresolved().size(), 1u);
+    EXPECT_EQ(planner.GetUnresolved()[0], "Missing.bmp");
+
+    planner.Clear();
+    EXPECT_TRUE(planner.GetPaths().empty());
+    EXPECT_TRUE(planner.GetUnresolved().empty());
+    EXPECT_EQ(planner.GetBytes(), 0u);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include "BackgroundPolicy.h"
+
+TEST(BackgroundPolicyTest, ActiveWindowFollowsTheLimiter) {
+    CBackgroundPolicy policy;
+    policy.Configure(eBackgroundPause, 10);
+    EXPECT_TRUE(policy.IsActive());
+    EXPECT_FALSE(policy.IsRestricting());
+
+    BackgroundAction action = policy.Decide(0, true, false);
+    EXPECT_TRUE(action.process);
+    EXPECT_FALSE(action.render);
+    EXPECT_EQ(action.wait, eBackgroundNoWait);
+}
+
+TEST(BackgroundPolicyTest, ContinueModeIgnoresFocus) {
+    CBackgroundPolicy policy;
+    policy.Configure(eBackgroundContinue, 10);
+    policy.SetActive(false);
+    EXPECT_FALSE(policy.IsRestricting());
+
+    BackgroundAction action = policy.Decide(0, true, true);
+    EXPECT_TRUE(action.process);
+    EXPECT_TRUE(action.render);
+    EXPECT_EQ(action.wait, eBackgroundNoWait);
+}
+
+TEST(BackgroundPolicyTest, ThrottleRunsAtMostNFramesPerSecond) {
+    CBackgroundPolicy policy;
+    policy.Configure(eBackgroundThrottle, 10);
+    policy.SetActive(false);
+    EXPECT_TRUE(policy.IsRestricting());
+
+    // First frame after losing focus runs immediately.
+    BackgroundAction action = policy.Decide(1000, false, false);
+    EXPECT_TRUE(action.process);
+    EXPECT_TRUE(action.render);
+
+    action = policy.Decide(41000, true, true);
+    EXPECT_FALSE(action.process);
+    EXPECT_FALSE(action.render);
+    EXPECT_EQ(action.wait, eBackgroundWaitTimeout);
+    EXPECT_EQ(action.waitMs, 60u);
+
+    action = policy.Decide(100500, true, true);
+    EXPECT_FALSE(action.process);
+    EXPECT_EQ(action.waitMs, 1u);
+
+    action = policy.Decide(101000, false, false);
+    EXPECT_TRUE(action.process);
+    EXPECT_TRUE(action.render);
+
+    // Simulated second of busy polling yields exactly ten frames.
+    int frames = 0;
+    for (platform::uint64 t = 101000; t <= 1101000; t += 500) {
+        if (policy.Decide(t, true, true).render)
+            ++frames;
+    }
+    EXPECT_EQ(frames, 10);
+}
+
+TEST(BackgroundPolicyTest, ProcessOnlySkipsRendering) {
+    CBackgroundPolicy policy;
+    policy.Configure(eBackgroundProcessOnly, 0);
+    policy.SetActive(false);
+
+    BackgroundAction action = policy.Decide(0, true, true);
+    EXPECT_TRUE(action.process);
+    EXPECT_FALSE(action.render);
+    EXPECT_EQ(action.wait, eBackgroundNoWait);
+
+    action = policy.Decide(0, false, true);
+    EXPECT_FALSE(action.process);
+    EXPECT_FALSE(action.render);
+}
+
+TEST(BackgroundPolicyTest, PauseWaitsForMessages) {
+    CBackgroundPolicy policy;
+    policy.Configure(eBackgroundPause, 0);
+    policy.SetActive(false);
+
+    BackgroundAction action = policy.Decide(0, true, true);
+    EXPECT_FALSE(action.process);
+    EXPECT_FALSE(action.render);
+    EXPECT_EQ(action.wait, eBackgroundWaitMessage);
+
+    policy.SetActive(true);
+    action = policy.Decide(10, true, true);
+    EXPECT_TRUE(action.process);
+    EXPECT_TRUE(action.render);
+    EXPECT_EQ(action.wait, eBackgroundNoWait);
+}
+
+TEST(BackgroundPolicyTest, RegainingFocusRestartsTheThrottle) {
+    CBackgroundPolicy policy;
+    policy.Configure(eBackgroundThrottle, 1);
+    policy.SetActive(false);
+    EXPECT_TRUE(policy.Decide(0, false, false).render);
+    EXPECT_FALSE(policy.Decide(10, true, true).render);
+
+    policy.SetActive(true);
+    policy.SetActive(false);
+    EXPECT_TRUE(policy.Decide(20, false, false).render);
+}
+
+TEST(BackgroundPolicyTest, InvalidSettingsFallBackToDefaults) {
+    CBackgroundPolicy policy;
+    policy.Configure(42, -5);
+    EXPECT_EQ(policy.GetMode(), eBackgroundContinue);
+    EXPECT_EQ(policy.GetThrottleFps(), (int)CBackgroundPolicy::DEFAULT_THROTTLE_FPS);
+
+    policy.Configure(eBackgroundThrottle, CBackgroundPolicy::MAX_THROTTLE_FPS + 1);
+    EXPECT_EQ(policy.GetMode(), eBackgroundThrottle);
+    EXPECT_EQ(policy.GetThrottleFps(), (int)CBackgroundPolicy::DEFAULT_THROTTLE_FPS);
+
+    policy.Configure(eBackgroundThrottle, 30);
+    EXPECT_EQ(policy.GetThrottleFps(), 30);
+}
@@ -0,0 +1,444 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "BatchRunner.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    BatchResult Passed(const std::string &composition, platform::uint64 loadUs) {
+        BatchResult result;
+        result.Reset(composition);
+        result.status = eBatchPassed;
+        result.loadUs = loadUs;
+        result.hotfix = eBatchHotfixApplied;
+        result.frameStats.frames = 100;
+        result.frameStats.totalUs = 1600000;
+        result.frameStats.minUs = 15000;
+        result.frameStats.maxUs = 21000;
+        result.frameStats.p95Us = 17250;
+        return result;
+    }
+
+    // Workers finish when the test says so; the script decides what each reports.
+    class FakeLauncher : public CBatchLauncher {
+    public:
+        FakeLauncher() : m_Running(0), m_MaxRunning(0), m_Killed(0) {}
+
+        virtual bool Start(int job, const std::string &composition, int &worker) {
+            if (composition.find("unstartable") != std::string::npos)
+                return false;
+            Worker w;
+            w.job = job;
+            w.composition = composition;
+            w.done = false;
+            worker = (int)m_Workers.size();
+            m_Workers.push_back(w);
+            ++m_Running;
+            if (m_Running > m_MaxRunning)
+                m_MaxRunning = m_Running;
+            m_Started.push_back(job);
+            return true;
+        }
+
+        virtual bool Poll(int worker, BatchResult &result) {
+            Worker &w = m_Workers[worker];
+            if (!w.done)
+                return false;
+            --m_Running;
+            if (w.composition.find("crash") != std::string::npos) {
+                result.exitCode = 139;
+                return true;
+            }
+            result = Passed(w.composition, 1000 + w.job);
+            return true;
+        }
+
+        virtual void Kill(int worker) {
+            m_Workers[worker].done = true;
+            --m_Running;
+            ++m_Killed;
+        }
+
+        // Finishes every running worker except those whose composition contains the text.
+        void FinishAllBut(const char *keep) {
+            for (size_t i = 0; i < m_Workers.size(); ++i) {
+                if (!keep || m_Workers[i].composition.find(keep) == std::string::npos)
+                    m_Workers[i].done = true;
+            }
+        }
+
+        int m_Running;
+        int m_MaxRunning;
+        int m_Killed;
+        std::vector<int> m_Started;
+
+    private:
+        struct Worker {
+            int job;
+            std::string composition;
+            bool done;
+        };
+        std::vector<Worker> m_Workers;
+    };
+
+    std::string ReadFile(const fs::path &path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST(BatchOptionsTest, RemovesOnlyTheBatchOptions) {
+    std::vector<std::string> args = {
+        "--batch", "maps.txt", "--disable-hotfix", "--batch-jobs=4", "--root-path", "D:\\Ballance",
+        "--batch-frames", "--verbose", "--batch-report", "out.json", "--batches", "-x", "-5"};
+    batchrunner::RemoveOptions(args);
+    const std::vector<std::string> expected = {
+        "--disable-hotfix", "--root-path", "D:\\Ballance", "--verbose", "--batches", "-x", "-5"};
+    EXPECT_EQ(args, expected);
+}
+
+TEST(BatchJobListTest, SkipsBlankLinesAndComments) {
+    std::vector<std::string> compositions;
+    batchrunner::ReadJobList("# community maps\r\nLevel_01.nmo\r\n\r\n   \n  Custom Map.nmo  \n#skip.nmo\nlast.nmo",
+                             compositions);
+    const std::vector<std::string> expected = {"Level_01.nmo", "Custom Map.nmo", "last.nmo"};
+    EXPECT_EQ(compositions, expected);
+
+    const fs::path path = fs::temp_directory_path() / "ballance_batch_list_test.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "\xEF\xBB\xBFwith_bom.nmo\n";
+    }
+    std::vector<std::string> loaded;
+    ASSERT_TRUE(batchrunner::LoadJobList(path.string().c_str(), loaded));
+    ASSERT_EQ(loaded.size(), 1u);
+    EXPECT_EQ(loaded[0], "with_bom.nmo");
+    fs::remove(path);
+
+    EXPECT_FALSE(batchrunner::LoadJobList((path.string() + ".missing").c_str(), loaded));
+}
+
+TEST(BatchResultTest, RoundTripsThroughTheResultFile) {
+    BatchResult result = Passed("Maps\\Custom\tMap.nmo", 2345678);
+    result.status = eBatchHotfixFailed;
+    result.hotfix = eBatchHotfixError;
+    result.missingGuids.push_back("7a3f1c20,4d2e0b91");
+    result.missingGuids.push_back("1,2");
+    result.error = "Failed to apply\nhotfixes";
+
+    std::string text;
+    batchrunner::WriteResult(result, text);
+
+    BatchResult read;
+    read.exitCode = 1;
+    read.logFile = "worker.log";
+    ASSERT_TRUE(batchrunner::ReadResult(text, read));
+    EXPECT_EQ(read.composition, "Maps\\Custom Map.nmo");
+    EXPECT_EQ(read.status, (int)eBatchHotfixFailed);
+    EXPECT_EQ(read.loadUs, 2345678u);
+    EXPECT_EQ(read.hotfix, (int)eBatchHotfixError);
+    EXPECT_EQ(read.missingGuids, result.missingGuids);
+    EXPECT_EQ(read.frameStats.frames, 100);
+    EXPECT_EQ(read.frameStats.totalUs, 1600000u);
+    EXPECT_EQ(read.frameStats.minUs, 15000u);
+    EXPECT_EQ(read.frameStats.maxUs, 21000u);
+    EXPECT_EQ(read.frameStats.p95Us, 17250u);
+    EXPECT_EQ(read.error, "Failed to apply hotfixes");
+    // What the runner knows about the worker is not overwritten.
+    EXPECT_EQ(read.exitCode, 1);
+    EXPECT_EQ(read.logFile, "worker.log");
+}
+
+TEST(BatchResultTest, RejectsDamagedResults) {
+    std::string text;
+    batchrunner::WriteResult(Passed("a.nmo", 1), text);
+
+    BatchResult result;
+    EXPECT_FALSE(batchrunner::ReadResult("", result));
+    EXPECT_FALSE(batchrunner::ReadResult("BallancePlayerBatchResult 2\nstatus\tpassed\n", result));
+    EXPECT_FALSE(batchrunner::ReadResult("BallancePlayerBatchResult 1\ncomposition\ta.nmo\n", result));
+    EXPECT_FALSE(batchrunner::ReadResult("BallancePlayerBatchResult 1\nstatus\tgreat\n", result));
+    EXPECT_FALSE(batchrunner::ReadResult(text + "load_us\t-5\n", result));
+    EXPECT_FALSE(batchrunner::ReadResult(text + "frames\t1\t2\n", result));
+    EXPECT_EQ(result.status, (int)eBatchPending);
+
+    // Fields a later version adds are skipped.
+    EXPECT_TRUE(batchrunner::ReadResult(text + "peak_memory\t123456\n", result));
+    EXPECT_EQ(result.status, (int)eBatchPassed);
+}
+
+TEST(BatchSchedulerTest, NeverRunsMoreWorkersThanAllowed) {
+    CBatchScheduler scheduler;
+    scheduler.SetConcurrency(3);
+    for (int i = 0; i < 10; ++i)
+        scheduler.AddJob("map" + std::to_string(i) + ".nmo");
+
+    FakeLauncher launcher;
+    platform::uint64 now = 0;
+    EXPECT_TRUE(scheduler.Step(launcher, now));
+    EXPECT_EQ(scheduler.GetRunningCount(), 3);
+
+    int steps = 0;
+    while (scheduler.Step(launcher, ++now)) {
+        launcher.FinishAllBut(NULL);
+        ASSERT_LT(++steps, 100);
+    }
+    EXPECT_EQ(launcher.m_MaxRunning, 3);
+    EXPECT_EQ(scheduler.GetRunningCount(), 0);
+    EXPECT_EQ(scheduler.GetFinishedCount(), 10);
+
+    // Started in list order, reported in list order.
+    ASSERT_EQ(launcher.m_Started.size(), 10u);
+    const std::vector<BatchResult> &results = scheduler.GetResults();
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(launcher.m_Started[i], i);
+        EXPECT_EQ(results[i].composition, "map" + std::to_string(i) + ".nmo");
+        EXPECT_EQ(results[i].status, (int)eBatchPassed);
+        EXPECT_EQ(results[i].loadUs, 1000u + i);
+    }
+}
+
+TEST(BatchSchedulerTest, SlowWorkersDoNotHoldUpTheRest) {
+    CBatchScheduler scheduler;
+    scheduler.SetConcurrency(2);
+    scheduler.AddJob("slow.nmo");
+    for (int i = 0; i < 5; ++i)
+        scheduler.AddJob("fast" + std::to_string(i) + ".nmo");
+
+    FakeLauncher launcher;
+    platform::uint64 now = 0;
+    scheduler.Step(launcher, now);
+    for (int i = 0; i < 10; ++i) {
+        launcher.FinishAllBut("slow");
+        scheduler.Step(launcher, ++now);
+    }
+    // The other slot worked through the whole list meanwhile.
+    EXPECT_EQ(scheduler.GetFinishedCount(), 5);
+    EXPECT_EQ(scheduler.GetRunningCount(), 1);
+
+    launcher.FinishAllBut(NULL);
+    EXPECT_FALSE(scheduler.Step(launcher, ++now));
+}
+
+TEST(BatchSchedulerTest, GivesEveryJobAResult) {
+    CBatchScheduler scheduler;
+    scheduler.SetConcurrency(4);
+    scheduler.SetTimeout(1000);
+    scheduler.AddJob("good.nmo");
+    scheduler.AddJob("crash.nmo");
+    scheduler.AddJob("unstartable.nmo");
+    scheduler.AddJob("hang.nmo");
+
+    FakeLauncher launcher;
+    scheduler.Step(launcher, 0);
+    launcher.FinishAllBut("hang");
+    EXPECT_TRUE(scheduler.Step(launcher, 999));
+    EXPECT_EQ(launcher.m_Killed, 0);
+    EXPECT_FALSE(scheduler.Step(launcher, 1000));
+    EXPECT_EQ(launcher.m_Killed, 1);
+    EXPECT_EQ(launcher.m_Running, 0);
+
+    const std::vector<BatchResult> &results = scheduler.GetResults();
+    EXPECT_EQ(results[0].status, (int)eBatchPassed);
+    EXPECT_EQ(results[1].status, (int)eBatchCrashed);
+    EXPECT_EQ(results[1].exitCode, 139);
+    EXPECT_FALSE(results[1].error.empty());
+    EXPECT_EQ(results[2].status, (int)eBatchLaunchFailed);
+    EXPECT_EQ(results[3].status, (int)eBatchTimedOut);
+}
+
+TEST(BatchSchedulerTest, EmptyListIsDoneAtOnce) {
+    CBatchScheduler scheduler;
+    FakeLauncher launcher;
+    EXPECT_FALSE(scheduler.Step(launcher, 0));
+    scheduler.SetConcurrency(0);
+    EXPECT_EQ(scheduler.GetConcurrency(), 1);
+}
+
+TEST(BatchProcessLauncherTest, RunsWorkerProcesses) {
+    const fs::path directory = fs::temp_directory_path() / ("ballance_batch_test_" + std::to_string(getpid()));
+    fs::create_directories(directory);
+    const std::string prefix = (directory / "BatchReport").string();
+
+    // Stands in for the player: $2 is the result file, $4 the composition.
+    const std::string script =
+        "case \"$4\" in\n"
+        "  *crash*) exit 3 ;;\n"
+        "  *hang*) exec sleep 30 ;;\n"
+        "esac\n"
+        "log=\"${2%.txt}.log\"\n"
+        "echo \"loading $4\" > \"$log\"\n"
+        "printf 'BallancePlayerBatchResult 1\\ncomposition\\t%s\\nstatus\\tpassed\\nload_us\\t%s\\n"
+        "hotfix\\tapplied\\nmissing_guid\\t1a,2b\\nframes\\t10\\t1000\\t90\\t120\\t110\\n' \"$4\" \"${#4}\" > \"$2\"\n";
+
+    CBatchProcessLauncher launcher("/bin/sh", {"-c", script, "player"}, prefix);
+    CBatchScheduler scheduler;
+    scheduler.SetConcurrency(3);
+    scheduler.SetTimeout(2000000);
+    const char *maps[] = {"a.nmo", "crash.nmo", "Custom Map.nmo", "hang.nmo", "bbbbb.nmo"};
+    for (const char *map : maps)
+        scheduler.AddJob(map);
+
+    const platform::uint64 start = platform::GetTimeMicros();
+    scheduler.Run(launcher, 5);
+    EXPECT_LT(platform::GetTimeMicros() - start, 10000000u);
+
+    const std::vector<BatchResult> &results = scheduler.GetResults();
+    ASSERT_EQ(results.size(), 5u);
+    EXPECT_EQ(results[0].status, (int)eBatchPassed);
+    EXPECT_EQ(results[0].loadUs, 5u);
+    EXPECT_EQ(results[0].exitCode, 0);
+    ASSERT_EQ(results[0].missingGuids.size(), 1u);
+    EXPECT_EQ(results[0].missingGuids[0], "1a,2b");
+    EXPECT_EQ(results[0].frameStats.frames, 10);
+    EXPECT_EQ(results[0].logFile, prefix + "-0.log");
+    EXPECT_EQ(ReadFile(results[0].logFile), "loading a.nmo\n");
+
+    EXPECT_EQ(results[1].status, (int)eBatchCrashed);
+    EXPECT_EQ(results[1].exitCode, 3);
+    EXPECT_TRUE(results[1].logFile.empty());
+
+    EXPECT_EQ(results[2].status, (int)eBatchPassed);
+    EXPECT_EQ(results[2].composition, "Custom Map.nmo");
+    EXPECT_EQ(results[3].status, (int)eBatchTimedOut);
+    EXPECT_EQ(results[4].status, (int)eBatchPassed);
+
+    // The result files are consumed; the logs stay for whoever reads the report.
+    for (int i = 0; i < 5; ++i)
+        EXPECT_FALSE(fs::exists(prefix + "-" + std::to_string(i) + ".txt"));
+    fs::remove_all(directory);
+}
+
+TEST(BatchProcessLauncherTest, ReportsAMissingExecutable) {
+    const fs::path directory = fs::temp_directory_path();
+    CBatchProcessLauncher launcher("/nonexistent/Player.exe", {}, (directory / "ballance_batch_missing").string());
+    CBatchScheduler scheduler;
+    scheduler.AddJob("a.nmo");
+    scheduler.Run(launcher, 1);
+    // exec fails in the child, which then exits without a result.
+    EXPECT_EQ(scheduler.GetResults()[0].status, (int)eBatchCrashed);
+    EXPECT_EQ(scheduler.GetResults()[0].exitCode, 127);
+
+    EXPECT_EQ(CBatchProcessLauncher::GetLogFile("out/BatchReport-3.txt"), "out/BatchReport-3.log");
+    EXPECT_EQ(CBatchProcessLauncher::GetLogFile("out.d/result"), "out.d/result.log");
+}
+
+TEST(BatchReportTest, AddsUpTheResults) {
+    CBatchReport report;
+    report.Add(Passed("a.nmo", 3000));
+    report.Add(Passed("b.nmo", 9000));
+
+    BatchResult missing;
+    missing.Reset("c.nmo");
+    missing.status = eBatchLoadFailed;
+    missing.loadUs = 50000;
+    missing.missingGuids.push_back("1,2");
+    report.Add(missing);
+
+    BatchResult hotfix = Passed("d.nmo", 6000);
+    hotfix.status = eBatchHotfixFailed;
+    hotfix.hotfix = eBatchHotfixError;
+    report.Add(hotfix);
+
+    BatchResult timedOut;
+    timedOut.Reset("e.nmo");
+    timedOut.status = eBatchTimedOut;
+    report.Add(timedOut);
+
+    const BatchSummary &summary = report.GetSummary();
+    EXPECT_EQ(summary.jobs, 5);
+    EXPECT_EQ(summary.statusCounts[eBatchPassed], 2);
+    EXPECT_EQ(summary.statusCounts[eBatchLoadFailed], 1);
+    EXPECT_EQ(summary.statusCounts[eBatchHotfixFailed], 1);
+    EXPECT_EQ(summary.statusCounts[eBatchTimedOut], 1);
+    EXPECT_EQ(summary.missingGuidJobs, 1);
+    EXPECT_EQ(summary.hotfixApplied, 2);
+    EXPECT_EQ(summary.hotfixFailed, 1);
+    // The failed load's time is left out.
+    EXPECT_EQ(summary.loadedJobs, 3);
+    EXPECT_EQ(summary.totalLoadUs, 18000u);
+    EXPECT_EQ(summary.maxLoadUs, 9000u);
+    EXPECT_EQ(summary.slowestLoad, "b.nmo");
+    EXPECT_FALSE(report.AllPassed());
+
+    CBatchReport clean;
+    clean.AddAll(std::vector<BatchResult>(1, Passed("a.nmo", 1)));
+    EXPECT_TRUE(clean.AllPassed());
+}
+
+TEST(BatchReportTest, WritesJson) {
+    CBatchReport report;
+    BatchResult result = Passed("Maps\\\"Quoted\".nmo", 2500);
+    result.status = eBatchLoadFailed;
+    result.exitCode = 1;
+    result.missingGuids.push_back("7a3f1c20,4d2e0b91");
+    result.error = std::string("Bad\x01 byte");
+    result.logFile = "out\\BatchReport-0.log";
+    report.Add(result);
+    report.SetWallTime(123456);
+
+    std::string json;
+    report.WriteJson(json);
+    const std::string expected =
+        "{\n"
+        "  \"version\": 1,\n"
+        "  \"summary\": {\n"
+        "    \"jobs\": 1,\n"
+        "    \"passed\": 0,\n"
+        "    \"failed\": 1,\n"
+        "    \"statuses\": {\"passed\": 0, \"load_failed\": 1, \"hotfix_failed\": 0, \"crashed\": 0, "
+        "\"timed_out\": 0, \"launch_failed\": 0},\n"
+        "    \"missing_guid_jobs\": 1,\n"
+        "    \"hotfix_applied\": 1,\n"
+        "    \"hotfix_failed\": 0,\n"
+        "    \"total_load_us\": 0,\n"
+        "    \"mean_load_us\": 0,\n"
+        "    \"max_load_us\": 0,\n"
+        "    \"slowest_load\": \"\",\n"
+        "    \"wall_us\": 123456\n"
+        "  },\n"
+        "  \"results\": [\n"
+        "    {\n"
+        "      \"composition\": \"Maps\\\\\\\"Quoted\\\".nmo\",\n"
+        "      \"status\": \"load_failed\",\n"
+        "      \"exit_code\": 1,\n"
+        "      \"load_us\": 2500,\n"
+        "      \"hotfix\": \"applied\",\n"
+        "      \"missing_guids\": [\"7a3f1c20,4d2e0b91\"],\n"
+        "      \"frames\": {\"count\": 100, \"mean_us\": 16000, \"min_us\": 15000, \"max_us\": 21000, \"p95_us\": 17250},\n"
+        "      \"error\": \"Bad\\u0001 byte\",\n"
+        "      \"log\": \"out\\\\BatchReport-0.log\"\n"
+        "    }\n"
+        "  ]\n"
+        "}\n";
+    EXPECT_EQ(json, expected);
+
+    CBatchReport empty;
+    empty.WriteJson(json);
+    EXPECT_NE(json.find("\"results\": []\n}"), std::string::npos);
+
+    const fs::path path = fs::temp_directory_path() / "ballance_batch_report_test.json";
+    ASSERT_TRUE(report.Save(path.string().c_str()));
+    report.WriteJson(json);
+    EXPECT_EQ(ReadFile(path), json);
+    fs::remove(path);
+}
+
+TEST(BatchReportTest, EscapesHighBytesInPaths) {
+    // A GBK path as it comes from the ANSI code page: not valid UTF-8.
+    CBatchReport report;
+    report.Add(Passed("Maps\\\xB5\xD8\xCD\xBC.nmo", 1));
+
+    std::string json;
+    report.WriteJson(json);
+    EXPECT_NE(json.find("\"composition\": \"Maps\\\\\\u00b5\\u00d8\\u00cd\\u00bc.nmo\""), std::string::npos);
+    for (size_t i = 0; i < json.size(); ++i)
+        EXPECT_LT((unsigned char)json[i], 0x80u) << "raw byte at " << i;
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BehaviorGraphMock.h"
+
+TEST(BehaviorGraphIndexTest, FindsBehaviorsByNameInScriptOrder) {
+    MockScript script;
+    MockBehavior *a1 = script.Add("Remove Row If");
+    script.Add("Set Cell");
+    MockBehavior *a2 = script.Add("Remove Row If");
+    MockBehavior *a3 = script.Add("Remove Row If");
+
+    MockIndex index;
+    index.Build(script.Get());
+    EXPECT_EQ(index.GetScript(), script.Get());
+    EXPECT_EQ(index.GetBehaviorCount(), 4);
+
+    EXPECT_EQ(index.FindBehavior("Remove Row If"), a1);
+    EXPECT_EQ(index.FindBehavior("Remove Row If", a1), a2);
+    EXPECT_EQ(index.FindBehavior("Remove Row If", a2), a3);
+    EXPECT_EQ(index.FindBehavior("Remove Row If", a3), (MockBehavior *)NULL);
+    EXPECT_EQ(index.FindBehavior("Missing"), (MockBehavior *)NULL);
+    EXPECT_EQ(index.FindBehavior(NULL), (MockBehavior *)NULL);
+
+    MockScript other;
+    MockBehavior *stranger = other.Add("Remove Row If");
+    EXPECT_EQ(index.FindBehavior("Remove Row If", stranger), (MockBehavior *)NULL);
+}
+
+TEST(BehaviorGraphIndexTest, FindsBehaviorsByTargetName) {
+    MockScript script;
+    script.Add("Insert Column", 1, 1);
+    script.Add("Insert Column", 1, 1, "Drivers");
+    MockBehavior *modes = script.Add("Insert Column", 1, 1, "ScreenModes");
+
+    MockIndex index;
+    index.Build(script.Get());
+    EXPECT_EQ(index.FindBehavior("Insert Column", "ScreenModes"), modes);
+    EXPECT_EQ(index.FindBehavior("Insert Column", "ScreenModes", modes), (MockBehavior *)NULL);
+    EXPECT_EQ(index.FindBehavior("Insert Column", "Levels"), (MockBehavior *)NULL);
+}
+
+TEST(BehaviorGraphIndexTest, FindsLinksByEndsAndNames) {
+    MockScript script;
+    MockBehavior *ts = script.Add("Time Settings");
+    MockBehavior *ii = script.Add("Iterator If");
+    MockBehavior *delayer = script.Add("Delayer");
+    MockBehavior *csm = script.Add("TT Change ScreenMode");
+    MockLink *first = script.Link(ts, ii);
+    MockLink *other = script.Link(ts, ii, 1, 0);
+    MockLink *second = script.Link(ts, ii);
+    MockLink *toCsm = script.Link(delayer, csm);
+    MockLink *fromScript = script.Link(script.Get()->inputs[0], ts->inputs[0]);
+
+    MockIndex index;
+    index.Build(script.Get());
+    EXPECT_EQ(index.GetLinkCount(), 5);
+
+    EXPECT_EQ(index.FindLink(ts->outputs[0], ii->inputs[0]), first);
+    EXPECT_EQ(index.FindLink(ts, ii, 0, 0), first);
+    EXPECT_EQ(index.FindLink(ts, ii, 0, 0, first), second);
+    EXPECT_EQ(index.FindLink(ts, ii, 1, 0), other);
+    EXPECT_EQ(index.FindLink("Time Settings", ii, 0, 0), first);
+    EXPECT_EQ(index.FindLink("Time Settings", ii, 0, 0, first), second);
+    EXPECT_EQ(index.FindLink("Time Settings", ii, 0, 0, second), (MockLink *)NULL);
+    EXPECT_EQ(index.FindLink(delayer, "TT Change ScreenMode", 0, 0), toCsm);
+    EXPECT_EQ(index.FindLink("Delayer", "TT Change ScreenMode", 0, 0), toCsm);
+    EXPECT_EQ(index.FindLink("Delayer", "TT Change ScreenMode", 1, 0), (MockLink *)NULL);
+    EXPECT_EQ(index.FindLink("Script", "Time Settings", 0, 0), (MockLink *)NULL);
+    EXPECT_EQ(index.FindLink(script.Get()->inputs[0], ts->inputs[0]), fromScript);
+
+    std::vector<MockLink *> links;
+    index.GetLinksTo(ii, links);
+    EXPECT_EQ(links, (std::vector<MockLink *>{first, other, second}));
+    index.GetLinksTo(ts, links);
+    EXPECT_EQ(links, (std::vector<MockLink *>{fromScript}));
+    index.GetLinksFrom(script.Get(), links);
+    EXPECT_EQ(links, (std::vector<MockLink *>{fromScript}));
+    index.GetLinksFrom(csm, links);
+    EXPECT_TRUE(links.empty());
+}
+
+TEST(BehaviorGraphIndexTest, TracksLinkEdits) {
+    MockScript script;
+    MockBehavior *sc = script.Add("Set Cell");
+    MockBehavior *rc = script.Add("Remove Column");
+    MockBehavior *minWidth = script.Add("Remove Row If");
+    MockBehavior *bpp = script.Add("Remove Row If");
+    MockLink *rcMin = script.Link(rc, minWidth);
+    MockLink *scRc = script.Link(sc, rc);
+
+    MockIndex index;
+    index.Build(script.Get());
+
+    script.Unlink(rcMin);
+    index.RemoveLink(rcMin);
+    EXPECT_EQ(index.FindLink("Remove Column", minWidth, 0, 0), (MockLink *)NULL);
+    EXPECT_EQ(index.GetLinkCount(), 1);
+
+    MockLink *scMin = script.Link(sc, minWidth);
+    index.AddLink(scMin);
+    EXPECT_EQ(index.FindLink("Set Cell", minWidth, 0, 0), scMin);
+    EXPECT_EQ(index.FindLink("Set Cell", "Remove Row If", 0, 0), scMin);
+
+    // A re-pointed link is found by its new ends and keeps its place.
+    scRc->out = bpp->inputs[0];
+    index.UpdateLink(scRc);
+    EXPECT_EQ(index.FindLink(sc, rc, 0, 0), (MockLink *)NULL);
+    EXPECT_EQ(index.FindLink("Set Cell", "Remove Row If", 0, 0), scRc);
+    EXPECT_EQ(index.FindLink("Set Cell", "Remove Row If", 0, 0, scRc), scMin);
+
+    std::vector<MockLink *> links;
+    index.GetLinksFrom(sc, links);
+    EXPECT_EQ(links, (std::vector<MockLink *>{scRc, scMin}));
+
+    index.RemoveBehavior(rc);
+    EXPECT_EQ(index.FindBehavior("Remove Column"), (MockBehavior *)NULL);
+    EXPECT_EQ(index.GetBehaviorCount(), 3);
+
+    index.Clear();
+    EXPECT_EQ(index.GetScript(), (MockBehavior *)NULL);
+    EXPECT_EQ(index.GetLinkCount(), 0);
+    EXPECT_EQ(index.FindBehavior("Set Cell"), (MockBehavior *)NULL);
+}
+
+TEST(BehaviorGraphIndexTest, MatchesScansThroughRandomEdits) {
+    const char *names[] = {"Set Cell", "Remove Row If", "Op", "Get Cell", "Delayer"};
+    const int kNames = sizeof(names) / sizeof(names[0]);
+
+    std::mt19937 rng(40);
+    MockScript script;
+    std::vector<MockBehavior *> behaviors;
+    for (int i = 0; i < 60; ++i)
+        behaviors.push_back(script.Add(names[rng() % kNames]));
+    for (int i = 0; i < 200; ++i)
+        script.Link(behaviors[rng() % behaviors.size()], behaviors[rng() % behaviors.size()], rng() % 2, rng() % 2);
+
+    MockIndex index;
+    index.Build(script.Get());
+
+    for (int round = 0; round < 300; ++round) {
+        std::vector<MockLink *> &links = script.Get()->subLinks;
+        switch (rng() % 3) {
+            case 0: {
+                MockLink *link = script.Link(behaviors[rng() % behaviors.size()], behaviors[rng() % behaviors.size()], rng() % 2, rng() % 2);
+                index.AddLink(link);
+                break;
+            }
+            case 1:
+                if (!links.empty()) {
+                    MockLink *link = links[rng() % links.size()];
+                    script.Unlink(link);
+                    index.RemoveLink(link);
+                }
+                break;
+            default:
+                if (!links.empty()) {
+                    MockLink *link = links[rng() % links.size()];
+                    link->out = behaviors[rng() % behaviors.size()]->inputs[rng() % 2];
+                    index.UpdateLink(link);
+                }
+                break;
+        }
+
+        const char *inName = names[rng() % kNames];
+        const char *outName = names[rng() % kNames];
+        const int inPos = rng() % 2;
+        const int outPos = rng() % 2;
+        MockLink *expected = ScanLink(script.Get(), inName, outName, inPos, outPos);
+        MockLink *actual = index.FindLink(inName, outName, inPos, outPos);
+        ASSERT_EQ(actual, expected) << "round " << round;
+        while (expected) {
+            expected = ScanLink(script.Get(), inName, outName, inPos, outPos, expected);
+            actual = index.FindLink(inName, outName, inPos, outPos, actual);
+            ASSERT_EQ(actual, expected) << "round " << round;
+        }
+
+        MockBehavior *from = behaviors[rng() % behaviors.size()];
+        MockBehavior *to = behaviors[rng() % behaviors.size()];
+        ASSERT_EQ(index.FindLink(from, to, inPos, outPos), ScanLink(script.Get(), from->outputs[inPos], to->inputs[outPos]));
+        ASSERT_EQ(index.FindLink(inName, to, inPos, outPos),
+                  ScanLink(script.Get(), [&](MockLink *link) {
+                      return link->out == to->inputs[outPos] && link->in->owner->name == inName &&
+                             link->in->owner->outputs[inPos] == link->in;
+                  }, NULL));
+        ASSERT_EQ(index.FindLink(from, outName, inPos, outPos),
+                  ScanLink(script.Get(), [&](MockLink *link) {
+                      return link->in == from->outputs[inPos] && link->out->owner->name == outName &&
+                             link->out->owner->inputs[outPos] == link->out;
+                  }, NULL));
+    }
+}
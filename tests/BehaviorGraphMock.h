@@ -0,0 +1,161 @@
+#ifndef PLAYER_TESTS_BEHAVIORGRAPHMOCK_H
+#define PLAYER_TESTS_BEHAVIORGRAPHMOCK_H
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BehaviorGraphIndex.h"
+
+// An in-memory script for CBehaviorGraphIndex, with the linear scans of the
+// scriptutils helpers to check and time the index against.
+namespace {
+    struct MockIO;
+    struct MockLink;
+
+    struct MockBehavior {
+        std::string name;
+        std::string target;
+        bool hasTarget = false;
+        std::vector<MockIO *> inputs;
+        std::vector<MockIO *> outputs;
+        std::vector<MockBehavior *> subBehaviors;
+        std::vector<MockLink *> subLinks;
+    };
+
+    struct MockIO {
+        MockBehavior *owner;
+    };
+
+    struct MockLink {
+        MockIO *in;
+        MockIO *out;
+    };
+
+    struct MockGraph {
+        typedef MockBehavior *Behavior;
+        typedef MockLink *Link;
+        typedef MockIO *IO;
+
+        static int GetSubBehaviorCount(MockBehavior *script) { return (int)script->subBehaviors.size(); }
+        static MockBehavior *GetSubBehavior(MockBehavior *script, int index) { return script->subBehaviors[index]; }
+        static int GetSubLinkCount(MockBehavior *script) { return (int)script->subLinks.size(); }
+        static MockLink *GetSubLink(MockBehavior *script, int index) { return script->subLinks[index]; }
+        static const char *GetName(MockBehavior *beh) { return beh->name.c_str(); }
+        static const char *GetTargetName(MockBehavior *beh) { return beh->hasTarget ? beh->target.c_str() : NULL; }
+        static MockIO *GetInput(MockBehavior *beh, int pos) { return pos < (int)beh->inputs.size() ? beh->inputs[pos] : NULL; }
+        static MockIO *GetOutput(MockBehavior *beh, int pos) { return pos < (int)beh->outputs.size() ? beh->outputs[pos] : NULL; }
+        static MockIO *GetLinkInput(MockLink *link) { return link->in; }
+        static MockIO *GetLinkOutput(MockLink *link) { return link->out; }
+        static MockBehavior *GetOwner(MockIO *io) { return io->owner; }
+    };
+
+    typedef CBehaviorGraphIndex<MockGraph> MockIndex;
+
+    // A script that owns its behaviors, IOs and links.
+    class MockScript {
+    public:
+        MockScript() : m_Script(NewBehavior("Script", 2, 2)) {}
+
+        MockBehavior *Get() { return m_Script; }
+
+        MockBehavior *Add(const std::string &name, int inputs = 2, int outputs = 2, const char *target = NULL) {
+            MockBehavior *beh = NewBehavior(name, inputs, outputs);
+            if (target) {
+                beh->hasTarget = true;
+                beh->target = target;
+            }
+            m_Script->subBehaviors.push_back(beh);
+            return beh;
+        }
+
+        MockLink *Link(MockIO *in, MockIO *out) {
+            m_Links.push_back(std::unique_ptr<MockLink>(new MockLink{in, out}));
+            m_Script->subLinks.push_back(m_Links.back().get());
+            return m_Links.back().get();
+        }
+
+        MockLink *Link(MockBehavior *from, MockBehavior *to, int outPos = 0, int inPos = 0) {
+            return Link(from->outputs[outPos], to->inputs[inPos]);
+        }
+
+        void Unlink(MockLink *link) {
+            std::vector<MockLink *> &links = m_Script->subLinks;
+            links.erase(std::find(links.begin(), links.end(), link));
+        }
+
+    private:
+        MockBehavior *NewBehavior(const std::string &name, int inputs, int outputs) {
+            m_Behaviors.push_back(std::unique_ptr<MockBehavior>(new MockBehavior));
+            MockBehavior *beh = m_Behaviors.back().get();
+            beh->name = name;
+            for (int i = 0; i < inputs; ++i)
+                beh->inputs.push_back(NewIO(beh));
+            for (int i = 0; i < outputs; ++i)
+                beh->outputs.push_back(NewIO(beh));
+            return beh;
+        }
+
+        MockIO *NewIO(MockBehavior *owner) {
+            m_IOs.push_back(std::unique_ptr<MockIO>(new MockIO{owner}));
+            return m_IOs.back().get();
+        }
+
+        std::vector<std::unique_ptr<MockBehavior>> m_Behaviors;
+        std::vector<std::unique_ptr<MockIO>> m_IOs;
+        std::vector<std::unique_ptr<MockLink>> m_Links;
+        MockBehavior *m_Script;
+    };
+
+    // The scans of the scriptutils helpers: the first match after previous, none
+    // when previous is not in the script.
+    inline MockBehavior *ScanBehavior(MockBehavior *script, const char *name, MockBehavior *previous = NULL) {
+        const std::vector<MockBehavior *> &list = script->subBehaviors;
+        size_t i = 0;
+        if (previous) {
+            i = std::find(list.begin(), list.end(), previous) - list.begin();
+            if (i == list.size())
+                return NULL;
+            ++i;
+        }
+        for (; i < list.size(); ++i) {
+            if (list[i]->name == name)
+                return list[i];
+        }
+        return NULL;
+    }
+
+    template <typename Match>
+    inline MockLink *ScanLink(MockBehavior *script, Match match, MockLink *previous) {
+        const std::vector<MockLink *> &list = script->subLinks;
+        size_t i = 0;
+        if (previous) {
+            i = std::find(list.begin(), list.end(), previous) - list.begin();
+            if (i == list.size())
+                return NULL;
+            ++i;
+        }
+        for (; i < list.size(); ++i) {
+            if (match(list[i]))
+                return list[i];
+        }
+        return NULL;
+    }
+
+    inline MockLink *ScanLink(MockBehavior *script, const char *inName, const char *outName, int inPos, int outPos,
+                              MockLink *previous = NULL) {
+        return ScanLink(script, [&](MockLink *link) {
+            MockBehavior *inBeh = link->in->owner;
+            MockBehavior *outBeh = link->out->owner;
+            return inBeh->name == inName && outBeh->name == outName &&
+                   MockGraph::GetOutput(inBeh, inPos) == link->in && MockGraph::GetInput(outBeh, outPos) == link->out;
+        }, previous);
+    }
+
+    inline MockLink *ScanLink(MockBehavior *script, MockIO *in, MockIO *out, MockLink *previous = NULL) {
+        return ScanLink(script, [&](MockLink *link) { return link->in == in && link->out == out; }, previous);
+    }
+}
+
+#endif // PLAYER_TESTS_BEHAVIORGRAPHMOCK_H
@@ -0,0 +1,335 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BmpImage.h"
+#include "MappedFile.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    typedef std::vector<unsigned char> Bytes;
+
+    void Put16(Bytes &out, size_t at, unsigned int value) {
+        out[at] = (unsigned char)value;
+        out[at + 1] = (unsigned char)(value >> 8);
+    }
+
+    void Put32(Bytes &out, size_t at, platform::uint32 value) {
+        for (int i = 0; i < 4; ++i)
+            out[at + i] = (unsigned char)(value >> (8 * i));
+    }
+
+    // A BMP with an info header, `colors` palette entries and the given pixel bytes.
+    Bytes MakeBmp(int width, int height, int bitCount, int compression, int colors, const Bytes &pixels) {
+        const size_t paletteOffset = 14 + 40 + (compression == eBmpBitfields ? 12 : 0);
+        const size_t pixelOffset = paletteOffset + (size_t)colors * 4;
+        Bytes out(pixelOffset, 0);
+        out[0] = 'B';
+        out[1] = 'M';
+        Put32(out, 2, (platform::uint32)(pixelOffset + pixels.size()));
+        Put32(out, 10, (platform::uint32)pixelOffset);
+        Put32(out, 14, 40);
+        Put32(out, 18, (platform::uint32)width);
+        Put32(out, 22, (platform::uint32)height);
+        Put16(out, 26, 1);
+        Put16(out, 28, (unsigned int)bitCount);
+        Put32(out, 30, (platform::uint32)compression);
+        Put32(out, 34, (platform::uint32)pixels.size());
+        Put32(out, 46, (platform::uint32)colors);
+        if (compression == eBmpBitfields) {
+            Put32(out, 54, 0x00FF0000);
+            Put32(out, 58, 0x0000FF00);
+            Put32(out, 62, 0x000000FF);
+        }
+        for (int i = 0; i < colors; ++i) {
+            out[paletteOffset + i * 4] = (unsigned char)i;            // blue
+            out[paletteOffset + i * 4 + 1] = (unsigned char)(i * 2);  // green
+            out[paletteOffset + i * 4 + 2] = (unsigned char)(i * 3);  // red
+        }
+        out.insert(out.end(), pixels.begin(), pixels.end());
+        return out;
+    }
+
+    Bytes Gradient(size_t size) {
+        Bytes pixels(size);
+        for (size_t i = 0; i < size; ++i)
+            pixels[i] = (unsigned char)(i * 7);
+        return pixels;
+    }
+
+    fs::path WriteFile(const char *name, const Bytes &contents) {
+        const fs::path path = fs::temp_directory_path() / name;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write((const char *)contents.data(), (std::streamsize)contents.size());
+        return path;
+    }
+}
+
+TEST(BmpImageTest, References24BitPixelsInPlace) {
+    // Rows of 3 pixels take 9 bytes, padded to 12.
+    const Bytes file = MakeBmp(3, 2, 24, eBmpRgb, 0, Gradient(24));
+
+    CBmpImage image;
+    ASSERT_TRUE(image.Decode(file.data(), file.size()));
+    EXPECT_EQ(image.GetWidth(), 3);
+    EXPECT_EQ(image.GetHeight(), 2);
+    EXPECT_EQ(image.GetBitCount(), 24);
+    EXPECT_EQ(image.GetStride(), 12u);
+    EXPECT_TRUE(image.IsInPlace());
+    EXPECT_FALSE(image.IsTopDown());
+    EXPECT_EQ(image.GetPaletteSize(), 0);
+    EXPECT_EQ(image.GetPixels(), file.data() + 54);
+
+    // Bottom-up: the first stored row is the bottom one.
+    EXPECT_EQ(image.GetRow(1), file.data() + 54);
+    EXPECT_EQ(image.GetRow(0), file.data() + 54 + 12);
+    EXPECT_EQ(image.GetRow(2), nullptr);
+}
+
+TEST(BmpImageTest, Decodes8BitWithPalette) {
+    const Bytes file = MakeBmp(4, 4, 8, eBmpRgb, 16, Gradient(16));
+
+    CBmpImage image;
+    ASSERT_TRUE(image.Decode(file.data(), file.size()));
+    EXPECT_EQ(image.GetBitCount(), 8);
+    ASSERT_EQ(image.GetPaletteSize(), 16);
+    EXPECT_EQ(image.GetPalette()[5].blue, 5);
+    EXPECT_EQ(image.GetPalette()[5].green, 10);
+    EXPECT_EQ(image.GetPalette()[5].red, 15);
+    EXPECT_TRUE(image.IsInPlace());
+}
+
+TEST(BmpImageTest, Decodes32BitTopDownAndBitfields) {
+    Bytes file = MakeBmp(2, 2, 32, eBmpRgb, 0, Gradient(16));
+    Put32(file, 22, (platform::uint32)-2);
+
+    CBmpImage image;
+    ASSERT_TRUE(image.Decode(file.data(), file.size()));
+    EXPECT_TRUE(image.IsTopDown());
+    EXPECT_EQ(image.GetHeight(), 2);
+    EXPECT_EQ(image.GetRow(0), file.data() + 54);
+
+    const Bytes bitfields = MakeBmp(2, 2, 32, eBmpBitfields, 0, Gradient(16));
+    ASSERT_TRUE(image.Decode(bitfields.data(), bitfields.size()));
+    EXPECT_EQ(image.GetPixels(), bitfields.data() + 66);
+
+    // Masks other than BGRX would need a conversion.
+    Bytes swapped = bitfields;
+    Put32(swapped, 54, 0x000000FF);
+    Put32(swapped, 62, 0x00FF0000);
+    EXPECT_FALSE(image.Decode(swapped.data(), swapped.size()));
+    EXPECT_FALSE(image.IsValid());
+}
+
+TEST(BmpImageTest, ReadsCoreHeaderPalettes) {
+    // An OS/2 header with three-byte palette entries.
+    Bytes file(14 + 12 + 2 * 3, 0);
+    file[0] = 'B';
+    file[1] = 'M';
+    Put32(file, 10, (platform::uint32)file.size());
+    Put32(file, 14, 12);
+    Put16(file, 18, 4);
+    Put16(file, 20, 1);
+    Put16(file, 22, 1);
+    Put16(file, 24, 8);
+    const Bytes pixels(4, 1);
+    file.insert(file.end(), pixels.begin(), pixels.end());
+
+    // Without a colour count, an 8-bit core palette would have 256 entries.
+    CBmpImage image;
+    EXPECT_FALSE(image.Decode(file.data(), file.size()));
+
+    Bytes full(14 + 12 + 256 * 3, 0);
+    std::memcpy(full.data(), file.data(), 26);
+    Put32(full, 10, (platform::uint32)full.size());
+    full[26 + 3 + 2] = 0x80; // red of entry 1
+    full.insert(full.end(), pixels.begin(), pixels.end());
+    ASSERT_TRUE(image.Decode(full.data(), full.size()));
+    ASSERT_EQ(image.GetPaletteSize(), 256);
+    EXPECT_EQ(image.GetPalette()[1].red, 0x80);
+    EXPECT_EQ(image.GetPalette()[1].reserved, 0);
+}
+
+TEST(BmpImageTest, ExpandsRle8) {
+    const unsigned char stream[] = {
+        3, 7,          // 7 7 7
+        0, 3, 1, 2, 4, 0, // literal 1 2 4, padded
+        0, 0,          // end of line
+        0, 2, 2, 0,    // move right by 2
+        2, 9,          // 9 9
+        0, 1,          // end of bitmap
+    };
+    const Bytes file = MakeBmp(6, 2, 8, eBmpRle8, 16, Bytes(stream, stream + sizeof(stream)));
+
+    CBmpImage image;
+    ASSERT_TRUE(image.Decode(file.data(), file.size()));
+    EXPECT_FALSE(image.IsInPlace());
+    EXPECT_EQ(image.GetBitCount(), 8);
+    EXPECT_EQ(image.GetCompression(), eBmpRle8);
+
+    const unsigned char bottom[] = {7, 7, 7, 1, 2, 4};
+    const unsigned char top[] = {0, 0, 9, 9, 0, 0};
+    EXPECT_EQ(std::memcmp(image.GetRow(1), bottom, 6), 0);
+    EXPECT_EQ(std::memcmp(image.GetRow(0), top, 6), 0);
+}
+
+TEST(BmpImageTest, ExpandsRle4) {
+    const unsigned char stream[] = {
+        5, 0x12,          // 1 2 1 2 1
+        0, 3, 0x34, 0x50, // literal 3 4 5
+        0, 1,
+    };
+    const Bytes file = MakeBmp(8, 1, 4, eBmpRle4, 16, Bytes(stream, stream + sizeof(stream)));
+
+    CBmpImage image;
+    ASSERT_TRUE(image.Decode(file.data(), file.size()));
+    const unsigned char row[] = {1, 2, 1, 2, 1, 3, 4, 5};
+    EXPECT_EQ(std::memcmp(image.GetRow(0), row, 8), 0);
+}
+
+TEST(BmpImageTest, RejectsMalformedRle) {
+    const unsigned char overrun[] = {9, 1, 0, 1};              // a run past the row
+    const unsigned char literal[] = {0, 4, 1, 2};              // a literal past the data
+    const unsigned char unterminated[] = {2, 1};               // no end of bitmap
+    const unsigned char jump[] = {0, 2, 0, 5, 0, 1};           // a move past the top
+    const unsigned char *streams[] = {overrun, literal, unterminated, jump};
+    const size_t sizes[] = {sizeof(overrun), sizeof(literal), sizeof(unterminated), sizeof(jump)};
+
+    CBmpImage image;
+    for (int i = 0; i < 4; ++i) {
+        const Bytes file = MakeBmp(4, 2, 8, eBmpRle8, 4, Bytes(streams[i], streams[i] + sizes[i]));
+        EXPECT_FALSE(image.Decode(file.data(), file.size())) << "stream " << i;
+        EXPECT_FALSE(image.IsValid());
+    }
+}
+
+TEST(BmpImageTest, RejectsMalformedHeaders) {
+    const Bytes valid = MakeBmp(4, 4, 24, eBmpRgb, 0, Gradient(48));
+    CBmpImage image;
+    ASSERT_TRUE(image.Decode(valid.data(), valid.size()));
+
+    EXPECT_FALSE(image.Decode(NULL, 0));
+    EXPECT_FALSE(image.Decode(valid.data(), 20));
+
+    Bytes bad = valid;
+    bad[1] = 'A';
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "magic";
+
+    bad = valid;
+    Put32(bad, 14, 64);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "header size";
+
+    bad = valid;
+    Put16(bad, 26, 2);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "planes";
+
+    bad = valid;
+    Put16(bad, 28, 16);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "bit count";
+
+    bad = valid;
+    Put32(bad, 18, 0);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "zero width";
+
+    bad = valid;
+    Put32(bad, 22, 0x80000000u);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "most negative height";
+
+    bad = valid;
+    Put32(bad, 18, CBmpImage::MAX_DIMENSION + 1);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "huge width";
+
+    bad = valid;
+    Put32(bad, 10, (platform::uint32)valid.size());
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "pixels past the end";
+
+    bad = valid;
+    Put32(bad, 10, 20);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "pixels inside the header";
+
+    EXPECT_FALSE(image.Decode(valid.data(), valid.size() - 1)) << "truncated pixels";
+
+    bad = valid;
+    Put32(bad, 30, 1);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "RLE8 at 24 bits";
+
+    const Bytes palette = MakeBmp(4, 4, 8, eBmpRgb, 16, Gradient(16));
+    bad = palette;
+    Put32(bad, 46, 257);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "oversized palette";
+
+    bad = palette;
+    Put32(bad, 46, 32);
+    EXPECT_FALSE(image.Decode(bad.data(), bad.size())) << "palette over the pixels";
+}
+
+TEST(BmpImageTest, DecodesAMappedFile) {
+    const Bytes contents = MakeBmp(16, 8, 24, eBmpRgb, 0, Gradient(16 * 3 * 8));
+    const fs::path path = WriteFile("ballance_bmp_image_test.bmp", contents);
+
+    CMappedFile file;
+    ASSERT_TRUE(file.Open(path.string().c_str()));
+    CBmpImage image;
+    ASSERT_TRUE(image.Decode(file.GetData(), (size_t)file.GetSize()));
+    EXPECT_EQ(image.GetPixels(), (const unsigned char *)file.GetData() + 54);
+    EXPECT_EQ(std::memcmp(image.GetRow(7), contents.data() + 54, 48), 0);
+
+    image.Clear();
+    file.Close();
+    fs::remove(path);
+}
+
+TEST(BmpImageFuzz, MutatedFilesNeverReadOutOfBounds) {
+    const unsigned char rle[] = {3, 7, 0, 3, 1, 2, 4, 0, 0, 0, 0, 2, 2, 0, 2, 9, 0, 1};
+    std::vector<Bytes> seeds;
+    seeds.push_back(MakeBmp(5, 3, 24, eBmpRgb, 0, Gradient(48)));
+    seeds.push_back(MakeBmp(4, 4, 8, eBmpRgb, 16, Gradient(16)));
+    seeds.push_back(MakeBmp(2, 2, 32, eBmpBitfields, 0, Gradient(16)));
+    seeds.push_back(MakeBmp(6, 2, 8, eBmpRle8, 16, Bytes(rle, rle + sizeof(rle))));
+    seeds.push_back(MakeBmp(8, 1, 4, eBmpRle4, 16, Bytes(rle, rle + sizeof(rle))));
+
+    std::mt19937 rng(46);
+    CBmpImage image;
+    int decoded = 0;
+    for (int round = 0; round < 20000; ++round) {
+        const Bytes &seed = seeds[round % seeds.size()];
+        // Decode from an exactly sized heap copy, so a sanitizer catches any overread.
+        Bytes mutated = seed;
+        const int edits = 1 + (int)(rng() % 4);
+        for (int e = 0; e < edits; ++e) {
+            const size_t at = rng() % mutated.size();
+            switch (rng() % 3) {
+            case 0: mutated[at] = (unsigned char)rng(); break;
+            case 1: mutated[at] ^= (unsigned char)(1u << (rng() % 8)); break;
+            default: mutated.resize(at + 1); break;
+            }
+        }
+
+        if (!image.Decode(mutated.data(), mutated.size()))
+            continue;
+        ++decoded;
+
+        // Whatever decodes must describe memory that exists.
+        const size_t rowBytes = ((size_t)image.GetWidth() * image.GetBitCount() + 7) / 8;
+        ASSERT_LE(rowBytes, image.GetStride());
+        unsigned int sum = 0;
+        for (int y = 0; y < image.GetHeight(); ++y) {
+            const unsigned char *row = image.GetRow(y);
+            ASSERT_NE(row, nullptr);
+            if (image.IsInPlace()) {
+                ASSERT_GE(row, mutated.data());
+                ASSERT_LE(row + rowBytes, mutated.data() + mutated.size());
+            }
+            for (size_t x = 0; x < rowBytes; ++x)
+                sum += row[x];
+        }
+        (void)sum;
+    }
+    EXPECT_GT(decoded, 0);
+}
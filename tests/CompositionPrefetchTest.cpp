@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "CompositionPrefetch.h"
+
+namespace {
+    // In-memory tree. Prefetch() can be held until the test opens the gate.
+    class FakeFileSystem : public CFileSystem {
+    public:
+        FakeFileSystem() : m_GateOpen(true), m_Waiting(0) {}
+
+        void AddFile(const std::string &directory, const std::string &name, platform::uint64 size) {
+            m_Directories.insert(filesystem::NormalizePath(directory));
+            FileEntry entry;
+            entry.path = filesystem::JoinPath(directory, name);
+            entry.size = size;
+            entry.modifiedTime = 1;
+            m_Files[filesystem::NormalizePath(directory)].push_back(entry);
+            m_Sizes[filesystem::NormalizePath(entry.path)] = size;
+        }
+
+        void CloseGate() {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_GateOpen = false;
+        }
+
+        void OpenGate() {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_GateOpen = true;
+            m_Changed.notify_all();
+        }
+
+        void WaitForBlockedRead() {
+            std::unique_lock<std::mutex> lock(m_Lock);
+            m_Changed.wait(lock, [this] { return m_Waiting > 0; });
+        }
+
+        bool DirectoryExists(const char *path) override {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            return m_Directories.count(filesystem::NormalizePath(path)) != 0;
+        }
+
+        bool ListFiles(const char *directory, const char *extension, std::vector<FileEntry> &files) override {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            const std::string key = filesystem::NormalizePath(directory);
+            ++m_ListCalls[key];
+            if (m_Directories.count(key) == 0)
+                return false;
+            const std::vector<FileEntry> &entries = m_Files[key];
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (filesystem::HasExtension(entries[i].path.c_str(), extension))
+                    files.push_back(entries[i]);
+            }
+            return true;
+        }
+
+        bool ListDirectories(const char *directory, std::vector<std::string> &) override {
+            return DirectoryExists(directory);
+        }
+
+        bool GetFileEntry(const char *path, FileEntry &entry) override {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            std::map<std::string, platform::uint64>::const_iterator it = m_Sizes.find(filesystem::NormalizePath(path));
+            if (it == m_Sizes.end())
+                return false;
+            entry.path = path;
+            entry.size = it->second;
+            entry.modifiedTime = 1;
+            return true;
+        }
+
+        platform::uint64 Prefetch(const char *path) override {
+            std::unique_lock<std::mutex> lock(m_Lock);
+            ++m_Waiting;
+            m_Changed.notify_all();
+            m_Changed.wait(lock, [this] { return m_GateOpen; });
+            --m_Waiting;
+            m_Prefetched.push_back(path);
+            std::map<std::string, platform::uint64>::const_iterator it = m_Sizes.find(filesystem::NormalizePath(path));
+            return it != m_Sizes.end() ? it->second : 0;
+        }
+
+        std::vector<std::string> Prefetched() {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            return m_Prefetched;
+        }
+
+        int ListCalls(const std::string &path) {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            return m_ListCalls[filesystem::NormalizePath(path)];
+        }
+
+    private:
+        std::mutex m_Lock;
+        std::condition_variable m_Changed;
+        bool m_GateOpen;
+        int m_Waiting;
+        std::set<std::string> m_Directories;
+        std::map<std::string, std::vector<FileEntry> > m_Files;
+        std::map<std::string, platform::uint64> m_Sizes;
+        std::map<std::string, int> m_ListCalls;
+        std::vector<std::string> m_Prefetched;
+    };
+
+    void BuildGame(FakeFileSystem &fs) {
+        fs.AddFile("/game/", "base.cmo", 5000);
+        fs.AddFile("/game/Textures/", "Ball.bmp", 300);
+        fs.AddFile("/game/Textures/", "Sky.bmp", 200);
+        fs.AddFile("/game/Sounds/", "Hit.wav", 100);
+        fs.AddFile("/game/3D Entities/", "Balls.nmo", 400);
+        fs.AddFile("/game/Music/", "Theme.wav", 50);
+    }
+}
+
+TEST(CompositionPrefetchTest, ReadsCompositionFirstThenItsDirectoriesOnce) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+
+    CCompositionPrefetcher prefetcher(fs);
+    prefetcher.SetComposition("base.cmo", "/game/");
+    prefetcher.AddDirectory("/game/textures");
+    prefetcher.AddDirectory("/game/Music/");
+    prefetcher.AddDirectory("/game/Missing/");
+    ASSERT_TRUE(prefetcher.Start(1));
+    ASSERT_TRUE(prefetcher.Wait());
+    EXPECT_TRUE(prefetcher.IsFinished());
+
+    EXPECT_EQ(prefetcher.GetCompositionPath(), "/game/base.cmo");
+    const std::vector<std::string> order = fs.Prefetched();
+    ASSERT_EQ(order.size(), 6u);
+    EXPECT_EQ(order[0], "/game/base.cmo");
+    EXPECT_EQ(order[1], "/game/Textures/Ball.bmp");
+    EXPECT_EQ(order[2], "/game/Textures/Sky.bmp");
+    EXPECT_EQ(order[3], "/game/Sounds/Hit.wav");
+    EXPECT_EQ(order[4], "/game/3D Entities/Balls.nmo");
+    EXPECT_EQ(order[5], "/game/Music/Theme.wav");
+
+    EXPECT_EQ(fs.ListCalls("/game/Textures"), 1);
+    EXPECT_EQ(prefetcher.GetPrefetchedFiles(), 6);
+    EXPECT_EQ(prefetcher.GetPrefetchedBytes(), 6050u);
+    EXPECT_EQ(prefetcher.GetSkippedFiles(), 0);
+}
+
+TEST(CompositionPrefetchTest, PrefersTheFileNameAsGiven) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+    fs.AddFile("/mods/", "base.cmo", 10);
+    fs.AddFile("/mods/Textures/", "Mod.bmp", 20);
+
+    CCompositionPrefetcher prefetcher(fs);
+    prefetcher.SetComposition("/mods/base.cmo", "/game/");
+    ASSERT_TRUE(prefetcher.Start(2));
+    ASSERT_TRUE(prefetcher.Wait());
+
+    EXPECT_EQ(prefetcher.GetCompositionPath(), "/mods/base.cmo");
+    EXPECT_EQ(prefetcher.GetPrefetchedFiles(), 2);
+    EXPECT_EQ(prefetcher.GetPrefetchedBytes(), 30u);
+}
+
+TEST(CompositionPrefetchTest, MissingCompositionStillReadsAddedDirectories) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+
+    CCompositionPrefetcher prefetcher(fs);
+    prefetcher.SetComposition("level.cmo", "/game/");
+    prefetcher.AddDirectory("/game/Music/");
+    ASSERT_TRUE(prefetcher.Start(2));
+    ASSERT_TRUE(prefetcher.Wait());
+
+    EXPECT_TRUE(prefetcher.GetCompositionPath().empty());
+    const std::vector<std::string> order = fs.Prefetched();
+    ASSERT_EQ(order.size(), 1u);
+    EXPECT_EQ(order[0], "/game/Music/Theme.wav");
+}
+
+TEST(CompositionPrefetchTest, ReadsAddedFilesBeforeDirectoriesAndOnlyOnce) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+
+    CCompositionPrefetcher prefetcher(fs);
+    prefetcher.SetComposition("base.cmo", "/game/");
+    prefetcher.AddFile("/game/Sounds/Hit.wav");
+    prefetcher.AddFile("/game/Missing/Gone.wav");
+    prefetcher.AddFile("/game/textures/sky.bmp");
+    prefetcher.AddFile("/game/Sounds/Hit.wav");
+    ASSERT_TRUE(prefetcher.Start(1));
+    ASSERT_TRUE(prefetcher.Wait());
+
+    const std::vector<std::string> order = fs.Prefetched();
+    ASSERT_EQ(order.size(), 5u);
+    EXPECT_EQ(order[0], "/game/base.cmo");
+    EXPECT_EQ(order[1], "/game/Sounds/Hit.wav");
+    EXPECT_EQ(order[2], "/game/textures/sky.bmp");
+    EXPECT_EQ(order[3], "/game/Textures/Ball.bmp");
+    EXPECT_EQ(order[4], "/game/3D Entities/Balls.nmo");
+    EXPECT_EQ(prefetcher.GetPrefetchedBytes(), 6000u);
+}
+
+TEST(CompositionPrefetchTest, BudgetSkipsDirectoryFilesButNotTheComposition) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+
+    CCompositionPrefetcher prefetcher(fs);
+    prefetcher.SetComposition("base.cmo", "/game/");
+    prefetcher.SetByteBudget(5350);
+    ASSERT_TRUE(prefetcher.Start(1));
+    ASSERT_TRUE(prefetcher.Wait());
+
+    // The composition takes 5000 of the 5350 bytes, Ball.bmp another 300; every
+    // later file would go past the budget.
+    const std::vector<std::string> order = fs.Prefetched();
+    ASSERT_EQ(order.size(), 2u);
+    EXPECT_EQ(order[0], "/game/base.cmo");
+    EXPECT_EQ(order[1], "/game/Textures/Ball.bmp");
+    EXPECT_EQ(prefetcher.GetSkippedFiles(), 3);
+    EXPECT_EQ(prefetcher.GetPrefetchedBytes(), 5300u);
+}
+
+TEST(CompositionPrefetchTest, CancelSkipsFilesNotStartedYet) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+    fs.CloseGate();
+
+    CCompositionPrefetcher prefetcher(fs);
+    prefetcher.SetComposition("base.cmo", "/game/");
+    ASSERT_TRUE(prefetcher.Start(1));
+
+    // The composition read is held, so the worker cannot finish.
+    fs.WaitForBlockedRead();
+    EXPECT_FALSE(prefetcher.Wait(10));
+    EXPECT_FALSE(prefetcher.IsFinished());
+
+    prefetcher.Cancel();
+    fs.OpenGate();
+    ASSERT_TRUE(prefetcher.Wait());
+    EXPECT_TRUE(prefetcher.Wait(0));
+    EXPECT_TRUE(prefetcher.IsCancelled());
+
+    // The read in progress completes; nothing else is listed or read.
+    const std::vector<std::string> order = fs.Prefetched();
+    ASSERT_EQ(order.size(), 1u);
+    EXPECT_EQ(order[0], "/game/base.cmo");
+    EXPECT_EQ(prefetcher.GetPrefetchedFiles(), 1);
+    EXPECT_EQ(fs.ListCalls("/game/Textures"), 0);
+}
+
+TEST(CompositionPrefetchTest, DestructorStopsARunningWorker) {
+    FakeFileSystem fs;
+    BuildGame(fs);
+    fs.CloseGate();
+    {
+        CCompositionPrefetcher prefetcher(fs);
+        prefetcher.SetComposition("base.cmo", "/game/");
+        ASSERT_TRUE(prefetcher.Start(2));
+        fs.WaitForBlockedRead();
+        fs.OpenGate();
+    }
+    EXPECT_LE(fs.Prefetched().size(), 6u);
+}
+
+TEST(CompositionPrefetchTest, WaitWithoutStartReturnsImmediately) {
+    FakeFileSystem fs;
+    CCompositionPrefetcher prefetcher(fs);
+    EXPECT_TRUE(prefetcher.Wait(0));
+    EXPECT_EQ(prefetcher.GetPrefetchedFiles(), 0);
+}
+
+TEST(CompositionPrefetchTest, GetDirectoryKeepsTheTrailingSeparator) {
+    EXPECT_EQ(filesystem::GetDirectory("/game/base.cmo"), "/game/");
+    EXPECT_EQ(filesystem::GetDirectory("..\\base.cmo"), "..\\");
+    EXPECT_EQ(filesystem::GetDirectory("base.cmo"), "");
+    EXPECT_EQ(filesystem::GetDirectory("/game/"), "/game/");
+}
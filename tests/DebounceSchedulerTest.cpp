@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include "DebounceScheduler.h"
+
+namespace {
+    const platform::uint64 kMs = 1000;
+
+    enum {
+        kPosition = 1,
+        kDisplay = 2,
+        kFullscreen = 4
+    };
+
+    // Stands in for the system clock so the tests decide how much time passes.
+    class FakeClock {
+    public:
+        FakeClock() : m_Now(5000 * kMs) {}
+
+        platform::uint64 Now() const { return m_Now; }
+        void Advance(platform::uint64 micros) { m_Now += micros; }
+
+    private:
+        platform::uint64 m_Now;
+    };
+
+    CDebounceScheduler MakeScheduler() {
+        CDebounceScheduler scheduler;
+        scheduler.Configure(500 * kMs, 2000 * kMs);
+        return scheduler;
+    }
+}
+
+TEST(DebounceSchedulerTest, CleanSchedulerIsNeverDue) {
+    FakeClock clock;
+    CDebounceScheduler scheduler = MakeScheduler();
+    EXPECT_FALSE(scheduler.IsDirty());
+    EXPECT_FALSE(scheduler.IsDue(clock.Now()));
+    EXPECT_EQ(scheduler.Poll(clock.Now()), 0u);
+    EXPECT_EQ(scheduler.GetWaitTime(clock.Now()), 0u);
+    EXPECT_EQ(scheduler.TakeAll(), 0u);
+    EXPECT_EQ(scheduler.GetFlushCount(), 0);
+
+    scheduler.MarkDirty(0, clock.Now());
+    EXPECT_FALSE(scheduler.IsDirty());
+}
+
+TEST(DebounceSchedulerTest, FlushesOnceTheChangesSettle) {
+    FakeClock clock;
+    CDebounceScheduler scheduler = MakeScheduler();
+
+    scheduler.MarkDirty(kPosition, clock.Now());
+    EXPECT_TRUE(scheduler.IsDirty());
+    EXPECT_EQ(scheduler.GetWaitTime(clock.Now()), 500 * kMs);
+
+    clock.Advance(499 * kMs);
+    EXPECT_EQ(scheduler.Poll(clock.Now()), 0u);
+    EXPECT_EQ(scheduler.GetWaitTime(clock.Now()), 1 * kMs);
+
+    clock.Advance(1 * kMs);
+    EXPECT_EQ(scheduler.Poll(clock.Now()), (unsigned int)kPosition);
+    EXPECT_FALSE(scheduler.IsDirty());
+    EXPECT_EQ(scheduler.Poll(clock.Now()), 0u);
+    EXPECT_EQ(scheduler.GetFlushCount(), 1);
+}
+
+TEST(DebounceSchedulerTest, DragCoalescesIntoOneFlush) {
+    FakeClock clock;
+    CDebounceScheduler scheduler = MakeScheduler();
+
+    // A one second drag sending a WM_MOVE every 8 ms.
+    int flushes = 0;
+    for (int i = 0; i < 125; ++i) {
+        scheduler.MarkDirty(kPosition, clock.Now());
+        if (scheduler.Poll(clock.Now()) != 0)
+            ++flushes;
+        clock.Advance(8 * kMs);
+    }
+    EXPECT_EQ(flushes, 0);
+
+    clock.Advance(500 * kMs);
+    EXPECT_EQ(scheduler.Poll(clock.Now()), (unsigned int)kPosition);
+    EXPECT_EQ(scheduler.GetFlushCount(), 1);
+}
+
+TEST(DebounceSchedulerTest, MaxDelayBoundsAnEndlessStream) {
+    FakeClock clock;
+    CDebounceScheduler scheduler = MakeScheduler();
+
+    // Changes every 100 ms for ten seconds never settle, yet flush every two seconds.
+    int flushes = 0;
+    for (int i = 0; i < 100; ++i) {
+        scheduler.MarkDirty(kPosition, clock.Now());
+        clock.Advance(100 * kMs);
+        if (scheduler.Poll(clock.Now()) != 0)
+            ++flushes;
+    }
+    EXPECT_EQ(flushes, 5);
+}
+
+TEST(DebounceSchedulerTest, MergesFieldsUntilTheFlush) {
+    FakeClock clock;
+    CDebounceScheduler scheduler = MakeScheduler();
+
+    scheduler.MarkDirty(kPosition, clock.Now());
+    clock.Advance(100 * kMs);
+    scheduler.MarkDirty(kDisplay | kFullscreen, clock.Now());
+    EXPECT_EQ(scheduler.GetDirtyFields(), (unsigned int)(kPosition | kDisplay | kFullscreen));
+
+    // The later change restarts the quiet period.
+    clock.Advance(450 * kMs);
+    EXPECT_EQ(scheduler.Poll(clock.Now()), 0u);
+    clock.Advance(50 * kMs);
+    EXPECT_EQ(scheduler.Poll(clock.Now()), (unsigned int)(kPosition | kDisplay | kFullscreen));
+}
+
+TEST(DebounceSchedulerTest, TakeAllFlushesOnShutdown) {
+    FakeClock clock;
+    CDebounceScheduler scheduler = MakeScheduler();
+
+    scheduler.MarkDirty(kDisplay, clock.Now());
+    EXPECT_EQ(scheduler.TakeAll(), (unsigned int)kDisplay);
+    EXPECT_FALSE(scheduler.IsDirty());
+    EXPECT_EQ(scheduler.GetFlushCount(), 1);
+}
+
+TEST(DebounceSchedulerTest, ClockGoingBackwardsWaitsAgain) {
+    FakeClock clock;
+    CDebounceScheduler scheduler = MakeScheduler();
+
+    scheduler.MarkDirty(kPosition, clock.Now());
+    EXPECT_FALSE(scheduler.IsDue(clock.Now() - 1000 * kMs));
+    EXPECT_EQ(scheduler.GetWaitTime(clock.Now() - 1000 * kMs), 500 * kMs);
+}
+
+TEST(DebounceSchedulerTest, MaxDelayIsAtLeastTheDelay) {
+    CDebounceScheduler scheduler;
+    EXPECT_EQ(scheduler.GetDelay(), (platform::uint64)CDebounceScheduler::DEFAULT_DELAY_MS * kMs);
+    EXPECT_EQ(scheduler.GetMaxDelay(), (platform::uint64)CDebounceScheduler::DEFAULT_MAX_DELAY_MS * kMs);
+
+    scheduler.Configure(800 * kMs, 100 * kMs);
+    EXPECT_EQ(scheduler.GetMaxDelay(), 800 * kMs);
+
+    FakeClock clock;
+    scheduler.MarkDirty(kPosition, clock.Now());
+    clock.Advance(799 * kMs);
+    EXPECT_FALSE(scheduler.IsDue(clock.Now()));
+    clock.Advance(1 * kMs);
+    EXPECT_TRUE(scheduler.IsDue(clock.Now()));
+}
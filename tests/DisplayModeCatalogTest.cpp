@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "DisplayModeCatalog.h"
+
+namespace {
+    DisplayMode Mode(int width, int height, int bpp, int refreshRate) {
+        DisplayMode mode = {width, height, bpp, refreshRate};
+        return mode;
+    }
+
+    // The two scans FindScreenMode used to make over the driver list.
+    int ScanMode(const std::vector<DisplayMode> &modes, int width, int height, int bpp) {
+        bool found = false;
+        int refreshRate = 0;
+        for (size_t i = 0; i < modes.size(); ++i) {
+            if (modes[i].width == width && modes[i].height == height && modes[i].bpp == bpp) {
+                found = true;
+                if (modes[i].refreshRate > refreshRate)
+                    refreshRate = modes[i].refreshRate;
+            }
+        }
+        if (!found)
+            return -1;
+        for (size_t j = 0; j < modes.size(); ++j) {
+            if (modes[j].width == width && modes[j].height == height && modes[j].bpp == bpp &&
+                modes[j].refreshRate == refreshRate)
+                return (int)j;
+        }
+        return -1;
+    }
+}
+
+TEST(DisplayModeCatalogTest, EmptyCatalogFindsNothing) {
+    CDisplayModeCatalog catalog;
+    catalog.Build(NULL, 0);
+    EXPECT_EQ(catalog.GetModeCount(), 0);
+    EXPECT_EQ(catalog.GetEntryCount(), 0);
+    EXPECT_EQ(catalog.FindMode(640, 480, 32), -1);
+
+    std::vector<int> modes(1, 7);
+    catalog.SelectModes(DisplayModeFilter(), modes);
+    EXPECT_TRUE(modes.empty());
+}
+
+TEST(DisplayModeCatalogTest, GroupsModesAndPicksBestRefreshRate) {
+    const DisplayMode modes[] = {
+        Mode(1024, 768, 32, 60),
+        Mode(640, 480, 16, 60),
+        Mode(640, 480, 32, 60),
+        Mode(1024, 768, 32, 75),
+        Mode(640, 480, 32, 85),
+        Mode(1024, 768, 32, 75),
+        Mode(640, 480, 8, 60),
+    };
+
+    CDisplayModeCatalog catalog;
+    catalog.Build(modes, 7);
+    EXPECT_EQ(catalog.GetModeCount(), 7);
+    ASSERT_EQ(catalog.GetEntryCount(), 4);
+
+    const DisplayModeEntry &first = catalog.GetEntry(0);
+    EXPECT_EQ(first.width, 640);
+    EXPECT_EQ(first.bpp, 8);
+    EXPECT_EQ(catalog.GetEntry(1).bpp, 16);
+    EXPECT_EQ(catalog.GetEntry(2).refreshRate, 85);
+    EXPECT_EQ(catalog.GetEntry(3).width, 1024);
+
+    EXPECT_EQ(catalog.FindMode(640, 480, 32), 4);
+    EXPECT_EQ(catalog.FindMode(640, 480, 16), 1);
+    // The first of two modes with the best rate, as the scan found it.
+    EXPECT_EQ(catalog.FindMode(1024, 768, 32), 3);
+    EXPECT_EQ(catalog.FindMode(1024, 768, 16), -1);
+    EXPECT_EQ(catalog.FindEntry(640, 480, 32), 2);
+    EXPECT_EQ(catalog.GetMode(3).refreshRate, 75);
+}
+
+TEST(DisplayModeCatalogTest, FiltersByDepthAndBounds) {
+    const DisplayMode modes[] = {
+        Mode(320, 200, 8, 70),
+        Mode(640, 480, 32, 60),
+        Mode(1600, 1200, 32, 60),
+        Mode(1920, 1080, 32, 60),
+        Mode(1920, 1080, 32, 144),
+        Mode(2560, 1440, 32, 60),
+    };
+
+    CDisplayModeCatalog catalog;
+    catalog.Build(modes, 6);
+
+    DisplayModeFilter filter;
+    filter.minBpp = 9;
+    std::vector<int> entries;
+    catalog.SelectEntries(filter, entries);
+    EXPECT_EQ(entries.size(), 4u);
+
+    filter.minWidth = 640;
+    filter.maxWidth = 1920;
+    catalog.SelectEntries(filter, entries);
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(catalog.GetEntry(entries[2]).width, 1920);
+
+    std::vector<int> all;
+    catalog.SelectModes(filter, all);
+    EXPECT_EQ(all, (std::vector<int>{1, 2, 3, 4}));
+
+    filter.maxHeight = 1080;
+    catalog.SelectModes(filter, all);
+    EXPECT_EQ(all, (std::vector<int>{1, 3, 4}));
+}
+
+TEST(DisplayModeCatalogTest, FiltersByAspectRatio) {
+    const DisplayMode modes[] = {
+        Mode(640, 480, 32, 60),
+        Mode(1280, 720, 32, 60),
+        Mode(1366, 768, 32, 60),
+        Mode(1280, 1024, 32, 60),
+        Mode(1920, 1080, 32, 60),
+    };
+
+    CDisplayModeCatalog catalog;
+    catalog.Build(modes, 5);
+
+    DisplayModeFilter filter;
+    filter.aspectWidth = 16;
+    filter.aspectHeight = 9;
+    std::vector<int> modesOut;
+    catalog.SelectModes(filter, modesOut);
+    EXPECT_EQ(modesOut, (std::vector<int>{1, 2, 4}));
+
+    filter.aspectWidth = 4;
+    filter.aspectHeight = 3;
+    catalog.SelectModes(filter, modesOut);
+    EXPECT_EQ(modesOut, (std::vector<int>{0}));
+
+    EXPECT_TRUE(DisplayModeFilter().Accepts(1, 1, 1));
+}
+
+TEST(DisplayModeCatalogTest, RebuildReplacesModes) {
+    const DisplayMode first[] = {Mode(640, 480, 32, 60)};
+    const DisplayMode second[] = {Mode(800, 600, 32, 60), Mode(800, 600, 32, 72)};
+
+    CDisplayModeCatalog catalog;
+    catalog.Build(first, 1);
+    catalog.Build(second, 2);
+    EXPECT_EQ(catalog.FindMode(640, 480, 32), -1);
+    EXPECT_EQ(catalog.FindMode(800, 600, 32), 1);
+
+    catalog.Clear();
+    EXPECT_EQ(catalog.GetEntryCount(), 0);
+}
+
+TEST(DisplayModeCatalogTest, MatchesScansOfRandomModes) {
+    const int depths[] = {16, 32};
+    const int rates[] = {60, 75, 120, 144};
+
+    std::mt19937 rng(41);
+    std::vector<DisplayMode> modes;
+    for (int i = 0; i < 60; ++i) {
+        for (int d = 0; d < 2; ++d) {
+            for (int r = 0; r < 4; ++r)
+                modes.push_back(Mode(320 + 8 * i, 200 + 4 * (i % 30), depths[d], rates[rng() % 4]));
+        }
+    }
+
+    CDisplayModeCatalog catalog;
+    catalog.Build(&modes[0], (int)modes.size());
+    for (int i = 0; i < 500; ++i) {
+        const DisplayMode &mode = modes[rng() % modes.size()];
+        const int height = mode.height + (i % 10 == 0 ? 1 : 0);
+        ASSERT_EQ(catalog.FindMode(mode.width, height, mode.bpp), ScanMode(modes, mode.width, height, mode.bpp)) << i;
+    }
+}
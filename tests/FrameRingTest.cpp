@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "FrameRing.h"
+
+TEST(FrameRingTest, WrapsAroundAndRejectsWhenFull) {
+    FrameRing<int, 4> ring;
+    int value = 0;
+
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i)
+            EXPECT_TRUE(ring.TryPush(round * 10 + i));
+        EXPECT_FALSE(ring.TryPush(99));
+        EXPECT_EQ(ring.GetSize(), 4);
+
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_TRUE(ring.TryPop(value));
+            EXPECT_EQ(value, round * 10 + i);
+        }
+        EXPECT_FALSE(ring.TryPop(value));
+    }
+}
+
+TEST(FrameRingTest, StressPreservesOrder) {
+    const int kCount = 200000;
+    FrameRing<int, 16> ring;
+
+    std::thread producer([&]() {
+        for (int i = 0; i < kCount; ++i) {
+            while (!ring.TryPush(i))
+                std::this_thread::yield();
+        }
+    });
+
+    int expected = 0;
+    int value = 0;
+    while (expected < kCount) {
+        if (ring.TryPop(value)) {
+            ASSERT_EQ(value, expected);
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+}
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include "FullscreenPolicy.h"
+
+namespace {
+    const int kDesktopWidth = 1920;
+    const int kDesktopHeight = 1080;
+
+    // Alt+Enter pressed repeatedly, with the window losing focus in between.
+    void ToggleAndSwitchAway(CFullscreenPolicy &policy, int width, int height, int cycles) {
+        for (int i = 0; i < cycles; ++i) {
+            policy.Enter(width, height, kDesktopWidth, kDesktopHeight);
+            policy.Deactivate();
+            policy.Activate();
+            policy.Leave();
+        }
+    }
+}
+
+TEST(FullscreenPolicyTest, OutOfRangeModesFallBackToAuto) {
+    CFullscreenPolicy policy;
+    EXPECT_EQ(policy.GetMode(), eFullscreenAuto);
+    policy.Configure(eFullscreenBorderless);
+    EXPECT_EQ(policy.GetMode(), eFullscreenBorderless);
+    policy.Configure(eFullscreenModeCount);
+    EXPECT_EQ(policy.GetMode(), eFullscreenAuto);
+    policy.Configure(-1);
+    EXPECT_EQ(policy.GetMode(), eFullscreenAuto);
+}
+
+TEST(FullscreenPolicyTest, AutoPicksBorderlessOnlyAtDesktopResolution) {
+    CFullscreenPolicy policy;
+    EXPECT_EQ(policy.Resolve(1920, 1080, kDesktopWidth, kDesktopHeight), eFullscreenStrategyBorderless);
+    EXPECT_EQ(policy.Resolve(1024, 768, kDesktopWidth, kDesktopHeight), eFullscreenStrategyExclusive);
+    EXPECT_EQ(policy.Resolve(1920, 1080, 0, 0), eFullscreenStrategyExclusive);
+
+    policy.Configure(eFullscreenExclusive);
+    EXPECT_EQ(policy.Resolve(1920, 1080, kDesktopWidth, kDesktopHeight), eFullscreenStrategyExclusive);
+
+    policy.Configure(eFullscreenBorderlessScaled);
+    EXPECT_EQ(policy.Resolve(1024, 768, kDesktopWidth, kDesktopHeight), eFullscreenStrategyScaled);
+    EXPECT_EQ(policy.Resolve(1920, 1080, kDesktopWidth, kDesktopHeight), eFullscreenStrategyBorderless);
+}
+
+TEST(FullscreenPolicyTest, ExclusiveChangesTheModeAndTakesTheDevice) {
+    CFullscreenPolicy policy;
+    policy.Configure(eFullscreenExclusive);
+
+    FullscreenAction action = policy.Enter(1024, 768, kDesktopWidth, kDesktopHeight);
+    EXPECT_TRUE(action.changeDisplayMode);
+    EXPECT_TRUE(action.popupWindow);
+    EXPECT_TRUE(action.enterExclusive);
+    EXPECT_FALSE(action.leaveExclusive);
+    EXPECT_FALSE(action.resizeRenderTarget);
+    EXPECT_TRUE(policy.IsFullscreen());
+    EXPECT_TRUE(policy.HasChangedDisplayMode());
+
+    // Entering again with the same request does nothing.
+    EXPECT_TRUE(policy.Enter(1024, 768, kDesktopWidth, kDesktopHeight).IsEmpty());
+
+    action = policy.Leave();
+    EXPECT_TRUE(action.leaveExclusive);
+    EXPECT_TRUE(action.restoreDisplayMode);
+    EXPECT_TRUE(action.restoreWindow);
+    EXPECT_FALSE(action.enterExclusive);
+    EXPECT_FALSE(policy.IsFullscreen());
+    EXPECT_FALSE(policy.HasChangedDisplayMode());
+    EXPECT_TRUE(policy.Leave().IsEmpty());
+
+    EXPECT_EQ(policy.GetDisplayModeChanges(), 2);
+    EXPECT_EQ(policy.GetDeviceResets(), 2);
+    EXPECT_EQ(policy.GetExpensiveTransitions(), 2);
+}
+
+TEST(FullscreenPolicyTest, BorderlessOnlyRestylesTheWindow) {
+    CFullscreenPolicy policy;
+    policy.Configure(eFullscreenBorderless);
+
+    FullscreenAction action = policy.Enter(1024, 768, kDesktopWidth, kDesktopHeight);
+    EXPECT_FALSE(action.IsExpensive());
+    EXPECT_TRUE(action.popupWindow);
+    EXPECT_TRUE(action.resizeRenderTarget);
+    EXPECT_EQ(action.renderX, 0);
+    EXPECT_EQ(action.renderWidth, kDesktopWidth);
+    EXPECT_EQ(action.renderHeight, kDesktopHeight);
+    EXPECT_EQ(policy.GetStrategy(), eFullscreenStrategyBorderless);
+
+    // Losing focus keeps the window where it is.
+    EXPECT_TRUE(policy.Deactivate().IsEmpty());
+    EXPECT_TRUE(policy.IsFullscreen());
+    EXPECT_TRUE(policy.Activate().IsEmpty());
+
+    action = policy.Leave();
+    EXPECT_FALSE(action.IsExpensive());
+    EXPECT_TRUE(action.restoreWindow);
+    EXPECT_TRUE(action.resizeRenderTarget);
+    EXPECT_EQ(action.renderWidth, 1024);
+    EXPECT_EQ(action.renderHeight, 768);
+    EXPECT_EQ(policy.GetExpensiveTransitions(), 0);
+}
+
+TEST(FullscreenPolicyTest, ScaledKeepsTheAspectRatioCentred) {
+    CFullscreenPolicy policy;
+    policy.Configure(eFullscreenBorderlessScaled);
+
+    FullscreenAction action = policy.Enter(1024, 768, kDesktopWidth, kDesktopHeight);
+    EXPECT_FALSE(action.IsExpensive());
+    EXPECT_EQ(policy.GetStrategy(), eFullscreenStrategyScaled);
+    EXPECT_EQ(action.renderWidth, 1440);
+    EXPECT_EQ(action.renderHeight, 1080);
+    EXPECT_EQ(action.renderX, 240);
+    EXPECT_EQ(action.renderY, 0);
+
+    // A wider mode than the desktop gets bars above and below.
+    action = policy.Resize(2560, 1080, kDesktopWidth, kDesktopHeight);
+    EXPECT_FALSE(action.IsExpensive());
+    EXPECT_FALSE(action.popupWindow);
+    EXPECT_TRUE(action.resizeRenderTarget);
+    EXPECT_EQ(action.renderWidth, 1920);
+    EXPECT_EQ(action.renderHeight, 810);
+    EXPECT_EQ(action.renderY, 135);
+}
+
+TEST(FullscreenPolicyTest, ExclusiveIsSuspendedWhileFocusIsAway) {
+    CFullscreenPolicy policy;
+    policy.Enter(1024, 768, kDesktopWidth, kDesktopHeight);
+    ASSERT_EQ(policy.GetStrategy(), eFullscreenStrategyExclusive);
+
+    FullscreenAction action = policy.Deactivate();
+    EXPECT_TRUE(action.leaveExclusive);
+    EXPECT_TRUE(action.restoreDisplayMode);
+    EXPECT_TRUE(action.restoreWindow);
+    EXPECT_TRUE(policy.IsSuspended());
+    EXPECT_FALSE(policy.IsFullscreen());
+
+    // Windows sends several deactivations; only the first one counts.
+    EXPECT_TRUE(policy.Deactivate().IsEmpty());
+
+    action = policy.Activate();
+    EXPECT_TRUE(action.changeDisplayMode);
+    EXPECT_TRUE(action.enterExclusive);
+    EXPECT_FALSE(policy.IsSuspended());
+    EXPECT_TRUE(policy.IsFullscreen());
+    EXPECT_TRUE(policy.Activate().IsEmpty());
+}
+
+TEST(FullscreenPolicyTest, LeavingWhileSuspendedDoesNothing) {
+    CFullscreenPolicy policy;
+    policy.Configure(eFullscreenExclusive);
+    policy.Enter(1024, 768, kDesktopWidth, kDesktopHeight);
+    policy.Deactivate();
+
+    EXPECT_TRUE(policy.Leave().IsEmpty());
+    EXPECT_EQ(policy.GetStrategy(), eFullscreenWindowed);
+    EXPECT_TRUE(policy.Activate().IsEmpty());
+    EXPECT_FALSE(policy.IsFullscreen());
+}
+
+TEST(FullscreenPolicyTest, ResizeMovesBetweenStrategies) {
+    CFullscreenPolicy policy;
+    policy.Enter(1920, 1080, kDesktopWidth, kDesktopHeight);
+    ASSERT_EQ(policy.GetStrategy(), eFullscreenStrategyBorderless);
+
+    FullscreenAction action = policy.Resize(1024, 768, kDesktopWidth, kDesktopHeight);
+    EXPECT_EQ(policy.GetStrategy(), eFullscreenStrategyExclusive);
+    EXPECT_TRUE(action.changeDisplayMode);
+    EXPECT_TRUE(action.popupWindow);
+    EXPECT_TRUE(action.enterExclusive);
+    EXPECT_FALSE(action.leaveExclusive);
+
+    // Another exclusive mode resets the device once more.
+    action = policy.Resize(800, 600, kDesktopWidth, kDesktopHeight);
+    EXPECT_TRUE(action.leaveExclusive);
+    EXPECT_TRUE(action.changeDisplayMode);
+    EXPECT_TRUE(action.enterExclusive);
+    EXPECT_FALSE(action.restoreDisplayMode);
+
+    action = policy.Resize(1920, 1080, kDesktopWidth, kDesktopHeight);
+    EXPECT_EQ(policy.GetStrategy(), eFullscreenStrategyBorderless);
+    EXPECT_TRUE(action.leaveExclusive);
+    EXPECT_TRUE(action.restoreDisplayMode);
+    EXPECT_TRUE(action.popupWindow);
+    EXPECT_TRUE(action.resizeRenderTarget);
+    EXPECT_FALSE(action.restoreWindow);
+    EXPECT_FALSE(policy.HasChangedDisplayMode());
+
+    EXPECT_TRUE(policy.Resize(1920, 1080, kDesktopWidth, kDesktopHeight).IsEmpty());
+}
+
+TEST(FullscreenPolicyTest, ResizeWhileWindowedIsUsedOnTheNextEnter) {
+    CFullscreenPolicy policy;
+    EXPECT_TRUE(policy.Resize(1920, 1080, kDesktopWidth, kDesktopHeight).IsEmpty());
+    EXPECT_FALSE(policy.IsFullscreen());
+
+    FullscreenAction action = policy.Enter(1920, 1080, kDesktopWidth, kDesktopHeight);
+    EXPECT_EQ(policy.GetStrategy(), eFullscreenStrategyBorderless);
+    EXPECT_TRUE(action.popupWindow);
+}
+
+TEST(FullscreenPolicyTest, FailedEnterRestoresTheWindow) {
+    CFullscreenPolicy policy;
+    policy.Enter(1024, 768, kDesktopWidth, kDesktopHeight);
+
+    FullscreenAction action = policy.EnterFailed();
+    EXPECT_TRUE(action.restoreDisplayMode);
+    EXPECT_TRUE(action.restoreWindow);
+    EXPECT_FALSE(action.leaveExclusive);
+    EXPECT_FALSE(policy.IsFullscreen());
+    EXPECT_FALSE(policy.HasChangedDisplayMode());
+    EXPECT_TRUE(policy.Leave().IsEmpty());
+}
+
+TEST(FullscreenPolicyTest, CountsExpensiveTransitionsPerStrategy) {
+    const int kCycles = 10;
+
+    CFullscreenPolicy exclusive;
+    exclusive.Configure(eFullscreenExclusive);
+    ToggleAndSwitchAway(exclusive, kDesktopWidth, kDesktopHeight, kCycles);
+    // Enter, lose focus, get it back and leave: four mode changes and four resets a cycle.
+    EXPECT_EQ(exclusive.GetExpensiveTransitions(), 4 * kCycles);
+    EXPECT_EQ(exclusive.GetDisplayModeChanges(), 4 * kCycles);
+    EXPECT_EQ(exclusive.GetDeviceResets(), 4 * kCycles);
+
+    CFullscreenPolicy automatic;
+    ToggleAndSwitchAway(automatic, kDesktopWidth, kDesktopHeight, kCycles);
+    EXPECT_EQ(automatic.GetExpensiveTransitions(), 0);
+
+    ToggleAndSwitchAway(automatic, 1024, 768, kCycles);
+    EXPECT_EQ(automatic.GetExpensiveTransitions(), 4 * kCycles);
+
+    CFullscreenPolicy borderless;
+    borderless.Configure(eFullscreenBorderless);
+    ToggleAndSwitchAway(borderless, 1024, 768, kCycles);
+    EXPECT_EQ(borderless.GetExpensiveTransitions(), 0);
+
+    CFullscreenPolicy scaled;
+    scaled.Configure(eFullscreenBorderlessScaled);
+    ToggleAndSwitchAway(scaled, 1024, 768, kCycles);
+    EXPECT_EQ(scaled.GetExpensiveTransitions(), 0);
+    EXPECT_EQ(scaled.GetDisplayModeChanges(), 0);
+    EXPECT_EQ(scaled.GetDeviceResets(), 0);
+}
@@ -85,6 +85,21 @@ TEST_F(GameConfigTest, DefaultConstructor) {
     EXPECT_EQ(config.screenMode, -1);
     EXPECT_FALSE(config.debug);
     EXPECT_FALSE(config.rookie);
+    EXPECT_FALSE(config.latencyProbe);
+    EXPECT_FALSE(config.pickCache);
+    EXPECT_EQ(config.backgroundMode, 0);
+    EXPECT_EQ(config.backgroundFps, 10);
+    EXPECT_FALSE(config.rebuildPluginCache);
+    EXPECT_FALSE(config.lazyBuildingBlocks);
+    EXPECT_FALSE(config.prefetchPlugins);
+    EXPECT_FALSE(config.preloadComposition);
+    EXPECT_FALSE(config.mapComposition);
+    EXPECT_EQ(config.reloadCacheSize, 0);
+    EXPECT_FALSE(config.prefetchAssets);
+    EXPECT_FALSE(config.cacheHotfixPlan);
+    EXPECT_FALSE(config.cacheRenderDrivers);
+    EXPECT_FALSE(config.loadDiagnostics);
+    EXPECT_EQ(config.fullscreenMode, 0);
 }
 
 // Test assignment operator
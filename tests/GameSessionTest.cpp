@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#include "GameSession.h"
+
+namespace {
+    size_t OffsetIn(const CGameInfo &info, const void *field) {
+        return (const char *)field - (const char *)&info;
+    }
+}
+
+TEST(GameSessionTest, KeepsTheInterfaceManagerLayout) {
+    CGameInfo info;
+    EXPECT_EQ(sizeof(CGameInfo), sizeof(GameInfoLayout));
+    EXPECT_EQ(OffsetIn(info, &info.next), offsetof(GameInfoLayout, next));
+    EXPECT_EQ(OffsetIn(info, info.gameName), offsetof(GameInfoLayout, gameName));
+    EXPECT_EQ(OffsetIn(info, info.levelName), offsetof(GameInfoLayout, levelName));
+    EXPECT_EQ(OffsetIn(info, info.fileName), offsetof(GameInfoLayout, fileName));
+    EXPECT_EQ(OffsetIn(info, info.path), offsetof(GameInfoLayout, path));
+    EXPECT_EQ(OffsetIn(info, info.regSubkey), offsetof(GameInfoLayout, regSubkey));
+    EXPECT_EQ(OffsetIn(info, &info.hkRoot), offsetof(GameInfoLayout, hkRoot));
+    EXPECT_EQ(OffsetIn(info, &info.gameScore), offsetof(GameInfoLayout, gameScore));
+    EXPECT_EQ(OffsetIn(info, &info.levelBonus), offsetof(GameInfoLayout, levelBonus));
+    EXPECT_EQ(OffsetIn(info, &info.levelReached), offsetof(GameInfoLayout, levelReached));
+}
+
+TEST(GameSessionTest, PoolResetsRecordsInPlace) {
+    CGameInfoPool pool;
+    CGameInfo *records[CGameInfoPool::CAPACITY];
+    for (int i = 0; i < CGameInfoPool::CAPACITY; ++i) {
+        records[i] = pool.Acquire();
+        ASSERT_NE(records[i], nullptr);
+        EXPECT_TRUE(pool.Owns(records[i]));
+    }
+    EXPECT_EQ(pool.Acquire(), nullptr);
+    EXPECT_EQ(pool.GetUsedCount(), (size_t)CGameInfoPool::CAPACITY);
+
+    CGameInfo *used = records[1];
+    strcpy(used->gameName, "Ballance");
+    used->levelScore = 1200;
+    used->levelReached = 12;
+    used->hkRoot = 0;
+    used->next = records[0];
+
+    EXPECT_TRUE(pool.Release(used));
+    EXPECT_FALSE(pool.Release(used));
+    CGameInfo *again = pool.Acquire();
+    EXPECT_EQ(again, used);
+    EXPECT_STREQ(again->gameName, "");
+    EXPECT_EQ(again->levelScore, 0);
+    EXPECT_EQ(again->levelReached, 0);
+    EXPECT_EQ(again->hkRoot, 0x80000001ul);
+    EXPECT_EQ(again->next, nullptr);
+    EXPECT_STREQ(again->regSubkey, "\"Software\\\\Ballance\\\\Settings\"");
+
+    CGameInfo outside;
+    EXPECT_FALSE(pool.Owns(&outside));
+    EXPECT_FALSE(pool.Release(&outside));
+    EXPECT_FALSE(pool.Release(NULL));
+}
+
+TEST(GameSessionTest, StringTableInternsOnce) {
+    CStringTable strings;
+    const std::string base = "base.cmo";
+    const char *first = strings.Intern(base.c_str());
+    ASSERT_NE(first, nullptr);
+    EXPECT_NE(first, base.c_str());
+    EXPECT_STREQ(first, "base.cmo");
+    EXPECT_EQ(strings.Intern(std::string("base.cmo").c_str()), first);
+    EXPECT_NE(strings.Intern("Level_01.nmo"), first);
+    EXPECT_EQ(strings.GetCount(), 2u);
+    EXPECT_EQ(strings.GetUsedSize(), sizeof("base.cmo") + sizeof("Level_01.nmo"));
+    EXPECT_EQ(strings.Intern(NULL), nullptr);
+
+    // Full by count.
+    char name[32];
+    for (int i = strings.GetCount(); i < CStringTable::MAX_STRINGS; ++i) {
+        snprintf(name, sizeof(name), "map%d.nmo", i);
+        EXPECT_NE(strings.Intern(name), nullptr);
+    }
+    EXPECT_EQ(strings.Intern("one more.nmo"), nullptr);
+    EXPECT_EQ(strings.Intern("base.cmo"), first);
+
+    // Full by size.
+    strings.Clear();
+    EXPECT_EQ(strings.GetCount(), 0u);
+    const std::string big(CStringTable::ARENA_SIZE - 10, 'x');
+    EXPECT_NE(strings.Intern(big.c_str()), nullptr);
+    EXPECT_EQ(strings.Intern("0123456789.nmo"), nullptr);
+    EXPECT_NE(strings.Intern("a.nmo"), nullptr);
+}
+
+TEST(GameSessionTest, RestartsReuseTheSameRecords) {
+    CGameSession session;
+    EXPECT_EQ(session.GetCurrent(), nullptr);
+    EXPECT_EQ(session.GetFileName(), nullptr);
+
+    CGameInfo *first = session.Start("base.cmo", ".");
+    ASSERT_NE(first, nullptr);
+    EXPECT_STREQ(first->fileName, "base.cmo");
+    EXPECT_STREQ(first->path, ".");
+    EXPECT_STREQ(session.GetFileName(), "base.cmo");
+    first->levelReached = 5;
+
+    // A restart passes the name of the session it replaces.
+    CGameInfo *second = session.Start(session.GetFileName(), ".");
+    ASSERT_NE(second, nullptr);
+    EXPECT_NE(second, first);
+    EXPECT_STREQ(second->fileName, "base.cmo");
+    EXPECT_EQ(second->levelReached, 0);
+    EXPECT_EQ(session.GetPool().GetUsedCount(), 1u);
+
+    const CGameInfo *seen[CGameInfoPool::CAPACITY] = {};
+    for (int i = 0; i < 1000; ++i) {
+        CGameInfo *info = session.Start(i % 2 ? "base.cmo" : "Level_01.nmo", ".");
+        ASSERT_TRUE(session.GetPool().Owns(info));
+        EXPECT_EQ(session.GetPool().GetUsedCount(), 1u);
+        for (int j = 0; j < CGameInfoPool::CAPACITY; ++j) {
+            if (!seen[j] || seen[j] == info) {
+                seen[j] = info;
+                break;
+            }
+        }
+    }
+    EXPECT_EQ(seen[2], nullptr);
+    EXPECT_EQ(session.GetStrings().GetCount(), 3u);
+
+    session.End();
+    EXPECT_EQ(session.GetCurrent(), nullptr);
+    EXPECT_EQ(session.GetFileName(), nullptr);
+    EXPECT_EQ(session.GetPool().GetUsedCount(), 0u);
+}
+
+TEST(GameSessionTest, CutsLongNamesShort) {
+    CGameSession session;
+    const std::string longName = std::string(300, 'm') + ".nmo";
+    CGameInfo *info = session.Start(longName.c_str(), NULL);
+    ASSERT_NE(info, nullptr);
+    EXPECT_EQ(strlen(info->fileName), sizeof(info->fileName) - 1);
+    EXPECT_EQ(std::string(info->fileName), longName.substr(0, sizeof(info->fileName) - 1));
+    EXPECT_STREQ(info->path, "");
+    EXPECT_EQ(std::string(session.GetFileName()), longName);
+}
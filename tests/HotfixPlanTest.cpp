@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+
+#include "HotfixPlan.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    // The behaviors and links of a loaded composition, by ID.
+    class FakeObjectLookup : public CHotfixObjectLookup {
+    public:
+        void AddBehavior(platform::uint32 id, const std::string &name, platform::uint32 parent) {
+            HotfixObjectInfo info;
+            info.kind = HOTFIX_SITE_BEHAVIOR;
+            info.owner = parent;
+            info.name = name;
+            m_Objects[id] = info;
+        }
+
+        void AddLink(platform::uint32 id, platform::uint32 from, platform::uint32 to) {
+            HotfixObjectInfo info;
+            info.kind = HOTFIX_SITE_LINK;
+            info.owner = from;
+            info.target = to;
+            m_Objects[id] = info;
+        }
+
+        void Remove(platform::uint32 id) { m_Objects.erase(id); }
+
+        bool Describe(platform::uint32 id, HotfixObjectInfo &info) override {
+            ++m_Calls;
+            std::map<platform::uint32, HotfixObjectInfo>::const_iterator it = m_Objects.find(id);
+            if (it == m_Objects.end())
+                return false;
+            info = it->second;
+            return true;
+        }
+
+        int Calls() const { return m_Calls; }
+
+    private:
+        std::map<platform::uint32, HotfixObjectInfo> m_Objects;
+        int m_Calls = 0;
+    };
+
+    HotfixPlanSite Behavior(const char *key, platform::uint32 id, const char *name, platform::uint32 parent) {
+        HotfixPlanSite site;
+        site.key = key;
+        site.kind = HOTFIX_SITE_BEHAVIOR;
+        site.id = id;
+        site.owner = parent;
+        site.name = name;
+        return site;
+    }
+
+    HotfixPlanSite Link(const char *key, platform::uint32 id, platform::uint32 from, platform::uint32 to) {
+        HotfixPlanSite site;
+        site.key = key;
+        site.kind = HOTFIX_SITE_LINK;
+        site.id = id;
+        site.owner = from;
+        site.target = to;
+        return site;
+    }
+
+    // A plan as the first load of a composition records it, and the objects it found.
+    void BuildPlan(CHotfixPlan &plan, FakeObjectLookup &lookup) {
+        plan.Reset(0xC0FFEE01, 0x12);
+        ASSERT_TRUE(plan.Record(Behavior("Default Level", 100, "Default Level", 0)));
+        ASSERT_TRUE(plan.Record(Behavior("Screen Modes", 120, "Screen Modes", 100)));
+        ASSERT_TRUE(plan.Record(Behavior("Screen Modes/TT List Driver", 121, "TT List Driver", 120)));
+        ASSERT_TRUE(plan.Record(Link("Screen Modes/Max Width -> Bpp Filter", 900, 130, 131)));
+
+        lookup.AddBehavior(100, "Default Level", 0);
+        lookup.AddBehavior(120, "Screen Modes", 100);
+        lookup.AddBehavior(121, "TT List Driver", 120);
+        lookup.AddLink(900, 130, 131);
+    }
+}
+
+TEST(HotfixPlanTest, RecordsAndFindsSitesByKey) {
+    CHotfixPlan plan;
+    FakeObjectLookup lookup;
+    BuildPlan(plan, lookup);
+
+    EXPECT_TRUE(plan.IsModified());
+    EXPECT_TRUE(plan.Matches(0xC0FFEE01, 0x12));
+    EXPECT_FALSE(plan.Matches(0xC0FFEE01, 0x02));
+    EXPECT_FALSE(plan.Matches(0xC0FFEE02, 0x12));
+    EXPECT_EQ(plan.GetSiteCount(), 4);
+
+    const HotfixPlanSite *site = plan.Find("Screen Modes/TT List Driver");
+    ASSERT_NE(site, nullptr);
+    EXPECT_EQ(site->id, 121u);
+    EXPECT_EQ(site->owner, 120u);
+    EXPECT_EQ(site->name, "TT List Driver");
+    EXPECT_EQ(plan.Find("Synch to Screen"), nullptr);
+    EXPECT_EQ(plan.Find(nullptr), nullptr);
+
+    // Recording a key again replaces its site.
+    ASSERT_TRUE(plan.Record(Behavior("Screen Modes", 125, "Screen Modes", 100)));
+    EXPECT_EQ(plan.GetSiteCount(), 4);
+    EXPECT_EQ(plan.Find("Screen Modes")->id, 125u);
+}
+
+TEST(HotfixPlanTest, RejectsSitesItCannotStore) {
+    CHotfixPlan plan;
+    plan.Reset(1, 0);
+    EXPECT_FALSE(plan.Record(Behavior("", 1, "A", 0)));
+    EXPECT_FALSE(plan.Record(Behavior("A", 0, "A", 0)));
+    EXPECT_FALSE(plan.Record(Behavior("A\tB", 1, "A", 0)));
+    EXPECT_FALSE(plan.Record(Behavior("A", 1, "Line\nBreak", 0)));
+
+    HotfixPlanSite unknown = Behavior("A", 1, "A", 0);
+    unknown.kind = 7;
+    EXPECT_FALSE(plan.Record(unknown));
+    EXPECT_EQ(plan.GetSiteCount(), 0);
+}
+
+TEST(HotfixPlanTest, RoundTripsThroughText) {
+    CHotfixPlan plan;
+    FakeObjectLookup lookup;
+    BuildPlan(plan, lookup);
+
+    std::string text;
+    plan.Write(text);
+
+    CHotfixPlan read;
+    ASSERT_TRUE(read.Read(text));
+    EXPECT_FALSE(read.IsModified());
+    EXPECT_TRUE(read.Matches(0xC0FFEE01, 0x12));
+    EXPECT_EQ(read.GetSiteCount(), 4);
+
+    const HotfixPlanSite *link = read.Find("Screen Modes/Max Width -> Bpp Filter");
+    ASSERT_NE(link, nullptr);
+    EXPECT_EQ(link->kind, HOTFIX_SITE_LINK);
+    EXPECT_EQ(link->id, 900u);
+    EXPECT_EQ(link->owner, 130u);
+    EXPECT_EQ(link->target, 131u);
+    EXPECT_TRUE(link->name.empty());
+
+    const HotfixPlanSite *behavior = read.Find("Default Level");
+    ASSERT_NE(behavior, nullptr);
+    EXPECT_EQ(behavior->kind, HOTFIX_SITE_BEHAVIOR);
+    EXPECT_EQ(behavior->name, "Default Level");
+
+    std::string again;
+    read.Write(again);
+    EXPECT_EQ(again, text);
+
+    // Windows line endings read the same.
+    std::string crlf;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n')
+            crlf += '\r';
+        crlf += text[i];
+    }
+    CHotfixPlan fromCrlf;
+    ASSERT_TRUE(fromCrlf.Read(crlf));
+    EXPECT_EQ(fromCrlf.GetSiteCount(), 4);
+}
+
+TEST(HotfixPlanTest, DiscardsMalformedText) {
+    CHotfixPlan plan;
+    FakeObjectLookup lookup;
+    BuildPlan(plan, lookup);
+    std::string text;
+    plan.Write(text);
+
+    const size_t header = text.find('\n');
+    const size_t fingerprint = text.find('\n', header + 1);
+
+    const std::string bad[] = {
+        "",
+        "BallancePlayerHotfixPlan 0\n00000001\t00000000\n",
+        text.substr(0, header + 1),
+        text.substr(0, header + 1) + "xyz\t00000000\n",
+        text.substr(0, fingerprint + 1) + "q\t00000001\t00000000\t00000000\tKey\tName\n",
+        text.substr(0, fingerprint + 1) + "b\t00000000\t00000000\t00000000\tKey\tName\n",
+        text.substr(0, fingerprint + 1) + "b\t00000001\t00000000\t00000000\t\tName\n",
+        text.substr(0, fingerprint + 1) + "b\t00000001\t00000000\t00000000\tKey\n",
+        text.substr(0, fingerprint + 1) + "l\t0000000g\t00000000\t00000000\tKey\t\n",
+        text.substr(0, fingerprint + 1) + "l\t123456789\t00000000\t00000000\tKey\t\n",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        CHotfixPlan read;
+        ASSERT_TRUE(read.Read(text));
+        EXPECT_FALSE(read.Read(bad[i])) << i;
+        EXPECT_EQ(read.GetSiteCount(), 0) << i;
+        EXPECT_FALSE(read.Matches(0xC0FFEE01, 0x12)) << i;
+    }
+}
+
+TEST(HotfixPlanTest, ValidatesAgainstTheLoadedObjects) {
+    CHotfixPlan plan;
+    FakeObjectLookup lookup;
+    BuildPlan(plan, lookup);
+
+    std::string stale;
+    EXPECT_TRUE(plan.Validate(lookup, &stale));
+    EXPECT_TRUE(stale.empty());
+    EXPECT_EQ(lookup.Calls(), 4);
+
+    // An empty plan has nothing to check.
+    CHotfixPlan empty;
+    EXPECT_TRUE(empty.Validate(lookup));
+}
+
+TEST(HotfixPlanTest, ValidationFailsOnAnyChangedSite) {
+    {
+        CHotfixPlan plan;
+        FakeObjectLookup lookup;
+        BuildPlan(plan, lookup);
+        lookup.Remove(121);
+        std::string stale;
+        EXPECT_FALSE(plan.Validate(lookup, &stale));
+        EXPECT_EQ(stale, "Screen Modes/TT List Driver");
+    }
+    {
+        // Another behavior got the ID.
+        CHotfixPlan plan;
+        FakeObjectLookup lookup;
+        BuildPlan(plan, lookup);
+        lookup.AddBehavior(121, "TT List ScreenModes", 120);
+        EXPECT_FALSE(plan.Validate(lookup));
+    }
+    {
+        // Same name, moved to another script.
+        CHotfixPlan plan;
+        FakeObjectLookup lookup;
+        BuildPlan(plan, lookup);
+        lookup.AddBehavior(121, "TT List Driver", 100);
+        EXPECT_FALSE(plan.Validate(lookup));
+    }
+    {
+        // The link now ends somewhere else.
+        CHotfixPlan plan;
+        FakeObjectLookup lookup;
+        BuildPlan(plan, lookup);
+        lookup.AddLink(900, 130, 132);
+        std::string stale;
+        EXPECT_FALSE(plan.Validate(lookup, &stale));
+        EXPECT_EQ(stale, "Screen Modes/Max Width -> Bpp Filter");
+    }
+    {
+        // The ID now names a behavior.
+        CHotfixPlan plan;
+        FakeObjectLookup lookup;
+        BuildPlan(plan, lookup);
+        lookup.AddBehavior(900, "", 130);
+        EXPECT_FALSE(plan.Validate(lookup));
+    }
+}
+
+TEST(HotfixPlanTest, SavesAndLoadsFiles) {
+    const fs::path path = fs::temp_directory_path() / "BallancePlayerHotfixPlanTest.txt";
+    fs::remove(path);
+
+    CHotfixPlan plan;
+    FakeObjectLookup lookup;
+    BuildPlan(plan, lookup);
+    ASSERT_TRUE(plan.Save(path.string().c_str()));
+
+    CHotfixPlan loaded;
+    ASSERT_TRUE(loaded.Load(path.string().c_str()));
+    EXPECT_TRUE(loaded.Matches(0xC0FFEE01, 0x12));
+    EXPECT_EQ(loaded.GetSiteCount(), 4);
+    EXPECT_TRUE(loaded.Validate(lookup));
+
+    fs::remove(path);
+    EXPECT_FALSE(loaded.Load(path.string().c_str()));
+    EXPECT_EQ(loaded.GetSiteCount(), 0);
+    EXPECT_FALSE(loaded.Load(nullptr));
+}
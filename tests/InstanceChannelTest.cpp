@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "InstanceChannel.h"
+
+namespace {
+    // Unique per process, so parallel test runs do not meet on the same channel.
+    std::string ChannelName(const char *test) {
+        return std::string("BallancePlayerTest-") + test + "-" + std::to_string(getpid());
+    }
+
+    InstanceMessage CommandLine(const std::string &payload) {
+        InstanceMessage message;
+        message.type = eInstanceCommandLine;
+        message.payload = payload;
+        return message;
+    }
+
+    std::string Frame(const InstanceMessage &message) {
+        std::string frame;
+        EXPECT_TRUE(CInstanceChannel::Encode(message, frame));
+        return frame;
+    }
+
+    struct Arrivals {
+        CSemaphore signal;
+    };
+
+    void OnMessages(void *userData) {
+        static_cast<Arrivals *>(userData)->signal.Release();
+    }
+
+    // Writes raw bytes to the channel the way a misbehaving sender would.
+    bool SendRaw(const std::string &name, const std::string &bytes) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        memcpy(address.sun_path + 1, name.data(), name.size());
+        const socklen_t length = (socklen_t)(offsetof(sockaddr_un, sun_path) + 1 + name.size());
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || connect(fd, (const sockaddr *)&address, length) != 0) {
+            if (fd >= 0)
+                close(fd);
+            return false;
+        }
+        bool ok = send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL) == (ssize_t)bytes.size();
+        close(fd);
+        return ok;
+    }
+}
+
+TEST(InstanceMessageReaderTest, RoundTripsAFrame) {
+    const std::string frame = Frame(CommandLine("--cmo=custom.nmo --fullscreen"));
+    ASSERT_EQ(frame.size(), (size_t)CInstanceMessageReader::HEADER_SIZE + 29);
+    EXPECT_EQ(frame.substr(0, 4), "BPIC");
+
+    CInstanceMessageReader reader;
+    ASSERT_TRUE(reader.Feed(frame.data(), frame.size()));
+    InstanceMessage message;
+    ASSERT_TRUE(reader.Next(message));
+    EXPECT_EQ(message.type, (platform::uint32)eInstanceCommandLine);
+    EXPECT_EQ(message.payload, "--cmo=custom.nmo --fullscreen");
+    EXPECT_FALSE(reader.Next(message));
+    EXPECT_EQ(reader.GetPendingSize(), 0u);
+}
+
+TEST(InstanceMessageReaderTest, ReassemblesSplitAndBatchedFrames) {
+    std::string stream = Frame(CommandLine("first")) + Frame(CommandLine("")) + Frame(CommandLine("third one"));
+
+    CInstanceMessageReader reader;
+    std::vector<std::string> payloads;
+    for (size_t i = 0; i < stream.size(); ++i) {
+        ASSERT_TRUE(reader.Feed(&stream[i], 1));
+        InstanceMessage message;
+        while (reader.Next(message))
+            payloads.push_back(message.payload);
+    }
+    ASSERT_EQ(payloads.size(), 3u);
+    EXPECT_EQ(payloads[0], "first");
+    EXPECT_EQ(payloads[1], "");
+    EXPECT_EQ(payloads[2], "third one");
+}
+
+TEST(InstanceMessageReaderTest, RejectsBadFraming) {
+    CInstanceMessageReader reader;
+    EXPECT_FALSE(reader.Feed("GET / HTTP/1.1\r\n", 16));
+    EXPECT_TRUE(reader.HasError());
+    InstanceMessage message;
+    EXPECT_FALSE(reader.Next(message));
+
+    // A length past the limit is refused before any of the payload arrives.
+    std::string frame = Frame(CommandLine("x"));
+    frame[8] = frame[9] = frame[10] = frame[11] = (char)0x7F;
+    reader.Reset();
+    EXPECT_FALSE(reader.Feed(frame.data(), CInstanceMessageReader::HEADER_SIZE));
+
+    // A bad frame after a good one is found when the good one has been taken.
+    std::string stream = Frame(CommandLine("good")) + std::string(12, 'z');
+    reader.Reset();
+    ASSERT_TRUE(reader.Feed(stream.data(), stream.size()));
+    ASSERT_TRUE(reader.Next(message));
+    EXPECT_FALSE(reader.Next(message));
+    EXPECT_TRUE(reader.HasError());
+
+    InstanceMessage huge = CommandLine(std::string(CInstanceMessageReader::MAX_PAYLOAD_SIZE + 1, 'a'));
+    std::string unused;
+    EXPECT_FALSE(CInstanceChannel::Encode(huge, unused));
+}
+
+TEST(InstanceChannelTest, OnlyOneInstanceListens) {
+    const std::string name = ChannelName("exclusive");
+    CInstanceChannel first;
+    ASSERT_TRUE(first.Listen(name.c_str()));
+    EXPECT_TRUE(first.IsListening());
+
+    CInstanceChannel second;
+    EXPECT_FALSE(second.Listen(name.c_str()));
+    EXPECT_FALSE(second.IsListening());
+
+    // The name is free again as soon as the first instance lets go.
+    first.Close();
+    EXPECT_FALSE(first.IsListening());
+    EXPECT_TRUE(second.Listen(name.c_str()));
+}
+
+TEST(InstanceChannelTest, ForwardsCommandLines) {
+    const std::string name = ChannelName("forward");
+    Arrivals arrivals;
+    CInstanceChannel channel;
+    channel.SetCallback(OnMessages, &arrivals);
+    ASSERT_TRUE(channel.Listen(name.c_str()));
+
+    ASSERT_TRUE(CInstanceChannel::Send(name.c_str(), CommandLine("--cmo=custom.nmo"), 2000));
+    ASSERT_TRUE(arrivals.signal.Acquire(5000));
+
+    std::vector<InstanceMessage> messages;
+    ASSERT_EQ(channel.TakeMessages(messages), 1u);
+    EXPECT_EQ(messages[0].type, (platform::uint32)eInstanceCommandLine);
+    EXPECT_EQ(messages[0].payload, "--cmo=custom.nmo");
+    EXPECT_EQ(channel.TakeMessages(messages), 0u);
+}
+
+TEST(InstanceChannelTest, ServesSendersOneAfterAnother) {
+    const std::string name = ChannelName("many");
+    Arrivals arrivals;
+    CInstanceChannel channel;
+    channel.SetCallback(OnMessages, &arrivals);
+    ASSERT_TRUE(channel.Listen(name.c_str()));
+
+    const int kSenders = 8;
+    std::vector<std::thread> senders;
+    for (int i = 0; i < kSenders; ++i) {
+        senders.emplace_back([&name, i]() {
+            EXPECT_TRUE(CInstanceChannel::Send(name.c_str(), CommandLine("--launch=" + std::to_string(i)), 5000));
+        });
+    }
+    for (size_t i = 0; i < senders.size(); ++i)
+        senders[i].join();
+
+    std::vector<InstanceMessage> messages;
+    while (messages.size() < (size_t)kSenders && arrivals.signal.Acquire(5000))
+        channel.TakeMessages(messages);
+    EXPECT_EQ(messages.size(), (size_t)kSenders);
+    EXPECT_EQ(channel.GetRejectedCount(), 0);
+}
+
+TEST(InstanceChannelTest, DropsSendersThatBreakTheFraming) {
+    const std::string name = ChannelName("garbage");
+    Arrivals arrivals;
+    CInstanceChannel channel;
+    channel.SetCallback(OnMessages, &arrivals);
+    ASSERT_TRUE(channel.Listen(name.c_str()));
+
+    // A good frame followed by garbage on the same connection is dropped whole.
+    ASSERT_TRUE(SendRaw(name, Frame(CommandLine("--fullscreen")) + std::string(16, '?')));
+    ASSERT_TRUE(CInstanceChannel::Send(name.c_str(), CommandLine("--cmo=after.nmo"), 2000));
+    ASSERT_TRUE(arrivals.signal.Acquire(5000));
+
+    std::vector<InstanceMessage> messages;
+    channel.TakeMessages(messages);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0].payload, "--cmo=after.nmo");
+    EXPECT_EQ(channel.GetRejectedCount(), 1);
+}
+
+TEST(InstanceChannelTest, SendGivesUpWithoutAListener) {
+    const std::string name = ChannelName("nobody");
+    EXPECT_FALSE(CInstanceChannel::Send(name.c_str(), CommandLine("--fullscreen"), 100));
+    EXPECT_FALSE(CInstanceChannel::Send("", CommandLine("--fullscreen"), 0));
+}
+
+TEST(InstanceChannelTest, SendWaitsForALateListener) {
+    const std::string name = ChannelName("late");
+    Arrivals arrivals;
+    CInstanceChannel channel;
+    channel.SetCallback(OnMessages, &arrivals);
+
+    // The second launch may race the first one's start-up.
+    std::thread sender([&name]() {
+        EXPECT_TRUE(CInstanceChannel::Send(name.c_str(), CommandLine("--cmo=race.nmo"), 5000));
+    });
+    platform::SleepMs(100);
+    ASSERT_TRUE(channel.Listen(name.c_str()));
+    sender.join();
+
+    ASSERT_TRUE(arrivals.signal.Acquire(5000));
+    std::vector<InstanceMessage> messages;
+    channel.TakeMessages(messages);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_EQ(messages[0].payload, "--cmo=race.nmo");
+}
+
+TEST(InstanceChannelTest, CloseStopsAStalledSender) {
+    const std::string name = ChannelName("stalled");
+    CInstanceChannel channel;
+    ASSERT_TRUE(channel.Listen(name.c_str()));
+
+    // A sender that connects and never writes must not hold up the shutdown.
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    memcpy(address.sun_path + 1, name.data(), name.size());
+    const socklen_t length = (socklen_t)(offsetof(sockaddr_un, sun_path) + 1 + name.size());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(connect(fd, (const sockaddr *)&address, length), 0);
+    platform::SleepMs(50);
+
+    const platform::uint64 start = platform::GetTimeMicros();
+    channel.Close();
+    EXPECT_LT(platform::GetTimeMicros() - start, (platform::uint64)CInstanceChannel::READ_TIMEOUT_MS * 1000);
+    close(fd);
+}
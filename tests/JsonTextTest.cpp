@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "JsonText.h"
+
+TEST(JsonTextTest, LeavesPlainTextAlone) {
+    std::string json;
+    jsontext::AppendString(json, "Maps/Level_01.NMO");
+    EXPECT_EQ(json, "\"Maps/Level_01.NMO\"");
+
+    jsontext::AppendString(json, "");
+    EXPECT_EQ(json, "\"Maps/Level_01.NMO\"\"\"");
+}
+
+TEST(JsonTextTest, EscapesQuotesAndControlBytes) {
+    std::string json;
+    jsontext::AppendString(json, std::string("a\"b\\c\nd\re\tf\x01g\x1f", 14));
+    EXPECT_EQ(json, "\"a\\\"b\\\\c\\nd\\re\\tf\\u0001g\\u001f\"");
+
+    std::string nul;
+    jsontext::AppendString(nul, std::string("a\0b", 3));
+    EXPECT_EQ(nul, "\"a\\u0000b\"");
+}
+
+TEST(JsonTextTest, EscapesHighBytes) {
+    std::string json;
+    jsontext::AppendString(json, "C:\\\xB5\xD8\xCD\xBC\\\xFF.nmo");
+    EXPECT_EQ(json, "\"C:\\\\\\u00b5\\u00d8\\u00cd\\u00bc\\\\\\u00ff.nmo\"");
+
+    char escape[jsontext::MAX_ESCAPE_LENGTH];
+    EXPECT_EQ(jsontext::Escape('a', escape), 0u);
+    EXPECT_EQ(jsontext::Escape(0x7f, escape), 0u);
+    ASSERT_EQ(jsontext::Escape(0x80, escape), 6u);
+    EXPECT_EQ(std::string(escape, 6), "\\u0080");
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "LatencyProbe.h"
+
+TEST(LatencyHistogramTest, EmptyHistogramReportsZero) {
+    CLatencyHistogram histogram;
+    EXPECT_EQ(histogram.GetCount(), 0u);
+    EXPECT_EQ(histogram.GetMin(), 0u);
+    EXPECT_EQ(histogram.GetMax(), 0u);
+    EXPECT_EQ(histogram.GetMean(), 0u);
+    EXPECT_EQ(histogram.GetPercentile(50), 0u);
+}
+
+TEST(LatencyHistogramTest, PercentilesFollowBuckets) {
+    CLatencyHistogram histogram;
+    for (int i = 1; i <= 100; ++i)
+        histogram.Add(i * 100); // 0.1 ms .. 10 ms
+
+    EXPECT_EQ(histogram.GetCount(), 100u);
+    EXPECT_EQ(histogram.GetMin(), 100u);
+    EXPECT_EQ(histogram.GetMax(), 10000u);
+    EXPECT_EQ(histogram.GetMean(), 5050u);
+
+    // p50 is the 50th sample (5000 us) which lives in the [5000, 5250) bucket.
+    EXPECT_EQ(histogram.GetPercentile(50), 5250u);
+    EXPECT_EQ(histogram.GetPercentile(100), 10000u);
+    EXPECT_LE(histogram.GetPercentile(95), 9750u);
+    EXPECT_GE(histogram.GetPercentile(95), 9500u);
+}
+
+TEST(LatencyHistogramTest, OutliersAreClampedToLastBucket) {
+    CLatencyHistogram histogram;
+    histogram.Add(5000000);
+    EXPECT_EQ(histogram.GetMax(), 5000000u);
+    EXPECT_EQ(histogram.GetPercentile(99), 100000u);
+}
+
+TEST(LatencyProbeTest, CorrelatesInputWithNextProcessAndRender) {
+    CLatencyProbe probe;
+
+    EXPECT_TRUE(probe.RecordInput(eLatencyKey, 1000));
+    EXPECT_TRUE(probe.RecordInput(eLatencyMouseButton, 1500));
+    EXPECT_EQ(probe.GetPendingCount(), 2u);
+
+    probe.OnProcess(3000);
+    EXPECT_EQ(probe.GetSampleCount(), 0u);
+
+    probe.OnRender(11000);
+    EXPECT_EQ(probe.GetPendingCount(), 0u);
+    EXPECT_EQ(probe.GetSampleCount(), 2u);
+
+    const CLatencyHistogram &keyProcess = probe.GetProcessLatency(eLatencyKey);
+    const CLatencyHistogram &keyRender = probe.GetRenderLatency(eLatencyKey);
+    EXPECT_EQ(keyProcess.GetMax(), 2000u);
+    EXPECT_EQ(keyRender.GetMax(), 10000u);
+
+    const CLatencyHistogram &mouseRender = probe.GetRenderLatency(eLatencyMouseButton);
+    EXPECT_EQ(mouseRender.GetCount(), 1u);
+    EXPECT_EQ(mouseRender.GetMax(), 9500u);
+}
+
+TEST(LatencyProbeTest, RenderWithoutProcessRecordsNothing) {
+    CLatencyProbe probe;
+    probe.RecordInput(eLatencyKey, 1000);
+    probe.OnRender(2000);
+    EXPECT_EQ(probe.GetSampleCount(), 0u);
+
+    probe.OnProcess(3000);
+    probe.OnRender(4000);
+    EXPECT_EQ(probe.GetSampleCount(), 1u);
+    EXPECT_EQ(probe.GetRenderLatency(eLatencyKey).GetMax(), 3000u);
+}
+
+TEST(LatencyProbeTest, EventsArrivingBetweenFramesJoinTheNextFrame) {
+    CLatencyProbe probe;
+
+    probe.RecordInput(eLatencyKey, 0);
+    probe.OnProcess(1000);
+    probe.RecordInput(eLatencyKey, 1500);
+    probe.OnRender(2000);
+    EXPECT_EQ(probe.GetSampleCount(), 1u);
+
+    probe.OnProcess(3000);
+    probe.OnRender(4000);
+    EXPECT_EQ(probe.GetSampleCount(), 2u);
+    EXPECT_EQ(probe.GetRenderLatency(eLatencyKey).GetMax(), 2500u);
+}
+
+TEST(LatencyProbeTest, DropsWhenRingOverflows) {
+    CLatencyProbe probe;
+    for (int i = 0; i < CLatencyProbe::INPUT_CAPACITY; ++i)
+        EXPECT_TRUE(probe.RecordInput(eLatencyRawInput, i));
+    EXPECT_FALSE(probe.RecordInput(eLatencyRawInput, 999));
+    EXPECT_EQ(probe.GetDroppedCount(), 1u);
+
+    probe.OnProcess(1000);
+    probe.OnRender(2000);
+    EXPECT_EQ(probe.GetRenderLatency(eLatencyRawInput).GetCount(), (unsigned long)CLatencyProbe::INPUT_CAPACITY);
+
+    probe.Reset();
+    EXPECT_EQ(probe.GetSampleCount(), 0u);
+    EXPECT_EQ(probe.GetDroppedCount(), 0u);
+}
+
+TEST(LatencyProbeTest, RejectsUnknownKinds) {
+    CLatencyProbe probe;
+    EXPECT_FALSE(probe.RecordInput(eLatencyEventKindCount, 0));
+    EXPECT_EQ(probe.GetPendingCount(), 0u);
+}
+
+TEST(LatencyProbeTest, FormatsSummary) {
+    CLatencyProbe probe;
+    char buffer[256];
+    EXPECT_FALSE(probe.FormatSummary(eLatencyKey, buffer, sizeof(buffer)));
+
+    for (int frame = 0; frame < 10; ++frame) {
+        platform::uint64 base = frame * 16000;
+        probe.RecordInput(eLatencyKey, base);
+        probe.OnProcess(base + 4000);
+        probe.OnRender(base + 12000);
+    }
+
+    ASSERT_TRUE(probe.FormatSummary(eLatencyKey, buffer, sizeof(buffer)));
+    std::string summary(buffer);
+    EXPECT_NE(summary.find("Key latency (n=10)"), std::string::npos);
+    EXPECT_NE(summary.find("max 12.00ms"), std::string::npos);
+}
+
+TEST(LatencyProbeTest, SyntheticStreamMatchesExpectedDistribution) {
+    // 60 Hz frames, inputs spread uniformly inside each frame.
+    CLatencyProbe probe;
+    const platform::uint64 frameUs = 16667;
+    for (int frame = 0; frame < 600; ++frame) {
+        platform::uint64 start = frame * frameUs;
+        probe.RecordInput(eLatencyMouseButton, start + (frame % 16) * 1000);
+        probe.OnProcess(start + frameUs);
+        probe.OnRender(start + frameUs + 5000);
+    }
+
+    const CLatencyHistogram &render = probe.GetRenderLatency(eLatencyMouseButton);
+    EXPECT_EQ(render.GetCount(), 600u);
+    EXPECT_GE(render.GetMin(), 5000u);
+    EXPECT_LE(render.GetMax(), frameUs + 5000);
+    EXPECT_LT(render.GetPercentile(50), render.GetPercentile(99));
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "LoadDiagnostics.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    platform::uint64 g_Now = 0;
+
+    platform::uint64 FakeClock() {
+        return g_Now;
+    }
+
+    class MemorySink : public CDiagnosticsSink {
+    public:
+        MemorySink() : m_Writes(0), m_Fail(false) {}
+
+        virtual bool Write(const char *data, size_t size) {
+            ++m_Writes;
+            m_Text.append(data, size);
+            return !m_Fail;
+        }
+
+        std::string m_Text;
+        int m_Writes;
+        bool m_Fail;
+    };
+
+    std::vector<std::string> Lines(const std::string &text) {
+        std::vector<std::string> lines;
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos)
+                end = text.size();
+            lines.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+        return lines;
+    }
+}
+
+TEST(LoadDiagnosticsTest, WritesALoadAsNdjson) {
+    MemorySink sink;
+    CLoadDiagnostics diagnostics;
+    diagnostics.SetClock(FakeClock);
+    diagnostics.SetSink(&sink);
+
+    g_Now = 5000;
+    diagnostics.BeginLoad("base.cmo");
+    g_Now = 5010;
+    diagnostics.PathResolved("base.cmo", "D:\\Ballance\\base.cmo");
+    g_Now = 6500;
+    diagnostics.Phase("open", 1480, 5242880);
+    const platform::uint32 guids[] = {0x7a3f1c20, 0x4d2e0b91, 0x1, 0x0};
+    diagnostics.MissingGuids(guids, 2);
+    g_Now = 9000;
+    diagnostics.Hotfix("screen_modes", true);
+    diagnostics.Hotfix("skip_opening", false);
+    diagnostics.Error("Failed to load file");
+    EXPECT_EQ(sink.m_Writes, 0);
+    g_Now = 9100;
+    ASSERT_TRUE(diagnostics.EndLoad(false));
+
+    const std::string expected =
+        "{\"load\":1,\"t\":0,\"event\":\"begin\",\"file\":\"base.cmo\"}\n"
+        "{\"load\":1,\"t\":10,\"event\":\"path\",\"requested\":\"base.cmo\",\"resolved\":\"D:\\\\Ballance\\\\base.cmo\"}\n"
+        "{\"load\":1,\"t\":1500,\"event\":\"phase\",\"phase\":\"open\",\"us\":1480,\"bytes\":5242880}\n"
+        "{\"load\":1,\"t\":1500,\"event\":\"missing_guids\",\"count\":2,\"guids\":[\"7a3f1c20,4d2e0b91\",\"1,0\"]}\n"
+        "{\"load\":1,\"t\":4000,\"event\":\"hotfix\",\"step\":\"screen_modes\",\"ok\":true}\n"
+        "{\"load\":1,\"t\":4000,\"event\":\"hotfix\",\"step\":\"skip_opening\",\"ok\":false}\n"
+        "{\"load\":1,\"t\":4000,\"event\":\"error\",\"message\":\"Failed to load file\"}\n"
+        "{\"load\":1,\"t\":4100,\"event\":\"end\",\"ok\":false,\"us\":4100,\"events\":8,\"dropped\":0}\n";
+    EXPECT_EQ(sink.m_Text, expected);
+    EXPECT_EQ(sink.m_Writes, 1);
+    EXPECT_EQ(std::string(diagnostics.GetData(), diagnostics.GetSize()), expected);
+    EXPECT_EQ(diagnostics.GetEventCount(), 8u);
+    EXPECT_FALSE(diagnostics.IsLoading());
+}
+
+TEST(LoadDiagnosticsTest, EscapesStrings) {
+    MemorySink sink;
+    CLoadDiagnostics diagnostics;
+    diagnostics.SetClock(FakeClock);
+    diagnostics.SetSink(&sink);
+    g_Now = 0;
+
+    diagnostics.BeginLoad(NULL);
+    diagnostics.PathResolved("Custom \"Map\"\t2.nmo", NULL);
+    diagnostics.Error("line one\nline two\r\x01\x1f end \xC3\xA9");
+    diagnostics.EndLoad(true);
+
+    const std::vector<std::string> lines = Lines(sink.m_Text);
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0], "{\"load\":1,\"t\":0,\"event\":\"begin\",\"file\":null}");
+    EXPECT_EQ(lines[1], "{\"load\":1,\"t\":0,\"event\":\"path\",\"requested\":\"Custom \\\"Map\\\"\\t2.nmo\",\"resolved\":null}");
+    EXPECT_EQ(lines[2], "{\"load\":1,\"t\":0,\"event\":\"error\",\"message\":\"line one\\nline two\\r\\u0001\\u001f end \\u00c3\\u00a9\"}");
+}
+
+TEST(LoadDiagnosticsTest, DropsEventsBeyondTheBufferButNeverTheEnd) {
+    MemorySink sink;
+    CLoadDiagnostics diagnostics(CLoadDiagnostics::MIN_CAPACITY);
+    diagnostics.SetClock(FakeClock);
+    diagnostics.SetSink(&sink);
+    g_Now = 0;
+
+    diagnostics.BeginLoad("big.nmo");
+    for (int i = 0; i < 200; ++i)
+        diagnostics.Hotfix("a_step_with_a_long_name", i % 2 == 0);
+    // Too long for what is left, but a shorter one after it still fits.
+    diagnostics.Error(std::string(2000, 'x').c_str());
+    ASSERT_TRUE(diagnostics.EndLoad(true));
+
+    EXPECT_LE(sink.m_Text.size(), diagnostics.GetCapacity());
+    EXPECT_GT(diagnostics.GetDroppedCount(), 100u);
+    const std::vector<std::string> lines = Lines(sink.m_Text);
+    ASSERT_GE(lines.size(), 2u);
+    EXPECT_EQ(lines.size(), diagnostics.GetEventCount());
+    for (size_t i = 0; i < lines.size(); ++i) {
+        EXPECT_EQ(lines[i].front(), '{');
+        EXPECT_EQ(lines[i].back(), '}');
+    }
+    const std::string end = lines.back();
+    EXPECT_NE(end.find("\"event\":\"end\""), std::string::npos);
+    EXPECT_NE(end.find("\"dropped\":" + std::to_string(diagnostics.GetDroppedCount())), std::string::npos);
+
+    // The next load starts with an empty buffer.
+    sink.m_Text.clear();
+    diagnostics.BeginLoad("small.nmo");
+    diagnostics.Hotfix("a_step_with_a_long_name", true);
+    diagnostics.EndLoad(true);
+    EXPECT_EQ(diagnostics.GetDroppedCount(), 0u);
+    EXPECT_EQ(Lines(sink.m_Text).size(), 3u);
+    EXPECT_NE(sink.m_Text.find("\"load\":2"), std::string::npos);
+}
+
+TEST(LoadDiagnosticsTest, WritesOncePerLoad) {
+    MemorySink sink;
+    CLoadDiagnostics diagnostics;
+    diagnostics.SetSink(&sink);
+
+    // Outside of a load there is nothing to attach events to.
+    diagnostics.Phase("open", 1, 1);
+    diagnostics.Error("ignored");
+    EXPECT_TRUE(diagnostics.EndLoad(true));
+    EXPECT_EQ(sink.m_Writes, 0);
+    EXPECT_EQ(diagnostics.GetSize(), 0u);
+
+    // A load that never ended is dropped when the next one begins.
+    diagnostics.BeginLoad("first.nmo");
+    diagnostics.Phase("open", 1, 1);
+    diagnostics.BeginLoad("second.nmo");
+    diagnostics.Phase("load_data", 2, 2);
+    EXPECT_TRUE(diagnostics.EndLoad(true));
+    EXPECT_EQ(sink.m_Writes, 1);
+    EXPECT_EQ(sink.m_Text.find("first.nmo"), std::string::npos);
+    EXPECT_EQ(Lines(sink.m_Text).size(), 3u);
+    EXPECT_EQ(diagnostics.GetLoadCount(), 2u);
+
+    EXPECT_TRUE(diagnostics.EndLoad(true));
+    EXPECT_EQ(sink.m_Writes, 1);
+
+    sink.m_Fail = true;
+    diagnostics.BeginLoad("third.nmo");
+    EXPECT_FALSE(diagnostics.EndLoad(true));
+
+    // Without a sink the load stays readable in the buffer.
+    CLoadDiagnostics unsunk;
+    unsunk.BeginLoad("fourth.nmo");
+    EXPECT_TRUE(unsunk.EndLoad(true));
+    EXPECT_EQ(Lines(std::string(unsunk.GetData(), unsunk.GetSize())).size(), 2u);
+}
+
+TEST(LoadDiagnosticsTest, FileSinkAppends) {
+    const fs::path path = fs::temp_directory_path() / "ballance_load_diagnostics_test.ndjson";
+    fs::remove(path);
+
+    CDiagnosticsFileSink sink(path.string().c_str());
+    CLoadDiagnostics diagnostics;
+    diagnostics.SetSink(&sink);
+    diagnostics.BeginLoad("a.nmo");
+    ASSERT_TRUE(diagnostics.EndLoad(true));
+    diagnostics.BeginLoad("b.nmo");
+    diagnostics.Phase("open", 10, 20);
+    ASSERT_TRUE(diagnostics.EndLoad(true));
+
+    std::ifstream in(path, std::ios::binary);
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const std::vector<std::string> lines = Lines(text);
+    ASSERT_EQ(lines.size(), 5u);
+    EXPECT_NE(lines[0].find("a.nmo"), std::string::npos);
+    EXPECT_NE(lines[2].find("b.nmo"), std::string::npos);
+    EXPECT_NE(lines[4].find("\"load\":2"), std::string::npos);
+    in.close();
+    fs::remove(path);
+
+    CDiagnosticsFileSink nowhere((fs::temp_directory_path() / "missing_dir" / "x.ndjson").string().c_str());
+    EXPECT_FALSE(nowhere.Write("x", 1));
+}
+
+TEST(LoadDiagnosticsTest, FileSinkRotatesPastTheMaximumSize) {
+    const fs::path path = fs::temp_directory_path() / "ballance_load_diagnostics_rotate.ndjson";
+    const fs::path previous = path.string() + ".1";
+    fs::remove(path);
+    fs::remove(previous);
+
+    CDiagnosticsFileSink sink(path.string().c_str(), 16);
+    const std::string line = "0123456789\n";
+    ASSERT_TRUE(sink.Write(line.data(), line.size()));
+    EXPECT_EQ(fs::file_size(path), line.size());
+    ASSERT_TRUE(sink.Write(line.data(), line.size()));
+    EXPECT_EQ(fs::file_size(path), line.size());
+    EXPECT_EQ(fs::file_size(previous), line.size());
+
+    // Only one older file is kept.
+    const std::string longer = "0123456789abcdef\n";
+    ASSERT_TRUE(sink.Write(longer.data(), longer.size()));
+    EXPECT_EQ(fs::file_size(path), longer.size());
+    EXPECT_EQ(fs::file_size(previous), line.size());
+    EXPECT_FALSE(fs::exists(path.string() + ".2"));
+
+    // Without a maximum the file keeps growing.
+    sink.SetMaxSize(0);
+    ASSERT_TRUE(sink.Write(line.data(), line.size()));
+    EXPECT_EQ(fs::file_size(path), longer.size() + line.size());
+
+    fs::remove(path);
+    fs::remove(previous);
+}
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "LoadProgress.h"
+
+namespace {
+    LoadProgressSnapshot Snapshot(const CLoadProgress &progress) {
+        LoadProgressSnapshot snapshot = {eLoadStarting, -1, -1, -1};
+        EXPECT_TRUE(progress.Read(snapshot));
+        return snapshot;
+    }
+}
+
+TEST(LoadProgressTest, StartsEmpty) {
+    CLoadProgress progress;
+    LoadProgressSnapshot snapshot = Snapshot(progress);
+    EXPECT_EQ(snapshot.stage, eLoadStarting);
+    EXPECT_EQ(snapshot.done, 0);
+    EXPECT_EQ(snapshot.total, 0);
+    EXPECT_EQ(CLoadProgress::GetPermille(snapshot), 0);
+    EXPECT_FALSE(progress.IsFinished());
+}
+
+TEST(LoadProgressTest, StagesOnlyMoveForward) {
+    CLoadProgress progress;
+    progress.SetStage(eLoadPlugins, 10);
+    progress.Advance(3);
+
+    progress.SetStage(eLoadEngine);
+    EXPECT_EQ(progress.GetStage(), eLoadPlugins);
+    EXPECT_EQ(Snapshot(progress).done, 3);
+
+    // Repeating the stage keeps what is done and only updates the total.
+    progress.SetStage(eLoadPlugins, 12);
+    LoadProgressSnapshot snapshot = Snapshot(progress);
+    EXPECT_EQ(snapshot.done, 3);
+    EXPECT_EQ(snapshot.total, 12);
+
+    // A new stage starts over.
+    progress.SetStage(eLoadObjects, 400);
+    snapshot = Snapshot(progress);
+    EXPECT_EQ(snapshot.stage, eLoadObjects);
+    EXPECT_EQ(snapshot.done, 0);
+    EXPECT_EQ(snapshot.total, 400);
+}
+
+TEST(LoadProgressTest, PermilleWeighsTheStages) {
+    LoadProgressSnapshot snapshot = {eLoadEngine, 0, 0, 0};
+    EXPECT_EQ(CLoadProgress::GetPermille(snapshot), 0);
+
+    snapshot.stage = eLoadPlugins;
+    snapshot.done = 15;
+    snapshot.total = 30;
+    EXPECT_EQ(CLoadProgress::GetPermille(snapshot), 100 + 150);
+
+    snapshot.stage = eLoadComposition;
+    snapshot.done = 0;
+    snapshot.total = 0;
+    EXPECT_EQ(CLoadProgress::GetPermille(snapshot), 400);
+
+    // Overshooting the total counts as the whole stage.
+    snapshot.stage = eLoadObjects;
+    snapshot.done = 900;
+    snapshot.total = 300;
+    EXPECT_EQ(CLoadProgress::GetPermille(snapshot), 950);
+
+    snapshot.stage = eLoadFirstFrame;
+    snapshot.done = 0;
+    snapshot.total = 0;
+    EXPECT_EQ(CLoadProgress::GetPermille(snapshot), 950);
+
+    snapshot.stage = eLoadDone;
+    EXPECT_EQ(CLoadProgress::GetPermille(snapshot), 1000);
+}
+
+TEST(LoadProgressTest, FinishAndFailAreFinal) {
+    CLoadProgress finished;
+    finished.SetStage(eLoadFirstFrame);
+    finished.Finish();
+    EXPECT_TRUE(finished.IsFinished());
+    finished.Fail();
+    finished.SetStage(eLoadObjects, 10);
+    finished.Advance();
+    EXPECT_EQ(finished.GetStage(), eLoadDone);
+
+    CLoadProgress failed;
+    failed.SetStage(eLoadComposition, 1000);
+    failed.Fail();
+    EXPECT_TRUE(failed.IsFinished());
+    failed.Finish();
+    failed.SetStage(eLoadFailed);
+    EXPECT_EQ(failed.GetStage(), eLoadFailed);
+}
+
+TEST(LoadProgressTest, SequenceChangesWithEveryUpdate) {
+    CLoadProgress progress;
+    const long start = progress.GetSequence();
+    progress.SetStage(eLoadEngine);
+    const long afterStage = progress.GetSequence();
+    EXPECT_NE(afterStage, start);
+    EXPECT_EQ(afterStage % 2, 0);
+
+    progress.Finish();
+    const long afterFinish = progress.GetSequence();
+    EXPECT_NE(afterFinish, afterStage);
+
+    // Ignored updates leave nothing for the reader to redraw.
+    progress.Advance();
+    EXPECT_EQ(progress.GetSequence(), afterFinish);
+}
+
+TEST(LoadProgressTest, StageNames) {
+    EXPECT_STREQ(CLoadProgress::GetStageName(eLoadPlugins), "Loading plugins");
+    EXPECT_STREQ(CLoadProgress::GetStageName(eLoadFailed), "Failed");
+    EXPECT_STREQ(CLoadProgress::GetStageName(eLoadStageCount), "");
+}
+
+TEST(LoadProgressTest, ReaderNeverSeesATornUpdate) {
+    CLoadProgress progress;
+
+    std::thread reader([&progress]() {
+        int lastPermille = 0;
+        while (!progress.IsFinished()) {
+            LoadProgressSnapshot snapshot;
+            if (!progress.Read(snapshot))
+                continue;
+            if (snapshot.stage != eLoadDone) {
+                ASSERT_LE(snapshot.done, snapshot.total);
+                ASSERT_EQ(snapshot.total, snapshot.stage * 1000);
+            }
+            const int permille = CLoadProgress::GetPermille(snapshot);
+            ASSERT_GE(permille, lastPermille);
+            lastPermille = permille;
+        }
+    });
+
+    int stage;
+    for (stage = eLoadEngine; stage <= eLoadFirstFrame; ++stage) {
+        // Each stage has its own total, so a read mixing two updates shows up
+        // as a wrong total or as progress going backwards.
+        progress.SetStage((LoadStage)stage, stage * 1000);
+        long i;
+        for (i = 1; i <= stage * 1000; ++i)
+            progress.SetDone(i);
+    }
+    progress.Finish();
+    reader.join();
+}
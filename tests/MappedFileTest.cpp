@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    fs::path WriteFile(const char *name, const std::string &contents) {
+        const fs::path path = fs::temp_directory_path() / name;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), (std::streamsize)contents.size());
+        return path;
+    }
+
+    std::string ReadFile(const fs::path &path) {
+        std::ifstream in(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+}
+
+TEST(MappedFileTest, MapsTheWholeFile) {
+    std::string contents(3 * 4096 + 17, '\0');
+    for (size_t i = 0; i < contents.size(); ++i)
+        contents[i] = (char)(i * 31);
+    const fs::path path = WriteFile("ballance_mapped_file_test.cmo", contents);
+
+    CMappedFile file;
+    EXPECT_FALSE(file.IsOpen());
+    ASSERT_TRUE(file.Open(path.string().c_str()));
+    EXPECT_TRUE(file.IsOpen());
+    ASSERT_EQ(file.GetSize(), contents.size());
+    EXPECT_EQ(std::memcmp(file.GetData(), contents.data(), contents.size()), 0);
+
+    file.Close();
+    EXPECT_FALSE(file.IsOpen());
+    EXPECT_EQ(file.GetData(), nullptr);
+    EXPECT_EQ(file.GetSize(), 0u);
+    file.Close();
+
+    fs::remove(path);
+}
+
+TEST(MappedFileTest, CopyOnWriteLeavesTheFileUntouched) {
+    static const char raw[] = "Nemo Fi\0header and chunks";
+    const std::string contents(raw, sizeof(raw) - 1);
+    const fs::path path = WriteFile("ballance_mapped_file_cow.cmo", contents);
+
+    CMappedFile file;
+    ASSERT_TRUE(file.Open(path.string().c_str(), CMappedFile::eMapCopyOnWrite));
+    char *data = (char *)file.GetData();
+    data[0] = 'X';
+    data[file.GetSize() - 1] = 'Y';
+    EXPECT_EQ(data[0], 'X');
+
+    // Another view of the same file does not see the private writes.
+    CMappedFile other;
+    ASSERT_TRUE(other.Open(path.string().c_str()));
+    EXPECT_EQ(((const char *)other.GetData())[0], 'N');
+    other.Close();
+
+    file.Close();
+    EXPECT_EQ(ReadFile(path), contents);
+    fs::remove(path);
+}
+
+TEST(MappedFileTest, ReopeningReplacesThePreviousView) {
+    const fs::path first = WriteFile("ballance_mapped_file_a.nmo", "first");
+    const fs::path second = WriteFile("ballance_mapped_file_b.nmo", "second file");
+
+    CMappedFile file;
+    ASSERT_TRUE(file.Open(first.string().c_str()));
+    ASSERT_TRUE(file.Open(second.string().c_str()));
+    ASSERT_EQ(file.GetSize(), 11u);
+    EXPECT_EQ(std::memcmp(file.GetData(), "second file", 11), 0);
+
+    // A failed open leaves nothing mapped.
+    EXPECT_FALSE(file.Open((fs::temp_directory_path() / "ballance_mapped_file_missing.nmo").string().c_str()));
+    EXPECT_FALSE(file.IsOpen());
+
+    fs::remove(first);
+    fs::remove(second);
+}
+
+TEST(MappedFileTest, ViewOutlivesTheFileName) {
+    const fs::path path = WriteFile("ballance_mapped_file_unlinked.cmo", "still here");
+
+    CMappedFile file;
+    ASSERT_TRUE(file.Open(path.string().c_str()));
+#ifndef _WIN32
+    // The mapping holds its own reference, so the data survives the directory entry.
+    fs::remove(path);
+#endif
+    EXPECT_EQ(std::memcmp(file.GetData(), "still here", 10), 0);
+    file.Close();
+    fs::remove(path);
+}
+
+TEST(MappedFileTest, RejectsEmptyMissingAndDirectoryPaths) {
+    const fs::path empty = WriteFile("ballance_mapped_file_empty.cmo", "");
+
+    CMappedFile file;
+    EXPECT_FALSE(file.Open(empty.string().c_str()));
+    EXPECT_FALSE(file.Open(fs::temp_directory_path().string().c_str()));
+    EXPECT_FALSE(file.Open(""));
+    EXPECT_FALSE(file.Open(nullptr));
+    EXPECT_FALSE(file.IsOpen());
+
+    fs::remove(empty);
+}
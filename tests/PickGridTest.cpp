@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "PickGrid.h"
+
+namespace {
+    PickRect Rect(float left, float top, float right, float bottom) {
+        PickRect rect = {left, top, right, bottom};
+        return rect;
+    }
+}
+
+TEST(PickGridTest, EmptyGridHasNoHits) {
+    CPickGrid grid;
+    grid.Reset(640, 480);
+    PickHit hits[4];
+    EXPECT_EQ(grid.Query(10, 10, hits, 4), 0);
+    EXPECT_EQ(grid.Query(-1, 10, hits, 4), 0);
+    EXPECT_EQ(grid.Query(640, 10, hits, 4), 0);
+}
+
+TEST(PickGridTest, OrdersSpritesByZThenEntities) {
+    CPickGrid grid;
+    grid.Reset(640, 480);
+    grid.Update(1, ePickEntity, Rect(0, 0, 200, 200), 0, true);
+    grid.Update(2, ePickSprite, Rect(50, 50, 150, 150), 1, true);
+    grid.Update(3, ePickSprite, Rect(90, 90, 110, 110), 5, true);
+    grid.Update(4, ePickSprite, Rect(300, 300, 400, 400), 9, true);
+
+    PickHit hits[8];
+    ASSERT_EQ(grid.Query(100, 100, hits, 8), 3);
+    EXPECT_EQ(hits[0].id, 3u);
+    EXPECT_EQ(hits[1].id, 2u);
+    EXPECT_EQ(hits[2].id, 1u);
+    EXPECT_EQ(hits[2].kind, ePickEntity);
+
+    ASSERT_EQ(grid.Query(10, 10, hits, 8), 1);
+    EXPECT_EQ(hits[0].id, 1u);
+
+    // Right and bottom edges are exclusive.
+    EXPECT_EQ(grid.Query(150, 60, hits, 8), 1);
+}
+
+TEST(PickGridTest, ReportsTotalWhenHitBufferIsSmall) {
+    CPickGrid grid;
+    grid.Reset(100, 100);
+    for (int i = 0; i < 5; ++i)
+        grid.Update(i + 1, ePickSprite, Rect(0, 0, 50, 50), i, true);
+
+    PickHit hits[2];
+    EXPECT_EQ(grid.Query(10, 10, hits, 2), 5);
+    EXPECT_EQ(grid.Query(10, 10, NULL, 0), 5);
+}
+
+TEST(PickGridTest, UnchangedUpdatesDoNotRebucket) {
+    CPickGrid grid;
+    grid.Reset(640, 480, 64);
+    EXPECT_TRUE(grid.Update(1, ePickSprite, Rect(10, 10, 20, 20), 0, true));
+    unsigned long rebuckets = grid.GetRebucketCount();
+
+    EXPECT_FALSE(grid.Update(1, ePickSprite, Rect(10, 10, 20, 20), 0, true));
+    EXPECT_EQ(grid.GetRebucketCount(), rebuckets);
+
+    // Moving inside the same cell updates the rectangle without touching the cells.
+    EXPECT_TRUE(grid.Update(1, ePickSprite, Rect(30, 30, 40, 40), 0, true));
+    EXPECT_EQ(grid.GetRebucketCount(), rebuckets);
+    PickHit hit;
+    EXPECT_EQ(grid.Query(15, 15, &hit, 1), 0);
+    EXPECT_EQ(grid.Query(35, 35, &hit, 1), 1);
+
+    // Moving to another cell does.
+    EXPECT_TRUE(grid.Update(1, ePickSprite, Rect(300, 300, 310, 310), 0, true));
+    EXPECT_EQ(grid.GetRebucketCount(), rebuckets + 1);
+    EXPECT_EQ(grid.Query(35, 35, &hit, 1), 0);
+    EXPECT_EQ(grid.Query(305, 305, &hit, 1), 1);
+}
+
+TEST(PickGridTest, HiddenAndOffscreenItemsAreNotHit) {
+    CPickGrid grid;
+    grid.Reset(640, 480);
+    grid.Update(1, ePickSprite, Rect(0, 0, 100, 100), 0, false);
+    grid.Update(2, ePickSprite, Rect(-200, -200, -100, -100), 0, true);
+    grid.Update(3, ePickSprite, Rect(-50, -50, 10, 10), 0, true);
+
+    PickHit hit;
+    ASSERT_EQ(grid.Query(5, 5, &hit, 1), 1);
+    EXPECT_EQ(hit.id, 3u);
+    EXPECT_EQ(grid.GetItemCount(), 3);
+
+    grid.Update(1, ePickSprite, Rect(0, 0, 100, 100), 10, true);
+    ASSERT_EQ(grid.Query(50, 50, &hit, 1), 1);
+    EXPECT_EQ(hit.id, 1u);
+}
+
+TEST(PickGridTest, RefreshSweepsDeletedItems) {
+    CPickGrid grid;
+    grid.Reset(640, 480);
+    grid.BeginRefresh();
+    grid.Update(1, ePickSprite, Rect(0, 0, 100, 100), 0, true);
+    grid.Update(2, ePickEntity, Rect(0, 0, 100, 100), 0, true);
+    EXPECT_EQ(grid.EndRefresh(), 0);
+
+    grid.BeginRefresh();
+    grid.Update(2, ePickEntity, Rect(0, 0, 100, 100), 0, true);
+    EXPECT_EQ(grid.EndRefresh(), 1);
+    EXPECT_EQ(grid.GetItemCount(), 1);
+
+    PickHit hits[2];
+    ASSERT_EQ(grid.Query(10, 10, hits, 2), 1);
+    EXPECT_EQ(hits[0].id, 2u);
+
+    // Freed slots are reused.
+    grid.Update(7, ePickSprite, Rect(0, 0, 100, 100), 0, true);
+    EXPECT_EQ(grid.Query(10, 10, hits, 2), 2);
+    EXPECT_TRUE(grid.Remove(7));
+    EXPECT_FALSE(grid.Remove(7));
+    EXPECT_EQ(grid.Query(10, 10, hits, 2), 1);
+}
+
+namespace {
+    bool Contains(const PickRect &r, float x, float y) {
+        return x >= r.left && x < r.right && y >= r.top && y < r.bottom;
+    }
+}
+
+TEST(PickGridTest, QueriesMatchLinearScan) {
+    const int kItems = 500;
+    const int kWidth = 1920;
+    const int kHeight = 1080;
+
+    std::mt19937 rng(29);
+    std::uniform_real_distribution<float> px(0, kWidth);
+    std::uniform_real_distribution<float> py(0, kHeight);
+    std::uniform_real_distribution<float> size(4, 96);
+
+    CPickGrid grid;
+    grid.Reset(kWidth, kHeight);
+    std::vector<PickRect> rects;
+    for (int i = 0; i < kItems; ++i) {
+        float x = px(rng), y = py(rng);
+        rects.push_back(Rect(x, y, x + size(rng), y + size(rng)));
+        grid.Update((platform::uint32)(i + 1), (i & 1) ? ePickEntity : ePickSprite, rects.back(), i, true);
+    }
+
+    for (int q = 0; q < 2000; ++q) {
+        float x = px(rng), y = py(rng);
+        int expected = 0;
+        for (int i = 0; i < kItems; ++i) {
+            if (Contains(rects[i], x, y))
+                ++expected;
+        }
+        ASSERT_EQ(grid.Query(x, y, NULL, 0), expected) << "at " << x << "," << y;
+    }
+}
+
+TEST(PickTrackerTest, StartsAndStaysFullUntilReset) {
+    CPickTracker tracker;
+    EXPECT_TRUE(tracker.NeedsFullRefresh());
+    EXPECT_FALSE(tracker.BeginFrame(7));
+    tracker.MarkMoved(3);
+    tracker.EndFrame(9);
+    EXPECT_TRUE(tracker.GetMoved().empty());
+
+    tracker.Reset(7, 9);
+    EXPECT_FALSE(tracker.NeedsFullRefresh());
+    EXPECT_TRUE(tracker.BeginFrame(7));
+    tracker.EndFrame(9);
+    EXPECT_FALSE(tracker.NeedsFullRefresh());
+}
+
+TEST(PickTrackerTest, CollectsEachMovedEntityOnce) {
+    CPickTracker tracker;
+    tracker.Reset(1, 1);
+    for (int frame = 0; frame < 3; ++frame) {
+        ASSERT_TRUE(tracker.BeginFrame(1));
+        tracker.MarkMoved(40);
+        tracker.MarkMoved(12);
+        tracker.EndFrame(1);
+    }
+    EXPECT_EQ(tracker.GetMoved(), (std::vector<platform::uint32>{40, 12}));
+
+    tracker.ClearMoved();
+    EXPECT_TRUE(tracker.GetMoved().empty());
+    tracker.MarkMoved(40);
+    EXPECT_EQ(tracker.GetMoved().size(), 1u);
+}
+
+TEST(PickTrackerTest, ViewOrSceneChangesNeedTheWholeScene) {
+    CPickTracker tracker;
+    tracker.Reset(1, 1);
+    tracker.MarkMoved(5);
+    EXPECT_FALSE(tracker.BeginFrame(2));
+    EXPECT_TRUE(tracker.NeedsFullRefresh());
+    EXPECT_TRUE(tracker.GetMoved().empty());
+
+    // Back to the old view: entities may have moved while nobody looked.
+    EXPECT_FALSE(tracker.BeginFrame(1));
+
+    tracker.Reset(1, 1);
+    EXPECT_TRUE(tracker.BeginFrame(1));
+    tracker.EndFrame(2);
+    EXPECT_TRUE(tracker.NeedsFullRefresh());
+}
+
+TEST(PickTrackerTest, TooManyMovedEntitiesNeedTheWholeScene) {
+    CPickTracker tracker;
+    tracker.Reset(1, 1);
+    for (int i = 0; i < CPickTracker::MAX_MOVED; ++i)
+        tracker.MarkMoved((platform::uint32)i);
+    EXPECT_FALSE(tracker.NeedsFullRefresh());
+    tracker.MarkMoved(CPickTracker::MAX_MOVED);
+    EXPECT_TRUE(tracker.NeedsFullRefresh());
+    EXPECT_TRUE(tracker.GetMoved().empty());
+
+    // The marks went with the list.
+    tracker.Reset(1, 1);
+    tracker.MarkMoved(0);
+    EXPECT_EQ(tracker.GetMoved().size(), 1u);
+}
+
+TEST(PickTrackerTest, ReportsVisibilityChanges) {
+    CPickTracker tracker;
+    EXPECT_FALSE(tracker.SetShown(8, false));
+    EXPECT_TRUE(tracker.SetShown(8, true));
+    EXPECT_FALSE(tracker.SetShown(8, true));
+    EXPECT_TRUE(tracker.SetShown(8, false));
+    EXPECT_TRUE(tracker.SetShown(100000, true));
+}
@@ -43,6 +43,18 @@ TEST(PlayerOptionsTest, AppliesConfigOptionsFromLongAndShortOptions) {
     EXPECT_TRUE(config.childWindowRendering);
 }
 
+TEST(PlayerOptionsTest, RebuildPluginCacheIsCommandLineOnly) {
+    CmdlineParser parser("--width=800 --rebuild-plugin-cache");
+    CGameConfig config;
+    EXPECT_FALSE(config.rebuildPluginCache);
+
+    playeroptions::ApplyConfigOptions(config, parser);
+
+    EXPECT_TRUE(config.rebuildPluginCache);
+    EXPECT_EQ(config.width, 800);
+    EXPECT_FALSE(playeroptions::HasConfigOption("--rebuild-plugin-cache", '\0'));
+}
+
 TEST(PlayerOptionsTest, CommandLineConfigOptionsApplyOnlyToRuntimeCopy) {
     CmdlineParser parser("--width=800 --height 600 --fullscreen");
     CGameConfig persistentConfig;
@@ -266,3 +278,36 @@ TEST(PlayerOptionsTest, ExposesMetadataForConfigAndPathOptions) {
     EXPECT_FALSE(playeroptions::HasConfigOption("--child-window-rendering", 's'));
     EXPECT_TRUE(playeroptions::HasPathOption("--log"));
 }
+
+TEST(PlayerOptionsTest, AppliesBatchOptions) {
+    CmdlineParser parser("--fullscreen --batch maps.txt --batch-jobs 4 --batch-frames=30 "
+                         "--batch-report \"out dir/report.json\" --batch-timeout 0 --cmo base.cmo");
+    BatchOptions options;
+    playeroptions::ApplyBatchOptions(options, parser);
+    EXPECT_EQ(options.listFile, "maps.txt");
+    EXPECT_EQ(options.jobs, 4);
+    EXPECT_EQ(options.frames, 30);
+    EXPECT_EQ(options.reportFile, "out dir/report.json");
+    EXPECT_EQ(options.timeoutSeconds, 0);
+    EXPECT_TRUE(options.IsBatch());
+    EXPECT_FALSE(options.IsWorker());
+
+    // The parser is left for the other options.
+    CmdlineArg arg;
+    EXPECT_TRUE(parser.Next(arg, "--fullscreen", 'f'));
+
+    CmdlineParser none("--fullscreen --cmo base.cmo");
+    BatchOptions defaults;
+    playeroptions::ApplyBatchOptions(defaults, none);
+    EXPECT_FALSE(defaults.IsBatch());
+    EXPECT_EQ(defaults.reportFile, "BatchReport.json");
+    EXPECT_EQ(defaults.jobs, 0);
+    EXPECT_EQ(defaults.frames, 100);
+    EXPECT_EQ(defaults.timeoutSeconds, 120);
+
+    CmdlineParser worker("--batch-worker result-3.txt --cmo custom.nmo");
+    BatchOptions workerOptions;
+    playeroptions::ApplyBatchOptions(workerOptions, worker);
+    EXPECT_TRUE(workerOptions.IsWorker());
+    EXPECT_EQ(workerOptions.resultFile, "result-3.txt");
+}
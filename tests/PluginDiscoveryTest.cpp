@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "PluginDiscovery.h"
+
+namespace {
+    // In-memory tree. Paths use '/' and are matched exactly after normalization.
+    class FakeFileSystem : public CFileSystem {
+    public:
+        void AddDirectory(const std::string &path) {
+            m_Directories.insert(filesystem::NormalizePath(path));
+        }
+
+        void AddFile(const std::string &directory, const std::string &name, platform::uint64 size) {
+            AddDirectory(directory);
+            FileEntry entry;
+            entry.path = filesystem::JoinPath(directory, name);
+            entry.size = size;
+            entry.modifiedTime = 1;
+            m_Files[filesystem::NormalizePath(directory)].push_back(entry);
+        }
+
+        bool DirectoryExists(const char *path) override {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            ++m_ExistsCalls[filesystem::NormalizePath(path)];
+            return m_Directories.count(filesystem::NormalizePath(path)) != 0;
+        }
+
+        bool ListFiles(const char *directory, const char *extension, std::vector<FileEntry> &files) override {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            const std::string key = filesystem::NormalizePath(directory);
+            ++m_ListCalls[key];
+            if (m_Directories.count(key) == 0)
+                return false;
+            const std::vector<FileEntry> &entries = m_Files[key];
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (filesystem::HasExtension(entries[i].path.c_str(), extension))
+                    files.push_back(entries[i]);
+            }
+            return true;
+        }
+
+        bool ListDirectories(const char *directory, std::vector<std::string> &directories) override {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            const std::string key = filesystem::NormalizePath(directory);
+            if (m_Directories.count(key) == 0)
+                return false;
+            for (std::set<std::string>::const_iterator it = m_Directories.begin(); it != m_Directories.end(); ++it) {
+                const std::string parent = filesystem::NormalizePath(filesystem::GetDirectory(*it));
+                if (*it != key && parent == key)
+                    directories.push_back(filesystem::JoinPath(directory, it->substr(it->find_last_of('/') + 1)));
+            }
+            return true;
+        }
+
+        bool GetFileEntry(const char *, FileEntry &) override {
+            return false;
+        }
+
+        platform::uint64 Prefetch(const char *path) override {
+            std::lock_guard<std::mutex> lock(m_Lock);
+            m_Prefetched.push_back(path);
+            for (std::map<std::string, std::vector<FileEntry> >::const_iterator it = m_Files.begin(); it != m_Files.end(); ++it) {
+                for (size_t i = 0; i < it->second.size(); ++i) {
+                    if (it->second[i].path == path)
+                        return it->second[i].size;
+                }
+            }
+            return 0;
+        }
+
+        int ListCalls(const std::string &path) {
+            return m_ListCalls[filesystem::NormalizePath(path)];
+        }
+
+        std::vector<std::string> m_Prefetched;
+
+    private:
+        std::mutex m_Lock;
+        std::set<std::string> m_Directories;
+        std::map<std::string, std::vector<FileEntry> > m_Files;
+        std::map<std::string, int> m_ExistsCalls;
+        std::map<std::string, int> m_ListCalls;
+    };
+
+    void ConfigureDefaults(CPluginDiscovery &discovery) {
+        discovery.SetDirectory(ePluginRenderEngines, "/game/RenderEngines/");
+        discovery.SetDirectory(ePluginManagers, "/game/Managers/");
+        discovery.SetDirectory(ePluginBuildingBlocks, "/game/BuildingBlocks/");
+        discovery.SetDirectory(ePluginPlugins, "/game/Plugins/");
+        discovery.SetExecutableDirectory("/game/Bin/");
+    }
+}
+
+TEST(PluginDiscoveryTest, ScansEveryDirectoryAndFiltersDlls) {
+    FakeFileSystem fs;
+    fs.AddFile("/game/RenderEngines/", "CK2_3D.dll", 400);
+    fs.AddFile("/game/Managers/", "Dx8InputManager.dll", 100);
+    fs.AddFile("/game/Managers/", "readme.txt", 5);
+    fs.AddFile("/game/BuildingBlocks/", "physics_RT.DLL", 900);
+    fs.AddFile("/game/BuildingBlocks/", "TT_Toolbox_RT.dll", 300);
+    fs.AddDirectory("/game/Plugins/");
+    fs.AddFile("/game/Bin/", "Player.dll", 50);
+
+    CPluginDiscovery discovery(fs);
+    ConfigureDefaults(discovery);
+    discovery.Discover(4, false);
+
+    EXPECT_TRUE(discovery.HasPlugins(ePluginRenderEngines));
+    EXPECT_EQ(discovery.GetScan(ePluginManagers).files.size(), 1u);
+    EXPECT_EQ(discovery.GetScan(ePluginBuildingBlocks).files.size(), 2u);
+    EXPECT_TRUE(discovery.GetScan(ePluginPlugins).exists);
+    EXPECT_FALSE(discovery.HasPlugins(ePluginPlugins));
+    EXPECT_TRUE(discovery.GetExecutableScan().exists);
+    EXPECT_EQ(discovery.GetPrefetchedFiles(), 0);
+    EXPECT_TRUE(fs.m_Prefetched.empty());
+}
+
+TEST(PluginDiscoveryTest, MissingDirectoriesAreReported) {
+    FakeFileSystem fs;
+    fs.AddFile("/game/Bin/", "CK2_3D.dll", 10);
+
+    CPluginDiscovery discovery(fs);
+    ConfigureDefaults(discovery);
+    discovery.Discover(2, true);
+
+    for (int i = 0; i < ePluginCategoryCount; ++i) {
+        EXPECT_FALSE(discovery.GetScan((PluginCategory)i).exists);
+        EXPECT_FALSE(discovery.HasPlugins((PluginCategory)i));
+    }
+    EXPECT_EQ(discovery.GetExecutableScan().files.size(), 1u);
+    EXPECT_EQ(discovery.GetPrefetchedFiles(), 1);
+}
+
+TEST(PluginDiscoveryTest, PrefetchesEachDllOnceLargestFirst) {
+    FakeFileSystem fs;
+    fs.AddFile("/game/RenderEngines/", "CK2_3D.dll", 400);
+    fs.AddFile("/game/Managers/", "a.dll", 100);
+    fs.AddFile("/game/BuildingBlocks/", "b.dll", 900);
+    fs.AddFile("/game/Plugins/", "c.dll", 200);
+
+    CPluginDiscovery discovery(fs);
+    ConfigureDefaults(discovery);
+    // Plugins shares the managers directory under another spelling.
+    discovery.SetDirectory(ePluginPlugins, "/GAME/managers");
+    discovery.Discover(1, true);
+
+    EXPECT_EQ(discovery.GetPrefetchedFiles(), 3);
+    EXPECT_EQ(discovery.GetPrefetchedBytes(), 1400u);
+    ASSERT_EQ(fs.m_Prefetched.size(), 3u);
+    EXPECT_EQ(fs.m_Prefetched[0], "/game/BuildingBlocks/b.dll");
+    EXPECT_EQ(fs.m_Prefetched[2], "/game/Managers/a.dll");
+
+    // The shared directory was listed once and both categories see its files.
+    EXPECT_EQ(fs.ListCalls("/game/Managers"), 1);
+    EXPECT_EQ(discovery.GetScan(ePluginPlugins).files.size(), 1u);
+}
+
+namespace {
+    bool SkipBuildingBlocks(const FileEntry &file, void *arg) {
+        ++*(int *)arg;
+        return file.path.find("/BuildingBlocks/") == std::string::npos;
+    }
+}
+
+TEST(PluginDiscoveryTest, PrefetchFilterLeavesFilesOut) {
+    FakeFileSystem fs;
+    fs.AddFile("/game/RenderEngines/", "CK2_3D.dll", 400);
+    fs.AddFile("/game/BuildingBlocks/", "b.dll", 900);
+    fs.AddFile("/game/BuildingBlocks/", "d.dll", 300);
+
+    int asked = 0;
+    CPluginDiscovery discovery(fs);
+    ConfigureDefaults(discovery);
+    discovery.SetPrefetchFilter(SkipBuildingBlocks, &asked);
+    discovery.Discover(2, true);
+
+    EXPECT_EQ(asked, 3);
+    EXPECT_EQ(discovery.GetPrefetchedFiles(), 1);
+    ASSERT_EQ(fs.m_Prefetched.size(), 1u);
+    EXPECT_EQ(fs.m_Prefetched[0], "/game/RenderEngines/CK2_3D.dll");
+    // Filtered files are still listed for registration.
+    EXPECT_EQ(discovery.GetScan(ePluginBuildingBlocks).files.size(), 2u);
+
+    discovery.Discover(2, false);
+    EXPECT_EQ(asked, 3);
+}
+
+TEST(PluginDiscoveryTest, ExecutableDirectoryFallbackIsClaimedOnce) {
+    FakeFileSystem fs;
+    fs.AddFile("/game/Bin/", "CK2_3D.dll", 10);
+
+    CPluginDiscovery discovery(fs);
+    ConfigureDefaults(discovery);
+    discovery.Discover(4, false);
+
+    // Every category falls back to the executable directory; only the first parses it.
+    int parses = 0;
+    for (int i = 0; i < ePluginCategoryCount; ++i) {
+        if (!discovery.HasPlugins((PluginCategory)i) &&
+            discovery.GetExecutableScan().exists &&
+            discovery.ClaimDirectory(discovery.GetExecutableScan().directory.c_str()))
+            ++parses;
+    }
+    EXPECT_EQ(parses, 1);
+    EXPECT_TRUE(discovery.IsDirectoryClaimed("/game/bin"));
+}
+
+TEST(PluginDiscoveryTest, CategoryDirectoryEqualToExecutableDirectoryIsNotParsedTwice) {
+    FakeFileSystem fs;
+    fs.AddFile("/game/Bin/", "CK2_3D.dll", 10);
+
+    CPluginDiscovery discovery(fs);
+    ConfigureDefaults(discovery);
+    discovery.SetDirectory(ePluginRenderEngines, "/game/Bin");
+    discovery.Discover(4, true);
+
+    EXPECT_TRUE(discovery.HasPlugins(ePluginRenderEngines));
+    EXPECT_TRUE(discovery.ClaimDirectory(discovery.GetScan(ePluginRenderEngines).directory.c_str()));
+    EXPECT_FALSE(discovery.ClaimDirectory(discovery.GetExecutableScan().directory.c_str()));
+    EXPECT_EQ(discovery.GetPrefetchedFiles(), 1);
+    EXPECT_FALSE(discovery.ClaimDirectory(""));
+}
+
+TEST(PluginDiscoveryTest, DiscoverCanBeRepeated) {
+    FakeFileSystem fs;
+    fs.AddFile("/game/Managers/", "a.dll", 100);
+
+    CPluginDiscovery discovery(fs);
+    ConfigureDefaults(discovery);
+    discovery.Discover(4, true);
+    discovery.Discover(4, true);
+    EXPECT_EQ(discovery.GetScan(ePluginManagers).files.size(), 1u);
+    EXPECT_EQ(discovery.GetPrefetchedFiles(), 1);
+}
+
+TEST(PluginDiscoveryTest, FindsDllsInSubdirectories) {
+    FakeFileSystem fs;
+    fs.AddFile("/game/BuildingBlocks/", "TT_Toolbox_RT.dll", 300);
+    fs.AddFile("/game/BuildingBlocks/Physics/", "physics_RT.dll", 900);
+    fs.AddFile("/game/BuildingBlocks/Physics/Extra/", "nested.dll", 50);
+    fs.AddFile("/game/BuildingBlocks/Docs/", "readme.txt", 5);
+
+    CPluginDiscovery discovery(fs);
+    ConfigureDefaults(discovery);
+    discovery.Discover(2, true);
+
+    const std::vector<FileEntry> &files = discovery.GetScan(ePluginBuildingBlocks).files;
+    ASSERT_EQ(files.size(), 3u);
+    std::vector<std::string> names;
+    for (size_t i = 0; i < files.size(); ++i)
+        names.push_back(filesystem::NormalizePath(files[i].path));
+    EXPECT_NE(std::find(names.begin(), names.end(), "/game/buildingblocks/physics/physics_rt.dll"), names.end());
+    EXPECT_NE(std::find(names.begin(), names.end(), "/game/buildingblocks/physics/extra/nested.dll"), names.end());
+    EXPECT_EQ(discovery.GetPrefetchedFiles(), 3);
+}
+
+TEST(FileSystemPathTest, NormalizesAndJoins) {
+    EXPECT_EQ(filesystem::NormalizePath("C:\\Game\\Bin\\"), "c:/game/bin");
+    EXPECT_EQ(filesystem::NormalizePath("/"), "/");
+    EXPECT_EQ(filesystem::JoinPath("a/", "b.dll"), "a/b.dll");
+    EXPECT_EQ(filesystem::JoinPath("", "b.dll"), "b.dll");
+    EXPECT_TRUE(filesystem::HasExtension("X.DLL", ".dll"));
+    EXPECT_FALSE(filesystem::HasExtension(".dll", ".dll"));
+    EXPECT_FALSE(filesystem::HasExtension("x.dll.txt", ".dll"));
+    EXPECT_TRUE(filesystem::HasExtension("x", NULL));
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "PluginIndex.h"
+
+namespace {
+    PluginGuid Guid(platform::uint32 d1, platform::uint32 d2) {
+        PluginGuid guid;
+        guid.d1 = d1;
+        guid.d2 = d2;
+        return guid;
+    }
+
+    PluginManifestEntry MakePlugin(const std::string &path, int type, int flags, PluginGuid guid,
+                                   const std::vector<PluginGuid> &behaviors) {
+        PluginManifestEntry entry;
+        entry.path = path;
+        entry.size = 1;
+        entry.modifiedTime = 1;
+        PluginManifestInfo info;
+        info.type = type;
+        info.flags = flags;
+        info.guid = guid;
+        entry.infos.push_back(info);
+        entry.infoCount = 1;
+        entry.behaviors = behaviors;
+        return entry;
+    }
+
+    // Three building block DLLs, one manager and a DLL that is not a plugin.
+    void BuildManifest(CPluginManifest &manifest) {
+        std::vector<PluginGuid> toolbox;
+        toolbox.push_back(Guid(0x10, 0x1));
+        toolbox.push_back(Guid(0x10, 0x2));
+        manifest.Set(MakePlugin("BB/TT_Toolbox_RT.dll", PLUGIN_TYPE_BEHAVIOR_DLL, 0, Guid(0x1, 0x1), toolbox));
+
+        std::vector<PluginGuid> physics;
+        physics.push_back(Guid(0x20, 0x1));
+        manifest.Set(MakePlugin("BB/physics_RT.dll", PLUGIN_TYPE_BEHAVIOR_DLL, 0, Guid(0x2, 0x2), physics));
+
+        std::vector<PluginGuid> sounds;
+        sounds.push_back(Guid(0x30, 0x1));
+        manifest.Set(MakePlugin("BB/Sounds.dll", PLUGIN_TYPE_BEHAVIOR_DLL, 0, Guid(0x3, 0x3), sounds));
+
+        manifest.Set(MakePlugin("Managers/Input.dll", 3, 0, Guid(0x4, 0x4), std::vector<PluginGuid>()));
+
+        PluginManifestEntry runtime;
+        runtime.path = "BB/msvcrt.dll";
+        manifest.Set(runtime);
+    }
+}
+
+TEST(PluginIndexTest, DeferralNeedsBehaviorOnlyPluginsWithoutContextCallbacks) {
+    std::vector<PluginGuid> none;
+    EXPECT_TRUE(IsDeferrablePlugin(MakePlugin("a.dll", PLUGIN_TYPE_BEHAVIOR_DLL, 0, Guid(1, 1), none)));
+    EXPECT_FALSE(IsDeferrablePlugin(MakePlugin("a.dll", PLUGIN_TYPE_BEHAVIOR_DLL, PLUGIN_INFO_HAS_INIT_INSTANCE, Guid(1, 1), none)));
+    EXPECT_FALSE(IsDeferrablePlugin(MakePlugin("a.dll", 3, 0, Guid(1, 1), none)));
+
+    PluginManifestEntry mixed = MakePlugin("a.dll", PLUGIN_TYPE_BEHAVIOR_DLL, 0, Guid(1, 1), none);
+    PluginManifestInfo reader = mixed.infos[0];
+    reader.type = 0;
+    mixed.infos.push_back(reader);
+    mixed.infoCount = 2;
+    EXPECT_FALSE(IsDeferrablePlugin(mixed));
+
+    EXPECT_FALSE(IsDeferrablePlugin(PluginManifestEntry()));
+}
+
+TEST(PluginIndexTest, IndexesPluginAndBehaviorGuids) {
+    CPluginManifest manifest;
+    BuildManifest(manifest);
+
+    CPluginGuidIndex index;
+    index.Build(manifest);
+    EXPECT_EQ(index.GetGuidCount(), 8);
+
+    ASSERT_NE(index.Find(Guid(0x10, 0x2)), nullptr);
+    EXPECT_STREQ(index.Find(Guid(0x10, 0x2)), "BB/TT_Toolbox_RT.dll");
+    EXPECT_STREQ(index.Find(Guid(0x2, 0x2)), "BB/physics_RT.dll");
+    EXPECT_STREQ(index.Find(Guid(0x4, 0x4)), "Managers/Input.dll");
+    EXPECT_EQ(index.Find(Guid(0x10, 0x3)), nullptr);
+    EXPECT_EQ(index.Find(Guid(0x2, 0x1)), nullptr);
+}
+
+TEST(PluginIndexTest, FirstDllByPathWinsADuplicateGuid) {
+    CPluginManifest manifest;
+    std::vector<PluginGuid> shared;
+    shared.push_back(Guid(0x99, 0x99));
+    manifest.Set(MakePlugin("b.dll", PLUGIN_TYPE_BEHAVIOR_DLL, 0, Guid(0x2, 0), shared));
+    manifest.Set(MakePlugin("a.dll", PLUGIN_TYPE_BEHAVIOR_DLL, 0, Guid(0x1, 0), shared));
+
+    CPluginGuidIndex index;
+    index.Build(manifest);
+    EXPECT_STREQ(index.Find(Guid(0x99, 0x99)), "a.dll");
+}
+
+TEST(PluginIndexTest, PlansOnlyDeferredDllsOnceInRequestOrder) {
+    CPluginManifest manifest;
+    BuildManifest(manifest);
+    CPluginGuidIndex index;
+    index.Build(manifest);
+
+    CPluginLoadPlanner planner;
+    planner.Defer("BB/TT_Toolbox_RT.dll");
+    planner.Defer("BB/physics_RT.dll");
+    planner.Defer("BB/Sounds.dll");
+    EXPECT_EQ(planner.GetDeferredCount(), 3);
+
+    std::vector<PluginGuid> required;
+    required.push_back(Guid(0x20, 0x1)); // physics behavior
+    required.push_back(Guid(0x10, 0x1)); // toolbox behavior
+    required.push_back(Guid(0x1, 0x1));  // toolbox plugin
+    required.push_back(Guid(0x10, 0x2)); // toolbox behavior
+    required.push_back(Guid(0x4, 0x4));  // manager, already registered
+    required.push_back(Guid(0x77, 0x7)); // unknown
+
+    std::vector<std::string> dlls;
+    std::vector<PluginGuid> unresolved;
+    EXPECT_EQ(planner.Plan(index, required, dlls, unresolved), 2);
+    ASSERT_EQ(dlls.size(), 2u);
+    EXPECT_EQ(dlls[0], "BB/physics_RT.dll");
+    EXPECT_EQ(dlls[1], "BB/TT_Toolbox_RT.dll");
+    ASSERT_EQ(unresolved.size(), 2u);
+    EXPECT_EQ(unresolved[0].d1, 0x4u);
+    EXPECT_EQ(unresolved[1].d1, 0x77u);
+
+    // Planning does not change state; loading does.
+    EXPECT_EQ(planner.GetDeferredCount(), 3);
+    for (size_t i = 0; i < dlls.size(); ++i)
+        planner.MarkLoaded(dlls[i].c_str());
+    EXPECT_EQ(planner.GetDeferredCount(), 1);
+    EXPECT_TRUE(planner.IsDeferred("bb\\sounds.DLL"));
+    EXPECT_FALSE(planner.IsDeferred("BB/physics_RT.dll"));
+
+    dlls.clear();
+    unresolved.clear();
+    EXPECT_EQ(planner.Plan(index, required, dlls, unresolved), 0);
+    EXPECT_TRUE(dlls.empty());
+    EXPECT_EQ(unresolved.size(), required.size());
+
+    std::vector<std::string> remaining;
+    planner.GetDeferred(remaining);
+    ASSERT_EQ(remaining.size(), 1u);
+    EXPECT_EQ(remaining[0], "BB/Sounds.dll");
+}
+
+TEST(PluginIndexTest, EmptyPlannerResolvesNothing) {
+    CPluginManifest manifest;
+    BuildManifest(manifest);
+    CPluginGuidIndex index;
+    index.Build(manifest);
+
+    CPluginLoadPlanner planner;
+    std::vector<PluginGuid> required(1, Guid(0x10, 0x1));
+    std::vector<std::string> dlls;
+    std::vector<PluginGuid> unresolved;
+    EXPECT_EQ(planner.Plan(index, required, dlls, unresolved), 0);
+    EXPECT_EQ(unresolved.size(), 1u);
+
+    planner.Defer(NULL);
+    planner.Defer("");
+    EXPECT_EQ(planner.GetDeferredCount(), 0);
+}
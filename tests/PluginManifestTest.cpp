@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include "PluginManifest.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    PluginManifestEntry MakeEntry(const std::string &path, platform::uint64 size, platform::uint64 time, int infos) {
+        PluginManifestEntry entry;
+        entry.path = path;
+        entry.size = size;
+        entry.modifiedTime = time;
+        entry.infoCount = infos;
+        for (int i = 0; i < infos; ++i) {
+            PluginManifestInfo info;
+            info.type = i % 6;
+            info.flags = i % 2;
+            info.guid.d1 = 0x12340000u + i;
+            info.guid.d2 = 0xfedcba98u - i;
+            entry.infos.push_back(info);
+
+            PluginGuid behavior;
+            behavior.d1 = 0x0badf00du;
+            behavior.d2 = 0x100u + i;
+            entry.behaviors.push_back(behavior);
+        }
+        return entry;
+    }
+
+    FileEntry MakeFile(const std::string &path, platform::uint64 size, platform::uint64 time) {
+        FileEntry file;
+        file.path = path;
+        file.size = size;
+        file.modifiedTime = time;
+        return file;
+    }
+}
+
+TEST(PluginManifestTest, RoundTripsEntries) {
+    CPluginManifest manifest;
+    manifest.Set(MakeEntry("C:\\Ballance\\BuildingBlocks\\TT_Toolbox_RT.dll", 1234567, 133456789012345678ull, 3));
+    manifest.Set(MakeEntry("C:\\Ballance\\Managers\\Dx8InputManager.dll", 4096, 1, 1));
+    manifest.Set(MakeEntry("C:\\Ballance\\BuildingBlocks\\msvcrt.dll", 18446744073709551615ull, 0, 0));
+
+    std::string text;
+    manifest.Write(text);
+
+    CPluginManifest loaded;
+    ASSERT_TRUE(loaded.Read(text));
+    EXPECT_EQ(loaded.GetEntryCount(), 3);
+
+    const PluginManifestEntry *entry = loaded.Find("c:/ballance/buildingblocks/tt_toolbox_rt.dll");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->path, "C:\\Ballance\\BuildingBlocks\\TT_Toolbox_RT.dll");
+    EXPECT_EQ(entry->size, 1234567u);
+    EXPECT_EQ(entry->modifiedTime, 133456789012345678ull);
+    ASSERT_EQ(entry->infoCount, 3);
+    ASSERT_EQ(entry->infos.size(), 3u);
+    EXPECT_EQ(entry->infos[2].type, 2);
+    EXPECT_EQ(entry->infos[2].flags, 0);
+    EXPECT_EQ(entry->infos[1].flags, PLUGIN_INFO_HAS_INIT_INSTANCE);
+    EXPECT_EQ(entry->infos[2].guid.d1, 0x12340002u);
+    EXPECT_EQ(entry->infos[2].guid.d2, 0xfedcba96u);
+    ASSERT_EQ(entry->behaviors.size(), 3u);
+    EXPECT_EQ(entry->behaviors[1].d1, 0x0badf00du);
+    EXPECT_EQ(entry->behaviors[1].d2, 0x101u);
+
+    const PluginManifestEntry *empty = loaded.Find("C:\\Ballance\\BuildingBlocks\\msvcrt.dll");
+    ASSERT_NE(empty, nullptr);
+    EXPECT_EQ(empty->infoCount, 0);
+    EXPECT_EQ(empty->size, 18446744073709551615ull);
+
+    std::string again;
+    loaded.Write(again);
+    EXPECT_EQ(again, text);
+}
+
+TEST(PluginManifestTest, EntriesGoStaleWhenSizeOrTimeChanges) {
+    CPluginManifest manifest;
+    manifest.Set(MakeEntry("/game/BuildingBlocks/a.dll", 100, 5, 1));
+
+    EXPECT_NE(manifest.FindCurrent(MakeFile("/game/BuildingBlocks/a.dll", 100, 5)), nullptr);
+    EXPECT_NE(manifest.FindCurrent(MakeFile("/GAME/buildingblocks/A.DLL", 100, 5)), nullptr);
+    EXPECT_EQ(manifest.FindCurrent(MakeFile("/game/BuildingBlocks/a.dll", 101, 5)), nullptr);
+    EXPECT_EQ(manifest.FindCurrent(MakeFile("/game/BuildingBlocks/a.dll", 100, 6)), nullptr);
+    EXPECT_EQ(manifest.FindCurrent(MakeFile("/game/BuildingBlocks/b.dll", 100, 5)), nullptr);
+}
+
+TEST(PluginManifestTest, SetReplacesExistingEntry) {
+    CPluginManifest manifest;
+    manifest.Set(MakeEntry("/game/a.dll", 100, 5, 1));
+    manifest.Set(MakeEntry("/GAME/A.dll", 200, 6, 2));
+    EXPECT_EQ(manifest.GetEntryCount(), 1);
+    EXPECT_EQ(manifest.Find("/game/a.dll")->infoCount, 2);
+
+    manifest.Set(MakeEntry("", 1, 1, 0));
+    EXPECT_EQ(manifest.GetEntryCount(), 1);
+}
+
+TEST(PluginManifestTest, RejectsInvalidText) {
+    CPluginManifest manifest;
+    manifest.Set(MakeEntry("/game/a.dll", 100, 5, 1));
+    std::string valid;
+    manifest.Write(valid);
+
+    const char *invalid[] = {
+        "",
+        "BallancePlayerPluginManifest 1\n",
+        "BallancePlayerPluginManifest 3\n",
+        "SomethingElse 1\n",
+        "BallancePlayerPluginManifest 2\n/game/a.dll\t100\t5\n",
+        "BallancePlayerPluginManifest 2\n/game/a.dll\t100\t5\t2\t1:0:0:0\n",
+        "BallancePlayerPluginManifest 2\n/game/a.dll\t100\t5\t1\t1:0:0\n",
+        "BallancePlayerPluginManifest 2\n/game/a.dll\t100\t5\t1\t1:0:0:123456789\n",
+        "BallancePlayerPluginManifest 2\n/game/a.dll\t-1\t5\t0\n",
+        "BallancePlayerPluginManifest 2\n/game/a.dll\t18446744073709551616\t5\t0\n",
+        "BallancePlayerPluginManifest 2\n\t1\t5\t0\n",
+        "BallancePlayerPluginManifest 2\n/game/a.dll\t1\t5\t0\tb:xyz:0\n",
+        "BallancePlayerPluginManifest 2\n/game/a.dll\t1\t5\t1\t1:x:0:0\n",
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        CPluginManifest loaded;
+        loaded.Set(MakeEntry("/game/stale.dll", 1, 1, 0));
+        EXPECT_FALSE(loaded.Read(invalid[i])) << i;
+        EXPECT_TRUE(loaded.IsEmpty()) << i;
+    }
+
+    // Line endings written by other tools and blank lines are tolerated.
+    std::string crlf;
+    for (size_t i = 0; i < valid.size(); ++i) {
+        if (valid[i] == '\n')
+            crlf += "\r\n\r\n";
+        else
+            crlf += valid[i];
+    }
+    CPluginManifest loaded;
+    EXPECT_TRUE(loaded.Read(crlf));
+    EXPECT_EQ(loaded.GetEntryCount(), 1);
+}
+
+TEST(PluginManifestTest, SavesAndLoadsFiles) {
+    const fs::path path = fs::temp_directory_path() / "ballance_plugin_manifest_test.txt";
+    fs::remove(path);
+
+    CPluginManifest manifest;
+    EXPECT_FALSE(manifest.Load(path.string().c_str()));
+
+    manifest.Set(MakeEntry("/game/BuildingBlocks/a.dll", 100, 5, 2));
+    manifest.Set(MakeEntry("/game/BuildingBlocks/b.dll", 200, 6, 0));
+    ASSERT_TRUE(manifest.Save(path.string().c_str()));
+
+    CPluginManifest loaded;
+    ASSERT_TRUE(loaded.Load(path.string().c_str()));
+    EXPECT_EQ(loaded.GetEntryCount(), 2);
+    EXPECT_NE(loaded.FindCurrent(MakeFile("/game/BuildingBlocks/a.dll", 100, 5)), nullptr);
+
+    fs::remove(path);
+}
@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "RenderDriverCache.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    DisplayMode Mode(int width, int height, int bpp, int refreshRate) {
+        DisplayMode mode = {width, height, bpp, refreshRate};
+        return mode;
+    }
+
+    CachedRenderDriver Driver(const char *name, const char *description, int modeCount) {
+        CachedRenderDriver driver;
+        driver.name = name;
+        driver.description = description;
+        for (int i = 0; i < modeCount; ++i)
+            driver.modes.push_back(Mode(640 + 160 * i, 480 + 120 * i, 32, 60));
+        return driver;
+    }
+
+    CRenderDriverCache MakeCache() {
+        CRenderDriverCache cache;
+        cache.Reset("NVIDIA GeForce RTX 3060 PCI\\VEN_10DE&DEV_2504", "31.0.15.3623");
+        cache.AddDriver(Driver("Direct3D 9 HAL", "Hardware", 3));
+        cache.AddDriver(Driver("Direct3D 9 REF", "Software", 1));
+        return cache;
+    }
+
+    class FakeDriverSource : public CRenderDriverSource {
+    public:
+        FakeDriverSource() : m_Fail(false), m_Gate(NULL), m_Calls(0) {}
+
+        virtual bool Enumerate(CRenderDriverCache &drivers) {
+            ++m_Calls;
+            if (m_Gate)
+                m_Gate->Acquire();
+            if (m_Fail)
+                return false;
+            for (size_t i = 0; i < m_Drivers.size(); ++i)
+                drivers.AddDriver(m_Drivers[i]);
+            return true;
+        }
+
+        std::vector<CachedRenderDriver> m_Drivers;
+        bool m_Fail;
+        CSemaphore *m_Gate;
+        int m_Calls;
+    };
+
+    class RenderDriverCacheTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            m_Path = fs::temp_directory_path() / "BallancePlayerDriverCacheTest.txt";
+            fs::remove(m_Path);
+        }
+
+        void TearDown() override {
+            fs::remove(m_Path);
+        }
+
+        fs::path m_Path;
+    };
+}
+
+TEST(RenderDriverCacheFormatTest, WriteAndReadRoundTrip) {
+    const CRenderDriverCache cache = MakeCache();
+    std::string text;
+    cache.Write(text);
+
+    CRenderDriverCache read;
+    ASSERT_TRUE(read.Read(text));
+    EXPECT_TRUE(read.Equals(cache));
+    ASSERT_EQ(read.GetDriverCount(), 2);
+    EXPECT_EQ(read.GetDriver(0).name, "Direct3D 9 HAL");
+    ASSERT_EQ(read.GetDriver(0).modes.size(), 3u);
+    EXPECT_EQ(read.GetDriver(0).modes[2].width, 960);
+    EXPECT_EQ(read.GetAdapter(), cache.GetAdapter());
+    EXPECT_EQ(read.GetDriverVersion(), "31.0.15.3623");
+}
+
+TEST(RenderDriverCacheFormatTest, MatchesOnlyTheSameAdapterAndVersion) {
+    const CRenderDriverCache cache = MakeCache();
+    EXPECT_TRUE(cache.Matches(cache.GetAdapter(), "31.0.15.3623"));
+    EXPECT_FALSE(cache.Matches(cache.GetAdapter(), "31.0.15.4000"));
+    EXPECT_FALSE(cache.Matches("AMD Radeon RX 6600", "31.0.15.3623"));
+
+    CRenderDriverCache empty;
+    empty.Reset(cache.GetAdapter(), "31.0.15.3623");
+    EXPECT_FALSE(empty.Matches(cache.GetAdapter(), "31.0.15.3623"));
+
+    CRenderDriverCache unknown;
+    unknown.AddDriver(Driver("Direct3D 9 HAL", "Hardware", 1));
+    EXPECT_FALSE(unknown.Matches("", ""));
+}
+
+TEST(RenderDriverCacheFormatTest, EqualsComparesDriversAndModes) {
+    const CRenderDriverCache cache = MakeCache();
+
+    CRenderDriverCache other = MakeCache();
+    EXPECT_TRUE(other.Equals(cache));
+
+    other = MakeCache();
+    other.AddDriver(Driver("OpenGL", "Hardware", 1));
+    EXPECT_FALSE(other.Equals(cache));
+
+    other.Reset(cache.GetAdapter(), cache.GetDriverVersion());
+    CachedRenderDriver hal = Driver("Direct3D 9 HAL", "Hardware", 3);
+    hal.modes[1].refreshRate = 75;
+    other.AddDriver(hal);
+    other.AddDriver(Driver("Direct3D 9 REF", "Software", 1));
+    EXPECT_FALSE(other.Equals(cache));
+    EXPECT_FALSE(other.HasSameModes(cache, 0));
+    EXPECT_TRUE(other.HasSameModes(cache, 1));
+    EXPECT_FALSE(other.HasSameModes(cache, 2));
+    EXPECT_FALSE(other.HasSameModes(cache, -1));
+}
+
+TEST(RenderDriverCacheFormatTest, ReplacesSeparatorsInNames) {
+    CRenderDriverCache cache;
+    cache.Reset("Adapter\twith tab", "1\n2");
+    cache.AddDriver(Driver("Name\twith tab", "Line\r\nbreak", 1));
+
+    std::string text;
+    cache.Write(text);
+    CRenderDriverCache read;
+    ASSERT_TRUE(read.Read(text));
+    EXPECT_EQ(read.GetAdapter(), "Adapter with tab");
+    EXPECT_EQ(read.GetDriver(0).name, "Name with tab");
+    EXPECT_EQ(read.GetDriver(0).description, "Line  break");
+    EXPECT_TRUE(read.Matches("Adapter\twith tab", "1\n2"));
+}
+
+TEST(RenderDriverCacheFormatTest, RejectsMalformedText) {
+    CRenderDriverCache cache;
+    EXPECT_FALSE(cache.Read(""));
+    EXPECT_FALSE(cache.Read("BallancePlayerDriverCache 2\nadapter\t1\n"));
+    EXPECT_FALSE(cache.Read("BallancePlayerDriverCache 1\n"));
+    EXPECT_FALSE(cache.Read("BallancePlayerDriverCache 1\nadapter\n"));
+    EXPECT_FALSE(cache.Read("BallancePlayerDriverCache 1\nadapter\t1\nm\t640\t480\t32\t60\n"));
+    EXPECT_FALSE(cache.Read("BallancePlayerDriverCache 1\nadapter\t1\nd\tHAL\tHardware\nm\t640\tx\t32\t60\n"));
+    EXPECT_FALSE(cache.Read("BallancePlayerDriverCache 1\nadapter\t1\nd\tHAL\tHardware\nm\t640\t-480\t32\t60\n"));
+    EXPECT_FALSE(cache.Read("BallancePlayerDriverCache 1\nadapter\t1\nx\tHAL\n"));
+    EXPECT_EQ(cache.GetDriverCount(), 0);
+
+    EXPECT_TRUE(cache.Read("BallancePlayerDriverCache 1\r\nadapter\t1\r\nd\tHAL\tHardware\r\nm\t640\t480\t32\t60\r\n"));
+    ASSERT_EQ(cache.GetDriverCount(), 1);
+    EXPECT_EQ(cache.GetDriver(0).modes.size(), 1u);
+}
+
+TEST_F(RenderDriverCacheTest, SavesAndLoads) {
+    const CRenderDriverCache cache = MakeCache();
+    ASSERT_TRUE(cache.Save(m_Path.string().c_str()));
+
+    CRenderDriverCache loaded;
+    ASSERT_TRUE(loaded.Load(m_Path.string().c_str()));
+    EXPECT_TRUE(loaded.Equals(cache));
+
+    fs::remove(m_Path);
+    EXPECT_FALSE(loaded.Load(m_Path.string().c_str()));
+    EXPECT_EQ(loaded.GetDriverCount(), 0);
+    EXPECT_FALSE(loaded.Load(NULL));
+}
+
+TEST_F(RenderDriverCacheTest, RefreshKeepsAnUnchangedCache) {
+    const CRenderDriverCache cache = MakeCache();
+    FakeDriverSource source;
+    for (int i = 0; i < cache.GetDriverCount(); ++i)
+        source.m_Drivers.push_back(cache.GetDriver(i));
+
+    CRenderDriverCacheRefresh refresh;
+    ASSERT_TRUE(refresh.Start(source, cache, m_Path.string().c_str()));
+    refresh.Wait();
+
+    EXPECT_TRUE(refresh.IsDone());
+    EXPECT_FALSE(refresh.HasChanged());
+    EXPECT_FALSE(refresh.TakeChange());
+    EXPECT_TRUE(refresh.GetDrivers().Equals(cache));
+    EXPECT_FALSE(fs::exists(m_Path));
+}
+
+TEST_F(RenderDriverCacheTest, RefreshSavesChangedDrivers) {
+    CRenderDriverCache cache = MakeCache();
+    FakeDriverSource source;
+    source.m_Drivers.push_back(Driver("Direct3D 9 HAL", "Hardware", 4));
+
+    CSemaphore gate;
+    source.m_Gate = &gate;
+
+    CRenderDriverCacheRefresh refresh;
+    ASSERT_TRUE(refresh.Start(source, cache, m_Path.string().c_str()));
+    EXPECT_FALSE(refresh.IsDone());
+    EXPECT_FALSE(refresh.TakeChange());
+
+    gate.Release();
+    refresh.Wait();
+    EXPECT_TRUE(refresh.HasChanged());
+    EXPECT_TRUE(refresh.TakeChange());
+    EXPECT_FALSE(refresh.TakeChange());
+
+    CRenderDriverCache saved;
+    ASSERT_TRUE(saved.Load(m_Path.string().c_str()));
+    EXPECT_TRUE(saved.Equals(refresh.GetDrivers()));
+    EXPECT_TRUE(saved.Matches(cache.GetAdapter(), cache.GetDriverVersion()));
+    ASSERT_EQ(saved.GetDriverCount(), 1);
+    EXPECT_EQ(saved.GetDriver(0).modes.size(), 4u);
+}
+
+TEST_F(RenderDriverCacheTest, RefreshWithoutCacheWritesOne) {
+    CRenderDriverCache identity;
+    identity.Reset("Adapter", "1.0");
+    FakeDriverSource source;
+    source.m_Drivers.push_back(Driver("Direct3D 9 HAL", "Hardware", 2));
+
+    CRenderDriverCacheRefresh refresh;
+    ASSERT_TRUE(refresh.Start(source, identity, m_Path.string().c_str()));
+    refresh.Wait();
+    EXPECT_TRUE(refresh.HasChanged());
+
+    CRenderDriverCache saved;
+    ASSERT_TRUE(saved.Load(m_Path.string().c_str()));
+    EXPECT_TRUE(saved.Matches("Adapter", "1.0"));
+}
+
+TEST_F(RenderDriverCacheTest, FailedEnumerationLeavesTheCache) {
+    const CRenderDriverCache cache = MakeCache();
+    ASSERT_TRUE(cache.Save(m_Path.string().c_str()));
+
+    FakeDriverSource source;
+    source.m_Fail = true;
+
+    CRenderDriverCacheRefresh refresh;
+    ASSERT_TRUE(refresh.Start(source, cache, m_Path.string().c_str()));
+    refresh.Wait();
+    EXPECT_TRUE(refresh.IsDone());
+    EXPECT_FALSE(refresh.HasChanged());
+
+    CRenderDriverCache loaded;
+    ASSERT_TRUE(loaded.Load(m_Path.string().c_str()));
+    EXPECT_TRUE(loaded.Equals(cache));
+
+    // A refresh can run again once the previous one finished.
+    source.m_Fail = false;
+    ASSERT_TRUE(refresh.Start(source, cache, NULL));
+    refresh.Wait();
+    EXPECT_EQ(source.m_Calls, 2);
+    EXPECT_TRUE(refresh.HasChanged());
+}
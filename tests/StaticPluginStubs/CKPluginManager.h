@@ -0,0 +1,26 @@
+#ifndef STATIC_PLUGIN_STUBS_CKPLUGINMANAGER_H
+#define STATIC_PLUGIN_STUBS_CKPLUGINMANAGER_H
+
+// Stand-ins for the CK2 types the generated static plugin tables refer to, so the
+// generator and the tables can be tested without CK2.
+
+struct CKGUID {
+    unsigned long d1;
+    unsigned long d2;
+};
+
+struct CKPluginInfo {
+    CKGUID m_GUID;
+    int m_Type;
+    int (*m_InitInstanceFct)(void *);
+};
+
+struct CKDataReader {
+    int id;
+};
+
+struct XObjectDeclarationArray {
+    int count;
+};
+
+#endif // STATIC_PLUGIN_STUBS_CKPLUGINMANAGER_H
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "CKPluginManager.h"
+
+extern CKPluginInfo g_StaticTestInfos[6];
+
+#include "StaticPluginTable.inc"
+#include "StaticPluginGuids.inc"
+
+TEST(StaticPluginTableTest, KeepsDeclarationOrder) {
+    ASSERT_EQ(kStaticPluginCount, 5);
+    ASSERT_EQ(sizeof(kStaticPlugins) / sizeof(kStaticPlugins[0]), 5u);
+    const char *expected[] = {"Zeta", "Alpha", "Beta_RT", "Beta", "3DTransfo"};
+    for (int i = 0; i < kStaticPluginCount; ++i)
+        EXPECT_STREQ(kStaticPlugins[i].Name, expected[i]) << i;
+}
+
+TEST(StaticPluginTableTest, WiresOptionalEntryPoints) {
+    const StaticPlugin &zeta = kStaticPlugins[0];
+    EXPECT_EQ(zeta.GetInfoCount, nullptr);
+    EXPECT_EQ(zeta.GetReader, nullptr);
+    EXPECT_EQ(zeta.RegisterDeclarations, nullptr);
+    EXPECT_EQ(zeta.GetInfo(0), &g_StaticTestInfos[0]);
+
+    const StaticPlugin &alpha = kStaticPlugins[1];
+    ASSERT_NE(alpha.GetInfoCount, nullptr);
+    EXPECT_EQ(alpha.GetInfoCount(), 2);
+    ASSERT_NE(alpha.GetReader, nullptr);
+    EXPECT_EQ(alpha.GetReader(0)->id, 7);
+    EXPECT_EQ(alpha.RegisterDeclarations, nullptr);
+
+    const StaticPlugin &betaRT = kStaticPlugins[2];
+    ASSERT_NE(betaRT.RegisterDeclarations, nullptr);
+    XObjectDeclarationArray array = {0};
+    betaRT.RegisterDeclarations(&array);
+    EXPECT_EQ(array.count, 1);
+    EXPECT_EQ(betaRT.GetReader, nullptr);
+}
+
+TEST(StaticPluginTableTest, GuidTableListsEveryInfoInGuidOrder) {
+    ASSERT_EQ(kStaticPluginGuidCount, 6);
+    ASSERT_EQ(sizeof(kStaticPluginGuids) / sizeof(kStaticPluginGuids[0]), 6u);
+    for (int i = 1; i < kStaticPluginGuidCount; ++i) {
+        const StaticPluginGuid &a = kStaticPluginGuids[i - 1];
+        const StaticPluginGuid &b = kStaticPluginGuids[i];
+        EXPECT_TRUE(a.D1 < b.D1 || (a.D1 == b.D1 && a.D2 < b.D2)) << i;
+    }
+
+    // Unsigned order: 0xF0000000 comes last.
+    EXPECT_EQ(kStaticPluginGuids[0].D1, 0x00000001ul);
+    EXPECT_STREQ(kStaticPlugins[kStaticPluginGuids[0].Plugin].Name, "3DTransfo");
+    EXPECT_EQ(kStaticPluginGuids[1].D2, 0x00000001ul);
+    EXPECT_EQ(kStaticPluginGuids[2].D2, 0x00000002ul);
+    EXPECT_STREQ(kStaticPlugins[kStaticPluginGuids[5].Plugin].Name, "Beta");
+}
+
+TEST(StaticPluginTableTest, GuidTableKeepsTypesAndFlags) {
+    for (int i = 0; i < 6; ++i) {
+        const CKPluginInfo &info = g_StaticTestInfos[i];
+        const StaticPluginGuid *guid = FindStaticPluginGuid(kStaticPluginGuids, kStaticPluginGuidCount,
+                                                            info.m_GUID.d1, info.m_GUID.d2);
+        ASSERT_NE(guid, nullptr) << i;
+        EXPECT_EQ(guid->Type, info.m_Type) << i;
+        EXPECT_EQ(guid->Flags, info.m_InitInstanceFct ? (int)STATIC_PLUGIN_HAS_INIT_INSTANCE : 0) << i;
+        const StaticPlugin &plugin = kStaticPlugins[guid->Plugin];
+        bool provides = false;
+        const int count = plugin.GetInfoCount ? plugin.GetInfoCount() : 1;
+        for (int j = 0; j < count; ++j) {
+            if (plugin.GetInfo(j) == &info)
+                provides = true;
+        }
+        EXPECT_TRUE(provides) << i;
+    }
+}
+
+TEST(StaticPluginTableTest, FindsNothingForUnknownGuids) {
+    EXPECT_EQ(FindStaticPluginGuid(kStaticPluginGuids, kStaticPluginGuidCount, 0, 0), nullptr);
+    EXPECT_EQ(FindStaticPluginGuid(kStaticPluginGuids, kStaticPluginGuidCount, 0x10000000, 0x00000003), nullptr);
+    EXPECT_EQ(FindStaticPluginGuid(kStaticPluginGuids, kStaticPluginGuidCount, 0xFFFFFFFF, 0xFFFFFFFF), nullptr);
+    EXPECT_EQ(FindStaticPluginGuid(kStaticPluginGuids, 0, 0x30000000, 0x00000001), nullptr);
+}
+
+TEST(StaticPluginTableTest, ReportsLinkTargets) {
+    EXPECT_EQ(std::string(STATIC_PLUGIN_TEST_TARGETS), "ZetaStatic,Beta_RTStatic");
+}
@@ -0,0 +1,26 @@
+// Fake modules for the static plugin table tests, declared in tests/CMakeLists.txt.
+#include "CKPluginManager.h"
+
+namespace {
+    int InitInstance(void *) { return 0; }
+}
+
+CKPluginInfo g_StaticTestInfos[6] = {
+    {{0x30000000, 0x00000001}, 4, nullptr},      // Zeta
+    {{0x10000000, 0x00000002}, 1, nullptr},      // Alpha, reader
+    {{0x10000000, 0x00000001}, 1, nullptr},      // Alpha, reader
+    {{0x20000000, 0x00000000}, 2, InitInstance}, // Beta_RT, manager
+    {{0xF0000000, 0x00000000}, 4, nullptr},      // Beta
+    {{0x00000001, 0xFFFFFFFF}, 4, nullptr},      // 3DTransfo
+};
+CKDataReader g_StaticTestReader = {7};
+
+CKPluginInfo *Zeta_GetInfo(int) { return &g_StaticTestInfos[0]; }
+CKPluginInfo *Alpha_GetInfo(int index) { return &g_StaticTestInfos[1 + index]; }
+int Alpha_GetInfoCount() { return 2; }
+CKDataReader *Alpha_GetReader(int) { return &g_StaticTestReader; }
+CKPluginInfo *BetaRT_GetInfo(int) { return &g_StaticTestInfos[3]; }
+int BetaRT_GetInfoCount() { return 1; }
+void BetaRT_RegisterDeclarations(XObjectDeclarationArray *array) { ++array->count; }
+CKPluginInfo *Beta_GetInfo(int) { return &g_StaticTestInfos[4]; }
+CKPluginInfo *Transfo_GetInfo(int) { return &g_StaticTestInfos[5]; }
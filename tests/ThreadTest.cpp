@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "Thread.h"
+
+namespace {
+    struct CountingJob {
+        std::vector<std::atomic<int> > *hits;
+        std::atomic<int> calls;
+    };
+
+    void CountTask(int index, void *arg) {
+        CountingJob *job = static_cast<CountingJob *>(arg);
+        (*job->hits)[index].fetch_add(1);
+        job->calls.fetch_add(1);
+    }
+}
+
+TEST(RunParallelTest, RunsEveryIndexExactlyOnce) {
+    const int kCount = 1000;
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        std::vector<std::atomic<int> > hits(kCount);
+        for (int i = 0; i < kCount; ++i)
+            hits[i] = 0;
+        CountingJob job;
+        job.hits = &hits;
+        job.calls = 0;
+
+        RunParallel(kCount, threads, CountTask, &job);
+
+        EXPECT_EQ(job.calls.load(), kCount);
+        for (int i = 0; i < kCount; ++i)
+            ASSERT_EQ(hits[i].load(), 1) << "index " << i << " with " << threads << " threads";
+    }
+}
+
+TEST(RunParallelTest, IgnoresEmptyWork) {
+    std::vector<std::atomic<int> > hits(1);
+    hits[0] = 0;
+    CountingJob job;
+    job.hits = &hits;
+    job.calls = 0;
+
+    RunParallel(0, 4, CountTask, &job);
+    RunParallel(-1, 4, CountTask, &job);
+    RunParallel(1, 0, CountTask, &job);
+    RunParallel(1, 4, NULL, &job);
+    EXPECT_EQ(job.calls.load(), 1);
+}
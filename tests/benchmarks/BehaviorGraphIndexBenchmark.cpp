@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../BehaviorGraphMock.h"
+
+TEST(BehaviorGraphIndexBenchmark, LookupsAgainstScans) {
+    const int kBehaviors = 2000;
+    const int kLinks = 4000;
+    const int kNames = 400;
+    const int kQueries = 2000;
+
+    std::mt19937 rng(41);
+    MockScript script;
+    std::vector<MockBehavior *> behaviors;
+    std::vector<std::string> names;
+    for (int i = 0; i < kNames; ++i)
+        names.push_back("Building Block " + std::to_string(i));
+    for (int i = 0; i < kBehaviors; ++i)
+        behaviors.push_back(script.Add(names[rng() % kNames]));
+    for (int i = 0; i < kLinks; ++i)
+        script.Link(behaviors[rng() % kBehaviors], behaviors[rng() % kBehaviors], rng() % 2, rng() % 2);
+
+    std::vector<std::pair<int, int> > queries;
+    for (int i = 0; i < kQueries; ++i)
+        queries.push_back(std::make_pair((int)(rng() % kNames), (int)(rng() % kNames)));
+
+    auto buildStart = std::chrono::steady_clock::now();
+    MockIndex index;
+    index.Build(script.Get());
+    auto buildTime = std::chrono::steady_clock::now() - buildStart;
+
+    // Each query walks every match, the way patches step with "previous".
+    long long indexHits = 0;
+    auto indexStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const char *inName = names[queries[i].first].c_str();
+        const char *outName = names[queries[i].second].c_str();
+        for (MockBehavior *beh = index.FindBehavior(inName); beh; beh = index.FindBehavior(inName, beh))
+            ++indexHits;
+        for (MockLink *link = index.FindLink(inName, outName, 0, 0); link; link = index.FindLink(inName, outName, 0, 0, link))
+            indexHits += 1000;
+    }
+    auto indexTime = std::chrono::steady_clock::now() - indexStart;
+
+    long long scanHits = 0;
+    auto scanStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const char *inName = names[queries[i].first].c_str();
+        const char *outName = names[queries[i].second].c_str();
+        for (MockBehavior *beh = ScanBehavior(script.Get(), inName); beh; beh = ScanBehavior(script.Get(), inName, beh))
+            ++scanHits;
+        for (MockLink *link = ScanLink(script.Get(), inName, outName, 0, 0); link; link = ScanLink(script.Get(), inName, outName, 0, 0, link))
+            scanHits += 1000;
+    }
+    auto scanTime = std::chrono::steady_clock::now() - scanStart;
+
+    EXPECT_EQ(indexHits, scanHits);
+
+    double buildUs = std::chrono::duration<double, std::micro>(buildTime).count();
+    double indexUs = std::chrono::duration<double, std::micro>(indexTime).count();
+    double scanUs = std::chrono::duration<double, std::micro>(scanTime).count();
+    RecordProperty("BuildUs", (int)buildUs);
+    RecordProperty("IndexQueryNs", (int)(indexUs * 1000 / kQueries));
+    RecordProperty("ScanQueryNs", (int)(scanUs * 1000 / kQueries));
+    printf("[ BENCH    ] %d behaviors, %d links: build %.0f us, index %.1f ns/query, scan %.1f ns/query\n",
+           kBehaviors, kLinks, buildUs, indexUs * 1000 / kQueries, scanUs * 1000 / kQueries);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "BmpImage.h"
+#include "MappedFile.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    typedef std::vector<unsigned char> Bytes;
+
+    void Put16(Bytes &out, size_t at, unsigned int value) {
+        out[at] = (unsigned char)value;
+        out[at + 1] = (unsigned char)(value >> 8);
+    }
+
+    void Put32(Bytes &out, size_t at, platform::uint32 value) {
+        for (int i = 0; i < 4; ++i)
+            out[at + i] = (unsigned char)(value >> (8 * i));
+    }
+
+    // A BMP with an info header, `colors` palette entries and the given pixel bytes.
+    Bytes MakeBmp(int width, int height, int bitCount, int compression, int colors, const Bytes &pixels) {
+        const size_t paletteOffset = 14 + 40 + (compression == eBmpBitfields ? 12 : 0);
+        const size_t pixelOffset = paletteOffset + (size_t)colors * 4;
+        Bytes out(pixelOffset, 0);
+        out[0] = 'B';
+        out[1] = 'M';
+        Put32(out, 2, (platform::uint32)(pixelOffset + pixels.size()));
+        Put32(out, 10, (platform::uint32)pixelOffset);
+        Put32(out, 14, 40);
+        Put32(out, 18, (platform::uint32)width);
+        Put32(out, 22, (platform::uint32)height);
+        Put16(out, 26, 1);
+        Put16(out, 28, (unsigned int)bitCount);
+        Put32(out, 30, (platform::uint32)compression);
+        Put32(out, 34, (platform::uint32)pixels.size());
+        Put32(out, 46, (platform::uint32)colors);
+        if (compression == eBmpBitfields) {
+            Put32(out, 54, 0x00FF0000);
+            Put32(out, 58, 0x0000FF00);
+            Put32(out, 62, 0x000000FF);
+        }
+        for (int i = 0; i < colors; ++i) {
+            out[paletteOffset + i * 4] = (unsigned char)i;            // blue
+            out[paletteOffset + i * 4 + 1] = (unsigned char)(i * 2);  // green
+            out[paletteOffset + i * 4 + 2] = (unsigned char)(i * 3);  // red
+        }
+        out.insert(out.end(), pixels.begin(), pixels.end());
+        return out;
+    }
+
+    Bytes Gradient(size_t size) {
+        Bytes pixels(size);
+        for (size_t i = 0; i < size; ++i)
+            pixels[i] = (unsigned char)(i * 7);
+        return pixels;
+    }
+
+    fs::path WriteFile(const char *name, const Bytes &contents) {
+        const fs::path path = fs::temp_directory_path() / name;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write((const char *)contents.data(), (std::streamsize)contents.size());
+        return path;
+    }
+
+    // Reads every byte of every row, so the pages behind a mapping are loaded.
+    unsigned int SumRows(const CBmpImage &image) {
+        const size_t rowBytes = ((size_t)image.GetWidth() * image.GetBitCount() + 7) / 8;
+        unsigned int sum = 0;
+        for (int y = 0; y < image.GetHeight(); ++y) {
+            const unsigned char *row = image.GetRow(y);
+            for (size_t x = 0; x < rowBytes; ++x)
+                sum += row[x];
+        }
+        return sum;
+    }
+}
+
+TEST(BmpImageBenchmark, MappingAgainstReadingTheWholeFile) {
+    const int kWidth = 1920;
+    const int kHeight = 1080;
+    const int kRounds = 20;
+    const Bytes contents = MakeBmp(kWidth, kHeight, 24, eBmpRgb, 0, Gradient((size_t)kWidth * 3 * kHeight));
+    const fs::path path = WriteFile("ballance_bmp_image_bench.bmp", contents);
+
+    // The old loader: read the file into a buffer of its own, then decode that.
+    unsigned int readSum = 0;
+    auto readStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+        std::ifstream in(path, std::ios::binary);
+        Bytes buffer(contents.size());
+        in.read((char *)buffer.data(), (std::streamsize)buffer.size());
+        CBmpImage image;
+        ASSERT_TRUE(image.Decode(buffer.data(), buffer.size()));
+        readSum += SumRows(image);
+    }
+    auto readTime = std::chrono::steady_clock::now() - readStart;
+
+    unsigned int mapSum = 0;
+    auto mapStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+        CMappedFile file;
+        ASSERT_TRUE(file.Open(path.string().c_str()));
+        CBmpImage image;
+        ASSERT_TRUE(image.Decode(file.GetData(), (size_t)file.GetSize()));
+        mapSum += SumRows(image);
+    }
+    auto mapTime = std::chrono::steady_clock::now() - mapStart;
+
+    EXPECT_EQ(mapSum, readSum);
+
+    // Expanding a full-screen RLE8 image of short runs.
+    Bytes rle;
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; x += 8) {
+            rle.push_back(8);
+            rle.push_back((unsigned char)(x + y));
+        }
+        rle.push_back(0);
+        rle.push_back(0);
+    }
+    rle.push_back(0);
+    rle.push_back(1);
+    const Bytes rleFile = MakeBmp(kWidth, kHeight, 8, eBmpRle8, 256, rle);
+    unsigned int rleSum = 0;
+    auto rleStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; ++i) {
+        CBmpImage image;
+        ASSERT_TRUE(image.Decode(rleFile.data(), rleFile.size()));
+        rleSum += SumRows(image);
+    }
+    auto rleTime = std::chrono::steady_clock::now() - rleStart;
+
+    fs::remove(path);
+
+    double readUs = std::chrono::duration<double, std::micro>(readTime).count() / kRounds;
+    double mapUs = std::chrono::duration<double, std::micro>(mapTime).count() / kRounds;
+    double rleUs = std::chrono::duration<double, std::micro>(rleTime).count() / kRounds;
+    RecordProperty("ReadDecodeUs", (int)readUs);
+    RecordProperty("MapDecodeUs", (int)mapUs);
+    RecordProperty("Rle8DecodeUs", (int)rleUs);
+    printf("[ BENCH    ] %dx%d: read+decode %.0f us, map+decode %.0f us, RLE8 expand %.0f us (checksum %u)\n",
+           kWidth, kHeight, readUs, mapUs, rleUs, rleSum);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "DisplayModeCatalog.h"
+
+namespace {
+    DisplayMode Mode(int width, int height, int bpp, int refreshRate) {
+        DisplayMode mode = {width, height, bpp, refreshRate};
+        return mode;
+    }
+
+    // The two scans FindScreenMode used to make over the driver list.
+    int ScanMode(const std::vector<DisplayMode> &modes, int width, int height, int bpp) {
+        bool found = false;
+        int refreshRate = 0;
+        for (size_t i = 0; i < modes.size(); ++i) {
+            if (modes[i].width == width && modes[i].height == height && modes[i].bpp == bpp) {
+                found = true;
+                if (modes[i].refreshRate > refreshRate)
+                    refreshRate = modes[i].refreshRate;
+            }
+        }
+        if (!found)
+            return -1;
+        for (size_t j = 0; j < modes.size(); ++j) {
+            if (modes[j].width == width && modes[j].height == height && modes[j].bpp == bpp &&
+                modes[j].refreshRate == refreshRate)
+                return (int)j;
+        }
+        return -1;
+    }
+}
+
+TEST(DisplayModeCatalogBenchmark, LookupsAgainstScans) {
+    const int kSizes = 600;
+    const int kQueries = 5000;
+    const int depths[] = {16, 32};
+    const int rates[] = {60, 75, 120, 144};
+
+    std::mt19937 rng(41);
+    std::vector<DisplayMode> modes;
+    for (int i = 0; i < kSizes; ++i) {
+        const int width = 320 + 8 * i;
+        const int height = 200 + 4 * (i % 300);
+        for (int d = 0; d < 2; ++d) {
+            for (int r = 0; r < 4; ++r)
+                modes.push_back(Mode(width, height, depths[d], rates[rng() % 4]));
+        }
+    }
+
+    std::vector<DisplayMode> queries;
+    for (int i = 0; i < kQueries; ++i) {
+        const DisplayMode &mode = modes[rng() % modes.size()];
+        queries.push_back(Mode(mode.width, mode.height + (i % 10 == 0 ? 1 : 0), mode.bpp, 0));
+    }
+
+    auto buildStart = std::chrono::steady_clock::now();
+    CDisplayModeCatalog catalog;
+    catalog.Build(&modes[0], (int)modes.size());
+    auto buildTime = std::chrono::steady_clock::now() - buildStart;
+
+    long long catalogSum = 0;
+    auto catalogStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i)
+        catalogSum += catalog.FindMode(queries[i].width, queries[i].height, queries[i].bpp);
+    auto catalogTime = std::chrono::steady_clock::now() - catalogStart;
+
+    long long scanSum = 0;
+    auto scanStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < queries.size(); ++i)
+        scanSum += ScanMode(modes, queries[i].width, queries[i].height, queries[i].bpp);
+    auto scanTime = std::chrono::steady_clock::now() - scanStart;
+
+    EXPECT_EQ(catalogSum, scanSum);
+
+    double buildUs = std::chrono::duration<double, std::micro>(buildTime).count();
+    double catalogUs = std::chrono::duration<double, std::micro>(catalogTime).count();
+    double scanUs = std::chrono::duration<double, std::micro>(scanTime).count();
+    RecordProperty("BuildUs", (int)buildUs);
+    RecordProperty("CatalogQueryNs", (int)(catalogUs * 1000 / kQueries));
+    RecordProperty("ScanQueryNs", (int)(scanUs * 1000 / kQueries));
+    printf("[ BENCH    ] %d modes: build %.0f us, catalog %.1f ns/query, scan %.1f ns/query\n",
+           (int)modes.size(), buildUs, catalogUs * 1000 / kQueries, scanUs * 1000 / kQueries);
+}
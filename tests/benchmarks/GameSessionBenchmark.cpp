@@ -0,0 +1,22 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+#include "GameSession.h"
+
+TEST(GameSessionBenchmark, RestartsWithoutAllocating) {
+    CGameSession session;
+    const int kRestarts = 200000;
+
+    const platform::uint64 start = platform::GetTimeMicros();
+    for (int i = 0; i < kRestarts; ++i)
+        session.Start(i % 8 ? "base.cmo" : "..\\Maps\\Level_01.nmo", ".");
+    const platform::uint64 elapsed = platform::GetTimeMicros() - start;
+
+    const double nsPerRestart = elapsed * 1000.0 / kRestarts;
+    RecordProperty("ns_per_restart", (int)nsPerRestart);
+    printf("[ BENCH    ] %d restarts in %.1f ms, %.0f ns per restart\n",
+           kRestarts, elapsed / 1000.0, nsPerRestart);
+    EXPECT_EQ(session.GetPool().GetUsedCount(), 1u);
+    EXPECT_EQ(session.GetStrings().GetCount(), 3u);
+}
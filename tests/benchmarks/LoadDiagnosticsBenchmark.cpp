@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "LoadDiagnostics.h"
+
+namespace {
+    class MemorySink : public CDiagnosticsSink {
+    public:
+        MemorySink() : m_Writes(0), m_Fail(false) {}
+
+        virtual bool Write(const char *data, size_t size) {
+            ++m_Writes;
+            m_Text.append(data, size);
+            return !m_Fail;
+        }
+
+        std::string m_Text;
+        int m_Writes;
+        bool m_Fail;
+    };
+}
+
+TEST(LoadDiagnosticsBenchmark, RecordsEventsWithoutAllocating) {
+    MemorySink sink;
+    sink.m_Text.reserve(CLoadDiagnostics::DEFAULT_CAPACITY * 2);
+    CLoadDiagnostics diagnostics;
+    diagnostics.SetSink(&sink);
+
+    // A load of a typical community map: a handful of phases and paths, the
+    // full set of hotfix steps, a few missing GUIDs.
+    const char *const steps[] = {"default_level", "replace_path_root", "player_active_root", "language",
+                                 "screen_modes", "list_driver", "list_screen_modes", "bpp_filter",
+                                 "synch_to_screen", "skip_resolution_check"};
+    const platform::uint32 guids[] = {0x7a3f1c20, 0x4d2e0b91, 0x12345678, 0x9abcdef0};
+    const int kLoads = 20000;
+    int events = 0;
+
+    const platform::uint64 start = platform::GetTimeMicros();
+    for (int i = 0; i < kLoads; ++i) {
+        diagnostics.BeginLoad("D:\\Games\\Ballance\\Maps\\Community Map.nmo");
+        diagnostics.PathResolved("Community Map.nmo", "D:\\Games\\Ballance\\Maps\\Community Map.nmo");
+        diagnostics.Phase("open", 1480, 5242880);
+        diagnostics.MissingGuids(guids, 2);
+        diagnostics.Phase("load_data", 93000, 0);
+        for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); ++s)
+            diagnostics.Hotfix(steps[s], true);
+        diagnostics.Phase("finish", 4200, 0);
+        diagnostics.EndLoad(true);
+        events += (int)diagnostics.GetEventCount();
+        sink.m_Text.clear();
+    }
+    const platform::uint64 elapsed = platform::GetTimeMicros() - start;
+
+    const double nsPerEvent = elapsed * 1000.0 / events;
+    RecordProperty("events", events);
+    RecordProperty("ns_per_event", (int)nsPerEvent);
+    printf("[ BENCH    ] %d events in %.1f ms, %.0f ns per event, %.1f M events/s\n",
+           events, elapsed / 1000.0, nsPerEvent, events / (elapsed + 1.0));
+    EXPECT_EQ(sink.m_Writes, kLoads);
+    EXPECT_EQ(diagnostics.GetDroppedCount(), 0u);
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "PickGrid.h"
+
+namespace {
+    PickRect Rect(float left, float top, float right, float bottom) {
+        PickRect rect = {left, top, right, bottom};
+        return rect;
+    }
+
+    struct ScanItem {
+        platform::uint32 id;
+        PickRect rect;
+    };
+
+    int LinearQuery(const std::vector<ScanItem> &items, float x, float y) {
+        int count = 0;
+        for (size_t i = 0; i < items.size(); ++i) {
+            const PickRect &r = items[i].rect;
+            if (x >= r.left && x < r.right && y >= r.top && y < r.bottom)
+                ++count;
+        }
+        return count;
+    }
+}
+
+TEST(PickGridBenchmark, GridQueryAgainstLinearScan) {
+    const int kItems = 5000;
+    const int kQueries = 20000;
+    const int kWidth = 1920;
+    const int kHeight = 1080;
+
+    std::mt19937 rng(29);
+    std::uniform_real_distribution<float> px(0, kWidth);
+    std::uniform_real_distribution<float> py(0, kHeight);
+    std::uniform_real_distribution<float> size(4, 96);
+
+    CPickGrid grid;
+    grid.Reset(kWidth, kHeight);
+    std::vector<ScanItem> items;
+    for (int i = 0; i < kItems; ++i) {
+        float x = px(rng), y = py(rng);
+        ScanItem item = {(platform::uint32)(i + 1), Rect(x, y, x + size(rng), y + size(rng))};
+        items.push_back(item);
+        grid.Update(item.id, (i & 1) ? ePickEntity : ePickSprite, item.rect, i, true);
+    }
+
+    std::vector<std::pair<float, float> > points;
+    for (int i = 0; i < kQueries; ++i)
+        points.push_back(std::make_pair(px(rng), py(rng)));
+
+    long long gridHits = 0;
+    auto gridStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < points.size(); ++i)
+        gridHits += grid.Query(points[i].first, points[i].second, NULL, 0);
+    auto gridTime = std::chrono::steady_clock::now() - gridStart;
+
+    long long scanHits = 0;
+    auto scanStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < points.size(); ++i)
+        scanHits += LinearQuery(items, points[i].first, points[i].second);
+    auto scanTime = std::chrono::steady_clock::now() - scanStart;
+
+    EXPECT_EQ(gridHits, scanHits);
+
+    // Incremental refresh of a scene where 1% of the objects move.
+    auto refreshStart = std::chrono::steady_clock::now();
+    grid.BeginRefresh();
+    for (int i = 0; i < kItems; ++i) {
+        PickRect rect = items[i].rect;
+        if (i % 100 == 0) {
+            rect.left += 200;
+            rect.right += 200;
+        }
+        grid.Update(items[i].id, (i & 1) ? ePickEntity : ePickSprite, rect, i, true);
+    }
+    EXPECT_EQ(grid.EndRefresh(), 0);
+    auto refreshTime = std::chrono::steady_clock::now() - refreshStart;
+
+    // The same move when the tracker names the moved objects: only they are read.
+    auto movedStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kItems; i += 100) {
+        PickRect rect = items[i].rect;
+        rect.left += 400;
+        rect.right += 400;
+        grid.Update(items[i].id, (i & 1) ? ePickEntity : ePickSprite, rect, i, true);
+    }
+    auto movedTime = std::chrono::steady_clock::now() - movedStart;
+
+    double gridUs = std::chrono::duration<double, std::micro>(gridTime).count();
+    double scanUs = std::chrono::duration<double, std::micro>(scanTime).count();
+    double refreshUs = std::chrono::duration<double, std::micro>(refreshTime).count();
+    RecordProperty("GridQueryNs", (int)(gridUs * 1000 / kQueries));
+    RecordProperty("LinearQueryNs", (int)(scanUs * 1000 / kQueries));
+    double movedUs = std::chrono::duration<double, std::micro>(movedTime).count();
+    RecordProperty("RefreshUs", (int)refreshUs);
+    RecordProperty("MovedRefreshUs", (int)movedUs);
+    printf("[ BENCH    ] %d items: grid %.1f ns/query, linear %.1f ns/query, full refresh %.0f us, moved only %.1f us\n",
+           kItems, gridUs * 1000 / kQueries, scanUs * 1000 / kQueries, refreshUs, movedUs);
+}